@@ -13,6 +13,9 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
 #ifdef _MSC_VER
   #include <Windows.h>
 #else
@@ -26,6 +29,18 @@
 
 #include "hal/hal.h"
 #include "main_screen.h"
+#include "pomodoro.h"
+#include "pomodoro_runtime.h"
+#include "pomodoro_journal.h"
+#include "pomodoro_history.h"
+#include "pomodoro_stats.h"
+#include "settings_store.h"
+#include "timer.h"
+#include "core_log.h"
+#include "event.h"
+#include "trace.h"
+#include "render_profiler.h"
+#include "app_timer.h"
 
 // #define DEMO_WIDGET 1
 
@@ -36,6 +51,21 @@
 /*********************
  *      DEFINES
  *********************/
+#define WAKEUP_REPORT_PERIOD_MS     60000
+
+/*Journal of the session, flash image of the settings and history of finished phases, next to the executable's working directory*/
+#define POMODORO_JOURNAL_FILE       "pomodoro.journal"
+#define POMODORO_SETTINGS_FILE      "pomodoro.settings"
+#define POMODORO_HISTORY_FILE       "pomodoro.history"
+
+/*Chrome trace JSON written on SIGUSR1 (SIGBREAK on Windows) when built with POMODORO_TRACE*/
+#define POMODORO_TRACE_FILE         "pomodoro.trace.json"
+
+/*Longest sleep of the main loop with POMODORO_TRACE, so that an idle loop still sees the signal*/
+#define TRACE_DUMP_POLL_MS          250
+
+/*Per-mode frame histograms, rewritten every report period when built with POMODORO_RENDER_PROFILER*/
+#define POMODORO_RENDER_CSV_FILE    "pomodoro.render.csv"
 
 /**********************
  *      TYPEDEFS
@@ -44,10 +74,29 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void core_log_print_cb(core_log_level_e level, const char * msg);
+static int32_t local_utc_offset_s(void);
+static void event_notify_cb(void);
+static void display_render_event_cb(lv_event_t * e);
+static bool main_loop_is_quiescent(void);
+static void main_loop_wait(uint32_t timeout_ms);
+#if POMODORO_TRACE
+static void trace_flush_event_cb(lv_event_t * e);
+static void trace_signal_handler(int sig);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static bool render_pending = true;
+static bool core_threaded;
+static uint32_t event_wakeup_type;
+static uint32_t wakeup_count;
+static uint32_t wakeup_report_tick;
+static uint64_t invalidated_px;
+#if POMODORO_TRACE
+static volatile sig_atomic_t trace_dump_requested;
+#endif
 
 /**********************
  *      MACROS
@@ -62,16 +111,60 @@
 
 int main(int argc, char **argv)
 {
-  (void)argc; /*Unused*/
-  (void)argv; /*Unused*/
+  /*--threaded: run the Pomodoro Core on its own timing thread instead of this loop
+   *--low-power: step the progress ring once a second instead of animating it every frame*/
+  bool want_threaded = false;
+  bool low_power = false;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--threaded") == 0) want_threaded = true;
+    else if(strcmp(argv[i], "--low-power") == 0) low_power = true;
+  }
 
   /*Initialize LVGL*/
   lv_init();
 
+  /*Core messages go through the LVGL log like the rest of the app*/
+  core_log_register_print_cb(core_log_print_cb);
+
   /*Initialize the HAL (display, input devices, tick) for LVGL*/
-  sdl_hal_init(LCD_WIDTH, LCD_HEIGHT);
+  lv_display_t * disp = sdl_hal_init(LCD_WIDTH, LCD_HEIGHT);
+  lv_display_add_event_cb(disp, display_render_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+  lv_display_add_event_cb(disp, display_render_event_cb, LV_EVENT_REFR_READY, NULL);
+
+#if POMODORO_TRACE
+  /*Flight recorder: the loop, the Core and the UI callbacks of this thread, display flushes*/
+  TRACE_THREAD_NAME("main");
+  lv_display_add_event_cb(disp, trace_flush_event_cb, LV_EVENT_FLUSH_START, NULL);
+  lv_display_add_event_cb(disp, trace_flush_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+#ifdef SIGUSR1
+  signal(SIGUSR1, trace_signal_handler);
+#elif defined(SIGBREAK)
+  signal(SIGBREAK, trace_signal_handler);
+#endif
+#endif
+
+  /*Events posted from other threads, and snapshots of the threaded Core, wake the loop through the SDL queue*/
+  event_wakeup_type = SDL_RegisterEvents(1);
+
+  /*Apply the stored settings, load the history, then continue the session the last run left, counting the time the app was closed*/
+  timer_init();
+  settings_store_open(POMODORO_SETTINGS_FILE);
+  pomodoro_history_open(POMODORO_HISTORY_FILE);
+  pomodoro_stats_set_utc_offset(local_utc_offset_s());
+  pomodoro_stats_rebuild();
+  event_init();
+  pomodoro_journal_open(POMODORO_JOURNAL_FILE, 0);
+
+  if(want_threaded) {
+    pomodoro_runtime_set_wakeup_cb(event_notify_cb);
+    core_threaded = pomodoro_runtime_start();
+  }
+  if(!core_threaded) {
+    event_set_notify_cb(event_notify_cb);
+  }
 
   #ifndef DEMO_WIDGET
+    ui_main_screen_set_low_power(low_power);
     ui_main_screen(lv_screen_active());
   #else
 
@@ -79,20 +172,192 @@ int main(int argc, char **argv)
 
   #endif
 
+#if POMODORO_RENDER_PROFILER
+  /*After the screen is built, so its widgets report their draw tasks from the first frame*/
+  render_profiler_start(disp);
+#endif
+
+  wakeup_report_tick = SDL_GetTicks();
+
   while(1) {
+    if(core_threaded) {
+      /* The timing thread owns the Core: take its newest snapshot and replay the UI callbacks */
+      pomodoro_runtime_dispatch();
+    }
+    else {
+      /* Apply posted events and run the Pomodoro Core first so its UI callbacks render in this pass */
+      event_process();
+      pomodoro_tick();
+    }
+
     /* Periodically call the lv_task handler.
      * It could be done in a timer interrupt or an OS task too.*/
+    TRACE_BEGIN(TRACE_LV_TIMER);
     uint32_t sleep_time_ms = lv_timer_handler();
-    if(sleep_time_ms == LV_NO_TIMER_READY){
-	    sleep_time_ms =  LV_DEF_REFR_PERIOD;
+    TRACE_END(TRACE_LV_TIMER, sleep_time_ms);
+
+#if POMODORO_TRACE
+    if(trace_dump_requested) {
+      trace_dump_requested = 0;
+      if(trace_dump_json(POMODORO_TRACE_FILE)) {
+        LV_LOG_USER("[TRACE] %llu records, last ones written to %s\n",
+                    (unsigned long long)trace_get_count(), POMODORO_TRACE_FILE);
+      }
     }
-#ifdef _MSC_VER
-    Sleep(sleep_time_ms);
-#else
-    usleep(sleep_time_ms * 1000);
 #endif
+    uint32_t core_wait_ms = core_threaded ? POMODORO_NO_DEADLINE : pomodoro_get_next_deadline_ms();
 
+    if(!core_threaded && event_is_pending()) {
+      /* Posted while LVGL ran (e.g. a button): apply it right away */
+      sleep_time_ms = 0;
+    }
+    else if(main_loop_is_quiescent()) {
+      /* IDLE / PAUSED_* with nothing to draw: sleep until input arrives or a timer of the app is due
+       * (LV_NO_TIMER_READY if there is none). LVGL's own polling is left to the SDL events. */
+      sleep_time_ms = app_timer_wait_ms();
+    }
+    else {
+      if(sleep_time_ms == LV_NO_TIMER_READY){
+        sleep_time_ms =  LV_DEF_REFR_PERIOD;
+      }
+      if(core_wait_ms < sleep_time_ms) {
+        sleep_time_ms = core_wait_ms;
+      }
+    }
+
+#if POMODORO_TRACE
+    /* SDL_WaitEvent() does not return on a signal: poll trace_dump_requested while idle */
+    if(sleep_time_ms > TRACE_DUMP_POLL_MS) {
+      sleep_time_ms = TRACE_DUMP_POLL_MS;
+    }
+#endif
+    main_loop_wait(sleep_time_ms);
   }
 
   return 0;
 }
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void core_log_print_cb(core_log_level_e level, const char * msg)
+{
+  if(level == CORE_LOG_LEVEL_WARN) {
+    LV_LOG_WARN("%s", msg);
+  }
+  else {
+    LV_LOG_USER("%s", msg);
+  }
+}
+
+/* Offset of local time to UTC now, so that stats days start at local midnight */
+static int32_t local_utc_offset_s(void)
+{
+  time_t now = time(NULL);
+  struct tm local = *localtime(&now);
+  struct tm utc = *gmtime(&now);
+
+  utc.tm_isdst = local.tm_isdst;
+  return (int32_t)difftime(now, mktime(&utc));
+}
+
+/* Called in the poster's context (or on the timing thread), SDL_PushEvent() is thread safe */
+static void event_notify_cb(void)
+{
+  if(event_wakeup_type != (uint32_t)-1) {
+    SDL_Event ev;
+    SDL_zero(ev);
+    ev.type = event_wakeup_type;
+    SDL_PushEvent(&ev);
+  }
+}
+
+static void display_render_event_cb(lv_event_t * e)
+{
+  if(lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+    const lv_area_t * area = lv_event_get_param(e);
+    render_pending = true;
+    if(area) invalidated_px += lv_area_get_size(area);
+  }
+  else {
+    render_pending = false;
+  }
+}
+
+#if POMODORO_TRACE
+static void trace_flush_event_cb(lv_event_t * e)
+{
+  if(lv_event_get_code(e) == LV_EVENT_FLUSH_START) {
+    TRACE_BEGIN(TRACE_FLUSH);
+  }
+  else {
+    const lv_area_t * area = lv_event_get_param(e);
+    TRACE_END(TRACE_FLUSH, area ? lv_area_get_size(area) : 0);
+  }
+}
+
+/* Only raises a flag, the loop writes the file at its next pass, within TRACE_DUMP_POLL_MS */
+static void trace_signal_handler(int sig)
+{
+  trace_dump_requested = 1;
+  signal(sig, trace_signal_handler);
+}
+#endif
+
+static bool main_loop_is_quiescent(void)
+{
+  /* The threaded Core wakes the loop itself when it publishes a snapshot. Between
+   * snapshots the ring frames come from their lv_timer, see app_timer.h */
+  if(!core_threaded && pomodoro_get_next_deadline_ms() != POMODORO_NO_DEADLINE) return false;
+  if(render_pending || lv_anim_count_running() > 0) return false;
+
+  /* A held button needs polling for long press / pressing events */
+  for(lv_indev_t * indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev)) {
+    if(lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED) return false;
+  }
+
+  return true;
+}
+
+/* Sleep until the timeout or the next SDL event, whichever comes first */
+static void main_loop_wait(uint32_t timeout_ms)
+{
+  if(timeout_ms == LV_NO_TIMER_READY) {
+    SDL_WaitEvent(NULL);
+  }
+  else if(timeout_ms > 0) {
+    SDL_WaitEventTimeout(NULL, (int)timeout_ms);
+  }
+
+  wakeup_count++;
+
+  uint32_t now = SDL_GetTicks();
+  if(now - wakeup_report_tick >= WAKEUP_REPORT_PERIOD_MS) {
+    timer_latency_stats_t lat;
+    if(core_threaded) {
+      /* Since start, as published by the timing thread */
+      pomodoro_runtime_get_tick_latency(&lat);
+    }
+    else {
+      timer_get_tick_latency(&lat);
+      timer_reset_tick_latency();
+    }
+
+    LV_LOG_USER("[MAIN] %u wakeups/min, tick latency p50 %d ms p99 %d ms max %d ms (%u ticks, lead %u ms)\n",
+                (unsigned)((uint64_t)wakeup_count * WAKEUP_REPORT_PERIOD_MS / (now - wakeup_report_tick)),
+                (int)lat.p50_ms, (int)lat.p99_ms, (int)lat.max_ms, (unsigned)lat.count, (unsigned)lat.lead_ms);
+    /*Overlapping invalidations are counted each, LVGL joins them before rendering*/
+    LV_LOG_USER("[UI] %u property writes/min, %llu px invalidated/min\n",
+                (unsigned)((uint64_t)ui_main_screen_take_prop_writes() * WAKEUP_REPORT_PERIOD_MS / (now - wakeup_report_tick)),
+                (unsigned long long)(invalidated_px * WAKEUP_REPORT_PERIOD_MS / (now - wakeup_report_tick)));
+    invalidated_px = 0;
+#if POMODORO_RENDER_PROFILER
+    if(!render_profiler_write_csv(POMODORO_RENDER_CSV_FILE)) {
+      LV_LOG_WARN("[RENDER] cannot write %s\n", POMODORO_RENDER_CSV_FILE);
+    }
+#endif
+    wakeup_count = 0;
+    wakeup_report_tick = now;
+  }
+}
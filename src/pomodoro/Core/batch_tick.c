@@ -0,0 +1,274 @@
+#include <stddef.h>
+#include <string.h>
+#include "batch_tick.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define BATCH_TICK_HAS_X86  1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#else
+    #define BATCH_TICK_HAS_X86  0
+#endif
+
+// GCC and Clang only emit SSE2 / AVX2 instructions inside functions marked for them,
+// so the rest of the Core stays buildable for the baseline CPU
+#if BATCH_TICK_HAS_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define TARGET_SSE2     __attribute__((target("sse2")))
+    #define TARGET_AVX2     __attribute__((target("avx2")))
+#else
+    #define TARGET_SSE2
+    #define TARGET_AVX2
+#endif
+
+typedef uint32_t (*batch_tick_fn)(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                                  uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired);
+
+// ====================== Scalar ======================
+
+// Bits set in an expired word, for every path and target (_mm_popcnt_u64 is x86-64 only).
+// MSVC's __popcnt is the POPCNT instruction itself, only taken when /arch:AVX guarantees it.
+static inline uint32_t popcount64(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcountll(bits);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) && defined(__AVX__)
+    return __popcnt((uint32_t)bits) + __popcnt((uint32_t)(bits >> 32));
+#else
+    bits -= (bits >> 1) & 0x5555555555555555ull;
+    bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (uint32_t)((bits * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Lanes [first, count) of one mask word, returns the expired bits
+static inline uint64_t tick_lanes_scalar(uint32_t *remaining_ms, const uint8_t *state, uint32_t first,
+                                         uint32_t count, uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max) {
+    uint64_t bits = 0;
+
+    for (uint32_t i = first; i < count; i++) {
+        // All-ones / all-zeros lane masks keep the loop free of branches
+        uint32_t running = 0u - (uint32_t)((uint8_t)(state[i] - run_min) <= (uint8_t)(run_max - run_min));
+        uint32_t alive = 0u - (uint32_t)(remaining_ms[i] > elapsed_ms);
+
+        remaining_ms[i] -= elapsed_ms & running & alive;
+        bits |= (uint64_t)(running & ~alive & 1u) << (i & 63u);
+    }
+    return bits;
+}
+
+static uint32_t tick_scalar(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                            uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired) {
+    uint32_t total = 0;
+    uint32_t base = 0;
+
+    for (; base + 64u <= count; base += 64u) {
+        uint8_t flags[64];
+        uint64_t bits = 0;
+        uint32_t *rem = &remaining_ms[base];
+        const uint8_t *st = &state[base];
+
+        for (uint32_t i = 0; i < 64u; i++) {
+            uint32_t running = 0u - (uint32_t)((uint8_t)(st[i] - run_min) <= (uint8_t)(run_max - run_min));
+            uint32_t alive = 0u - (uint32_t)(rem[i] > elapsed_ms);
+
+            rem[i] -= elapsed_ms & running & alive;
+            flags[i] = (uint8_t)(running & ~alive & 1u);
+        }
+        for (uint32_t i = 0; i < 64u; i++) {
+            bits |= (uint64_t)flags[i] << i;
+        }
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+    if (base < count) {
+        uint64_t bits = tick_lanes_scalar(remaining_ms, state, base, count, elapsed_ms, run_min, run_max);
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+    return total;
+}
+
+// ====================== SSE2 / AVX2 ======================
+#if BATCH_TICK_HAS_X86
+
+/*
+ * Per lane: running = run_min <= state <= run_max, alive = remaining > elapsed.
+ * SSE2 and AVX2 only compare signed 32-bit lanes; flipping the sign bit of both
+ * sides turns that into the unsigned compare the countdown needs.
+ */
+
+TARGET_SSE2
+static uint32_t tick_sse2(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                          uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    const __m128i elapsed = _mm_set1_epi32((int)elapsed_ms);
+    const __m128i elapsed_biased = _mm_xor_si128(elapsed, bias);
+    const __m128i lo = _mm_set1_epi32((int)run_min - 1);
+    const __m128i hi = _mm_set1_epi32((int)run_max + 1);
+    uint32_t total = 0;
+    uint32_t base = 0;
+
+    for (; base + 64u <= count; base += 64u) {
+        uint64_t bits = 0;
+
+        for (uint32_t i = 0; i < 64u; i += 4u) {
+            int32_t st4;
+            memcpy(&st4, &state[base + i], sizeof(st4));
+            __m128i st = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(st4), zero), zero);
+            __m128i running = _mm_and_si128(_mm_cmpgt_epi32(st, lo), _mm_cmplt_epi32(st, hi));
+
+            __m128i rem = _mm_loadu_si128((const __m128i *)&remaining_ms[base + i]);
+            __m128i alive = _mm_cmpgt_epi32(_mm_xor_si128(rem, bias), elapsed_biased);
+            __m128i dec = _mm_and_si128(running, alive);
+
+            _mm_storeu_si128((__m128i *)&remaining_ms[base + i], _mm_sub_epi32(rem, _mm_and_si128(elapsed, dec)));
+            bits |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(alive, running))) << i;
+        }
+
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+
+    if (base < count) {
+        uint64_t bits = tick_lanes_scalar(remaining_ms, state, base, count, elapsed_ms, run_min, run_max);
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+    return total;
+}
+
+TARGET_AVX2
+static uint32_t tick_avx2(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                          uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired) {
+    const __m256i bias = _mm256_set1_epi32((int)0x80000000u);
+    const __m256i elapsed = _mm256_set1_epi32((int)elapsed_ms);
+    const __m256i elapsed_biased = _mm256_xor_si256(elapsed, bias);
+    const __m256i lo = _mm256_set1_epi32((int)run_min - 1);
+    const __m256i hi = _mm256_set1_epi32((int)run_max + 1);
+    uint32_t total = 0;
+    uint32_t base = 0;
+
+    for (; base + 64u <= count; base += 64u) {
+        uint64_t bits = 0;
+
+        for (uint32_t i = 0; i < 64u; i += 8u) {
+            __m256i st = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&state[base + i]));
+            __m256i running = _mm256_and_si256(_mm256_cmpgt_epi32(st, lo), _mm256_cmpgt_epi32(hi, st));
+
+            __m256i rem = _mm256_loadu_si256((const __m256i *)&remaining_ms[base + i]);
+            __m256i alive = _mm256_cmpgt_epi32(_mm256_xor_si256(rem, bias), elapsed_biased);
+            __m256i dec = _mm256_and_si256(running, alive);
+
+            _mm256_storeu_si256((__m256i *)&remaining_ms[base + i], _mm256_sub_epi32(rem, _mm256_and_si256(elapsed, dec)));
+            bits |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(alive, running))) << i;
+        }
+
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+
+    if (base < count) {
+        uint64_t bits = tick_lanes_scalar(remaining_ms, state, base, count, elapsed_ms, run_min, run_max);
+        expired[base / 64u] = bits;
+        total += popcount64(bits);
+    }
+    return total;
+}
+
+static bool cpu_has_avx2(void) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int regs[4];
+
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    // OSXSAVE and the OS saving YMM state
+    if (!(regs[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // BATCH_TICK_HAS_X86
+
+// ====================== Dispatch ======================
+
+static const struct {
+    const char      *name;
+    batch_tick_fn   fn;
+} impls[BATCH_TICK_IMPL_COUNT] = {
+    [BATCH_TICK_AUTO]   = { "auto",   NULL },
+    [BATCH_TICK_SCALAR] = { "scalar", tick_scalar },
+#if BATCH_TICK_HAS_X86
+    [BATCH_TICK_SSE2]   = { "sse2",   tick_sse2 },
+    [BATCH_TICK_AVX2]   = { "avx2",   tick_avx2 },
+#else
+    [BATCH_TICK_SSE2]   = { "sse2",   NULL },
+    [BATCH_TICK_AVX2]   = { "avx2",   NULL },
+#endif
+};
+
+static batch_tick_impl_e current_impl = BATCH_TICK_AUTO;
+
+static batch_tick_impl_e best_impl(void) {
+    if (batch_tick_is_supported(BATCH_TICK_AVX2)) return BATCH_TICK_AVX2;
+    if (batch_tick_is_supported(BATCH_TICK_SSE2)) return BATCH_TICK_SSE2;
+    return BATCH_TICK_SCALAR;
+}
+
+// ====================== Public API ======================
+
+uint32_t batch_tick(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                    uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired) {
+    if (current_impl == BATCH_TICK_AUTO) {
+        current_impl = best_impl();
+    }
+    return impls[current_impl].fn(remaining_ms, state, count, elapsed_ms, run_min, run_max, expired);
+}
+
+bool batch_tick_is_supported(batch_tick_impl_e impl) {
+    switch (impl) {
+        case BATCH_TICK_AUTO:
+        case BATCH_TICK_SCALAR:
+            return true;
+#if BATCH_TICK_HAS_X86
+        case BATCH_TICK_SSE2:
+            // Baseline on x86-64; on 32-bit x86 only if the build may use it
+  #if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+            return true;
+  #else
+            return false;
+  #endif
+        case BATCH_TICK_AVX2:
+            return cpu_has_avx2();
+#endif
+        default:
+            return false;
+    }
+}
+
+bool batch_tick_select(batch_tick_impl_e impl) {
+    if (impl >= BATCH_TICK_IMPL_COUNT || !batch_tick_is_supported(impl)) {
+        return false;
+    }
+    current_impl = (impl == BATCH_TICK_AUTO) ? best_impl() : impl;
+    return true;
+}
+
+batch_tick_impl_e batch_tick_get_impl(void) {
+    if (current_impl == BATCH_TICK_AUTO) {
+        current_impl = best_impl();
+    }
+    return current_impl;
+}
+
+const char *batch_tick_impl_name(batch_tick_impl_e impl) {
+    return (impl < BATCH_TICK_IMPL_COUNT) ? impls[impl].name : "unknown";
+}
@@ -0,0 +1,97 @@
+#ifndef BATCH_TICK_H
+#define BATCH_TICK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file batch_tick.h
+ * @brief Vectorized countdown of many sessions at once.
+ *
+ * Subtracts the elapsed time from a contiguous remaining_ms[] array and
+ * reports the lanes that expired as a bitmask, so the caller runs phase
+ * ends only for those instead of branching and calling per session.
+ *
+ * SSE2 and AVX2 paths on x86, a scalar path everywhere. The fastest one the
+ * CPU supports is picked on first use; batch_tick_select() overrides it.
+ */
+
+/**
+ * @brief Kernel implementations
+ */
+typedef enum {
+    BATCH_TICK_AUTO,        /**< Fastest supported */
+    BATCH_TICK_SCALAR,      /**< Plain C, any CPU */
+    BATCH_TICK_SSE2,        /**< 4 lanes per step */
+    BATCH_TICK_AVX2,        /**< 8 lanes per step */
+    BATCH_TICK_IMPL_COUNT
+} batch_tick_impl_e;
+
+/** Number of uint64_t words of the expiry mask for count lanes */
+#define BATCH_TICK_MASK_WORDS(count)    (((count) + 63u) / 64u)
+
+/**
+ * @brief Index of the lowest set bit of a non-zero mask word, to walk the expired lanes
+ */
+static inline uint32_t batch_tick_lowest_lane(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(bits);
+#else
+    uint32_t i = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/**
+ * @brief Count running lanes down and flag the ones that expire
+ * @details A lane runs when run_min <= state[i] <= run_max. Running lanes with
+ *          remaining_ms[i] > elapsed_ms are decremented. Running lanes with
+ *          remaining_ms[i] <= elapsed_ms are left unchanged, so the caller can
+ *          compute the overshoot, and get their bit set in expired. Other lanes
+ *          are not touched.
+ * @param remaining_ms Remaining time per lane
+ * @param state State per lane
+ * @param count Number of lanes
+ * @param elapsed_ms Time to subtract
+ * @param run_min Lowest running state
+ * @param run_max Highest running state
+ * @param expired Receives BATCH_TICK_MASK_WORDS(count) words, bit i of word i / 64 for lane i
+ * @return Number of expired lanes
+ */
+uint32_t batch_tick(uint32_t *remaining_ms, const uint8_t *state, uint32_t count,
+                    uint32_t elapsed_ms, uint8_t run_min, uint8_t run_max, uint64_t *expired);
+
+/**
+ * @brief Check if this build and CPU can run an implementation
+ */
+bool batch_tick_is_supported(batch_tick_impl_e impl);
+
+/**
+ * @brief Force an implementation, or BATCH_TICK_AUTO for the fastest supported
+ * @return false if not supported, the current one is kept
+ */
+bool batch_tick_select(batch_tick_impl_e impl);
+
+/**
+ * @brief Implementation in use
+ */
+batch_tick_impl_e batch_tick_get_impl(void);
+
+/**
+ * @brief Name of an implementation, for logs and benchmarks
+ */
+const char *batch_tick_impl_name(batch_tick_impl_e impl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BATCH_TICK_H
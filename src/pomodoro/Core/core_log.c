@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include "core_log.h"
+
+#define CORE_LOG_BUF_SIZE   256
+
+// ====================== Internal State ======================
+static core_log_print_cb_t print_cb;
+static core_log_level_e log_level = CORE_LOG_LEVEL_USER;
+
+// ====================== Public API ======================
+
+void core_log_register_print_cb(core_log_print_cb_t cb) {
+    print_cb = cb;
+}
+
+void core_log_set_level(core_log_level_e level) {
+    log_level = level;
+}
+
+void core_log_add(core_log_level_e level, const char *format, ...) {
+    if (level == CORE_LOG_LEVEL_NONE || level > log_level) return;
+
+    char buf[CORE_LOG_BUF_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (print_cb) {
+        print_cb(level, buf);
+    } else {
+        fputs(buf, stdout);
+    }
+}
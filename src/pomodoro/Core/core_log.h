@@ -0,0 +1,48 @@
+#ifndef CORE_LOG_H
+#define CORE_LOG_H
+
+#include <stdint.h>
+
+/**
+ * @file core_log.h
+ * @brief Logging for the Core without a graphics dependency.
+ *
+ * Messages go to stdout unless a print callback is registered, e.g. one that
+ * forwards them to LV_LOG_* in the LVGL application.
+ */
+
+/**
+ * @brief Log levels, lower is more important
+ */
+typedef enum {
+    CORE_LOG_LEVEL_NONE,    /**< Nothing is logged */
+    CORE_LOG_LEVEL_WARN,    /**< Something went wrong but the Core keeps running */
+    CORE_LOG_LEVEL_USER,    /**< State transitions and other user-visible events */
+} core_log_level_e;
+
+/**
+ * @brief Type for the print callback
+ * @param level Level of the message
+ * @param msg Formatted message
+ */
+typedef void (*core_log_print_cb_t)(core_log_level_e level, const char *msg);
+
+/**
+ * @brief Register a print callback, NULL prints to stdout
+ */
+void core_log_register_print_cb(core_log_print_cb_t cb);
+
+/**
+ * @brief Set the most verbose level that is still logged (default CORE_LOG_LEVEL_USER)
+ */
+void core_log_set_level(core_log_level_e level);
+
+/**
+ * @brief Format and print a message if its level is enabled
+ */
+void core_log_add(core_log_level_e level, const char *format, ...);
+
+#define CORE_LOG_WARN(...)  core_log_add(CORE_LOG_LEVEL_WARN, __VA_ARGS__)
+#define CORE_LOG_USER(...)  core_log_add(CORE_LOG_LEVEL_USER, __VA_ARGS__)
+
+#endif // CORE_LOG_H
@@ -0,0 +1,24 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as in zlib) of a buffer
+ * @param crc 0 to start, or the result of the previous call to continue
+ * @param data Bytes to add
+ * @param len Number of bytes
+ * @return Updated CRC
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRC32_H
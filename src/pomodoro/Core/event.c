@@ -1,5 +1,8 @@
+#include <stddef.h>
 #include "event.h"
+#include "event_queue.h"
 #include "pomodoro.h"
+#include "settings_store.h"
 
 /**
  * @file event.c
@@ -8,55 +11,125 @@
  * This file translates UI events into Pomodoro core API calls.
  */
 
-// ================== Public API ==================
+// ================== Internal State ==================
+
+static event_queue_t queue;     // Zero-initialized: valid and empty
+static event_notify_cb_t notify_cb;
+
+// ================== Private Functions ==================
+
+static void apply_start(const PomodoroEvent_t *event) {
+    (void)event;
+    pomodoro_start();
+}
 
-#define POMODORO_DEF_WORK_MIN               1
-#define POMODORO_DEF_SHORT_BREAK_MIN        1
-#define POMODORO_DEF_LONG_BREAK_MIN         2
-#define POMODORO_DEF_CYCLES_BEFORE_LONG     2
+static void apply_pause(const PomodoroEvent_t *event) {
+    (void)event;
+    pomodoro_pause();
+}
+
+static void apply_resume(const PomodoroEvent_t *event) {
+    (void)event;
+    pomodoro_resume();
+}
+
+static void apply_reset(const PomodoroEvent_t *event) {
+    (void)event;
+    pomodoro_reset();
+}
+
+static void apply_settings(const PomodoroEvent_t *event) {
+    const PomodoroSettings_t *s = &event->data.settings;
+    pomodoro_init(s->work_min,
+                  s->short_break_min,
+                  s->long_break_min,
+                  s->cycles_before_long);
+}
+
+static void apply_nothing(const PomodoroEvent_t *event) {
+    // EVENT_TICK: optional, could call pomodoro_tick() if using manual tick
+    (void)event;
+}
+
+// One handler per EventType_e; the transitions themselves are in pomodoro_fsm.h
+static void (*const event_handlers[EVENT_COUNT])(const PomodoroEvent_t *event) = {
+    [EVENT_START] = apply_start,
+    [EVENT_PAUSE] = apply_pause,
+    [EVENT_RESUME] = apply_resume,
+    [EVENT_RESET] = apply_reset,
+    [EVENT_SETTINGS] = apply_settings,
+    [EVENT_TICK] = apply_nothing,
+};
+
+static void event_apply(const PomodoroEvent_t *event) {
+    // Unknown event -> ignore
+    if ((uint32_t)event->type < EVENT_COUNT && event_handlers[event->type]) {
+        event_handlers[event->type](event);
+    }
+}
+
+static bool event_enqueue(const PomodoroEvent_t *event) {
+    if (!event_queue_push(&queue, event)) {
+        return false;
+    }
+    if (notify_cb) {
+        notify_cb();
+    }
+    return true;
+}
+
+// ================== Public API ==================
 
 void event_init(void) {
-    pomodoro_init(pomodoro_get_work_time() / (60 * 1000),
-                  pomodoro_get_short_break() /  (60 * 1000),
-                  pomodoro_get_long_break() /  (60 * 1000),
-                  pomodoro_get_cycle_count());
+    PomodoroSettings_t s;
+
+    // Same source as the settings screen, so the Core and the UI agree from the start
+    settings_store_load_pomodoro(&s);
+    pomodoro_init(s.work_min,
+                  s.short_break_min,
+                  s.long_break_min,
+                  s.cycles_before_long);
 }
 
 void event_dispatch(EventType_e type, void *data) {
-    switch (type) {
-    case EVENT_START:
-        pomodoro_start();
-        break;
-
-    case EVENT_PAUSE:
-        pomodoro_pause();
-        break;
-
-    case EVENT_RESUME:
-        pomodoro_resume();
-        break;
-
-    case EVENT_RESET:
-        pomodoro_reset();
-        break;
-
-    case EVENT_SETTINGS: {
-        PomodoroSettings_t *s = (PomodoroSettings_t *)data;
-        if (s) {
-            pomodoro_init(s->work_min,
-                          s->short_break_min,
-                          s->long_break_min,
-                          s->cycles_before_long);
-        }
-        break;
+    PomodoroEvent_t event = { .type = type };
+
+    if (type == EVENT_SETTINGS) {
+        if (!data) return;
+        event.data.settings = *(const PomodoroSettings_t *)data;
     }
+    event_apply(&event);
+}
+
+bool event_post(EventType_e type) {
+    PomodoroEvent_t event = { .type = type };
+    return event_enqueue(&event);
+}
+
+bool event_post_settings(const PomodoroSettings_t *settings) {
+    PomodoroEvent_t event = { .type = EVENT_SETTINGS, .data.settings = *settings };
+    return event_enqueue(&event);
+}
 
-    case EVENT_TICK:
-        // Optional: could call pomodoro_tick() if using manual tick
-        break;
+uint32_t event_process(void) {
+    PomodoroEvent_t event;
+    uint32_t count = 0;
 
-    default:
-        // Unknown event -> ignore
-        break;
+    while (count < EVENT_QUEUE_SIZE && event_queue_pop(&queue, &event)) {
+        event_apply(&event);
+        count++;
     }
+    return count;
+}
+
+bool event_is_pending(void) {
+    return event_queue_is_pending(&queue);
+}
+
+void event_set_notify_cb(event_notify_cb_t cb) {
+    notify_cb = cb;
+}
+
+uint32_t event_get_dropped_count(void) {
+    return event_queue_get_dropped(&queue);
 }
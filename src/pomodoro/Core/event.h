@@ -2,6 +2,7 @@
 #define EVENT_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "pomodoro.h"
 
 /**
@@ -10,6 +11,12 @@
  *
  * This module defines events generated by the UI and dispatches them
  * to the Pomodoro core logic.
+ *
+ * event_dispatch() applies an event right away on the caller's stack and
+ * must only be used from the thread running the Core. Everything else
+ * (interrupts, other threads, IPC) posts with event_post*(): the event is
+ * copied into a lock-free queue and applied by event_process(), which the
+ * main loop calls once per iteration.
  */
 
 /**
@@ -21,7 +28,8 @@ typedef enum {
     EVENT_RESUME,    /**< Resume paused session */
     EVENT_RESET,     /**< Reset Pomodoro to idle */
     EVENT_SETTINGS,  /**< Settings updated (e.g., durations, cycles) */
-    EVENT_TICK       /**< Optional: UI requests a tick update */
+    EVENT_TICK,      /**< Optional: UI requests a tick update */
+    EVENT_COUNT      /**< Number of event types, not an event */
 } EventType_e;
 
 /**
@@ -35,7 +43,24 @@ typedef struct {
 } PomodoroSettings_t;
 
 /**
- * @brief Initialize the event system.
+ * @brief Event with its payload, copied by value through the queue.
+ */
+typedef struct {
+    EventType_e type;                   /**< Event type */
+    union {
+        PomodoroSettings_t settings;    /**< EVENT_SETTINGS */
+    } data;
+} PomodoroEvent_t;
+
+/**
+ * @brief Callback run after an event was posted, in the poster's context.
+ *        Used to wake up a sleeping main loop; must be ISR/thread safe.
+ */
+typedef void (*event_notify_cb_t)(void);
+
+/**
+ * @brief Initialize the event system and the Core from the stored settings
+ *        (settings_store_load_pomodoro()).
  */
 void event_init(void);
 
@@ -47,4 +72,45 @@ void event_init(void);
  */
 void event_dispatch(EventType_e type, void *data);
 
+/**
+ * @brief Post an event without payload (any thread or ISR).
+ *
+ * @param type The event type
+ * @return false if the queue is full and the event was dropped
+ */
+bool event_post(EventType_e type);
+
+/**
+ * @brief Post new settings (any thread or ISR).
+ *
+ * @param settings Copied into the queue, may be reused right after the call
+ * @return false if the queue is full and the event was dropped
+ */
+bool event_post_settings(const PomodoroSettings_t *settings);
+
+/**
+ * @brief Apply the posted events, oldest first. Call once per main loop iteration.
+ *
+ * Applies at most EVENT_QUEUE_SIZE events, so a busy producer cannot
+ * keep the main loop in here.
+ *
+ * @return Number of events applied
+ */
+uint32_t event_process(void);
+
+/**
+ * @brief Check if posted events wait for event_process().
+ */
+bool event_is_pending(void);
+
+/**
+ * @brief Register a callback run after each successful post (NULL to remove).
+ */
+void event_set_notify_cb(event_notify_cb_t cb);
+
+/**
+ * @brief Number of posts dropped because the queue was full.
+ */
+uint32_t event_get_dropped_count(void);
+
 #endif // EVENT_H
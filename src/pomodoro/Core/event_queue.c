@@ -0,0 +1,72 @@
+#include <string.h>
+#include "event_queue.h"
+
+#define EVENT_QUEUE_MASK    (EVENT_QUEUE_SIZE - 1u)
+
+// Cell i is free for the producer at position p when seq == p, and holds an
+// event for the consumer at position p when seq == p + 1. The stored value
+// is seq - i, so all-zero memory is the initial state seq == i.
+static inline unsigned int cell_seq(const event_queue_t *q, unsigned int pos) {
+    const EventQueueCell_t *cell = &q->cells[pos & EVENT_QUEUE_MASK];
+    return atomic_load_explicit((atomic_uint *)&cell->seq, memory_order_acquire) + (pos & EVENT_QUEUE_MASK);
+}
+
+static inline void cell_set_seq(event_queue_t *q, unsigned int pos, unsigned int seq) {
+    EventQueueCell_t *cell = &q->cells[pos & EVENT_QUEUE_MASK];
+    atomic_store_explicit(&cell->seq, seq - (pos & EVENT_QUEUE_MASK), memory_order_release);
+}
+
+// ====================== Public API ======================
+
+void event_queue_init(event_queue_t *q) {
+    memset(q, 0, sizeof(*q));
+}
+
+bool event_queue_push(event_queue_t *q, const PomodoroEvent_t *event) {
+    unsigned int pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    for (;;) {
+        int diff = (int)(cell_seq(q, pos) - pos);
+
+        if (diff == 0) {
+            // Free cell: claim it, on failure pos is reloaded and we retry
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1u,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The consumer has not freed this cell yet: full
+            atomic_fetch_add_explicit(&q->dropped, 1u, memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer claimed it first
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+
+    q->cells[pos & EVENT_QUEUE_MASK].event = *event;
+    cell_set_seq(q, pos, pos + 1u);
+    return true;
+}
+
+bool event_queue_pop(event_queue_t *q, PomodoroEvent_t *event) {
+    unsigned int pos = q->tail;
+
+    if (cell_seq(q, pos) != pos + 1u) {
+        // Empty, or the producer of the oldest cell is still copying
+        return false;
+    }
+
+    *event = q->cells[pos & EVENT_QUEUE_MASK].event;
+    cell_set_seq(q, pos, pos + EVENT_QUEUE_SIZE);
+    q->tail = pos + 1u;
+    return true;
+}
+
+bool event_queue_is_pending(const event_queue_t *q) {
+    return cell_seq(q, q->tail) == q->tail + 1u;
+}
+
+uint32_t event_queue_get_dropped(const event_queue_t *q) {
+    return atomic_load_explicit((atomic_uint *)&q->dropped, memory_order_relaxed);
+}
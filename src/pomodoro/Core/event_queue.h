@@ -0,0 +1,77 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "event.h"
+
+/**
+ * @file event_queue.h
+ * @brief Bounded lock-free multi-producer / single-consumer event queue.
+ *
+ * Fixed array of cells, each with a sequence number telling producers and
+ * the consumer whose turn it is (D. Vyukov's bounded queue). Producers
+ * claim a cell with one compare-and-swap and never wait for each other, so
+ * posting is safe from threads, IPC handlers and interrupts. Events are
+ * copied into the cell by value; nothing is allocated.
+ *
+ * A zero-initialized queue is valid and empty, so a static queue can be
+ * posted to before anything calls event_queue_init().
+ */
+
+/** Number of cells, power of 2 */
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE    32u
+#endif
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1u)) != 0
+#error "EVENT_QUEUE_SIZE must be a power of 2"
+#endif
+
+/**
+ * @brief One queue cell
+ */
+typedef struct {
+    atomic_uint     seq;        /**< Turn counter, stored relative to the cell index */
+    PomodoroEvent_t event;
+} EventQueueCell_t;
+
+/**
+ * @brief Event queue
+ */
+typedef struct {
+    EventQueueCell_t cells[EVENT_QUEUE_SIZE];
+    atomic_uint      head;      /**< Next position to claim by producers */
+    unsigned int     tail;      /**< Next position to read, consumer only */
+    atomic_uint      dropped;   /**< Posts rejected because the queue was full */
+} event_queue_t;
+
+/**
+ * @brief Empty the queue. Not safe while producers are posting.
+ */
+void event_queue_init(event_queue_t *q);
+
+/**
+ * @brief Copy an event into the queue (any thread or ISR)
+ * @return false if the queue is full, the event is dropped and counted
+ */
+bool event_queue_push(event_queue_t *q, const PomodoroEvent_t *event);
+
+/**
+ * @brief Take the oldest event out of the queue (consumer only)
+ * @return false if the queue is empty
+ */
+bool event_queue_pop(event_queue_t *q, PomodoroEvent_t *event);
+
+/**
+ * @brief Check if an event is ready to pop (consumer only)
+ */
+bool event_queue_is_pending(const event_queue_t *q);
+
+/**
+ * @brief Number of events dropped because the queue was full
+ */
+uint32_t event_queue_get_dropped(const event_queue_t *q);
+
+#endif // EVENT_QUEUE_H
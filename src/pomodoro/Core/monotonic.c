@@ -0,0 +1,173 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stddef.h>
+#include "monotonic.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define MONOTONIC_HAS_POSIX 1
+    #include <time.h>
+#else
+    #define MONOTONIC_HAS_POSIX 0
+#endif
+
+#if defined(USE_HAL_TICK) || defined(HAL_PICO)
+    #define MONOTONIC_HAS_HAL   1
+    #define MONOTONIC_HAS_SDL   0
+    #ifdef USE_HAL_TICK
+        #include "stm32f4xx_hal.h"   // Or your MCU HAL header
+    #endif
+#elif defined(MONOTONIC_NO_SDL)
+    #define MONOTONIC_HAS_HAL   0
+    #define MONOTONIC_HAS_SDL   0
+#else
+    #define MONOTONIC_HAS_HAL   0
+    #define MONOTONIC_HAS_SDL   1
+    #include <SDL.h>
+#endif
+
+typedef struct {
+    const char *name;
+    uint64_t (*read_ns)(void);      /**< NULL if not compiled in */
+} MonotonicSource_t;
+
+#if MONOTONIC_HAS_POSIX
+static uint64_t posix_read_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * MONOTONIC_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#if MONOTONIC_HAS_SDL
+static uint64_t sdl_read_ns(void) {
+    static uint64_t freq;
+    if (!freq) freq = SDL_GetPerformanceFrequency();
+
+    // Split to keep counter * 1e9 from overflowing
+    uint64_t counter = SDL_GetPerformanceCounter();
+    uint64_t sec = counter / freq;
+    uint64_t rem = counter % freq;
+    return sec * MONOTONIC_NS_PER_SEC + (rem * MONOTONIC_NS_PER_SEC) / freq;
+}
+#endif
+
+#if MONOTONIC_HAS_HAL
+static uint64_t hal_read_ns(void) {
+    static uint32_t last_raw;
+    static uint64_t acc_ms;
+    uint32_t raw;
+
+#ifdef USE_HAL_TICK
+    raw = HAL_GetTick();
+#else
+    extern uint32_t tick_timer();
+    raw = tick_timer();
+#endif
+
+    // Accumulate deltas so the 32-bit ms counter wrapping is harmless
+    acc_ms += (uint32_t)(raw - last_raw);
+    last_raw = raw;
+    return acc_ms * MONOTONIC_NS_PER_MS;
+}
+#endif
+
+static uint64_t virtual_ns;
+
+static uint64_t virtual_read_ns(void) {
+    return virtual_ns;
+}
+
+static const MonotonicSource_t sources[MONOTONIC_SRC_COUNT] = {
+#if MONOTONIC_HAS_POSIX
+    [MONOTONIC_SRC_POSIX]   = { "posix",   posix_read_ns },
+#else
+    [MONOTONIC_SRC_POSIX]   = { "posix",   NULL },
+#endif
+#if MONOTONIC_HAS_SDL
+    [MONOTONIC_SRC_SDL]     = { "sdl",     sdl_read_ns },
+#else
+    [MONOTONIC_SRC_SDL]     = { "sdl",     NULL },
+#endif
+#if MONOTONIC_HAS_HAL
+    [MONOTONIC_SRC_HAL]     = { "hal",     hal_read_ns },
+#else
+    [MONOTONIC_SRC_HAL]     = { "hal",     NULL },
+#endif
+    [MONOTONIC_SRC_VIRTUAL] = { "virtual", virtual_read_ns },
+};
+
+static struct {
+    bool               ready;
+    monotonic_source_e src;
+    uint64_t           origin_ns;   /**< Raw reading of the source when it was selected */
+    uint64_t           base_ns;     /**< Reported time when the source was selected */
+    uint64_t           last_ns;     /**< Last reported time, output never goes below it */
+} mono;
+
+static void monotonic_ensure_init(void) {
+    if (mono.ready) return;
+
+    // Firmware ticks on MCUs, the OS clock on hosts
+#if MONOTONIC_HAS_HAL
+    mono.src = MONOTONIC_SRC_HAL;
+#elif MONOTONIC_HAS_POSIX
+    mono.src = MONOTONIC_SRC_POSIX;
+#elif MONOTONIC_HAS_SDL
+    mono.src = MONOTONIC_SRC_SDL;
+#else
+    mono.src = MONOTONIC_SRC_VIRTUAL;
+#endif
+    mono.origin_ns = sources[mono.src].read_ns();
+    mono.base_ns = 0;
+    mono.last_ns = 0;
+    mono.ready = true;
+}
+
+bool monotonic_is_available(monotonic_source_e src) {
+    return src < MONOTONIC_SRC_COUNT && sources[src].read_ns != NULL;
+}
+
+const char *monotonic_source_name(monotonic_source_e src) {
+    return (src < MONOTONIC_SRC_COUNT) ? sources[src].name : "unknown";
+}
+
+bool monotonic_select(monotonic_source_e src) {
+    if (!monotonic_is_available(src)) return false;
+
+    uint64_t now = monotonic_now_ns();
+    mono.src = src;
+    mono.origin_ns = sources[src].read_ns();
+    mono.base_ns = now;
+    return true;
+}
+
+monotonic_source_e monotonic_get_source(void) {
+    monotonic_ensure_init();
+    return mono.src;
+}
+
+uint64_t monotonic_now_ns(void) {
+    monotonic_ensure_init();
+
+    uint64_t now = mono.base_ns + (sources[mono.src].read_ns() - mono.origin_ns);
+    if (now < mono.last_ns) {
+        now = mono.last_ns;
+    }
+    mono.last_ns = now;
+    return now;
+}
+
+uint64_t monotonic_now_ms(void) {
+    return monotonic_now_ns() / MONOTONIC_NS_PER_MS;
+}
+
+uint64_t monotonic_read_ns(void) {
+    if (!mono.ready) return monotonic_now_ns();
+    return mono.base_ns + (sources[mono.src].read_ns() - mono.origin_ns);
+}
+
+void monotonic_virtual_advance_ns(uint64_t ns) {
+    virtual_ns += ns;
+}
@@ -0,0 +1,80 @@
+#ifndef MONOTONIC_H
+#define MONOTONIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file monotonic.h
+ * @brief 64-bit monotonic clock with runtime-selectable tick sources.
+ *
+ * Time is reported in nanoseconds since an arbitrary origin and never wraps
+ * or goes backwards, also across source switches. Sources with a narrower
+ * hardware counter (32-bit ms HAL ticks) are extended to 64 bits; they must
+ * be sampled at least once per counter period (~49.7 days for ms ticks).
+ */
+
+// #define USE_HAL_TICK   1
+
+#define MONOTONIC_NS_PER_MS     1000000ull
+#define MONOTONIC_NS_PER_SEC    1000000000ull
+
+/**
+ * @brief Available tick sources
+ */
+typedef enum {
+    MONOTONIC_SRC_POSIX,    /**< clock_gettime(CLOCK_MONOTONIC) */
+    MONOTONIC_SRC_SDL,      /**< SDL_GetPerformanceCounter() */
+    MONOTONIC_SRC_HAL,      /**< HAL_GetTick() (USE_HAL_TICK) or tick_timer() (HAL_PICO), 1 ms */
+    MONOTONIC_SRC_VIRTUAL,  /**< Only moves through monotonic_virtual_advance_ns() */
+    MONOTONIC_SRC_COUNT
+} monotonic_source_e;
+
+/**
+ * @brief Select the tick source. Time continues from the current value.
+ * @param src Source to use
+ * @return false if the source is not compiled into this build
+ */
+bool monotonic_select(monotonic_source_e src);
+
+/**
+ * @brief Get the active tick source
+ */
+monotonic_source_e monotonic_get_source(void);
+
+/**
+ * @brief Check if a source is compiled into this build
+ */
+bool monotonic_is_available(monotonic_source_e src);
+
+/**
+ * @brief Get a printable name of a source
+ */
+const char *monotonic_source_name(monotonic_source_e src);
+
+/**
+ * @brief Current time in nanoseconds
+ */
+uint64_t monotonic_now_ns(void);
+
+/**
+ * @brief Current time in milliseconds
+ */
+uint64_t monotonic_now_ms(void);
+
+/**
+ * @brief Current time, for threads other than the one that drives the clock
+ * @details Same timeline as monotonic_now_ns() but writes no state, so a second
+ *          thread may read it meanwhile. Not clamped to earlier readings, and the
+ *          hal source extends its counter in place: only call it from that
+ *          source's thread.
+ */
+uint64_t monotonic_read_ns(void);
+
+/**
+ * @brief Move the virtual source forward
+ * @param ns Nanoseconds to add
+ */
+void monotonic_virtual_advance_ns(uint64_t ns);
+
+#endif // MONOTONIC_H
@@ -1,29 +1,67 @@
 #include <stdio.h>
-#include "lvgl.h"
+#include <stdint.h>
+#include "batch_tick.h"
+#include "core_log.h"
+#include "monotonic.h"
 #include "pomodoro.h"
+#include "pomodoro_fsm.h"
+#include "pomodoro_history.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_journal.h"
 #include "timer.h"
+#include "trace.h"
 
 // ====================== Data Structures ======================
 
-/**
- * @brief Pomodoro session configuration
- */
-typedef struct {
-    uint32_t    work_duration_ms;          /**< Work session duration in milliseconds */
-    uint32_t    short_break_duration_ms;   /**< Short break duration in milliseconds */
-    uint32_t    long_break_duration_ms;    /**< Long break duration in milliseconds */
-    uint8_t     max_cycles;                /**< Cycles before long break */
-} PomodoroConfig_t;
+/** Session handle layout: generation above the slot index, like timer handles */
+#define SESSION_INDEX_BITS  21
+#define SESSION_INDEX_MASK  ((1u << SESSION_INDEX_BITS) - 1u)
+#define SESSION_GEN_MASK    ((1u << (32 - SESSION_INDEX_BITS)) - 1u)
+
+#if POMODORO_MAX_SESSIONS >= (1u << SESSION_INDEX_BITS) || POMODORO_MAX_SESSIONS < 1
+#error "POMODORO_MAX_SESSIONS must be between 1 and 2^21 - 1"
+#endif
+
+/** Slot of the default session driven by the single-session API */
+#define SESSION_DEFAULT     0u
+
+/** current_state[] value of a destroyed slot, never running */
+#define SESSION_FREE        0xFFu
+
+/** Slots per batch_tick() call of the sweep, sized so the expiry mask stays small on the stack */
+#define SWEEP_CHUNK         (POMODORO_MAX_SESSIONS < 4096u ? POMODORO_MAX_SESSIONS : 4096u)
 
 /**
- * @brief Pomodoro session state
+ * @brief Session store, one array per field (struct of arrays)
+ * @details The bulk sweep only touches current_state[] and remaining_ms[], so it
+ *          streams through two dense arrays instead of striding over whole sessions.
+ *          Slots at or above high_water were never used; destroyed slots are chained
+ *          into a free list through remaining_ms[].
  */
 typedef struct {
-    PomodoroState_e current_state;      /**< Current session state */
-    PomodoroState_e previous_state;     /**< Previous session state */
-    uint32_t        remaining_ms;       /**< Remaining milliseconds in current session */
-    uint8_t         cycle_count;        /**< Work sessions completed */
-} PomodoroSession_t;
+    // Configuration
+    uint32_t    work_duration_ms[POMODORO_MAX_SESSIONS];        /**< Work session duration in milliseconds */
+    uint32_t    short_break_duration_ms[POMODORO_MAX_SESSIONS]; /**< Short break duration in milliseconds */
+    uint32_t    long_break_duration_ms[POMODORO_MAX_SESSIONS];  /**< Long break duration in milliseconds */
+    uint8_t     max_cycles[POMODORO_MAX_SESSIONS];              /**< Cycles before long break */
+    uint8_t     plan[POMODORO_MAX_SESSIONS];                    /**< Plan slot, PomodoroPlanId_e or a user slot */
+
+    // State
+    uint8_t     current_state[POMODORO_MAX_SESSIONS];   /**< PomodoroState_e, or SESSION_FREE */
+    uint8_t     previous_state[POMODORO_MAX_SESSIONS];  /**< PomodoroState_e */
+    uint32_t    remaining_ms[POMODORO_MAX_SESSIONS];    /**< Remaining milliseconds in current session */
+    uint8_t     cycle_count[POMODORO_MAX_SESSIONS];     /**< Work sessions completed */
+    uint32_t    phase_ms[POMODORO_MAX_SESSIONS];        /**< Length of the current phase, as the plan set it */
+    PomodoroPlanCursor_t plan_cursor[POMODORO_MAX_SESSIONS]; /**< Plan position after the current phase */
+    uint8_t     plan_next[POMODORO_MAX_SESSIONS];       /**< Phase the plan yields next, POMODORO_PLAN_END..ROUND */
+
+    // Allocation
+    uint16_t    gen[POMODORO_MAX_SESSIONS];     /**< Bumped on destroy, stale handles stop matching */
+    uint32_t    high_water;                     /**< One past the highest slot ever used */
+    uint32_t    free_head;                      /**< First destroyed slot, or SESSION_INDEX_MASK */
+    uint32_t    live;                           /**< Sessions in use, default included */
+    uint32_t    bulk_running;                   /**< Created sessions in WORK / SHORT_BREAK / LONG_BREAK */
+} PomodoroSessionStore_t;
 
 /**
  * @brief Pomodoro callback functions
@@ -34,140 +72,608 @@ typedef struct {
 } PomodoroCallbacks_t;
 
 /**
- * @brief Main Pomodoro context
+ * @brief Timing of the default session's current phase, for its history record
+ */
+typedef struct {
+    uint64_t    start_ns;           /**< Monotonic time the phase started */
+    uint64_t    start_wall_ms;      /**< Wall clock time it started */
+    uint64_t    pause_ns;           /**< Monotonic time of the last pause */
+    uint64_t    paused_ns;          /**< Time spent paused */
+    uint16_t    interruptions;      /**< Pauses so far */
+    bool        mute;               /**< Set while pomodoro_restore() runs through missed phases */
+} PomodoroPhaseLog_t;
+
+/**
+ * @brief What only the default session has: UI callbacks and snapshot counters
  */
 typedef struct {
-    PomodoroConfig_t config;            /**< Session configuration */
-    PomodoroSession_t session;          /**< Current session state */
     PomodoroCallbacks_t callbacks;      /**< Registered callbacks */
+    uint32_t            transition_count; /**< State changes since boot, for snapshot readers */
+    uint32_t            tick_count;     /**< Ticks since boot, for snapshot readers */
+    PomodoroPhaseLog_t  phase;          /**< Current phase, for the history */
 } PomodoroContext_t;
 
 // ====================== Internal State ======================
+static PomodoroSessionStore_t store = {
+    .work_duration_ms = { [SESSION_DEFAULT] = POMODORO_DEF_WORK_MIN * 60 * 1000 },
+    .short_break_duration_ms = { [SESSION_DEFAULT] = POMODORO_DEF_SHORT_BREAK_MIN * 60 * 1000 },
+    .long_break_duration_ms = { [SESSION_DEFAULT] = POMODORO_DEF_LONG_BREAK_MIN * 60 * 1000 },
+    .max_cycles = { [SESSION_DEFAULT] = POMODORO_DEF_CYCLES_BEFORE_LONG },
+    .current_state = { [SESSION_DEFAULT] = POMODORO_IDLE },
+    .previous_state = { [SESSION_DEFAULT] = POMODORO_IDLE },
+    .remaining_ms = { [SESSION_DEFAULT] = POMODORO_DEF_WORK_MIN * 60 * 1000 },
+    .phase_ms = { [SESSION_DEFAULT] = POMODORO_DEF_WORK_MIN * 60 * 1000 },
+    .plan_next = { [SESSION_DEFAULT] = POMODORO_PLAN_WORK },
+    .high_water = 1,
+    .free_head = SESSION_INDEX_MASK,
+    .live = 1
+};
+
 static PomodoroContext_t pomo_ctx = {
-    .config = {
-        .work_duration_ms = POMODORO_DEF_WORK_MIN * 60 * 1000,
-        .short_break_duration_ms = POMODORO_DEF_SHORT_BREAK_MIN * 60 * 1000,
-        .long_break_duration_ms = POMODORO_DEF_LONG_BREAK_MIN * 60 * 1000,
-        .max_cycles = POMODORO_DEF_CYCLES_BEFORE_LONG
-    },
-    .session = {
-        .current_state = POMODORO_IDLE,
-        .previous_state = POMODORO_IDLE,
-        .remaining_ms = POMODORO_DEF_WORK_MIN * 60 * 1000,
-        .cycle_count = 0
-    },
     .callbacks = {
         .state_callback = NULL,
         .tick_callback = NULL
     }
 };
 
+static pomodoro_session_state_cb_t sessions_state_cb;
+
+// Bulk sweep: one wheel timer re-armed every POMODORO_SWEEP_PERIOD_MS while created sessions run
+static timer_handle_t sweep_timer = TIMER_INVALID_HANDLE;
+static uint64_t sweep_last_ns;
+
+/*
+ * Snapshot the getters read from instead of the store (see pomodoro_set_snapshot_view).
+ * Per thread, so the thread driving the Core keeps reading the live session.
+ */
+#if POMODORO_RUNTIME_THREADS
+static _Thread_local const PomodoroSnapshot_t *snapshot_view;
+#else
+static const PomodoroSnapshot_t *snapshot_view;
+#endif
+
 static const char *pomoState2Str(PomodoroState_e state);
+static void on_timer_tick(uint32_t remaining_ms);
+static void on_timer_finished(void);
+static void session_dispatch(uint32_t s, PomodoroFsmEvent_e event);
 // ====================== Private Functions ======================
+/**
+ * @brief Check if a state counts down (WORK, SHORT_BREAK, LONG_BREAK)
+ */
+static inline bool state_is_running(uint8_t state) {
+    return (uint8_t)(state - POMODORO_WORK) <= (uint8_t)(POMODORO_LONG_BREAK - POMODORO_WORK);
+}
+
+static inline pomodoro_session_t make_session_handle(uint32_t s) {
+    return ((uint32_t)store.gen[s] << SESSION_INDEX_BITS) | s;
+}
+
+/**
+ * @brief Slot of a live session
+ * @return Slot index, or SESSION_INDEX_MASK for stale and invalid handles
+ */
+static uint32_t session_index(pomodoro_session_t session) {
+    uint32_t s = session & SESSION_INDEX_MASK;
+
+    if (s >= store.high_water || store.current_state[s] == SESSION_FREE ||
+        store.gen[s] != (session >> SESSION_INDEX_BITS)) {
+        return SESSION_INDEX_MASK;
+    }
+    return s;
+}
+
+/**
+ * @brief Tick callback to hand to the timer
+ * @details Without a tick listener the countdown is not ticked at all,
+ *          remaining time is then read from the timer on demand.
+ */
+static timer_tick_cb_t timer_tick_cb(void) {
+    return pomo_ctx.callbacks.tick_callback ? on_timer_tick : NULL;
+}
+
+// The default session counts down on the timing wheel with phase-locked ticks.
+// Created sessions only keep remaining_ms[], pomodoro_sessions_advance() counts it down.
+
+static void session_timer_start(uint32_t s, uint32_t ms) {
+    if (s == SESSION_DEFAULT) {
+        timer_start(ms, timer_tick_cb(), on_timer_finished);
+    }
+}
+
+static uint32_t session_timer_remaining(uint32_t s) {
+    return (s == SESSION_DEFAULT) ? timer_get_remaining() : store.remaining_ms[s];
+}
+
+static void session_timer_pause(uint32_t s) {
+    if (s == SESSION_DEFAULT) {
+        timer_pause();
+    }
+}
+
+static void session_timer_resume(uint32_t s) {
+    if (s == SESSION_DEFAULT) {
+        timer_resume();
+    }
+}
+
+static void session_timer_stop(uint32_t s) {
+    if (s == SESSION_DEFAULT) {
+        timer_stop();
+    }
+}
+
+/**
+ * @brief Remaining milliseconds of the current session
+ */
+static uint32_t session_remaining_ms(uint32_t s) {
+    if (s == SESSION_DEFAULT && state_is_running(store.current_state[s]) &&
+        !pomo_ctx.callbacks.tick_callback) {
+        return timer_get_remaining();
+    }
+    return store.remaining_ms[s];
+}
+
+/**
+ * @brief Monotonic time the running phase of a session ends, 0 if it is not running
+ * @details The default session's timer is armed after the state callback of a
+ *          new phase, until then the phase has its whole length left.
+ */
+static uint64_t session_end_ns(uint32_t s) {
+    uint32_t left_ms;
+
+    if (!state_is_running(store.current_state[s])) {
+        return 0;
+    }
+    if (s != SESSION_DEFAULT) {
+        return sweep_last_ns + (uint64_t)store.remaining_ms[s] * MONOTONIC_NS_PER_MS;
+    }
+    left_ms = timer_is_running() ? timer_get_remaining() : store.remaining_ms[s];
+    return monotonic_now_ns() + (uint64_t)left_ms * MONOTONIC_NS_PER_MS;
+}
+
+/**
+ * @brief Session the getters read: the thread's snapshot view, or a fresh copy of the default session
+ * @param scratch Storage for the copy
+ */
+static const PomodoroSnapshot_t *session_view(PomodoroSnapshot_t *scratch) {
+    if (snapshot_view) {
+        return snapshot_view;
+    }
+    pomodoro_get_snapshot(scratch);
+    return scratch;
+}
+
+static void session_snapshot(uint32_t s, PomodoroSnapshot_t *snap);
+
+/**
+ * @brief Journal the default session after a change
+ * @details remaining_ms comes from the store: on a transition the new phase's
+ *          timer is armed only after change_state() returns.
+ */
+static void journal_note(void) {
+    PomodoroSnapshot_t snap;
+
+    if (!pomodoro_journal_is_open()) {
+        return;
+    }
+    session_snapshot(SESSION_DEFAULT, &snap);
+    snap.remaining_ms = store.remaining_ms[SESSION_DEFAULT];
+    pomodoro_journal_append(&snap);
+}
+
+/**
+ * @brief Track pauses of the default session's phase, a new phase restarts the log
+ */
+static void phase_note(uint8_t old_state, PomodoroState_e new_state) {
+    PomodoroPhaseLog_t *ph = &pomo_ctx.phase;
+    bool was_paused = old_state == POMODORO_PAUSED_WORK || old_state == POMODORO_PAUSED_BREAK;
+
+    if (state_is_running((uint8_t)new_state)) {
+        if (was_paused) {
+            ph->paused_ns += monotonic_now_ns() - ph->pause_ns;
+        } else {
+            ph->start_ns = monotonic_now_ns();
+            ph->start_wall_ms = pomodoro_history_now_ms();
+            ph->paused_ns = 0;
+            ph->interruptions = 0;
+        }
+    } else if (new_state == POMODORO_PAUSED_WORK || new_state == POMODORO_PAUSED_BREAK) {
+        ph->pause_ns = monotonic_now_ns();
+        ph->interruptions++;
+    }
+}
+
+/**
+ * @brief Record the default session's phase that just ran to its end
+ */
+static void history_note(void) {
+    const PomodoroPhaseLog_t *ph = &pomo_ctx.phase;
+    uint64_t ran_ns = monotonic_now_ns() - ph->start_ns - ph->paused_ns;
+    PomodoroHistoryRecord_t rec = {
+        .start_s = (int64_t)(ph->start_wall_ms / 1000u),
+        .duration_s = (uint32_t)((ran_ns + MONOTONIC_NS_PER_SEC / 2u) / MONOTONIC_NS_PER_SEC),
+        .paused_s = (uint32_t)((ph->paused_ns + MONOTONIC_NS_PER_SEC / 2u) / MONOTONIC_NS_PER_SEC),
+        .interruptions = ph->interruptions,
+        .type = store.current_state[SESSION_DEFAULT],
+    };
+
+    if (!ph->mute) {
+        pomodoro_history_append(&rec);
+        pomodoro_stats_add(&rec);
+    }
+}
+
+static void on_sweep_timer(timer_handle_t handle, void *user_data);
+
+/**
+ * @brief Keep the sweep timer armed while created sessions are running
+ */
+static void sweep_arm(void) {
+    if (store.bulk_running == 0 || timer_handle_is_active(sweep_timer)) {
+        return;
+    }
+    sweep_timer = timer_handle_create(POMODORO_SWEEP_PERIOD_MS, NULL, on_sweep_timer, NULL);
+}
+
+static void on_sweep_timer(timer_handle_t handle, void *user_data) {
+    (void)handle;
+    (void)user_data;
+
+    // Whole milliseconds since the last sweep, the rest carries over to the next one
+    uint64_t elapsed_ms = (monotonic_now_ns() - sweep_last_ns) / MONOTONIC_NS_PER_MS;
+    sweep_last_ns += elapsed_ms * MONOTONIC_NS_PER_MS;
+
+    sweep_timer = TIMER_INVALID_HANDLE;
+    pomodoro_sessions_advance(elapsed_ms > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_ms);
+    sweep_arm();
+}
+
 /**
  * @brief Change state internally and trigger callback
+ * @param s Session slot
  * @param new_state New Pomodoro state
  * @param duration_ms Duration for the new state
  */
-static void change_state(PomodoroState_e new_state, uint32_t duration_ms) {
-    pomo_ctx.session.previous_state = pomo_ctx.session.current_state;
-    pomo_ctx.session.current_state = new_state;
-    pomo_ctx.session.remaining_ms = duration_ms;
+static void change_state(uint32_t s, PomodoroState_e new_state, uint32_t duration_ms) {
+    bool was_running = state_is_running(store.current_state[s]);
 
-    if (pomo_ctx.callbacks.state_callback) {
-        pomo_ctx.callbacks.state_callback(pomo_ctx.session.current_state); //UI callback to update display
+    store.previous_state[s] = store.current_state[s];
+    store.current_state[s] = (uint8_t)new_state;
+    store.remaining_ms[s] = duration_ms;
+
+    if (s == SESSION_DEFAULT) {
+        TRACE_INSTANT(TRACE_STATE, new_state);
+        pomo_ctx.transition_count++;
+        phase_note(store.previous_state[s], new_state);
+        journal_note();
+        if (pomo_ctx.callbacks.state_callback) {
+            pomo_ctx.callbacks.state_callback(new_state); //UI callback to update display
+        }
+    } else if (was_running != state_is_running((uint8_t)new_state)) {
+        if (was_running) {
+            store.bulk_running--;
+        } else if (store.bulk_running++ == 0) {
+            // First running session: its time starts now, not at the last sweep
+            sweep_last_ns = monotonic_now_ns();
+            sweep_arm();
+        }
+    }
+
+    if (sessions_state_cb) {
+        sessions_state_cb(make_session_handle(s), new_state);
     }
 }
 
 // Timer tick callback
 static void on_timer_tick(uint32_t remaining_ms) 
 {
-    pomo_ctx.session.remaining_ms = remaining_ms;  // Store current remaining time
+    store.remaining_ms[SESSION_DEFAULT] = remaining_ms;  // Store current remaining time
+    pomo_ctx.tick_count++;
     if (pomo_ctx.callbacks.tick_callback) {
-        pomo_ctx.callbacks.tick_callback(pomo_ctx.session.remaining_ms);  // Pass current remaining time to UI
+        pomo_ctx.callbacks.tick_callback(remaining_ms);  // Pass current remaining time to UI
     }
 }
 
 // Timer finished callback
 static void on_timer_finished(void) {
-    LV_LOG_USER("[Pomodoro] Timer finished in state %s\n", pomoState2Str(pomo_ctx.session.current_state));
-    if (pomo_ctx.session.current_state == POMODORO_WORK) {
-        pomo_ctx.session.cycle_count++;
-        if (pomo_ctx.session.cycle_count % pomo_ctx.config.max_cycles == 0) {
-            change_state(POMODORO_LONG_BREAK, pomo_ctx.config.long_break_duration_ms);
-            timer_start(pomo_ctx.config.long_break_duration_ms, on_timer_tick, on_timer_finished);
-        } else {
-            change_state(POMODORO_SHORT_BREAK, pomo_ctx.config.short_break_duration_ms);
-            timer_start(pomo_ctx.config.short_break_duration_ms, on_timer_tick, on_timer_finished);
-        }
-    } else { // Break finished
-        change_state(POMODORO_WORK, pomo_ctx.config.work_duration_ms);
-        timer_start(pomo_ctx.config.work_duration_ms, on_timer_tick, on_timer_finished);
+    CORE_LOG_USER("[Pomodoro] Timer finished in state %s\n",
+                  pomoState2Str((PomodoroState_e)store.current_state[SESSION_DEFAULT]));
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_FINISHED);
+}
+
+static void session_configure(uint32_t s, uint32_t work_min, uint32_t short_break_min,
+                              uint32_t long_break_min, uint8_t cycles_before_long) {
+    store.work_duration_ms[s] = work_min * 60 * 1000;
+    store.short_break_duration_ms[s] = short_break_min * 60 * 1000;
+    store.long_break_duration_ms[s] = long_break_min * 60 * 1000;
+    // Every dispatch takes the cycle count modulo max_cycles
+    store.max_cycles[s] = cycles_before_long ? cycles_before_long : 1;
+}
+
+// ====================== State Machine ======================
+
+// Phase length of each state, the paused ones included (a resumed break is resolved first)
+static uint32_t *const phase_duration_ms[POMODORO_FSM_STATES] = {
+    [POMODORO_IDLE] = store.work_duration_ms,
+    [POMODORO_WORK] = store.work_duration_ms,
+    [POMODORO_SHORT_BREAK] = store.short_break_duration_ms,
+    [POMODORO_LONG_BREAK] = store.long_break_duration_ms,
+    [POMODORO_PAUSED_WORK] = store.work_duration_ms,
+    [POMODORO_PAUSED_BREAK] = store.short_break_duration_ms,
+};
+
+/**
+ * @brief Length of a plan step: its own, or the session's configured one for the state it enters
+ */
+static uint32_t plan_step_ms(uint32_t s, PomodoroPlanStep_t step, uint8_t state) {
+    return step.duration_s ? step.duration_s * 1000u : phase_duration_ms[state][s];
+}
+
+/**
+ * @brief Look one phase ahead, so session_dispatch() knows which way FINISHED goes
+ */
+static void plan_prefetch(uint32_t s) {
+    PomodoroPlanCursor_t cursor = store.plan_cursor[s];
+
+    store.plan_next[s] = pomodoro_plan_step(pomodoro_plan_get(store.plan[s]), &cursor).phase;
+}
+
+/**
+ * @brief Back to the start of the plan, the idle session shows its first phase
+ * @details The first phase is a work phase, pomodoro_plan_compile() makes sure of it.
+ */
+static void plan_rewind(uint32_t s) {
+    PomodoroPlanCursor_t cursor = { 0 };
+    PomodoroPlanStep_t first = pomodoro_plan_step(pomodoro_plan_get(store.plan[s]), &cursor);
+
+    store.plan_cursor[s] = (PomodoroPlanCursor_t){ 0 };
+    store.plan_next[s] = first.phase;
+    store.phase_ms[s] = plan_step_ms(s, first, POMODORO_WORK);
+}
+
+/**
+ * @brief Move the plan past the phase that starts now
+ * @return Its length
+ */
+static uint32_t plan_advance(uint32_t s, uint8_t next) {
+    PomodoroPlanStep_t step = pomodoro_plan_step(pomodoro_plan_get(store.plan[s]), &store.plan_cursor[s]);
+
+    store.phase_ms[s] = plan_step_ms(s, step, next);
+    plan_prefetch(s);
+    return store.phase_ms[s];
+}
+
+/**
+ * @brief Start the phase the plan yields next
+ */
+static void enter_next_phase(uint32_t s, uint8_t next) {
+    uint32_t duration_ms = plan_advance(s, next);
+
+    change_state(s, (PomodoroState_e)next, duration_ms);
+    session_timer_start(s, duration_ms);
+}
+
+static void act_ignore(uint32_t s, uint8_t next) {
+    (void)s;
+    (void)next;
+}
+
+static void act_start(uint32_t s, uint8_t next) {
+    store.cycle_count[s] = 0;
+    store.plan_cursor[s] = (PomodoroPlanCursor_t){ 0 };
+    enter_next_phase(s, next);
+}
+
+static void act_pause(uint32_t s, uint8_t next) {
+    change_state(s, (PomodoroState_e)next, session_timer_remaining(s));
+    session_timer_pause(s);
+}
+
+static void act_resume(uint32_t s, uint8_t next) {
+    change_state(s, (PomodoroState_e)next, store.remaining_ms[s]);
+    session_timer_resume(s);
+}
+
+static void act_reset(uint32_t s, uint8_t next) {
+    // Cleared before the change, so callbacks and the journal see the fresh session
+    store.cycle_count[s] = 0;
+    plan_rewind(s);
+    change_state(s, (PomodoroState_e)next, store.phase_ms[s]);
+    session_timer_stop(s);
+}
+
+static void act_finish_break(uint32_t s, uint8_t next) {
+    if (s == SESSION_DEFAULT) {
+        history_note();
+    }
+    enter_next_phase(s, next);
+}
+
+static void act_finish_work(uint32_t s, uint8_t next) {
+    // history_note() records the work phase, the cycle counts once it is in
+    if (s == SESSION_DEFAULT) {
+        history_note();
+    }
+    store.cycle_count[s]++;
+    enter_next_phase(s, next);
+}
+
+static void act_finish_end(uint32_t s, uint8_t next) {
+    // The cycles done stay on display until the next start
+    if (s == SESSION_DEFAULT) {
+        history_note();
     }
+    plan_rewind(s);
+    change_state(s, (PomodoroState_e)next, store.phase_ms[s]);
+    session_timer_stop(s);
+}
+
+static void (*const session_actions[POMODORO_ACT_COUNT])(uint32_t s, uint8_t next) = {
+    [POMODORO_ACT_IGNORE] = act_ignore,
+    [POMODORO_ACT_START] = act_start,
+    [POMODORO_ACT_PAUSE] = act_pause,
+    [POMODORO_ACT_RESUME] = act_resume,
+    [POMODORO_ACT_RESET] = act_reset,
+    [POMODORO_ACT_FINISH_WORK] = act_finish_work,
+    [POMODORO_ACT_FINISH_BREAK] = act_finish_break,
+    [POMODORO_ACT_FINISH_END] = act_finish_end,
+};
+
+/**
+ * @brief Run an event through pomodoro_fsm_table for a session
+ * @details FINISHED becomes FINISHED_LONG or FINISHED_END by what the plan yields
+ *          next (prefetched when the phase started), the classic break by the cycle
+ *          count. Both are arithmetic, so the whole dispatch is a few loads and a call.
+ * @param s Session slot, not free
+ * @param event Event below POMODORO_EV_FINISHED_LONG
+ */
+static void session_dispatch(uint32_t s, PomodoroFsmEvent_e event) {
+    const uint8_t finish_as[POMODORO_PLAN_PHASE_COUNT] = {
+        [POMODORO_PLAN_END] = POMODORO_EV_FINISHED_END - POMODORO_EV_FINISHED,
+        [POMODORO_PLAN_WORK] = 0,
+        [POMODORO_PLAN_SHORT] = 0,
+        [POMODORO_PLAN_LONG] = POMODORO_EV_FINISHED_LONG - POMODORO_EV_FINISHED,
+        [POMODORO_PLAN_ROUND] = (uint8_t)((uint8_t)(store.cycle_count[s] + 1u) % store.max_cycles[s] == 0),
+    };
+    uint32_t ev = (uint32_t)event + (event == POMODORO_EV_FINISHED) * finish_as[store.plan_next[s]];
+    PomodoroFsmEntry_t entry = pomodoro_fsm_lookup(store.current_state[s], (uint8_t)ev, store.previous_state[s]);
+
+    session_actions[entry.action](s, entry.next);
 }
 
 void pomodoro_init(uint32_t work_min, uint32_t short_break_min,
                    uint32_t long_break_min, uint8_t cycles_before_long) {
-    pomo_ctx.config.work_duration_ms = work_min * 60 * 1000;
-    pomo_ctx.config.short_break_duration_ms = short_break_min * 60 * 1000;
-    pomo_ctx.config.long_break_duration_ms = long_break_min * 60 * 1000;
-    pomo_ctx.config.max_cycles = cycles_before_long;
-    pomo_ctx.session.cycle_count = 0;
-    pomo_ctx.session.current_state = POMODORO_IDLE;
-    pomo_ctx.session.remaining_ms = pomo_ctx.config.work_duration_ms;
+    // A phase armed before must not finish against the IDLE session
+    session_timer_stop(SESSION_DEFAULT);
+    session_configure(SESSION_DEFAULT, work_min, short_break_min, long_break_min, cycles_before_long);
+    store.cycle_count[SESSION_DEFAULT] = 0;
+    store.current_state[SESSION_DEFAULT] = POMODORO_IDLE;
+    plan_rewind(SESSION_DEFAULT);
+    store.remaining_ms[SESSION_DEFAULT] = store.phase_ms[SESSION_DEFAULT];
+    journal_note();
 }
 
-void pomodoro_start(void) {
-    if (pomo_ctx.session.current_state == POMODORO_IDLE) {
-        change_state(POMODORO_WORK, pomo_ctx.config.work_duration_ms);
-        timer_start(pomo_ctx.config.work_duration_ms, on_timer_tick, on_timer_finished);
-    }
+/**
+ * @brief Phase log of a restored phase: started as long ago as it has run, pauses unknown
+ */
+static void phase_restore(uint32_t s) {
+    PomodoroPhaseLog_t *ph = &pomo_ctx.phase;
+    uint32_t duration_ms = store.phase_ms[s];
+
+    uint32_t ran_ms = (duration_ms > store.remaining_ms[s]) ? duration_ms - store.remaining_ms[s] : 0;
+    ph->start_ns = monotonic_now_ns() - (uint64_t)ran_ms * MONOTONIC_NS_PER_MS;
+    ph->start_wall_ms = pomodoro_history_now_ms() - ran_ms;
+    ph->paused_ns = 0;
+    ph->interruptions = 0;
 }
 
-void pomodoro_pause(void)
+void pomodoro_restore(const PomodoroSnapshot_t *snap, uint64_t elapsed_ms)
 {
-    switch (pomo_ctx.session.current_state) {
+    const uint32_t s = SESSION_DEFAULT;
+
+    session_timer_stop(s);
+    store.work_duration_ms[s] = snap->work_duration_ms;
+    store.short_break_duration_ms[s] = snap->short_break_duration_ms;
+    store.long_break_duration_ms[s] = snap->long_break_duration_ms;
+    store.max_cycles[s] = snap->max_cycles ? snap->max_cycles : 1;
+    store.cycle_count[s] = snap->cycle_count;
+    store.previous_state[s] = (uint8_t)snap->previous_state;
+    store.current_state[s] = ((uint32_t)snap->state < POMODORO_FSM_STATES) ? (uint8_t)snap->state : POMODORO_IDLE;
+    store.remaining_ms[s] = snap->remaining_ms;
+    store.plan[s] = pomodoro_plan_is_valid(snap->plan) ? snap->plan : POMODORO_PLAN_CLASSIC;
+    store.plan_cursor[s] = (snap->plan_cursor.pc < pomodoro_plan_get(store.plan[s])->size)
+                               ? snap->plan_cursor : (PomodoroPlanCursor_t){ 0 };
+    plan_prefetch(s);
+    // A paused phase is as long as the phase it resumes into
+    store.phase_ms[s] = snap->phase_duration_ms ? snap->phase_duration_ms :
+        phase_duration_ms[pomodoro_fsm_lookup(store.current_state[s], POMODORO_EV_RESUME, store.previous_state[s]).next][s];
+    pomo_ctx.transition_count = snap->transition_count;
+
+    switch (store.current_state[s]) {
         case POMODORO_WORK:
-            change_state(POMODORO_PAUSED_WORK, timer_get_remaining());
-            timer_pause();
-            break;
-            
         case POMODORO_SHORT_BREAK:
-        case POMODORO_LONG_BREAK:
-            change_state(POMODORO_PAUSED_BREAK, timer_get_remaining());
-            timer_pause();
+        case POMODORO_LONG_BREAK: {
+            // After the current phase the classic plan repeats every round of max_cycles
+            // work phases, so whole rounds are skipped instead of stepped through; other
+            // plans take one dispatch per phase, a handful of bytecode steps each
+            uint64_t round = (uint64_t)store.work_duration_ms[s] * store.max_cycles[s] +
+                             (uint64_t)store.short_break_duration_ms[s] * (store.max_cycles[s] - 1u) +
+                             store.long_break_duration_ms[s];
+
+            if (round == 0) {
+                elapsed_ms = 0;
+            } else if (store.plan[s] == POMODORO_PLAN_CLASSIC && elapsed_ms >= store.remaining_ms[s]) {
+                elapsed_ms = store.remaining_ms[s] + (elapsed_ms - store.remaining_ms[s]) % round;
+            }
+            // Nobody was there to see the phases that ended while down, they stay out of the history
+            pomo_ctx.phase.mute = true;
+            while (state_is_running(store.current_state[s]) && elapsed_ms >= store.remaining_ms[s] && elapsed_ms > 0) {
+                elapsed_ms -= store.remaining_ms[s];
+                session_dispatch(s, POMODORO_EV_FINISHED);
+            }
+            pomo_ctx.phase.mute = false;
+            // A plan that ran out while down left the session IDLE
+            if (state_is_running(store.current_state[s])) {
+                store.remaining_ms[s] -= (uint32_t)elapsed_ms;
+                session_timer_start(s, store.remaining_ms[s]);
+                phase_restore(s);
+            }
+            break;
+        }
+
+        case POMODORO_PAUSED_WORK:
+        case POMODORO_PAUSED_BREAK:
+            // Armed and paused at once, so pomodoro_resume() continues with the saved time
+            session_timer_start(s, store.remaining_ms[s]);
+            session_timer_pause(s);
+            phase_restore(s);
+            pomo_ctx.phase.pause_ns = monotonic_now_ns();
+            pomo_ctx.phase.interruptions = 1;
+            break;
+
+        default:
             break;
     }
 }
 
+void pomodoro_start(void) {
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_START);
+}
+
+void pomodoro_pause(void)
+{
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_PAUSE);
+}
+
 void pomodoro_resume(void) {
-    if (pomo_ctx.session.current_state == POMODORO_PAUSED_WORK) {
-        change_state(POMODORO_WORK, pomo_ctx.session.remaining_ms);
-        timer_resume();
-    } else if (pomo_ctx.session.current_state == POMODORO_PAUSED_BREAK) {
-        if (pomo_ctx.session.cycle_count % pomo_ctx.config.max_cycles == 0) {
-            change_state(POMODORO_LONG_BREAK, pomo_ctx.session.remaining_ms);
-        } else {
-            change_state(POMODORO_SHORT_BREAK, pomo_ctx.session.remaining_ms);
-        }
-        timer_resume();
-    }
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_RESUME);
 }
 
 void pomodoro_reset(void) {
-    change_state(POMODORO_IDLE, 0);
-    pomo_ctx.session.cycle_count = 0;
-    pomo_ctx.session.remaining_ms = pomo_ctx.config.work_duration_ms;
-    timer_stop();
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_RESET);
+}
+
+void pomodoro_tick(void)
+{
+    timer_tick_handler();
+}
+
+uint32_t pomodoro_get_next_deadline_ms(void)
+{
+    uint32_t wait = timer_get_next_deadline_ms();
+    return (wait == TIMER_NO_DEADLINE) ? POMODORO_NO_DEADLINE : wait;
 }
 
 PomodoroState_e pomodoro_get_state(void) {
-    return pomo_ctx.session.current_state;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->state;
 }
 
 uint32_t pomodoro_get_remaining_sec(void) 
 {
-    return pomo_ctx.session.remaining_ms / 1000;  // Convert to seconds for API
+    PomodoroSnapshot_t scratch;
+    // Round up like the countdown display: a second is shown until it has fully elapsed
+    return (session_view(&scratch)->remaining_ms + 999) / 1000;
 }
 
 void pomodoro_set_state_callback(pomodoro_state_cb_t cb)
@@ -178,43 +684,55 @@ void pomodoro_set_state_callback(pomodoro_state_cb_t cb)
 void pomodoro_set_tick_callback(pomodoro_tick_cb_t cb)
 {
     pomo_ctx.callbacks.tick_callback = cb;
+    timer_set_tick_callback(timer_tick_cb());
 }
 
 uint8_t pomodoro_get_current_cycle(void)
 {
-    return pomo_ctx.session.cycle_count;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->cycle_count;
 }
 
 uint8_t pomodoro_get_max_cycles(void)
 {
-    return pomo_ctx.config.max_cycles;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->max_cycles;
 }
 
 bool pomodoro_is_resume_transition(void)
 {
+    PomodoroSnapshot_t scratch;
+    const PomodoroSnapshot_t *view = session_view(&scratch);
+
     // True if previous_state was PAUSED_WORK and current_state is WORK,
     // or previous_state was PAUSED_BREAK and current_state is SHORT_BREAK or LONG_BREAK
-    return ((pomo_ctx.session.previous_state == POMODORO_PAUSED_WORK && pomo_ctx.session.current_state == POMODORO_WORK) ||
-            (pomo_ctx.session.previous_state == POMODORO_PAUSED_BREAK && 
-               (pomo_ctx.session.current_state == POMODORO_SHORT_BREAK || pomo_ctx.session.current_state == POMODORO_LONG_BREAK)));
+    return ((view->previous_state == POMODORO_PAUSED_WORK && view->state == POMODORO_WORK) ||
+            (view->previous_state == POMODORO_PAUSED_BREAK && 
+               (view->state == POMODORO_SHORT_BREAK || view->state == POMODORO_LONG_BREAK)));
 }
 
 bool pomodoro_is_pause_transition(void)
 {
+    PomodoroSnapshot_t scratch;
+    const PomodoroSnapshot_t *view = session_view(&scratch);
+
     return (
-        (pomo_ctx.session.current_state == POMODORO_PAUSED_WORK ||
-         pomo_ctx.session.current_state == POMODORO_PAUSED_BREAK)
+        (view->state == POMODORO_PAUSED_WORK ||
+         view->state == POMODORO_PAUSED_BREAK)
     );
 }
 
 int8_t pomodoro_get_pause_break_type(void)
 {
-    if (pomo_ctx.session.current_state == POMODORO_PAUSED_BREAK) {
+    PomodoroSnapshot_t scratch;
+    const PomodoroSnapshot_t *view = session_view(&scratch);
+
+    if (view->state == POMODORO_PAUSED_BREAK) {
         // Check the previous state to know which break was paused
-        if (pomo_ctx.session.previous_state == POMODORO_SHORT_BREAK) {
+        if (view->previous_state == POMODORO_SHORT_BREAK) {
             return POMODORO_SHORT_BREAK;
         }
-        if (pomo_ctx.session.previous_state == POMODORO_LONG_BREAK) {
+        if (view->previous_state == POMODORO_LONG_BREAK) {
             return POMODORO_LONG_BREAK;
         }
     }
@@ -225,47 +743,289 @@ int8_t pomodoro_get_pause_break_type(void)
 void pomodoro_update_durations(uint32_t work_min, uint32_t short_break_min,
                                uint32_t long_break_min, uint8_t cycles_before_long)
 {
-    pomo_ctx.config.work_duration_ms = work_min * 60 * 1000;
-    pomo_ctx.config.short_break_duration_ms = short_break_min * 60 * 1000;
-    pomo_ctx.config.long_break_duration_ms = long_break_min * 60 * 1000;
-    pomo_ctx.config.max_cycles = cycles_before_long;
+    session_configure(SESSION_DEFAULT, work_min, short_break_min, long_break_min, cycles_before_long);
+
+    // If currently idle, show the plan's first phase with the new durations
+    if (store.current_state[SESSION_DEFAULT] == POMODORO_IDLE) {
+        plan_rewind(SESSION_DEFAULT);
+        store.remaining_ms[SESSION_DEFAULT] = store.phase_ms[SESSION_DEFAULT];
+    }
+    journal_note();
+}
 
-    // If currently idle, update remaining_ms to new work duration
-    if (pomo_ctx.session.current_state == POMODORO_IDLE) {
-        pomo_ctx.session.remaining_ms = pomo_ctx.config.work_duration_ms;
+bool pomodoro_set_plan(uint8_t plan)
+{
+    if (!pomodoro_plan_is_valid(plan)) {
+        CORE_LOG_WARN("[Pomodoro] Plan %u is not loaded\n", (unsigned)plan);
+        return false;
     }
+    store.plan[SESSION_DEFAULT] = plan;
+    session_dispatch(SESSION_DEFAULT, POMODORO_EV_RESET);
+    return true;
+}
+
+uint8_t pomodoro_get_plan(void)
+{
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->plan;
 }
 
 int pomodoro_get_work_time(void)
 {
-    return pomo_ctx.config.work_duration_ms;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->work_duration_ms;
 }
 
 int pomodoro_get_short_break(void)
 {
-    return pomo_ctx.config.short_break_duration_ms;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->short_break_duration_ms;
 }
 
 int pomodoro_get_long_break(void)
 {
-    return pomo_ctx.config.long_break_duration_ms;
+    PomodoroSnapshot_t scratch;
+    return session_view(&scratch)->long_break_duration_ms;
 }
 
 int pomodoro_get_cycle_count(void)
 {
-   return pomo_ctx.config.max_cycles;
+   PomodoroSnapshot_t scratch;
+   return session_view(&scratch)->max_cycles;
 }
 
 uint8_t pomodoro_get_work_progress_in_percent(void)
 {
+    PomodoroSnapshot_t scratch;
+    const PomodoroSnapshot_t *view = session_view(&scratch);
     uint8_t percent = 0;
-    if (pomo_ctx.config.work_duration_ms == 0) return 0;
+    if (view->phase_duration_ms == 0 || view->remaining_ms > view->phase_duration_ms) return 0;
 
-    percent = (uint8_t)(((pomo_ctx.config.work_duration_ms - pomo_ctx.session.remaining_ms) * 100) /
-                            pomo_ctx.config.work_duration_ms);
+    // 64-bit: the done milliseconds times 100 pass UINT32_MAX in phases over 11.9 h
+    percent = (uint8_t)(((uint64_t)(view->phase_duration_ms - view->remaining_ms) * 100u) /
+                            view->phase_duration_ms);
     return percent;
 }
 
+uint32_t pomodoro_progress_q16(const PomodoroSnapshot_t *snap, uint64_t now_ns)
+{
+    // Microseconds: a 2^32 ms phase shifted by 16 still fits in 64 bits
+    uint64_t phase_us = (uint64_t)snap->phase_duration_ms * 1000u;
+    uint64_t left_us = (uint64_t)snap->remaining_ms * 1000u;
+
+    if (phase_us == 0) return 0;
+    if (snap->phase_end_ns != 0) {
+        left_us = (snap->phase_end_ns > now_ns) ? (snap->phase_end_ns - now_ns) / 1000u : 0;
+    }
+    if (left_us >= phase_us) return 0;
+    return (uint32_t)(((phase_us - left_us) << 16) / phase_us);
+}
+
+uint32_t pomodoro_get_progress_q16(void)
+{
+    PomodoroSnapshot_t scratch;
+    return pomodoro_progress_q16(session_view(&scratch), monotonic_read_ns());
+}
+
+/**
+ * @brief Copy one session into a snapshot
+ */
+static void session_snapshot(uint32_t s, PomodoroSnapshot_t *snap)
+{
+    snap->state = (PomodoroState_e)store.current_state[s];
+    snap->previous_state = (PomodoroState_e)store.previous_state[s];
+    snap->remaining_ms = session_remaining_ms(s);
+    snap->work_duration_ms = store.work_duration_ms[s];
+    snap->short_break_duration_ms = store.short_break_duration_ms[s];
+    snap->long_break_duration_ms = store.long_break_duration_ms[s];
+    snap->transition_count = (s == SESSION_DEFAULT) ? pomo_ctx.transition_count : 0;
+    snap->tick_count = (s == SESSION_DEFAULT) ? pomo_ctx.tick_count : 0;
+    snap->cycle_count = store.cycle_count[s];
+    snap->max_cycles = store.max_cycles[s];
+    snap->phase_duration_ms = store.phase_ms[s];
+    snap->plan = store.plan[s];
+    snap->plan_cursor = store.plan_cursor[s];
+    snap->phase_end_ns = session_end_ns(s);
+}
+
+void pomodoro_get_snapshot(PomodoroSnapshot_t *snap)
+{
+    session_snapshot(SESSION_DEFAULT, snap);
+}
+
+void pomodoro_set_snapshot_view(const PomodoroSnapshot_t *snap)
+{
+    snapshot_view = snap;
+}
+
+void pomodoro_read_snapshot(PomodoroSnapshot_t *snap)
+{
+    const PomodoroSnapshot_t *view = session_view(snap);
+
+    if (view != snap) {
+        *snap = *view;
+    }
+}
+
+// ====================== Session API ======================
+
+pomodoro_session_t pomodoro_session_create(uint32_t work_min, uint32_t short_break_min,
+                                           uint32_t long_break_min, uint8_t cycles_before_long)
+{
+    uint32_t s;
+
+    if (store.free_head != SESSION_INDEX_MASK) {
+        s = store.free_head;
+        store.free_head = store.remaining_ms[s];
+    } else if (store.high_water < POMODORO_MAX_SESSIONS) {
+        s = store.high_water++;
+    } else {
+        CORE_LOG_WARN("[Pomodoro] Session pool exhausted (%d sessions)\n", POMODORO_MAX_SESSIONS);
+        return POMODORO_SESSION_INVALID;
+    }
+    store.live++;
+
+    session_configure(s, work_min, short_break_min, long_break_min, cycles_before_long);
+    store.current_state[s] = POMODORO_IDLE;
+    store.previous_state[s] = POMODORO_IDLE;
+    store.cycle_count[s] = 0;
+    store.plan[s] = POMODORO_PLAN_CLASSIC;
+    plan_rewind(s);
+    store.remaining_ms[s] = store.phase_ms[s];
+
+    return make_session_handle(s);
+}
+
+bool pomodoro_session_destroy(pomodoro_session_t session)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK || s == SESSION_DEFAULT) {
+        return false;
+    }
+    if (state_is_running(store.current_state[s])) {
+        store.bulk_running--;
+    }
+    store.current_state[s] = SESSION_FREE;
+    store.gen[s] = (uint16_t)((store.gen[s] + 1u) & SESSION_GEN_MASK);
+    store.remaining_ms[s] = store.free_head;
+    store.free_head = s;
+    store.live--;
+    return true;
+}
+
+bool pomodoro_session_start(pomodoro_session_t session)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK) return false;
+    session_dispatch(s, POMODORO_EV_START);
+    return true;
+}
+
+bool pomodoro_session_pause(pomodoro_session_t session)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK) return false;
+    session_dispatch(s, POMODORO_EV_PAUSE);
+    return true;
+}
+
+bool pomodoro_session_resume(pomodoro_session_t session)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK) return false;
+    session_dispatch(s, POMODORO_EV_RESUME);
+    return true;
+}
+
+bool pomodoro_session_reset(pomodoro_session_t session)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK) return false;
+    session_dispatch(s, POMODORO_EV_RESET);
+    return true;
+}
+
+bool pomodoro_session_dispatch(pomodoro_session_t session, PomodoroFsmEvent_e event)
+{
+    uint32_t s = session_index(session);
+
+    // FINISHED_LONG and FINISHED_END are the dispatcher's to pick, from the plan
+    if (s == SESSION_INDEX_MASK || (uint32_t)event >= POMODORO_EV_FINISHED_LONG) return false;
+    session_dispatch(s, event);
+    return true;
+}
+
+bool pomodoro_session_set_plan(pomodoro_session_t session, uint8_t plan)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK || !pomodoro_plan_is_valid(plan)) return false;
+    store.plan[s] = plan;
+    session_dispatch(s, POMODORO_EV_RESET);
+    return true;
+}
+
+bool pomodoro_session_get_snapshot(pomodoro_session_t session, PomodoroSnapshot_t *snap)
+{
+    uint32_t s = session_index(session);
+
+    if (s == SESSION_INDEX_MASK) return false;
+    session_snapshot(s, snap);
+    return true;
+}
+
+void pomodoro_sessions_set_state_callback(pomodoro_session_state_cb_t cb)
+{
+    sessions_state_cb = cb;
+}
+
+uint32_t pomodoro_sessions_get_count(void)
+{
+    return store.live;
+}
+
+void pomodoro_sessions_advance(uint32_t elapsed_ms)
+{
+    uint64_t expired[BATCH_TICK_MASK_WORDS(SWEEP_CHUNK)];
+    const uint8_t *state = store.current_state;
+    uint32_t *remaining = store.remaining_ms;
+    uint32_t end = store.high_water;
+
+    for (uint32_t base = SESSION_DEFAULT + 1; base < end; base += SWEEP_CHUNK) {
+        uint32_t count = (end - base < SWEEP_CHUNK) ? (end - base) : SWEEP_CHUNK;
+
+        // Countdown of the whole chunk in one vectorized pass, phase ends only where a bit is set
+        if (batch_tick(&remaining[base], &state[base], count, elapsed_ms,
+                       POMODORO_WORK, POMODORO_LONG_BREAK, expired) == 0) {
+            continue;
+        }
+
+        for (uint32_t w = 0; w < BATCH_TICK_MASK_WORDS(count); w++) {
+            for (uint64_t bits = expired[w]; bits; bits &= bits - 1u) {
+                uint32_t s = base + w * 64u + batch_tick_lowest_lane(bits);
+
+                // A state callback earlier in this chunk may have paused or destroyed it
+                if (!state_is_running(state[s])) {
+                    continue;
+                }
+
+                // Carry the overshoot into the next phase so sessions do not drift by a sweep
+                // period per phase. At most one transition per sweep, a shorter phase ends next time.
+                uint32_t overshoot = elapsed_ms - remaining[s];
+                session_dispatch(s, POMODORO_EV_FINISHED);
+                if (state_is_running(state[s])) {
+                    remaining[s] = (remaining[s] > overshoot) ? (remaining[s] - overshoot) : 0;
+                }
+            }
+        }
+    }
+}
+
 static const char *pomoState2Str(PomodoroState_e state) {
     switch (state) {
         case POMODORO_IDLE: return "IDLE";
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "pomodoro_plan.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +14,32 @@ extern "C" {
 #define POMODORO_DEF_LONG_BREAK_MIN         2
 #define POMODORO_DEF_CYCLES_BEFORE_LONG     2
 
+/** Returned by pomodoro_get_next_deadline_ms() when nothing is scheduled */
+#define POMODORO_NO_DEADLINE                UINT32_MAX
+
+/** A whole phase done, in the Q16 fixed point of pomodoro_get_progress_q16() */
+#define POMODORO_PROGRESS_ONE               (1u << 16)
+
+/** Session slots, the default session included. Static storage, override at build time for large hosts. */
+#ifndef POMODORO_MAX_SESSIONS
+#define POMODORO_MAX_SESSIONS               16
+#endif
+
+/** Period of the sweep that counts down created sessions, also their phase end resolution */
+#ifndef POMODORO_SWEEP_PERIOD_MS
+#define POMODORO_SWEEP_PERIOD_MS            1000
+#endif
+
+/**
+ * @brief Handle to a session
+ * @details The single-session API below drives POMODORO_SESSION_DEFAULT. Handles of
+ *          destroyed sessions go stale and are rejected.
+ */
+typedef uint32_t pomodoro_session_t;
+
+#define POMODORO_SESSION_DEFAULT            ((pomodoro_session_t)0)
+#define POMODORO_SESSION_INVALID            ((pomodoro_session_t)UINT32_MAX)
+
 /**
  * @brief Pomodoro states
  */
@@ -38,7 +65,36 @@ typedef void (*pomodoro_state_cb_t)(PomodoroState_e state);
 typedef void (*pomodoro_tick_cb_t)(uint32_t remaining_sec);
 
 /**
- * @brief Initialize the Pomodoro module
+ * @brief Type for state change callback of any session
+ * @param session Session that changed
+ * @param state New state
+ */
+typedef void (*pomodoro_session_state_cb_t)(pomodoro_session_t session, PomodoroState_e state);
+
+/**
+ * @brief Immutable copy of the session, as seen by another thread
+ * @details Filled on the thread that drives the Core. The counters let a
+ *          reader tell which callbacks happened since its last copy.
+ */
+typedef struct {
+    PomodoroState_e state;                      /**< Current session state */
+    PomodoroState_e previous_state;             /**< State before the last transition */
+    uint32_t        remaining_ms;               /**< Remaining milliseconds in current session */
+    uint32_t        work_duration_ms;           /**< Configured work duration */
+    uint32_t        short_break_duration_ms;    /**< Configured short break duration */
+    uint32_t        long_break_duration_ms;     /**< Configured long break duration */
+    uint32_t        transition_count;           /**< State callbacks fired since boot (default session only) */
+    uint32_t        tick_count;                 /**< Tick callbacks fired since boot (default session only) */
+    uint8_t         cycle_count;                /**< Work sessions completed */
+    uint8_t         max_cycles;                 /**< Cycles before long break */
+    uint32_t        phase_duration_ms;          /**< Length of the current phase; of the first one when IDLE */
+    uint8_t         plan;                       /**< Plan slot the session runs */
+    PomodoroPlanCursor_t plan_cursor;           /**< Where the session is in its plan */
+    uint64_t        phase_end_ns;               /**< Monotonic time the running phase ends, 0 if not running */
+} PomodoroSnapshot_t;
+
+/**
+ * @brief Initialize the Pomodoro module, back to IDLE; a running phase is stopped
  * @param work_min Duration of work session in minutes
  * @param short_break_min Duration of short break in minutes
  * @param long_break_min Duration of long break in minutes
@@ -47,6 +103,17 @@ typedef void (*pomodoro_tick_cb_t)(uint32_t remaining_sec);
 void pomodoro_init(uint32_t work_min, uint32_t short_break_min,
                    uint32_t long_break_min, uint8_t cycles_before_long);
 
+/**
+ * @brief Put the default session back into a saved state, e.g. after a restart
+ * @details Takes state, durations, cycles, remaining time and transition count from snap.
+ *          A running phase continues with elapsed_ms less; phases that would have ended
+ *          in that time are run through, firing the usual callbacks. Paused and idle
+ *          sessions are restored as they were.
+ * @param snap Saved session
+ * @param elapsed_ms Time since snap was taken
+ */
+void pomodoro_restore(const PomodoroSnapshot_t *snap, uint64_t elapsed_ms);
+
 /**
  * @brief Start a Pomodoro timer
  *        Moves IDLE -> WORK
@@ -63,7 +130,7 @@ void pomodoro_pause(void);
 /**
  * @brief Resume a paused session
  *        PAUSED_WORK -> WORK
- *        PAUSED_BREAK -> SHORT/LONG_BREAK
+ *        PAUSED_BREAK -> the SHORT/LONG_BREAK that was paused
  */
 void pomodoro_resume(void);
 
@@ -110,11 +177,20 @@ void pomodoro_set_state_callback(pomodoro_state_cb_t cb);
 void pomodoro_set_tick_callback(pomodoro_tick_cb_t cb);
 
 /**
- * @brief To be called every second to update Pomodoro timer
- *        Normally this will be called from a timer interrupt or periodic task
+ * @brief Drive the Pomodoro timer: fires tick and phase-end callbacks that are due
+ *        Call it from the main loop, at the latest when pomodoro_get_next_deadline_ms() elapses.
+ *        Calling it more often is cheap and harmless.
  */
 void pomodoro_tick(void);
 
+/**
+ * @brief Get the time until pomodoro_tick() has work to do
+ * @details Earliest of the next second boundary of the countdown and the phase end.
+ *          In IDLE and PAUSED_* nothing is armed, so the caller can sleep until input arrives.
+ * @return Milliseconds to wait, or POMODORO_NO_DEADLINE
+ */
+uint32_t pomodoro_get_next_deadline_ms(void);
+
 /** 
  * @brief Check if the last state transition was a resume transition
  * @return true if the last transition was a resume, false otherwise
@@ -137,6 +213,19 @@ bool pomodoro_is_pause_transition(void);
 void pomodoro_update_durations(uint32_t work_min, uint32_t short_break_min,
                                uint32_t long_break_min, uint8_t cycles_before_long);
 
+/**
+ * @brief Run the default session on another plan
+ * @details The session is reset, the plan starts with the next pomodoro_start().
+ * @param plan Plan slot, see pomodoro_plan.h
+ * @return false if the slot holds no plan
+ */
+bool pomodoro_set_plan(uint8_t plan);
+
+/**
+ * @brief Plan slot the default session runs
+ */
+uint8_t pomodoro_get_plan(void);
+
 /**
  * @brief Get the configured work time duration
  * @return Work time duration in minutes
@@ -164,15 +253,128 @@ int pomodoro_get_cycle_count(void);
 /**
  * @brief Get the progress of current work session as a percentage
  * @details Computes how far along the current work session is by comparing 
- *          the remaining time against the total work duration
+ *          the remaining time against the length of the phase, as its plan set it
  * @return Percentage of work session completed (0-100)
- * @note Returns 0 if work duration is configured as 0
+ * @note Returns 0 if the phase length is 0
  */
 uint8_t pomodoro_get_work_progress_in_percent(void);
 
+/**
+ * @brief Get how much of the current phase is done, in Q16 fixed point
+ * @details While the phase runs, the time left is taken from its end on the
+ *          monotonic clock instead of from the last tick, so the value moves
+ *          between ticks. Paused and IDLE sessions report the last tick.
+ *          Reads the clock with monotonic_read_ns(): also fine on the render
+ *          thread of pomodoro_runtime, from its snapshot.
+ * @return 0 to POMODORO_PROGRESS_ONE
+ * @note Returns 0 if the phase length is 0
+ */
+uint32_t pomodoro_get_progress_q16(void);
+
+/**
+ * @brief pomodoro_get_progress_q16() of a session copy at a given time
+ * @param snap Session, e.g. from pomodoro_read_snapshot()
+ * @param now_ns Monotonic time
+ * @return 0 to POMODORO_PROGRESS_ONE
+ */
+uint32_t pomodoro_progress_q16(const PomodoroSnapshot_t *snap, uint64_t now_ns);
+
 
 int8_t pomodoro_get_pause_break_type(void);
 
+/**
+ * @brief Copy the current session into a snapshot
+ * @details Call it from the thread that drives the Core.
+ * @param snap Destination
+ */
+void pomodoro_get_snapshot(PomodoroSnapshot_t *snap);
+
+/**
+ * @brief Make the getters of the calling thread read from a snapshot
+ * @details Used by pomodoro_runtime on the render thread, so the UI keeps
+ *          calling pomodoro_get_*() while the Core runs on another thread.
+ *          The snapshot must stay unchanged until it is replaced.
+ *          Only the calling thread is affected; NULL reads the live session again.
+ * @param snap Snapshot to read from, or NULL
+ */
+void pomodoro_set_snapshot_view(const PomodoroSnapshot_t *snap);
+
+/**
+ * @brief Copy the default session as the getters of the calling thread see it
+ * @details The snapshot set with pomodoro_set_snapshot_view(), else the live session.
+ * @param snap Destination
+ */
+void pomodoro_read_snapshot(PomodoroSnapshot_t *snap);
+
+/*
+ * Sessions
+ *
+ * One process can track many sessions, e.g. everyone in a team room. They live
+ * in one store with a contiguous array per field. The default session is the
+ * one behind the API above: it counts down on the timing wheel with
+ * phase-locked ticks. Created sessions have no tick callbacks; while any of them
+ * runs, a sweep every POMODORO_SWEEP_PERIOD_MS subtracts the elapsed time from
+ * all of them at once, driven by pomodoro_tick() like the default session.
+ * Note that timer_init() also drops the sweep timer, the next start or resume re-arms it.
+ */
+
+/**
+ * @brief Create an IDLE session
+ * @param work_min Duration of work session in minutes
+ * @param short_break_min Duration of short break in minutes
+ * @param long_break_min Duration of long break in minutes
+ * @param cycles_before_long Number of work cycles before a long break
+ * @return Handle, or POMODORO_SESSION_INVALID when all POMODORO_MAX_SESSIONS slots are used
+ */
+pomodoro_session_t pomodoro_session_create(uint32_t work_min, uint32_t short_break_min,
+                                           uint32_t long_break_min, uint8_t cycles_before_long);
+
+/**
+ * @brief Destroy a created session, its handle goes stale
+ * @return false for stale handles and the default session
+ */
+bool pomodoro_session_destroy(pomodoro_session_t session);
+
+/**
+ * @brief pomodoro_start() / pause() / resume() / reset() for any session
+ * @return false if the handle is stale or invalid
+ */
+bool pomodoro_session_start(pomodoro_session_t session);
+bool pomodoro_session_pause(pomodoro_session_t session);
+bool pomodoro_session_resume(pomodoro_session_t session);
+bool pomodoro_session_reset(pomodoro_session_t session);
+
+/**
+ * @brief pomodoro_set_plan() for any session
+ * @return false if the handle is stale or invalid, or the slot holds no plan
+ */
+bool pomodoro_session_set_plan(pomodoro_session_t session, uint8_t plan);
+
+/**
+ * @brief Copy a session into a snapshot
+ * @return false if the handle is stale or invalid
+ */
+bool pomodoro_session_get_snapshot(pomodoro_session_t session, PomodoroSnapshot_t *snap);
+
+/**
+ * @brief Register a callback for state changes of every session, the default one included
+ * @param cb Function pointer to call on state change, or NULL
+ */
+void pomodoro_sessions_set_state_callback(pomodoro_session_state_cb_t cb);
+
+/**
+ * @brief Number of sessions in use, the default session included
+ */
+uint32_t pomodoro_sessions_get_count(void);
+
+/**
+ * @brief Count all running created sessions down by elapsed_ms
+ * @details Runs the phase ends that are due, in slot order. Called by the sweep timer;
+ *          call it directly to drive sessions from an external clock.
+ * @param elapsed_ms Time since the last call
+ */
+void pomodoro_sessions_advance(uint32_t elapsed_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,77 @@
+#include "pomodoro_fsm.h"
+
+// ====================== Transition Table ======================
+
+#define FSM_ROW(arg, state, event, action, next) \
+    [state][event] = { (uint8_t)(action), (uint8_t)(next) },
+
+const PomodoroFsmEntry_t pomodoro_fsm_table[POMODORO_FSM_STATES][POMODORO_EV_COUNT] = {
+    POMODORO_FSM_TRANSITIONS(FSM_ROW, 0)
+};
+
+// ====================== Compile-Time Checks ======================
+
+#define FSM_ALL_STATES      ((1u << POMODORO_FSM_STATES) - 1u)
+#define FSM_BIT(state)      (1u << (state))
+
+/* Targets of a row: the resumed break may be either break */
+#define FSM_TARGETS(next) \
+    ((next) == POMODORO_FSM_PAUSED_BREAK_TYPE ? (FSM_BIT(POMODORO_SHORT_BREAK) | FSM_BIT(POMODORO_LONG_BREAK)) \
+                                              : FSM_BIT(next))
+
+/* One enumerator per (state, event): a pair listed twice is a redeclaration */
+#define FSM_PAIR(arg, state, event, action, next)   FSM_PAIR_##state##_##event,
+enum { POMODORO_FSM_TRANSITIONS(FSM_PAIR, 0) FSM_PAIR_COUNT };
+_Static_assert(FSM_PAIR_COUNT == POMODORO_FSM_STATES * POMODORO_EV_COUNT,
+               "every (state, event) pair needs exactly one row in POMODORO_FSM_TRANSITIONS");
+
+/* Rows out of range */
+#define FSM_BAD_ROW(arg, state, event, action, next) \
+    + ((unsigned)(state) >= POMODORO_FSM_STATES || (unsigned)(event) >= POMODORO_EV_COUNT || \
+       (unsigned)(action) >= POMODORO_ACT_COUNT || (unsigned)(next) > POMODORO_FSM_PAUSED_BREAK_TYPE)
+_Static_assert((0 POMODORO_FSM_TRANSITIONS(FSM_BAD_ROW, 0)) == 0, "a row names an unknown state, event or action");
+
+/* An ignored event leaves the state as it is */
+#define FSM_BAD_IGNORE(arg, state, event, action, next) \
+    + ((action) == POMODORO_ACT_IGNORE && (next) != (state))
+_Static_assert((0 POMODORO_FSM_TRANSITIONS(FSM_BAD_IGNORE, 0)) == 0, "an ignored event changes the state");
+
+/* States reachable from IDLE: one more step per enumerator, a path has at most STATES - 1 steps */
+#define FSM_STEP(reach, state, event, action, next) \
+    | (((reach) & FSM_BIT(state)) && (action) != POMODORO_ACT_IGNORE ? FSM_TARGETS(next) : 0u)
+enum {
+    FSM_REACH_0 = FSM_BIT(POMODORO_IDLE),
+    FSM_REACH_1 = FSM_REACH_0 POMODORO_FSM_TRANSITIONS(FSM_STEP, FSM_REACH_0),
+    FSM_REACH_2 = FSM_REACH_1 POMODORO_FSM_TRANSITIONS(FSM_STEP, FSM_REACH_1),
+    FSM_REACH_3 = FSM_REACH_2 POMODORO_FSM_TRANSITIONS(FSM_STEP, FSM_REACH_2),
+    FSM_REACH_4 = FSM_REACH_3 POMODORO_FSM_TRANSITIONS(FSM_STEP, FSM_REACH_3),
+    FSM_REACH_5 = FSM_REACH_4 POMODORO_FSM_TRANSITIONS(FSM_STEP, FSM_REACH_4),
+};
+_Static_assert(POMODORO_FSM_STATES == 6, "add an FSM_REACH step per state");
+_Static_assert(FSM_REACH_5 == FSM_ALL_STATES, "a state cannot be reached from IDLE");
+
+/* Every state has a way out */
+#define FSM_LEAVES(arg, state, event, action, next) \
+    | ((action) != POMODORO_ACT_IGNORE && (next) != (state) ? FSM_BIT(state) : 0u)
+_Static_assert((0u POMODORO_FSM_TRANSITIONS(FSM_LEAVES, 0)) == FSM_ALL_STATES, "a state cannot be left");
+
+/* Every action is used */
+#define FSM_ACTIONS(arg, state, event, action, next)    | (1u << (action))
+_Static_assert((0u POMODORO_FSM_TRANSITIONS(FSM_ACTIONS, 0)) == (1u << POMODORO_ACT_COUNT) - 1u,
+               "an action is never used");
+
+// ====================== Public API ======================
+
+const char *pomodoro_fsm_event_name(PomodoroFsmEvent_e event) {
+    static const char *const names[POMODORO_EV_COUNT] = {
+        [POMODORO_EV_START] = "START",
+        [POMODORO_EV_PAUSE] = "PAUSE",
+        [POMODORO_EV_RESUME] = "RESUME",
+        [POMODORO_EV_RESET] = "RESET",
+        [POMODORO_EV_FINISHED] = "FINISHED",
+        [POMODORO_EV_FINISHED_LONG] = "FINISHED_LONG",
+        [POMODORO_EV_FINISHED_END] = "FINISHED_END",
+    };
+
+    return ((unsigned)event < POMODORO_EV_COUNT) ? names[event] : "UNKNOWN";
+}
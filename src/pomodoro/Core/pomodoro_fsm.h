@@ -0,0 +1,160 @@
+#ifndef POMODORO_FSM_H
+#define POMODORO_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pomodoro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_fsm.h
+ * @brief Transition table of a session: state x event -> action, next state.
+ *
+ * Every transition of every session is one row of POMODORO_FSM_TRANSITIONS,
+ * and every (state, event) pair has exactly one row, ignored pairs included.
+ * pomodoro_fsm.c expands the list into pomodoro_fsm_table[][] and checks it
+ * at compile time: a missing or duplicated pair, a state that cannot be
+ * reached from IDLE, a state that cannot be left, or an ignored event that
+ * changes the state all fail the build.
+ *
+ * pomodoro.c dispatches an event with one table load and one call through
+ * its action table; nothing in between branches on the state or the event.
+ */
+
+/** States of the table: PomodoroState_e from POMODORO_IDLE to POMODORO_PAUSED_BREAK */
+#define POMODORO_FSM_STATES     6u
+
+/**
+ * @brief Events of the table
+ */
+typedef enum {
+    POMODORO_EV_START,
+    POMODORO_EV_PAUSE,
+    POMODORO_EV_RESUME,
+    POMODORO_EV_RESET,
+    POMODORO_EV_FINISHED,           /**< The phase ran out; the dispatcher turns it into one of the two below as the plan says */
+    POMODORO_EV_FINISHED_LONG,      /**< The phase ran out and the plan goes on with a long break */
+    POMODORO_EV_FINISHED_END,       /**< The phase ran out and it was the plan's last */
+    POMODORO_EV_COUNT
+} PomodoroFsmEvent_e;
+
+/**
+ * @brief What a transition does besides changing the state
+ */
+typedef enum {
+    POMODORO_ACT_IGNORE,            /**< Nothing, the state stays */
+    POMODORO_ACT_START,             /**< Arm the first phase */
+    POMODORO_ACT_PAUSE,             /**< Keep the remaining time, stop counting */
+    POMODORO_ACT_RESUME,            /**< Count the kept time down again */
+    POMODORO_ACT_RESET,             /**< Clear the cycles, disarm */
+    POMODORO_ACT_FINISH_WORK,       /**< Record the phase, count the cycle, arm the break */
+    POMODORO_ACT_FINISH_BREAK,      /**< Record the phase, arm the work phase */
+    POMODORO_ACT_FINISH_END,        /**< Record the phase, back to the start of the plan */
+    POMODORO_ACT_COUNT
+} PomodoroFsmAction_e;
+
+/** Next state of a resumed break: the break that was paused (previous_state) */
+#define POMODORO_FSM_PAUSED_BREAK_TYPE  POMODORO_FSM_STATES
+
+/**
+ * One row per (state, event). X(arg, state, event, action, next); arg is passed
+ * through for the compile-time checks.
+ */
+#define POMODORO_FSM_TRANSITIONS(X, arg) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_START,          POMODORO_ACT_START,         POMODORO_WORK) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_PAUSE,          POMODORO_ACT_IGNORE,        POMODORO_IDLE) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_RESUME,         POMODORO_ACT_IGNORE,        POMODORO_IDLE) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_FINISHED,       POMODORO_ACT_IGNORE,        POMODORO_IDLE) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_IGNORE,        POMODORO_IDLE) \
+    X(arg, POMODORO_IDLE,           POMODORO_EV_FINISHED_END,   POMODORO_ACT_IGNORE,        POMODORO_IDLE) \
+    \
+    X(arg, POMODORO_WORK,           POMODORO_EV_START,          POMODORO_ACT_IGNORE,        POMODORO_WORK) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_PAUSE,          POMODORO_ACT_PAUSE,         POMODORO_PAUSED_WORK) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_RESUME,         POMODORO_ACT_IGNORE,        POMODORO_WORK) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_FINISHED,       POMODORO_ACT_FINISH_WORK,   POMODORO_SHORT_BREAK) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_FINISH_WORK,   POMODORO_LONG_BREAK) \
+    X(arg, POMODORO_WORK,           POMODORO_EV_FINISHED_END,   POMODORO_ACT_FINISH_END,    POMODORO_IDLE) \
+    \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_START,          POMODORO_ACT_IGNORE,        POMODORO_SHORT_BREAK) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_PAUSE,          POMODORO_ACT_PAUSE,         POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_RESUME,         POMODORO_ACT_IGNORE,        POMODORO_SHORT_BREAK) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_FINISHED,       POMODORO_ACT_FINISH_BREAK,  POMODORO_WORK) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_FINISH_BREAK,  POMODORO_WORK) \
+    X(arg, POMODORO_SHORT_BREAK,    POMODORO_EV_FINISHED_END,   POMODORO_ACT_FINISH_END,    POMODORO_IDLE) \
+    \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_START,          POMODORO_ACT_IGNORE,        POMODORO_LONG_BREAK) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_PAUSE,          POMODORO_ACT_PAUSE,         POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_RESUME,         POMODORO_ACT_IGNORE,        POMODORO_LONG_BREAK) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_FINISHED,       POMODORO_ACT_FINISH_BREAK,  POMODORO_WORK) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_FINISH_BREAK,  POMODORO_WORK) \
+    X(arg, POMODORO_LONG_BREAK,     POMODORO_EV_FINISHED_END,   POMODORO_ACT_FINISH_END,    POMODORO_IDLE) \
+    \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_START,          POMODORO_ACT_IGNORE,        POMODORO_PAUSED_WORK) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_PAUSE,          POMODORO_ACT_IGNORE,        POMODORO_PAUSED_WORK) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_RESUME,         POMODORO_ACT_RESUME,        POMODORO_WORK) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_FINISHED,       POMODORO_ACT_IGNORE,        POMODORO_PAUSED_WORK) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_IGNORE,        POMODORO_PAUSED_WORK) \
+    X(arg, POMODORO_PAUSED_WORK,    POMODORO_EV_FINISHED_END,   POMODORO_ACT_IGNORE,        POMODORO_PAUSED_WORK) \
+    \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_START,          POMODORO_ACT_IGNORE,        POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_PAUSE,          POMODORO_ACT_IGNORE,        POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_RESUME,         POMODORO_ACT_RESUME,        POMODORO_FSM_PAUSED_BREAK_TYPE) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_RESET,          POMODORO_ACT_RESET,         POMODORO_IDLE) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_FINISHED,       POMODORO_ACT_IGNORE,        POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_FINISHED_LONG,  POMODORO_ACT_IGNORE,        POMODORO_PAUSED_BREAK) \
+    X(arg, POMODORO_PAUSED_BREAK,   POMODORO_EV_FINISHED_END,   POMODORO_ACT_IGNORE,        POMODORO_PAUSED_BREAK)
+
+/**
+ * @brief One row of the table
+ */
+typedef struct {
+    uint8_t action;             /**< PomodoroFsmAction_e */
+    uint8_t next;               /**< PomodoroState_e, or POMODORO_FSM_PAUSED_BREAK_TYPE */
+} PomodoroFsmEntry_t;
+
+extern const PomodoroFsmEntry_t pomodoro_fsm_table[POMODORO_FSM_STATES][POMODORO_EV_COUNT];
+
+/**
+ * @brief Look up a transition, with the resumed break resolved from the previous state
+ * @param state Current state, below POMODORO_FSM_STATES
+ * @param event Event, below POMODORO_EV_COUNT
+ * @param previous_state State before the last transition
+ */
+static inline PomodoroFsmEntry_t pomodoro_fsm_lookup(uint8_t state, uint8_t event, uint8_t previous_state) {
+    PomodoroFsmEntry_t entry = pomodoro_fsm_table[state][event];
+    // The long break if that was paused, else the short one
+    const uint8_t next[2] = {
+        entry.next,
+        (uint8_t)(POMODORO_SHORT_BREAK + (previous_state == POMODORO_LONG_BREAK) * (POMODORO_LONG_BREAK - POMODORO_SHORT_BREAK)),
+    };
+
+    entry.next = next[entry.next == POMODORO_FSM_PAUSED_BREAK_TYPE];
+    return entry;
+}
+
+/**
+ * @brief Name of an event, for logs
+ */
+const char *pomodoro_fsm_event_name(PomodoroFsmEvent_e event);
+
+/**
+ * @brief Run an event through the table for a session
+ * @details pomodoro_start() and friends are POMODORO_EV_START .. POMODORO_EV_RESET on the
+ *          default session; POMODORO_EV_FINISHED ends the current phase early.
+ * @return false if the handle is stale or invalid, or the event out of range
+ */
+bool pomodoro_session_dispatch(pomodoro_session_t session, PomodoroFsmEvent_e event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_FSM_H
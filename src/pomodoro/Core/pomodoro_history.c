@@ -0,0 +1,678 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pomodoro_history.h"
+#include "crc32.h"
+#include "core_log.h"
+
+// ====================== Data Structures ======================
+
+#define HISTORY_BLOCK_MAGIC     0x4B4C4248u     /* "HBLK" */
+#define HISTORY_RECORD_MAGIC    0x43455248u     /* "HREC" */
+
+/** Column streams of a block, in payload order; column c is pomodoro_history_col_e bit c */
+#define HISTORY_COLUMNS         5u
+#define COL_START               0u
+#define COL_DURATION            1u
+#define COL_TYPE                2u
+#define COL_PAUSED              3u
+#define COL_INTERRUPTIONS       4u
+
+#define VARINT_MAX_BYTES        11u     /* escape byte and a 64-bit varint */
+
+/** Payload bound of a full block: the widest varint of every column, 2 bits per type */
+#define BLOCK_MAX_PAYLOAD       (POMODORO_HISTORY_BLOCK_RECORDS * (VARINT_MAX_BYTES + 5u + 5u + 3u) + \
+                                 (POMODORO_HISTORY_BLOCK_RECORDS + 3u) / 4u + 8u)
+
+/**
+ * @brief Header of a sealed block, followed by the column streams (also the file format)
+ */
+typedef struct {
+    uint32_t magic;                         /**< HISTORY_BLOCK_MAGIC */
+    uint16_t count;                         /**< Records in the block */
+    uint8_t  narrow;                        /**< Bit per column: every value took one byte */
+    uint8_t  reserved;
+    int64_t  first_start_s;                 /**< Start of the first record, base of the start deltas */
+    int64_t  last_start_s;                  /**< Start of the last record */
+    uint32_t col_bytes[HISTORY_COLUMNS];    /**< Bytes of each column stream */
+    uint32_t payload_bytes;                 /**< Column streams, padded to 8 bytes */
+    uint32_t crc;                           /**< CRC-32 of the header before it and of the payload */
+    uint32_t reserved2;
+} HistoryBlockHeader_t;
+
+/**
+ * @brief One record appended to the file before its block is sealed
+ */
+typedef struct {
+    uint32_t magic;                         /**< HISTORY_RECORD_MAGIC */
+    uint32_t duration_s;
+    int64_t  start_s;
+    uint32_t paused_s;
+    uint16_t interruptions;
+    uint8_t  type;
+    uint8_t  reserved;
+    uint32_t reserved2;
+    uint32_t crc;                           /**< CRC-32 of the bytes before it */
+} HistoryFileRecord_t;
+
+_Static_assert(sizeof(HistoryBlockHeader_t) == 56, "history block header layout");
+_Static_assert(sizeof(HistoryFileRecord_t) == 32, "history file record layout");
+_Static_assert(POMODORO_HISTORY_BLOCK_RECORDS >= 1u && POMODORO_HISTORY_BLOCK_RECORDS <= UINT16_MAX,
+               "POMODORO_HISTORY_BLOCK_RECORDS must fit the block header");
+_Static_assert(POMODORO_HISTORY_ARENA_BYTES >= sizeof(HistoryBlockHeader_t) + BLOCK_MAX_PAYLOAD,
+               "POMODORO_HISTORY_ARENA_BYTES must hold a full block");
+
+/**
+ * @brief Records as plain column arrays: the open block, and decoded blocks during a scan
+ */
+typedef struct {
+    int64_t  start_s[POMODORO_HISTORY_BLOCK_RECORDS];
+    uint32_t duration_s[POMODORO_HISTORY_BLOCK_RECORDS];
+    uint8_t  type[POMODORO_HISTORY_BLOCK_RECORDS];
+    uint32_t paused_s[POMODORO_HISTORY_BLOCK_RECORDS];
+    uint16_t interruptions[POMODORO_HISTORY_BLOCK_RECORDS];
+} HistoryColumnArrays_t;
+
+// ====================== Internal State ======================
+
+static struct {
+    HistoryColumnArrays_t   open;           /**< Records not sealed yet */
+    uint32_t                open_count;
+    uint32_t                arena_used;
+    uint32_t                blocks;
+    uint32_t                sealed_records;
+    uint32_t                dropped_blocks;
+    PomodoroHistoryRecord_t last;
+    bool                    has_last;
+    FILE                    *file;
+    char                    path[256];
+    pomodoro_history_clock_t clock;
+} hist;
+
+static uint64_t arena[POMODORO_HISTORY_ARENA_BYTES / sizeof(uint64_t)];   // Sealed blocks, 8-byte aligned
+static uint64_t staging[(sizeof(HistoryBlockHeader_t) + BLOCK_MAX_PAYLOAD + 7u) / sizeof(uint64_t)];
+static HistoryColumnArrays_t decoded;
+
+// ====================== Private Functions ======================
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v) {
+    while (v >= 0x80u) {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, uint64_t *v) {
+    uint64_t x = *p & 0x7Fu;
+    unsigned shift = 7;
+
+    while (*p++ & 0x80u) {
+        x |= (uint64_t)(*p & 0x7Fu) << shift;
+        shift += 7;
+    }
+    *v = x;
+    return p;
+}
+
+/*
+ * Column values: one byte below VALUE_ESCAPE, otherwise VALUE_ESCAPE and the varint of
+ * the rest. Almost every value of every column takes the one byte, so decoding is a
+ * byte load with a branch that is nearly never taken, and a column without escapes
+ * (flagged narrow) is a plain byte array.
+ */
+#define VALUE_ESCAPE    0xFFu
+
+static inline uint8_t *put_value(uint8_t *p, uint64_t v) {
+    if (v < VALUE_ESCAPE) {
+        *p++ = (uint8_t)v;
+        return p;
+    }
+    *p++ = VALUE_ESCAPE;
+    return put_varint(p, v - VALUE_ESCAPE);
+}
+
+static inline const uint8_t *get_value(const uint8_t *p, uint64_t *v) {
+    if (*p != VALUE_ESCAPE) {
+        *v = *p;
+        return p + 1;
+    }
+    p = get_varint(p + 1, v);
+    *v += VALUE_ESCAPE;
+    return p;
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1u);
+}
+
+static uint32_t block_crc(const HistoryBlockHeader_t *hdr) {
+    uint32_t crc = crc32_update(0, hdr, offsetof(HistoryBlockHeader_t, crc));
+    return crc32_update(crc, hdr + 1, hdr->payload_bytes);
+}
+
+static uint32_t file_record_crc(const HistoryFileRecord_t *rec) {
+    return crc32_update(0, rec, offsetof(HistoryFileRecord_t, crc));
+}
+
+static inline uint32_t block_size(const HistoryBlockHeader_t *hdr) {
+    return (uint32_t)sizeof(*hdr) + hdr->payload_bytes;
+}
+
+static inline const HistoryBlockHeader_t *arena_block(uint32_t offset) {
+    return (const HistoryBlockHeader_t *)((const uint8_t *)arena + offset);
+}
+
+/**
+ * @brief Compress count records of cols into a block in the staging buffer
+ */
+static HistoryBlockHeader_t *block_encode(const HistoryColumnArrays_t *cols, uint32_t count) {
+    HistoryBlockHeader_t *hdr = (HistoryBlockHeader_t *)staging;
+    uint8_t *base = (uint8_t *)(hdr + 1);
+    uint8_t *p = base;
+    uint8_t *col;
+    uint32_t prev_dur[4] = { 0 };
+    uint64_t wide;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = HISTORY_BLOCK_MAGIC;
+    hdr->count = (uint16_t)count;
+    hdr->first_start_s = cols->start_s[0];
+    hdr->last_start_s = cols->start_s[count - 1u];
+
+    // A phase mostly starts where the one before it ended: only the gap to that is stored
+    col = p;
+    wide = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        int64_t predicted = i ? cols->start_s[i - 1u] + cols->duration_s[i - 1u] + cols->paused_s[i - 1u]
+                              : hdr->first_start_s;
+        uint64_t d = zigzag(cols->start_s[i] - predicted);
+        wide |= d;
+        p = put_value(p, d);
+    }
+    hdr->col_bytes[COL_START] = (uint32_t)(p - col);
+    hdr->narrow |= (wide < VALUE_ESCAPE) ? (1u << COL_START) : 0u;
+
+    // Phases of a type mostly last as long as the one of that type before, most deltas are 0
+    col = p;
+    wide = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t t = cols->type[i] & 3u;
+        uint64_t d = zigzag((int64_t)cols->duration_s[i] - (int64_t)prev_dur[t]);
+        prev_dur[t] = cols->duration_s[i];
+        wide |= d;
+        p = put_value(p, d);
+    }
+    hdr->col_bytes[COL_DURATION] = (uint32_t)(p - col);
+    hdr->narrow |= (wide < VALUE_ESCAPE) ? (1u << COL_DURATION) : 0u;
+
+    col = p;
+    memset(p, 0, (count + 3u) / 4u);
+    for (uint32_t i = 0; i < count; i++) {
+        p[i / 4u] |= (uint8_t)((cols->type[i] & 3u) << ((i % 4u) * 2u));
+    }
+    p += (count + 3u) / 4u;
+    hdr->col_bytes[COL_TYPE] = (uint32_t)(p - col);
+
+    col = p;
+    wide = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        wide |= cols->paused_s[i];
+        p = put_value(p, cols->paused_s[i]);
+    }
+    hdr->col_bytes[COL_PAUSED] = (uint32_t)(p - col);
+    hdr->narrow |= (wide < VALUE_ESCAPE) ? (1u << COL_PAUSED) : 0u;
+
+    col = p;
+    wide = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        wide |= cols->interruptions[i];
+        p = put_value(p, cols->interruptions[i]);
+    }
+    hdr->col_bytes[COL_INTERRUPTIONS] = (uint32_t)(p - col);
+    hdr->narrow |= (wide < VALUE_ESCAPE) ? (1u << COL_INTERRUPTIONS) : 0u;
+
+    while ((p - base) % 8) {
+        *p++ = 0;
+    }
+    hdr->payload_bytes = (uint32_t)(p - base);
+    hdr->crc = block_crc(hdr);
+    return hdr;
+}
+
+/**
+ * @brief Decode the columns of a sealed block into out
+ * @details Starts are predicted from the durations and pauses, and durations from
+ *          the types, so those are decoded as well when needed. Narrow columns are
+ *          plain byte arrays, their loops have no branch per value.
+ */
+static void block_decode(const HistoryBlockHeader_t *hdr, uint32_t columns, HistoryColumnArrays_t *out) {
+    const uint8_t *col[HISTORY_COLUMNS];
+    const uint8_t *p = (const uint8_t *)(hdr + 1);
+    const uint32_t n = hdr->count;
+    uint64_t v;
+
+    for (uint32_t c = 0; c < HISTORY_COLUMNS; c++) {
+        col[c] = p;
+        p += hdr->col_bytes[c];
+    }
+    if (columns & POMODORO_HISTORY_COL_START) {
+        columns |= POMODORO_HISTORY_COL_DURATION | POMODORO_HISTORY_COL_PAUSED;
+    }
+    if (columns & POMODORO_HISTORY_COL_DURATION) {
+        columns |= POMODORO_HISTORY_COL_TYPE;
+    }
+
+    if (columns & POMODORO_HISTORY_COL_TYPE) {
+        p = col[COL_TYPE];
+        for (uint32_t i = 0; i < n; i++) {
+            out->type[i] = (uint8_t)((p[i / 4u] >> ((i % 4u) * 2u)) & 3u);
+        }
+    }
+
+    if (columns & POMODORO_HISTORY_COL_DURATION) {
+        uint32_t prev[4] = { 0 };
+        p = col[COL_DURATION];
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t t = out->type[i];
+            p = get_value(p, &v);
+            prev[t] += (uint32_t)unzigzag(v);
+            out->duration_s[i] = prev[t];
+        }
+    }
+
+    if (columns & POMODORO_HISTORY_COL_PAUSED) {
+        p = col[COL_PAUSED];
+        if (hdr->narrow & (1u << COL_PAUSED)) {
+            for (uint32_t i = 0; i < n; i++) {
+                out->paused_s[i] = p[i];
+            }
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                p = get_value(p, &v);
+                out->paused_s[i] = (uint32_t)v;
+            }
+        }
+    }
+
+    if (columns & POMODORO_HISTORY_COL_START) {
+        int64_t next = hdr->first_start_s;
+        p = col[COL_START];
+        for (uint32_t i = 0; i < n; i++) {
+            p = get_value(p, &v);
+            out->start_s[i] = next + unzigzag(v);
+            next = out->start_s[i] + out->duration_s[i] + out->paused_s[i];
+        }
+    }
+
+    if (columns & POMODORO_HISTORY_COL_INTERRUPTIONS) {
+        p = col[COL_INTERRUPTIONS];
+        if (hdr->narrow & (1u << COL_INTERRUPTIONS)) {
+            for (uint32_t i = 0; i < n; i++) {
+                out->interruptions[i] = p[i];
+            }
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                p = get_value(p, &v);
+                out->interruptions[i] = (uint16_t)v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy an encoded block into the arena, dropping the oldest blocks to make room
+ */
+static void arena_push(const HistoryBlockHeader_t *hdr) {
+    uint32_t size = block_size(hdr);
+
+    while (hist.arena_used + size > POMODORO_HISTORY_ARENA_BYTES) {
+        uint32_t oldest = block_size(arena_block(0));
+
+        hist.sealed_records -= arena_block(0)->count;
+        hist.arena_used -= oldest;
+        hist.blocks--;
+        hist.dropped_blocks++;
+        memmove(arena, (const uint8_t *)arena + oldest, hist.arena_used);
+    }
+    memcpy((uint8_t *)arena + hist.arena_used, hdr, size);
+    hist.arena_used += size;
+    hist.blocks++;
+    hist.sealed_records += hdr->count;
+}
+
+static void open_push(const PomodoroHistoryRecord_t *rec) {
+    uint32_t i = hist.open_count++;
+
+    hist.open.start_s[i] = rec->start_s;
+    hist.open.duration_s[i] = rec->duration_s;
+    hist.open.type[i] = rec->type;
+    hist.open.paused_s[i] = rec->paused_s;
+    hist.open.interruptions[i] = rec->interruptions;
+    hist.last = *rec;
+    hist.has_last = true;
+}
+
+static void file_write(const void *data, size_t len) {
+    if (fwrite(data, 1, len, hist.file) != len || fflush(hist.file) != 0) {
+        CORE_LOG_WARN("[History] Write to %s failed, history kept in RAM only\n", hist.path);
+        fclose(hist.file);
+        hist.file = NULL;
+    }
+}
+
+/**
+ * @brief Seal the open block into the arena (and the file)
+ */
+static void seal(void) {
+    const HistoryBlockHeader_t *hdr = block_encode(&hist.open, hist.open_count);
+
+    arena_push(hdr);
+    if (hist.file) {
+        file_write(hdr, block_size(hdr));
+    }
+    hist.open_count = 0;
+}
+
+static void reset_ram(void) {
+    hist.open_count = 0;
+    hist.arena_used = 0;
+    hist.blocks = 0;
+    hist.sealed_records = 0;
+    hist.dropped_blocks = 0;
+    hist.has_last = false;
+}
+
+/**
+ * @brief Read the file into RAM
+ * @return true if the file has to be rewritten: torn end, or records already sealed into a block
+ */
+static bool file_load(FILE *f) {
+    bool rewrite = false;
+    uint32_t magic;
+
+    while (fread(&magic, sizeof(magic), 1, f) == 1) {
+        if (magic == HISTORY_BLOCK_MAGIC) {
+            HistoryBlockHeader_t *hdr = (HistoryBlockHeader_t *)staging;
+
+            hdr->magic = magic;
+            if (fread((uint8_t *)hdr + sizeof(magic), sizeof(*hdr) - sizeof(magic), 1, f) != 1 ||
+                hdr->count == 0 || hdr->count > POMODORO_HISTORY_BLOCK_RECORDS ||
+                hdr->payload_bytes > BLOCK_MAX_PAYLOAD ||
+                fread(hdr + 1, 1, hdr->payload_bytes, f) != hdr->payload_bytes ||
+                hdr->crc != block_crc(hdr)) {
+                return true;
+            }
+            // The block replaces the records appended one by one before it
+            rewrite |= hist.open_count != 0;
+            hist.open_count = 0;
+            arena_push(hdr);
+        } else if (magic == HISTORY_RECORD_MAGIC) {
+            HistoryFileRecord_t rec;
+            PomodoroHistoryRecord_t r;
+
+            rec.magic = magic;
+            if (fread((uint8_t *)&rec + sizeof(magic), sizeof(rec) - sizeof(magic), 1, f) != 1 ||
+                rec.crc != file_record_crc(&rec)) {
+                return true;
+            }
+            if (hist.open_count == POMODORO_HISTORY_BLOCK_RECORDS) {
+                seal();
+                rewrite = true;
+            }
+            r.start_s = rec.start_s;
+            r.duration_s = rec.duration_s;
+            r.paused_s = rec.paused_s;
+            r.interruptions = rec.interruptions;
+            r.type = rec.type;
+            open_push(&r);
+        } else {
+            return true;
+        }
+    }
+    return rewrite;
+}
+
+/**
+ * @brief Write RAM to a new file: sealed blocks, then the open records
+ */
+static bool file_rewrite(const char *path) {
+    char tmp[sizeof(hist.path) + 4];
+    FILE *f;
+    bool ok;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = fopen(tmp, "wb");
+    if (!f) {
+        return false;
+    }
+    ok = fwrite(arena, 1, hist.arena_used, f) == hist.arena_used;
+    for (uint32_t i = 0; i < hist.open_count && ok; i++) {
+        HistoryFileRecord_t rec = {
+            .magic = HISTORY_RECORD_MAGIC,
+            .duration_s = hist.open.duration_s[i],
+            .start_s = hist.open.start_s[i],
+            .paused_s = hist.open.paused_s[i],
+            .interruptions = hist.open.interruptions[i],
+            .type = hist.open.type[i],
+        };
+        rec.crc = file_record_crc(&rec);
+        ok = fwrite(&rec, sizeof(rec), 1, f) == 1;
+    }
+    ok &= fclose(f) == 0;
+    // rename() does not replace an existing file everywhere
+    if (ok) {
+        remove(path);
+        ok = rename(tmp, path) == 0;
+    }
+    return ok;
+}
+
+static void update_last(void) {
+    if (hist.open_count || !hist.blocks) {
+        return;
+    }
+
+    // Last sealed block: walk the headers to it
+    uint32_t offset = 0;
+    while (offset + block_size(arena_block(offset)) < hist.arena_used) {
+        offset += block_size(arena_block(offset));
+    }
+    const HistoryBlockHeader_t *hdr = arena_block(offset);
+    uint32_t i = hdr->count - 1u;
+
+    block_decode(hdr, POMODORO_HISTORY_COL_ALL, &decoded);
+    hist.last.start_s = decoded.start_s[i];
+    hist.last.duration_s = decoded.duration_s[i];
+    hist.last.type = decoded.type[i];
+    hist.last.paused_s = decoded.paused_s[i];
+    hist.last.interruptions = decoded.interruptions[i];
+    hist.has_last = true;
+}
+
+static uint32_t lower_bound(const int64_t *v, uint32_t n, int64_t key) {
+    uint32_t lo = 0;
+
+    while (n > 0) {
+        uint32_t half = n / 2u;
+        if (v[lo + half] < key) {
+            lo += half + 1u;
+            n -= half + 1u;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Hand the records of cols with from_s <= start < to_s to the callback
+ * @param stop Set if the callback stopped the scan
+ * @return Records visited
+ */
+static uint32_t scan_run(const HistoryColumnArrays_t *cols, uint32_t count, bool trim, int64_t from_s,
+                         int64_t to_s, uint32_t columns, pomodoro_history_scan_cb_t cb, void *user_data,
+                         bool *stop) {
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    PomodoroHistoryColumns_t run;
+
+    if (trim) {
+        lo = lower_bound(cols->start_s, count, from_s);
+        hi = lower_bound(cols->start_s, count, to_s);
+    }
+    if (lo >= hi) {
+        return 0;
+    }
+
+    run.count = hi - lo;
+    run.start_s = (columns & POMODORO_HISTORY_COL_START) ? &cols->start_s[lo] : NULL;
+    run.duration_s = (columns & POMODORO_HISTORY_COL_DURATION) ? &cols->duration_s[lo] : NULL;
+    run.type = (columns & POMODORO_HISTORY_COL_TYPE) ? &cols->type[lo] : NULL;
+    run.paused_s = (columns & POMODORO_HISTORY_COL_PAUSED) ? &cols->paused_s[lo] : NULL;
+    run.interruptions = (columns & POMODORO_HISTORY_COL_INTERRUPTIONS) ? &cols->interruptions[lo] : NULL;
+
+    *stop = cb && !cb(&run, user_data);
+    return run.count;
+}
+
+// ====================== Public API ======================
+
+bool pomodoro_history_open(const char *path) {
+    FILE *f;
+    bool rewrite = false;
+
+    pomodoro_history_close();
+    reset_ram();
+    snprintf(hist.path, sizeof(hist.path), "%s", path);
+
+    f = fopen(path, "rb");
+    if (f) {
+        rewrite = file_load(f);
+        fclose(f);
+        update_last();
+        CORE_LOG_USER("[History] Loaded %u records from %s\n",
+                      (unsigned)(hist.sealed_records + hist.open_count), path);
+    }
+    if (rewrite && !file_rewrite(path)) {
+        CORE_LOG_WARN("[History] Cannot compact %s\n", path);
+    }
+
+    hist.file = fopen(path, "ab");
+    if (!hist.file) {
+        CORE_LOG_WARN("[History] Cannot open %s, history kept in RAM only\n", path);
+        return false;
+    }
+    return true;
+}
+
+void pomodoro_history_close(void) {
+    if (hist.file) {
+        fclose(hist.file);
+        hist.file = NULL;
+    }
+}
+
+void pomodoro_history_clear(void) {
+    reset_ram();
+    if (hist.file) {
+        fclose(hist.file);
+        hist.file = fopen(hist.path, "wb");
+    }
+}
+
+void pomodoro_history_append(const PomodoroHistoryRecord_t *rec) {
+    PomodoroHistoryRecord_t r = *rec;
+
+    if (hist.has_last && r.start_s < hist.last.start_s) {
+        r.start_s = hist.last.start_s;
+    }
+    open_push(&r);
+
+    if (hist.file) {
+        HistoryFileRecord_t out = {
+            .magic = HISTORY_RECORD_MAGIC,
+            .duration_s = r.duration_s,
+            .start_s = r.start_s,
+            .paused_s = r.paused_s,
+            .interruptions = r.interruptions,
+            .type = r.type,
+        };
+        out.crc = file_record_crc(&out);
+        file_write(&out, sizeof(out));
+    }
+
+    if (hist.open_count == POMODORO_HISTORY_BLOCK_RECORDS) {
+        seal();
+    }
+}
+
+uint32_t pomodoro_history_scan(int64_t from_s, int64_t to_s, uint32_t columns,
+                               pomodoro_history_scan_cb_t cb, void *user_data) {
+    uint32_t visited = 0;
+    bool stop = false;
+
+    if (from_s >= to_s) {
+        return 0;
+    }
+
+    for (uint32_t offset = 0; offset < hist.arena_used; offset += block_size(arena_block(offset))) {
+        const HistoryBlockHeader_t *hdr = arena_block(offset);
+
+        // Zone map: blocks are in start order, skip or stop without decoding
+        if (hdr->last_start_s < from_s) {
+            continue;
+        }
+        if (hdr->first_start_s >= to_s) {
+            return visited;
+        }
+
+        bool trim = hdr->first_start_s < from_s || hdr->last_start_s >= to_s;
+        block_decode(hdr, columns | (trim ? POMODORO_HISTORY_COL_START : 0u), &decoded);
+        visited += scan_run(&decoded, hdr->count, trim, from_s, to_s, columns, cb, user_data, &stop);
+        if (stop) {
+            return visited;
+        }
+    }
+
+    if (hist.open_count) {
+        bool trim = hist.open.start_s[0] < from_s || hist.open.start_s[hist.open_count - 1u] >= to_s;
+        visited += scan_run(&hist.open, hist.open_count, trim, from_s, to_s, columns, cb, user_data, &stop);
+    }
+    return visited;
+}
+
+bool pomodoro_history_last(PomodoroHistoryRecord_t *rec) {
+    if (!hist.has_last) {
+        return false;
+    }
+    *rec = hist.last;
+    return true;
+}
+
+void pomodoro_history_get_stats(PomodoroHistoryStats_t *stats) {
+    stats->records = hist.sealed_records + hist.open_count;
+    stats->blocks = hist.blocks;
+    stats->arena_bytes = hist.arena_used;
+    stats->dropped_blocks = hist.dropped_blocks;
+}
+
+uint64_t pomodoro_history_now_ms(void) {
+    struct timespec ts;
+
+    if (hist.clock) {
+        return hist.clock();
+    }
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+void pomodoro_history_set_clock(pomodoro_history_clock_t now_ms) {
+    hist.clock = now_ms;
+}
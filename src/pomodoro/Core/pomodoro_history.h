@@ -0,0 +1,166 @@
+#ifndef POMODORO_HISTORY_H
+#define POMODORO_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_history.h
+ * @brief History of the finished phases of the default session.
+ *
+ * The Core appends one record per phase that ran to its end. Records are
+ * collected in an open block of plain column arrays; a full block of
+ * POMODORO_HISTORY_BLOCK_RECORDS is sealed into a compressed columnar block:
+ * every column is a separate byte stream. Start times are stored as the
+ * difference to the end of the previous phase, durations as the difference to
+ * the previous phase of the same type, pauses and interruptions as they are;
+ * each value takes one byte, larger ones an escape byte and a varint. Types
+ * take 2 bits each. A typical record takes under 5 bytes, so a year of
+ * Pomodoros fits in well under 100 KB.
+ *
+ * Sealed blocks live in a static arena of POMODORO_HISTORY_ARENA_BYTES; when
+ * it is full, the oldest blocks are dropped. Each block header carries the
+ * first and last start time, so a range scan skips blocks outside the range
+ * without decoding them, and a scan only decodes the columns it asks for.
+ *
+ * With a file opened, every record is appended to it as it is written and
+ * every sealed block follows the records it replaces. The file is compacted
+ * when it is opened again. Not thread safe: use it from the thread that
+ * drives the Core.
+ */
+
+/** Records per block */
+#ifndef POMODORO_HISTORY_BLOCK_RECORDS
+#define POMODORO_HISTORY_BLOCK_RECORDS  1024u
+#endif
+
+/** Bytes for sealed blocks, the oldest are dropped when it is full */
+#ifndef POMODORO_HISTORY_ARENA_BYTES
+#define POMODORO_HISTORY_ARENA_BYTES    (256u * 1024u)
+#endif
+
+/**
+ * @brief Columns, to select what pomodoro_history_scan() decodes
+ */
+typedef enum {
+    POMODORO_HISTORY_COL_START          = 1u << 0,
+    POMODORO_HISTORY_COL_DURATION       = 1u << 1,
+    POMODORO_HISTORY_COL_TYPE           = 1u << 2,
+    POMODORO_HISTORY_COL_PAUSED         = 1u << 3,
+    POMODORO_HISTORY_COL_INTERRUPTIONS  = 1u << 4,
+    POMODORO_HISTORY_COL_ALL            = 0x1Fu
+} pomodoro_history_col_e;
+
+/**
+ * @brief One finished phase
+ */
+typedef struct {
+    int64_t  start_s;           /**< Wall clock when the phase started, s since the Unix epoch */
+    uint32_t duration_s;        /**< Time the phase counted down, pauses excluded */
+    uint32_t paused_s;          /**< Time spent paused */
+    uint16_t interruptions;     /**< Number of pauses */
+    uint8_t  type;              /**< POMODORO_WORK, POMODORO_SHORT_BREAK or POMODORO_LONG_BREAK */
+} PomodoroHistoryRecord_t;
+
+/**
+ * @brief A run of consecutive records, one array per column
+ * @details Columns that were not asked for are NULL. Valid during the scan callback only.
+ */
+typedef struct {
+    uint32_t        count;          /**< Records in the run */
+    const int64_t   *start_s;
+    const uint32_t  *duration_s;
+    const uint8_t   *type;
+    const uint32_t  *paused_s;
+    const uint16_t  *interruptions;
+} PomodoroHistoryColumns_t;
+
+/**
+ * @brief Type for the scan callback
+ * @return false to stop the scan
+ */
+typedef bool (*pomodoro_history_scan_cb_t)(const PomodoroHistoryColumns_t *cols, void *user_data);
+
+/**
+ * @brief Type for the wall clock, ms since the Unix epoch
+ */
+typedef uint64_t (*pomodoro_history_clock_t)(void);
+
+/**
+ * @brief Counters for tests and benchmarks
+ */
+typedef struct {
+    uint32_t records;           /**< Records held, open block included */
+    uint32_t blocks;            /**< Sealed blocks held */
+    uint32_t arena_bytes;       /**< Arena bytes used by sealed blocks, headers included */
+    uint32_t dropped_blocks;    /**< Sealed blocks dropped to make room */
+} PomodoroHistoryStats_t;
+
+/**
+ * @brief Load the history from a file and keep appending to it
+ * @details A torn write at the end of the file is dropped. Records already held in
+ *          RAM are replaced by the file's.
+ * @param path History file, created if missing
+ * @return false if the file could not be opened, the history then stays in RAM only
+ */
+bool pomodoro_history_open(const char *path);
+
+/**
+ * @brief Stop writing to the file, the history stays in RAM
+ */
+void pomodoro_history_close(void);
+
+/**
+ * @brief Drop all records (the file, if open, is truncated)
+ */
+void pomodoro_history_clear(void);
+
+/**
+ * @brief Append a finished phase
+ * @details Called by the Core at the end of every phase of the default session.
+ *          A start before the previous record's is moved up to it, so a wall clock
+ *          set back does not reorder the history.
+ */
+void pomodoro_history_append(const PomodoroHistoryRecord_t *rec);
+
+/**
+ * @brief Visit the records with from_s <= start_s < to_s, oldest first
+ * @param from_s Range start, INT64_MIN for the beginning
+ * @param to_s Range end (excluded), INT64_MAX for the end
+ * @param columns pomodoro_history_col_e bits to decode
+ * @param cb Called with runs of up to POMODORO_HISTORY_BLOCK_RECORDS records
+ * @return Number of records visited
+ */
+uint32_t pomodoro_history_scan(int64_t from_s, int64_t to_s, uint32_t columns,
+                               pomodoro_history_scan_cb_t cb, void *user_data);
+
+/**
+ * @brief Get the last record
+ * @return false if the history is empty
+ */
+bool pomodoro_history_last(PomodoroHistoryRecord_t *rec);
+
+/**
+ * @brief Get the record counters
+ */
+void pomodoro_history_get_stats(PomodoroHistoryStats_t *stats);
+
+/**
+ * @brief Wall clock the Core stamps phase starts with
+ */
+uint64_t pomodoro_history_now_ms(void);
+
+/**
+ * @brief Replace the wall clock, e.g. for simulations. NULL restores the system clock.
+ */
+void pomodoro_history_set_clock(pomodoro_history_clock_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_HISTORY_H
@@ -0,0 +1,449 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 200809L /* needed for clock_gettime(), ftruncate(), pread() */
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include "pomodoro_journal.h"
+#include "crc32.h"
+#include "timer.h"
+#include "core_log.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define JOURNAL_HAS_MMAP    1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <time.h>
+    #include <unistd.h>
+#else
+    #define JOURNAL_HAS_MMAP    0
+#endif
+
+// ====================== Data Structures ======================
+
+#define JOURNAL_MAGIC       "POMOJRNL"
+#define JOURNAL_VERSION     2u     /* 2: plan fields, a version 1 journal starts over */
+
+/** Index returned when the journal holds no valid record */
+#define JOURNAL_NONE        UINT32_MAX
+
+/**
+ * @brief File header, followed by capacity records
+ */
+typedef struct {
+    char     magic[8];          /**< JOURNAL_MAGIC */
+    uint32_t version;           /**< JOURNAL_VERSION */
+    uint32_t record_size;       /**< sizeof(PomodoroJournalRecord_t) */
+    uint32_t capacity;          /**< Records in the file */
+    uint32_t reserved[10];
+    uint32_t crc;               /**< CRC-32 of the bytes before it */
+} JournalHeader_t;
+
+_Static_assert(sizeof(JournalHeader_t) == 64, "journal header layout");
+_Static_assert(sizeof(PomodoroJournalRecord_t) == 48, "journal record layout");
+
+#if JOURNAL_HAS_MMAP
+
+// ====================== Internal State ======================
+
+static struct {
+    bool                    open;
+    bool                    restored;
+    int                     fd;
+    uint8_t                 *map;
+    size_t                  map_size;
+    PomodoroJournalRecord_t *records;
+    uint32_t                capacity;
+    uint32_t                next;           /**< Slot of the next record */
+    uint32_t                seq;            /**< Sequence number of the last record */
+    uint32_t                dirty_lo;       /**< Slots not yet durable [dirty_lo, dirty_hi) */
+    uint32_t                dirty_hi;
+    uint32_t                kicked;         /**< Write-back started up to this slot */
+    uint32_t                lap_lo;         /**< Slots [lap_lo, capacity) of the last lap not yet durable */
+    timer_handle_t          flush_timer;
+    pomodoro_journal_clock_t clock;
+} jrnl = {
+    .fd = -1,
+    .flush_timer = TIMER_INVALID_HANDLE,
+};
+
+// ====================== Private Functions ======================
+
+static uint64_t system_wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint64_t wall_now_ms(void) {
+    return jrnl.clock ? jrnl.clock() : system_wall_ms();
+}
+
+static uint32_t record_crc(const PomodoroJournalRecord_t *rec) {
+    return crc32_update(0, rec, offsetof(PomodoroJournalRecord_t, crc));
+}
+
+static uint32_t header_crc(const JournalHeader_t *hdr) {
+    return crc32_update(0, hdr, offsetof(JournalHeader_t, crc));
+}
+
+static bool record_valid(const PomodoroJournalRecord_t *rec) {
+    return rec->seq != 0 && rec->crc == record_crc(rec) &&
+           rec->state <= POMODORO_PAUSED_BREAK && rec->max_cycles != 0;
+}
+
+/**
+ * @brief Slot of the newest valid record
+ * @details Slots 0..n hold consecutive sequence numbers starting at slot 0's; past them
+ *          are older records of the previous lap (lower numbers) or zeroes, so the end
+ *          of the run is found by binary search without reading the records in between.
+ *          Only the last record can be torn by a crash, it fails its CRC and the one
+ *          before it wins. A torn slot 0 (crash while wrapping) leaves slot 1 to anchor
+ *          the search in the previous lap; anything worse falls back to a full scan.
+ * @return Slot, or JOURNAL_NONE
+ */
+static uint32_t find_latest(void) {
+    const PomodoroJournalRecord_t *r = jrnl.records;
+    uint32_t best = JOURNAL_NONE;
+
+    for (uint32_t anchor = 0; anchor < 2u && anchor < jrnl.capacity; anchor++) {
+        if (!record_valid(&r[anchor])) {
+            continue;
+        }
+
+        uint32_t base = r[anchor].seq - anchor;
+        uint32_t lo = anchor;
+        uint32_t hi = jrnl.capacity - 1u;
+
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo + 1u) / 2u;
+            if (r[mid].seq == base + mid) {
+                lo = mid;
+            } else {
+                hi = mid - 1u;
+            }
+        }
+        while (lo > anchor && !record_valid(&r[lo])) {
+            lo--;
+        }
+        return lo;
+    }
+
+    for (uint32_t i = 0; i < jrnl.capacity; i++) {
+        if (record_valid(&r[i]) && (best == JOURNAL_NONE || r[i].seq > r[best].seq)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief msync() the pages holding slots [lo, hi)
+ */
+static void journal_sync(int flags, uint32_t lo, uint32_t hi) {
+    static uintptr_t page_size;
+
+    if (!page_size) {
+        page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    }
+
+    uintptr_t start = (uintptr_t)&jrnl.records[lo] & ~(page_size - 1u);
+    uintptr_t end = (uintptr_t)&jrnl.records[hi];
+
+    if (msync((void *)start, end - start, flags) != 0) {
+        CORE_LOG_WARN("[Journal] Flush failed\n");
+    }
+}
+
+static void on_flush_timer(timer_handle_t handle, void *user_data) {
+    (void)handle;
+    (void)user_data;
+
+    jrnl.flush_timer = TIMER_INVALID_HANDLE;
+    pomodoro_journal_flush();
+}
+
+/**
+ * @brief Map the file, creating or recreating it if it is not a journal of this version
+ */
+static bool journal_map(uint32_t capacity) {
+    JournalHeader_t hdr;
+    struct stat st;
+    bool fresh = true;
+
+    if (fstat(jrnl.fd, &st) != 0) {
+        return false;
+    }
+
+    if ((size_t)st.st_size >= sizeof(hdr) && pread(jrnl.fd, &hdr, sizeof(hdr), 0) == (ssize_t)sizeof(hdr) &&
+        memcmp(hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic)) == 0 && hdr.crc == header_crc(&hdr) &&
+        hdr.version == JOURNAL_VERSION && hdr.record_size == sizeof(PomodoroJournalRecord_t) &&
+        hdr.capacity != 0 &&
+        (uint64_t)st.st_size >= sizeof(hdr) + (uint64_t)hdr.capacity * sizeof(PomodoroJournalRecord_t)) {
+        capacity = hdr.capacity;
+        fresh = false;
+    } else if (st.st_size != 0) {
+        CORE_LOG_WARN("[Journal] Not a journal of this version, starting a new one\n");
+    }
+
+    jrnl.capacity = capacity;
+    jrnl.map_size = sizeof(hdr) + (size_t)capacity * sizeof(PomodoroJournalRecord_t);
+
+    // A new file reads as zeroes: no record written yet
+    if (fresh && (ftruncate(jrnl.fd, 0) != 0 || ftruncate(jrnl.fd, (off_t)jrnl.map_size) != 0)) {
+        return false;
+    }
+
+    void *map = mmap(NULL, jrnl.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, jrnl.fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    jrnl.map = map;
+    jrnl.records = (PomodoroJournalRecord_t *)(jrnl.map + sizeof(hdr));
+
+    if (fresh) {
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic));
+        hdr.version = JOURNAL_VERSION;
+        hdr.record_size = sizeof(PomodoroJournalRecord_t);
+        hdr.capacity = capacity;
+        hdr.crc = header_crc(&hdr);
+        memcpy(jrnl.map, &hdr, sizeof(hdr));
+        msync(jrnl.map, jrnl.map_size, MS_SYNC);
+    }
+    return true;
+}
+
+// ====================== Public API ======================
+
+bool pomodoro_journal_open(const char *path, uint32_t capacity) {
+    uint32_t latest;
+
+    if (jrnl.open) {
+        pomodoro_journal_close();
+    }
+
+    jrnl.fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (jrnl.fd < 0) {
+        CORE_LOG_WARN("[Journal] Cannot open %s\n", path);
+        return false;
+    }
+    if (!journal_map(capacity ? capacity : POMODORO_JOURNAL_DEF_CAPACITY)) {
+        CORE_LOG_WARN("[Journal] Cannot map %s\n", path);
+        close(jrnl.fd);
+        jrnl.fd = -1;
+        return false;
+    }
+
+    jrnl.next = 0;
+    jrnl.seq = 0;
+    jrnl.dirty_lo = jrnl.dirty_hi = jrnl.kicked = 0;
+    jrnl.lap_lo = jrnl.capacity;
+    jrnl.restored = false;
+
+    latest = find_latest();
+    if (latest != JOURNAL_NONE) {
+        const PomodoroJournalRecord_t *rec = &jrnl.records[latest];
+        uint64_t now = wall_now_ms();
+        uint64_t down_ms = (now > rec->wall_ms) ? (now - rec->wall_ms) : 0;
+        PomodoroSnapshot_t snap = {
+            .state = (PomodoroState_e)rec->state,
+            .previous_state = (PomodoroState_e)rec->previous_state,
+            .remaining_ms = rec->remaining_ms,
+            .work_duration_ms = rec->work_duration_ms,
+            .short_break_duration_ms = rec->short_break_duration_ms,
+            .long_break_duration_ms = rec->long_break_duration_ms,
+            .transition_count = rec->transition_count,
+            .cycle_count = rec->cycle_count,
+            .max_cycles = rec->max_cycles,
+            .phase_duration_ms = rec->phase_ms,
+            .plan = rec->plan,
+            .plan_cursor = { .pc = rec->plan_pc },
+        };
+
+        memcpy(snap.plan_cursor.loop, rec->plan_loop, sizeof(snap.plan_cursor.loop));
+        jrnl.seq = rec->seq;
+        jrnl.next = latest + 1u;
+
+        // Still closed: the phases that ended while down are not journaled one by one,
+        // the checkpoint below holds where they led
+        pomodoro_restore(&snap, down_ms);
+        jrnl.restored = true;
+        CORE_LOG_USER("[Journal] Restored record %u after %llu s down\n",
+                      (unsigned)rec->seq, (unsigned long long)(down_ms / 1000u));
+    }
+
+    jrnl.open = true;
+    if (jrnl.restored) {
+        PomodoroSnapshot_t now;
+        pomodoro_get_snapshot(&now);
+        pomodoro_journal_append(&now);
+    }
+    pomodoro_journal_flush();
+    return true;
+}
+
+void pomodoro_journal_close(void) {
+    if (!jrnl.open) {
+        return;
+    }
+
+    pomodoro_journal_flush();
+    timer_handle_cancel(jrnl.flush_timer);
+    jrnl.flush_timer = TIMER_INVALID_HANDLE;
+    munmap(jrnl.map, jrnl.map_size);
+    close(jrnl.fd);
+    jrnl.map = NULL;
+    jrnl.records = NULL;
+    jrnl.fd = -1;
+    jrnl.open = false;
+}
+
+bool pomodoro_journal_is_open(void) {
+    return jrnl.open;
+}
+
+bool pomodoro_journal_restored(void) {
+    return jrnl.restored;
+}
+
+void pomodoro_journal_append(const PomodoroSnapshot_t *snap) {
+    PomodoroJournalRecord_t rec;
+
+    if (!jrnl.open) {
+        return;
+    }
+
+    // Full: wrap to the first slot, the end of the lap is made durable by the next flush.
+    // Losing it to a power cut is harmless: recovery anchors on slot 0 once that is written.
+    if (jrnl.next == jrnl.capacity) {
+        if (jrnl.dirty_lo != jrnl.dirty_hi) {
+            journal_sync(MS_ASYNC, jrnl.kicked, jrnl.dirty_hi);
+            if (jrnl.dirty_lo < jrnl.lap_lo) {
+                jrnl.lap_lo = jrnl.dirty_lo;
+            }
+        }
+        jrnl.dirty_lo = jrnl.dirty_hi = jrnl.kicked = 0;
+        jrnl.next = 0;
+    }
+
+    rec.seq = ++jrnl.seq;
+    rec.state = (uint8_t)snap->state;
+    rec.previous_state = (uint8_t)snap->previous_state;
+    rec.cycle_count = snap->cycle_count;
+    rec.max_cycles = snap->max_cycles;
+    rec.wall_ms = wall_now_ms();
+    rec.remaining_ms = snap->remaining_ms;
+    rec.work_duration_ms = snap->work_duration_ms;
+    rec.short_break_duration_ms = snap->short_break_duration_ms;
+    rec.long_break_duration_ms = snap->long_break_duration_ms;
+    rec.transition_count = snap->transition_count;
+    rec.phase_ms = snap->phase_duration_ms;
+    rec.plan = snap->plan;
+    rec.plan_pc = snap->plan_cursor.pc;
+    memcpy(rec.plan_loop, snap->plan_cursor.loop, sizeof(rec.plan_loop));
+    rec.crc = record_crc(&rec);
+    jrnl.records[jrnl.next] = rec;
+
+    if (jrnl.dirty_lo == jrnl.dirty_hi) {
+        jrnl.dirty_lo = jrnl.kicked = jrnl.next;
+    }
+    jrnl.dirty_hi = ++jrnl.next;
+
+    if (jrnl.dirty_hi - jrnl.kicked >= POMODORO_JOURNAL_FLUSH_BATCH) {
+        // Start the write-back without waiting for it, the flush timer still makes it durable
+        journal_sync(MS_ASYNC, jrnl.kicked, jrnl.dirty_hi);
+        jrnl.kicked = jrnl.dirty_hi;
+    }
+    if (!timer_handle_is_active(jrnl.flush_timer)) {
+        jrnl.flush_timer = timer_handle_create(POMODORO_JOURNAL_FLUSH_MS, NULL, on_flush_timer, NULL);
+    }
+}
+
+void pomodoro_journal_flush(void) {
+    if (!jrnl.open) {
+        return;
+    }
+    if (jrnl.lap_lo < jrnl.capacity) {
+        journal_sync(MS_SYNC, jrnl.lap_lo, jrnl.capacity);
+        jrnl.lap_lo = jrnl.capacity;
+    }
+    if (jrnl.dirty_lo != jrnl.dirty_hi) {
+        journal_sync(MS_SYNC, jrnl.dirty_lo, jrnl.dirty_hi);
+        jrnl.dirty_lo = jrnl.dirty_hi = jrnl.kicked = 0;
+    }
+}
+
+uint32_t pomodoro_journal_replay(pomodoro_journal_replay_cb_t cb, void *user_data) {
+    const PomodoroJournalRecord_t *r = jrnl.records;
+    uint32_t latest;
+    uint32_t start = 0;
+    uint32_t count = 0;
+
+    if (!jrnl.open || (latest = find_latest()) == JOURNAL_NONE) {
+        return 0;
+    }
+
+    // After a wrap the oldest records are the rest of the previous lap, right after the newest
+    if (latest + 1u < jrnl.capacity && record_valid(&r[latest + 1u])) {
+        start = latest + 1u;
+    }
+
+    for (uint32_t n = 0; n < jrnl.capacity; n++) {
+        uint32_t i = (start + n) % jrnl.capacity;
+
+        if (!record_valid(&r[i]) || (n > 0 && r[i].seq != r[(i + jrnl.capacity - 1u) % jrnl.capacity].seq + 1u)) {
+            break;
+        }
+        count++;
+        if ((cb && !cb(&r[i], user_data)) || i == latest) {
+            break;
+        }
+    }
+    return count;
+}
+
+void pomodoro_journal_set_clock(pomodoro_journal_clock_t now_ms) {
+    jrnl.clock = now_ms;
+}
+
+#else // !JOURNAL_HAS_MMAP
+
+// ====================== Public API ======================
+
+bool pomodoro_journal_open(const char *path, uint32_t capacity) {
+    (void)capacity;
+    CORE_LOG_WARN("[Journal] No mmap() on this platform, %s not opened\n", path);
+    return false;
+}
+
+void pomodoro_journal_close(void) {
+}
+
+bool pomodoro_journal_is_open(void) {
+    return false;
+}
+
+bool pomodoro_journal_restored(void) {
+    return false;
+}
+
+void pomodoro_journal_append(const PomodoroSnapshot_t *snap) {
+    (void)snap;
+}
+
+void pomodoro_journal_flush(void) {
+}
+
+uint32_t pomodoro_journal_replay(pomodoro_journal_replay_cb_t cb, void *user_data) {
+    (void)cb;
+    (void)user_data;
+    return 0;
+}
+
+void pomodoro_journal_set_clock(pomodoro_journal_clock_t now_ms) {
+    (void)now_ms;
+}
+
+#endif // JOURNAL_HAS_MMAP
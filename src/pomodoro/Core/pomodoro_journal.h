@@ -0,0 +1,137 @@
+#ifndef POMODORO_JOURNAL_H
+#define POMODORO_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pomodoro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_journal.h
+ * @brief Crash-safe journal of the default session.
+ *
+ * Every state change of the default session (and every change of its
+ * durations) appends one fixed-size, CRC-checked record to a memory-mapped
+ * file. Each record is a complete snapshot stamped with the wall clock, so
+ * recovery only needs the newest valid one: it is found by binary search
+ * over the sequence numbers, and a record torn by a crash fails its CRC and
+ * falls back to the one before it. When the file is full, appending wraps
+ * to the first record; the file never grows.
+ *
+ * Appending is a copy into the mapping. Records reach the disk in batches:
+ * a flush timer waits for them POMODORO_JOURNAL_FLUSH_MS after the first
+ * unflushed one, and every POMODORO_JOURNAL_FLUSH_BATCH records the write-back
+ * is started early without waiting. A process crash loses nothing (the pages
+ * belong to the kernel), a power loss at most that window.
+ *
+ * Needs mmap(); elsewhere pomodoro_journal_open() fails and the Core runs
+ * without a journal.
+ */
+
+/** Records in a new journal file */
+#ifndef POMODORO_JOURNAL_DEF_CAPACITY
+#define POMODORO_JOURNAL_DEF_CAPACITY   4096u
+#endif
+
+/** Longest a record stays unflushed */
+#ifndef POMODORO_JOURNAL_FLUSH_MS
+#define POMODORO_JOURNAL_FLUSH_MS       1000u
+#endif
+
+/** Unflushed records that start the write-back early */
+#ifndef POMODORO_JOURNAL_FLUSH_BATCH
+#define POMODORO_JOURNAL_FLUSH_BATCH    256u
+#endif
+
+/**
+ * @brief One journal record, as stored in the file (host byte order)
+ */
+typedef struct {
+    uint32_t seq;                       /**< 1, 2, 3... in append order, 0 if never written */
+    uint8_t  state;                     /**< PomodoroState_e */
+    uint8_t  previous_state;            /**< PomodoroState_e */
+    uint8_t  cycle_count;               /**< Work sessions completed */
+    uint8_t  max_cycles;                /**< Cycles before long break */
+    uint64_t wall_ms;                   /**< Wall clock when written, ms since the Unix epoch */
+    uint32_t remaining_ms;              /**< Time left in the state at wall_ms */
+    uint32_t work_duration_ms;          /**< Work session duration */
+    uint32_t short_break_duration_ms;   /**< Short break duration */
+    uint32_t long_break_duration_ms;    /**< Long break duration */
+    uint32_t transition_count;          /**< State changes of the default session so far */
+    uint32_t phase_ms;                  /**< Length of the current phase, as the plan set it */
+    uint8_t  plan;                      /**< Plan slot */
+    uint8_t  plan_pc;                   /**< Plan cursor: next instruction */
+    uint8_t  plan_loop[POMODORO_PLAN_MAX_DEPTH];    /**< Plan cursor: repeat counters */
+    uint32_t crc;                       /**< CRC-32 of the bytes before it */
+} PomodoroJournalRecord_t;
+
+/**
+ * @brief Type for a replayed record
+ * @return false to stop the replay
+ */
+typedef bool (*pomodoro_journal_replay_cb_t)(const PomodoroJournalRecord_t *rec, void *user_data);
+
+/**
+ * @brief Type for the wall clock, ms since the Unix epoch
+ */
+typedef uint64_t (*pomodoro_journal_clock_t)(void);
+
+/**
+ * @brief Open or create the journal and restore the default session from it
+ * @details The newest valid record is handed to pomodoro_restore() together with the
+ *          wall time since it was written, so a running phase continues as if the
+ *          process had never stopped. The result is appended as a checkpoint and
+ *          flushed before returning. Call after timer_init() and before the Core
+ *          runs; the timer must not be reinitialized afterwards.
+ * @param path Journal file
+ * @param capacity Records in a new file, 0 for POMODORO_JOURNAL_DEF_CAPACITY.
+ *                 An existing file keeps its own capacity.
+ * @return false if the file could not be opened or mapped, the Core then runs without a journal
+ */
+bool pomodoro_journal_open(const char *path, uint32_t capacity);
+
+/**
+ * @brief Flush and close the journal
+ */
+void pomodoro_journal_close(void);
+
+/**
+ * @brief Check if a journal is open
+ */
+bool pomodoro_journal_is_open(void);
+
+/**
+ * @brief Check if pomodoro_journal_open() restored a session from an existing record
+ */
+bool pomodoro_journal_restored(void);
+
+/**
+ * @brief Append a snapshot of the default session
+ * @details Called by the Core on every change; does nothing without an open journal.
+ */
+void pomodoro_journal_append(const PomodoroSnapshot_t *snap);
+
+/**
+ * @brief Write all pending records to the disk now
+ */
+void pomodoro_journal_flush(void);
+
+/**
+ * @brief Visit every valid record, oldest first, checking each CRC
+ * @return Number of records visited
+ */
+uint32_t pomodoro_journal_replay(pomodoro_journal_replay_cb_t cb, void *user_data);
+
+/**
+ * @brief Replace the wall clock, e.g. to simulate downtime. NULL restores the system clock.
+ */
+void pomodoro_journal_set_clock(pomodoro_journal_clock_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_JOURNAL_H
@@ -0,0 +1,354 @@
+#include <string.h>
+#include "pomodoro_plan.h"
+
+#if (POMODORO_PLAN_MAX_CODE & (POMODORO_PLAN_MAX_CODE - 1u)) != 0 || POMODORO_PLAN_MAX_CODE > 256u || POMODORO_PLAN_MAX_CODE < 16u
+#error "POMODORO_PLAN_MAX_CODE must be a power of two from 16 to 256"
+#endif
+
+#define CODE_MASK           (POMODORO_PLAN_MAX_CODE - 1u)
+#define MAX_DURATION_S      UINT16_MAX
+#define MAX_WORD            8u
+
+// ====================== Built-in Plans ======================
+
+#define PHASE(op, seconds)  (op), (uint8_t)((seconds) & 0xFFu), (uint8_t)((seconds) >> 8)
+#define MIN(m)              ((m) * 60u)
+
+static const char *const builtin_source[POMODORO_PLAN_BUILTIN_COUNT] = {
+    [POMODORO_PLAN_CLASSIC] = "loop { work; break }",
+    [POMODORO_PLAN_52_17] = "loop { work 52m; short 17m }",
+    [POMODORO_PLAN_ULTRADIAN] = "loop { work 90m; long 20m }",
+    [POMODORO_PLAN_WARM_UP] = "work 10m; short 5m; loop { work; break }",
+    [POMODORO_PLAN_WORKDAY] = "repeat 3 { work 50m; short 10m } work 50m; long 60m; "
+                              "repeat 3 { work 50m; short 10m } work 50m",
+};
+
+static const char *const builtin_name[POMODORO_PLAN_BUILTIN_COUNT] = {
+    [POMODORO_PLAN_CLASSIC] = "Classic",
+    [POMODORO_PLAN_52_17] = "52/17",
+    [POMODORO_PLAN_ULTRADIAN] = "Ultradian",
+    [POMODORO_PLAN_WARM_UP] = "Warm-up",
+    [POMODORO_PLAN_WORKDAY] = "Workday",
+};
+
+// What pomodoro_plan_compile() makes of builtin_source[], kept in flash (plan_bench checks they match)
+static const PomodoroPlan_t builtin_plan[POMODORO_PLAN_BUILTIN_COUNT] = {
+    [POMODORO_PLAN_CLASSIC] = { .size = 7, .code = {
+        PHASE(POMODORO_PLAN_WORK, 0), POMODORO_PLAN_ROUND, POMODORO_PLAN_JUMP, 0, POMODORO_PLAN_END,
+    } },
+    [POMODORO_PLAN_52_17] = { .size = 9, .code = {
+        PHASE(POMODORO_PLAN_WORK, MIN(52)), PHASE(POMODORO_PLAN_SHORT, MIN(17)), POMODORO_PLAN_JUMP, 0,
+        POMODORO_PLAN_END,
+    } },
+    [POMODORO_PLAN_ULTRADIAN] = { .size = 9, .code = {
+        PHASE(POMODORO_PLAN_WORK, MIN(90)), PHASE(POMODORO_PLAN_LONG, MIN(20)), POMODORO_PLAN_JUMP, 0,
+        POMODORO_PLAN_END,
+    } },
+    [POMODORO_PLAN_WARM_UP] = { .size = 13, .code = {
+        PHASE(POMODORO_PLAN_WORK, MIN(10)), PHASE(POMODORO_PLAN_SHORT, MIN(5)),
+        PHASE(POMODORO_PLAN_WORK, 0), POMODORO_PLAN_ROUND, POMODORO_PLAN_JUMP, 6, POMODORO_PLAN_END,
+    } },
+    [POMODORO_PLAN_WORKDAY] = { .size = 34, .code = {
+        POMODORO_PLAN_SET, 0, 3,
+        PHASE(POMODORO_PLAN_WORK, MIN(50)), PHASE(POMODORO_PLAN_SHORT, MIN(10)), POMODORO_PLAN_NEXT, 0, 3,
+        PHASE(POMODORO_PLAN_WORK, MIN(50)), PHASE(POMODORO_PLAN_LONG, MIN(60)),
+        POMODORO_PLAN_SET, 0, 3,
+        PHASE(POMODORO_PLAN_WORK, MIN(50)), PHASE(POMODORO_PLAN_SHORT, MIN(10)), POMODORO_PLAN_NEXT, 0, 21,
+        PHASE(POMODORO_PLAN_WORK, MIN(50)), POMODORO_PLAN_END,
+    } },
+};
+
+static PomodoroPlan_t user_plan[POMODORO_PLAN_USER_SLOTS];
+
+// ====================== Compiler ======================
+
+/** Kind of the last phase, phases alternate between the two */
+enum {
+    KIND_NONE,
+    KIND_WORK,
+    KIND_BREAK
+};
+
+typedef struct {
+    const char          *src;
+    uint32_t            pos;
+    PomodoroPlan_t      out;
+    PomodoroPlanError_t err;
+    uint8_t             last;           /**< Kind of the phase compiled last */
+    uint8_t             depth;          /**< repeat blocks open */
+    bool                looped;         /**< A loop was closed, nothing can follow */
+    bool                started;        /**< A phase was compiled */
+} PlanCompiler_t;
+
+static bool fail(PlanCompiler_t *c, const char *message) {
+    c->err.offset = c->pos;
+    c->err.message = message;
+    return false;
+}
+
+static bool is_alpha(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+static bool is_digit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+/* Blanks, separators and comments */
+static void skip_blank(PlanCompiler_t *c) {
+    for (;;) {
+        char ch = c->src[c->pos];
+
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ';' || ch == ',') {
+            c->pos++;
+        } else if (ch == '#') {
+            while (c->src[c->pos] != '\0' && c->src[c->pos] != '\n') c->pos++;
+        } else {
+            return;
+        }
+    }
+}
+
+/* Spaces within an item, before its argument */
+static void skip_space(PlanCompiler_t *c) {
+    while (c->src[c->pos] == ' ' || c->src[c->pos] == '\t') c->pos++;
+}
+
+static bool read_word(PlanCompiler_t *c, char word[MAX_WORD + 1u]) {
+    uint32_t n = 0;
+
+    while (is_alpha(c->src[c->pos])) {
+        if (n == MAX_WORD) return fail(c, "unknown word");
+        word[n++] = c->src[c->pos++];
+    }
+    word[n] = '\0';
+    return n != 0 || fail(c, "expected work, short, long, break, repeat or loop");
+}
+
+static bool read_number(PlanCompiler_t *c, uint32_t *value) {
+    uint32_t v = 0;
+
+    if (!is_digit(c->src[c->pos])) return fail(c, "expected a number");
+    while (is_digit(c->src[c->pos])) {
+        v = (v > 100000u) ? v : v * 10u + (uint32_t)(c->src[c->pos] - '0');
+        c->pos++;
+    }
+    *value = v;
+    return true;
+}
+
+static bool emit(PlanCompiler_t *c, uint8_t op, uint8_t a, uint8_t b, uint32_t len) {
+    const uint8_t bytes[3] = { op, a, b };
+
+    // One byte stays free for the END
+    if (c->out.size + len >= POMODORO_PLAN_MAX_CODE) return fail(c, "plan too long");
+    memcpy(&c->out.code[c->out.size], bytes, len);
+    c->out.size = (uint8_t)(c->out.size + len);
+    return true;
+}
+
+static bool expect(PlanCompiler_t *c, char ch, const char *message) {
+    skip_blank(c);
+    if (c->src[c->pos] != ch) return fail(c, message);
+    c->pos++;
+    return true;
+}
+
+static bool compile_phase(PlanCompiler_t *c, uint8_t op, uint8_t *first) {
+    uint8_t kind = (op == POMODORO_PLAN_WORK) ? KIND_WORK : KIND_BREAK;
+    uint32_t seconds = 0;
+
+    if (kind == c->last) {
+        return fail(c, !c->started ? "a plan starts with work" :
+                       (kind == KIND_WORK) ? "two work phases in a row" : "two breaks in a row");
+    }
+    skip_space(c);
+    if (op != POMODORO_PLAN_ROUND && is_digit(c->src[c->pos])) {
+        uint32_t scale = 60u;
+
+        read_number(c, &seconds);
+        switch (c->src[c->pos]) {
+        case 's': scale = 1u;    c->pos++; break;
+        case 'm': scale = 60u;   c->pos++; break;
+        case 'h': scale = 3600u; c->pos++; break;
+        default: break;
+        }
+        if (is_alpha(c->src[c->pos])) return fail(c, "a duration is N, Ns, Nm or Nh");
+        seconds *= scale;
+        if (seconds == 0 || seconds > MAX_DURATION_S) return fail(c, "a phase lasts from 1 s to 18 h");
+    }
+    c->last = kind;
+    c->started = true;
+    *first = kind;
+    return (op == POMODORO_PLAN_ROUND) ? emit(c, op, 0, 0, 1u)
+                                       : emit(c, op, (uint8_t)(seconds & 0xFFu), (uint8_t)(seconds >> 8), 3u);
+}
+
+static bool compile_items(PlanCompiler_t *c, char closing, uint8_t *first);
+
+/* The body of repeat and loop: phases alternate across the jump back too */
+static bool compile_body(PlanCompiler_t *c, bool repeated, uint8_t *first) {
+    if (!expect(c, '{', "expected '{'") || !compile_items(c, '}', first)) return false;
+    if (*first == KIND_NONE) return fail(c, "empty block");
+    if (repeated && *first == c->last) {
+        return fail(c, "the block must end with the other kind of phase than it starts with");
+    }
+    c->pos++;
+    return true;
+}
+
+static bool compile_repeat(PlanCompiler_t *c, uint8_t *first) {
+    uint32_t count;
+    uint8_t level = c->depth;
+    uint8_t body;
+
+    skip_space(c);
+    if (!read_number(c, &count)) return false;
+    if (count == 0 || count > UINT8_MAX) return fail(c, "repeat 1 to 255 times");
+    if (level >= POMODORO_PLAN_MAX_DEPTH) return fail(c, "repeat nested too deep");
+    if (!emit(c, POMODORO_PLAN_SET, level, (uint8_t)count, 3u)) return false;
+
+    body = c->out.size;
+    c->depth++;
+    if (!compile_body(c, count > 1u, first)) return false;
+    c->depth--;
+    return emit(c, POMODORO_PLAN_NEXT, level, body, 3u);
+}
+
+static bool compile_loop(PlanCompiler_t *c, uint8_t *first) {
+    uint8_t body = c->out.size;
+
+    if (c->depth != 0) return fail(c, "a loop inside repeat never ends");
+    if (!compile_body(c, true, first) || !emit(c, POMODORO_PLAN_JUMP, body, 0, 2u)) return false;
+    c->looped = true;
+    return true;
+}
+
+/* Items up to closing ('}' of a block, or the end of the source) */
+static bool compile_items(PlanCompiler_t *c, char closing, uint8_t *first) {
+    *first = KIND_NONE;
+
+    for (;;) {
+        char word[MAX_WORD + 1u];
+        uint8_t item_first = KIND_NONE;
+        bool ok;
+
+        skip_blank(c);
+        if (c->src[c->pos] == closing) return true;
+        if (c->src[c->pos] == '\0') return fail(c, "missing '}'");
+        if (c->src[c->pos] == '}') return fail(c, "'}' without a block");
+        if (c->looped) return fail(c, "nothing can follow a loop");
+        if (!read_word(c, word)) return false;
+
+        if (strcmp(word, "work") == 0) {
+            ok = compile_phase(c, POMODORO_PLAN_WORK, &item_first);
+        } else if (strcmp(word, "short") == 0) {
+            ok = compile_phase(c, POMODORO_PLAN_SHORT, &item_first);
+        } else if (strcmp(word, "long") == 0) {
+            ok = compile_phase(c, POMODORO_PLAN_LONG, &item_first);
+        } else if (strcmp(word, "break") == 0) {
+            ok = compile_phase(c, POMODORO_PLAN_ROUND, &item_first);
+        } else if (strcmp(word, "repeat") == 0) {
+            ok = compile_repeat(c, &item_first);
+        } else if (strcmp(word, "loop") == 0) {
+            ok = compile_loop(c, &item_first);
+        } else {
+            c->pos -= (uint32_t)strlen(word);
+            return fail(c, "unknown word");
+        }
+        if (!ok) return false;
+        if (*first == KIND_NONE) *first = item_first;
+    }
+}
+
+// ====================== Public API ======================
+
+bool pomodoro_plan_compile(const char *source, PomodoroPlan_t *plan, PomodoroPlanError_t *err) {
+    PlanCompiler_t c = { .src = source, .last = KIND_BREAK };
+    uint8_t first;
+    bool ok = compile_items(&c, '\0', &first) &&
+              (first != KIND_NONE || fail(&c, "empty plan")) &&
+              emit(&c, POMODORO_PLAN_END, 0, 0, 1u);
+
+    if (!ok) {
+        if (err) *err = c.err;
+        return false;
+    }
+    *plan = c.out;
+    return true;
+}
+
+bool pomodoro_plan_load(uint8_t id, const char *source, PomodoroPlanError_t *err) {
+    if (id < POMODORO_PLAN_BUILTIN_COUNT || id >= POMODORO_PLAN_COUNT) {
+        if (err) *err = (PomodoroPlanError_t){ 0, "not a user plan slot" };
+        return false;
+    }
+    return pomodoro_plan_compile(source, &user_plan[id - POMODORO_PLAN_BUILTIN_COUNT], err);
+}
+
+const PomodoroPlan_t *pomodoro_plan_get(uint8_t id) {
+    if (id < POMODORO_PLAN_BUILTIN_COUNT) {
+        return &builtin_plan[id];
+    }
+    return (id < POMODORO_PLAN_COUNT) ? &user_plan[id - POMODORO_PLAN_BUILTIN_COUNT]
+                                      : &builtin_plan[POMODORO_PLAN_CLASSIC];
+}
+
+bool pomodoro_plan_is_valid(uint8_t id) {
+    return id < POMODORO_PLAN_COUNT && pomodoro_plan_get(id)->size != 0;
+}
+
+const char *pomodoro_plan_name(uint8_t id) {
+    if (id < POMODORO_PLAN_BUILTIN_COUNT) return builtin_name[id];
+    return (id < POMODORO_PLAN_COUNT) ? "Custom" : "UNKNOWN";
+}
+
+const char *pomodoro_plan_source(uint8_t id) {
+    return (id < POMODORO_PLAN_BUILTIN_COUNT) ? builtin_source[id] : NULL;
+}
+
+// ====================== Interpreter ======================
+
+PomodoroPlanStep_t pomodoro_plan_step(const PomodoroPlan_t *plan, PomodoroPlanCursor_t *cursor) {
+    const uint8_t *code = plan->code;
+    uint32_t pc = cursor->pc;
+
+    for (uint32_t n = 0; n < POMODORO_PLAN_MAX_STEPS; n++) {
+        uint8_t op = code[pc & CODE_MASK];
+        uint8_t a = code[(pc + 1u) & CODE_MASK];
+        uint8_t b = code[(pc + 2u) & CODE_MASK];
+
+        switch (op) {
+        case POMODORO_PLAN_WORK:
+        case POMODORO_PLAN_SHORT:
+        case POMODORO_PLAN_LONG:
+            cursor->pc = (uint8_t)(pc + 3u);
+            return (PomodoroPlanStep_t){ op, (uint16_t)(a | (b << 8)) };
+
+        case POMODORO_PLAN_ROUND:
+            cursor->pc = (uint8_t)(pc + 1u);
+            return (PomodoroPlanStep_t){ op, 0 };
+
+        case POMODORO_PLAN_SET:
+            cursor->loop[a % POMODORO_PLAN_MAX_DEPTH] = b;
+            pc += 3u;
+            break;
+
+        case POMODORO_PLAN_NEXT:
+            pc = (--cursor->loop[a % POMODORO_PLAN_MAX_DEPTH] != 0) ? b : pc + 3u;
+            break;
+
+        case POMODORO_PLAN_JUMP:
+            pc = a;
+            break;
+
+        default:
+            // END, or code a stale cursor landed in the middle of
+            cursor->pc = (uint8_t)pc;
+            return (PomodoroPlanStep_t){ POMODORO_PLAN_END, 0 };
+        }
+    }
+    // Only corrupt code runs this long, a compiled plan reaches a phase first
+    cursor->pc = (uint8_t)pc;
+    return (PomodoroPlanStep_t){ POMODORO_PLAN_END, 0 };
+}
@@ -0,0 +1,172 @@
+#ifndef POMODORO_PLAN_H
+#define POMODORO_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_plan.h
+ * @brief Session plans: the order and length of phases, as compact bytecode.
+ *
+ * A plan is written as a short text and compiled once into at most
+ * POMODORO_PLAN_MAX_CODE bytes:
+ *
+ *     work 10m; short 5m            # warm-up
+ *     repeat 3 { work 50m; short 10m }
+ *     loop { work; break }          # then the classic loop
+ *
+ *  - work, short, long [N[s|m|h]]   one phase, N minutes by default; without
+ *                                   N the session's configured duration
+ *  - break                          the configured short break, or the long
+ *                                   one every max_cycles work phases
+ *  - repeat N { ... }               the block N times (1..255), nested twice at most
+ *  - loop { ... }                   the block forever, last in the plan
+ *
+ * Items are separated by blanks, ';' or ','; '#' starts a comment. Phases
+ * alternate between work and a break, starting with work; the compiler
+ * rejects plans that do not. A plan that runs out sends its session back
+ * to IDLE after the last phase.
+ *
+ * The interpreter needs no heap. Per session it keeps a 3-byte cursor.
+ * Between two phases it runs at most POMODORO_PLAN_MAX_STEPS instructions,
+ * however long the plan is, so each transition takes constant time.
+ * The built-in plans are const bytecode. The classic one is the loop the
+ * Core always ran: work, then a short break, and a long break every
+ * max_cycles work phases.
+ */
+
+/** Bytes of bytecode per plan, a power of two up to 256 */
+#ifndef POMODORO_PLAN_MAX_CODE
+#define POMODORO_PLAN_MAX_CODE      64u
+#endif
+
+/** Plan slots that can be loaded at run time, after the built-in ones */
+#ifndef POMODORO_PLAN_USER_SLOTS
+#define POMODORO_PLAN_USER_SLOTS    4u
+#endif
+
+/** Nesting of repeat blocks, one loop counter per level */
+#define POMODORO_PLAN_MAX_DEPTH     2u
+
+/** Instructions run between two phases at most: leave and enter every level, one jump, the phase */
+#define POMODORO_PLAN_MAX_STEPS     (4u * POMODORO_PLAN_MAX_DEPTH + 2u)
+
+/**
+ * @brief Built-in plans
+ */
+typedef enum {
+    POMODORO_PLAN_CLASSIC,      /**< loop { work; break }, the configured durations */
+    POMODORO_PLAN_52_17,        /**< loop { work 52m; short 17m } */
+    POMODORO_PLAN_ULTRADIAN,    /**< loop { work 90m; long 20m } */
+    POMODORO_PLAN_WARM_UP,      /**< A 10 minute work phase and 5 minute break, then the classic loop */
+    POMODORO_PLAN_WORKDAY,      /**< 8 work phases of 50 minutes, long break after the 4th, then IDLE */
+    POMODORO_PLAN_BUILTIN_COUNT
+} PomodoroPlanId_e;
+
+/** Plan slots: built-in, then POMODORO_PLAN_USER_SLOTS loaded ones */
+#define POMODORO_PLAN_COUNT         (POMODORO_PLAN_BUILTIN_COUNT + POMODORO_PLAN_USER_SLOTS)
+
+/**
+ * @brief Opcodes. A phase opcode is also the phase it yields.
+ */
+typedef enum {
+    POMODORO_PLAN_END,          /**< The plan is over */
+    POMODORO_PLAN_WORK,         /**< + duration_s (2 bytes, 0: configured) */
+    POMODORO_PLAN_SHORT,        /**< + duration_s */
+    POMODORO_PLAN_LONG,         /**< + duration_s */
+    POMODORO_PLAN_ROUND,        /**< Configured break, long every max_cycles work phases */
+    POMODORO_PLAN_PHASE_COUNT,  /**< Opcodes below are control flow */
+    POMODORO_PLAN_SET = POMODORO_PLAN_PHASE_COUNT, /**< + level, count: loop[level] = count */
+    POMODORO_PLAN_NEXT,         /**< + level, target: jump while --loop[level] != 0 */
+    POMODORO_PLAN_JUMP          /**< + target */
+} PomodoroPlanOp_e;
+
+/**
+ * @brief Compiled plan
+ */
+typedef struct {
+    uint8_t code[POMODORO_PLAN_MAX_CODE];   /**< Bytecode, zero-padded */
+    uint8_t size;                           /**< Bytes used, 0 for an empty slot */
+} PomodoroPlan_t;
+
+/**
+ * @brief Where a session is in its plan
+ */
+typedef struct {
+    uint8_t pc;                                 /**< Next instruction */
+    uint8_t loop[POMODORO_PLAN_MAX_DEPTH];      /**< Iterations left per repeat level */
+} PomodoroPlanCursor_t;
+
+/**
+ * @brief A phase the plan yields
+ */
+typedef struct {
+    uint8_t  phase;             /**< POMODORO_PLAN_END .. POMODORO_PLAN_ROUND */
+    uint16_t duration_s;        /**< 0: the session's configured duration */
+} PomodoroPlanStep_t;
+
+/**
+ * @brief Why a plan did not compile
+ */
+typedef struct {
+    uint32_t    offset;         /**< Byte of the source where it stopped */
+    const char *message;        /**< What was wrong there */
+} PomodoroPlanError_t;
+
+/**
+ * @brief Compile a plan
+ * @param source Plan text, NUL-terminated
+ * @param plan Compiled plan, left as it was on failure
+ * @param err Where and why it failed, may be NULL
+ * @return false on a syntax error, a plan over POMODORO_PLAN_MAX_CODE bytes, or
+ *         phases that do not alternate between work and a break
+ */
+bool pomodoro_plan_compile(const char *source, PomodoroPlan_t *plan, PomodoroPlanError_t *err);
+
+/**
+ * @brief Compile a plan into a user slot
+ * @details Sessions already on the slot carry on from their cursor in the new
+ *          code; load a slot before sessions use it.
+ * @param id POMODORO_PLAN_BUILTIN_COUNT .. POMODORO_PLAN_COUNT - 1
+ */
+bool pomodoro_plan_load(uint8_t id, const char *source, PomodoroPlanError_t *err);
+
+/**
+ * @brief Plan in a slot
+ * @param id Below POMODORO_PLAN_COUNT
+ * @return The plan, size 0 if a user slot was never loaded
+ */
+const PomodoroPlan_t *pomodoro_plan_get(uint8_t id);
+
+/**
+ * @brief Whether a slot holds a plan a session can run
+ */
+bool pomodoro_plan_is_valid(uint8_t id);
+
+/**
+ * @brief Name of a plan, for the UI and logs
+ */
+const char *pomodoro_plan_name(uint8_t id);
+
+/**
+ * @brief Source text of a built-in plan, NULL for a user slot
+ */
+const char *pomodoro_plan_source(uint8_t id);
+
+/**
+ * @brief Run a plan to its next phase and move the cursor past it
+ * @details At most POMODORO_PLAN_MAX_STEPS instructions. Bytecode is read masked
+ *          to POMODORO_PLAN_MAX_CODE, so a stale or corrupt cursor cannot read
+ *          out of bounds; it ends the plan instead of running on.
+ */
+PomodoroPlanStep_t pomodoro_plan_step(const PomodoroPlan_t *plan, PomodoroPlanCursor_t *cursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_PLAN_H
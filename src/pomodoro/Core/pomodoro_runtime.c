@@ -0,0 +1,309 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 200112L /* needed for pthread_condattr_setclock() */
+#endif
+
+#include <string.h>
+#include "pomodoro_runtime.h"
+#include "event.h"
+#include "monotonic.h"
+#include "core_log.h"
+#include "trace.h"
+
+#if POMODORO_RUNTIME_THREADS
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// pthread_condattr_setclock() is missing on macOS, wait on wall time there
+#ifdef __APPLE__
+    #define RUNTIME_WAIT_CLOCK  CLOCK_REALTIME
+#else
+    #define RUNTIME_WAIT_CLOCK  CLOCK_MONOTONIC
+#endif
+
+// ====================== Data Structures ======================
+
+/**
+ * @brief What the timing thread publishes
+ */
+typedef struct {
+    PomodoroSnapshot_t    session;  /**< Core session */
+    timer_latency_stats_t latency;  /**< Tick latency on the timing thread */
+} RuntimeFrame_t;
+
+// ====================== Internal State ======================
+
+/*
+ * Triple buffer: the timing thread fills frames[back_idx], the render thread
+ * reads frames[front_idx], and the third one is parked in `middle`. Both sides
+ * trade their buffer with the parked one by an atomic exchange, so neither
+ * ever waits and a frame is never written while it is being read.
+ * FRAME_FRESH in `middle` marks a frame the render thread has not taken yet.
+ */
+#define FRAME_FRESH     4u
+
+static RuntimeFrame_t frames[3];
+static atomic_uint middle = 2;
+static unsigned int back_idx = 0;           // Timing thread only
+static unsigned int front_idx = 1;          // Render thread only
+
+static pthread_t timing_thread;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond;
+static bool wake_pending;                   // Guarded by wake_lock
+static atomic_bool stop_requested;
+static bool running;                        // Render thread only
+static bool dirty;                          // Timing thread only
+
+static pomodoro_runtime_wakeup_cb_t wakeup_cb;
+
+// Render thread only
+static pomodoro_state_cb_t ui_state_cb;
+static pomodoro_tick_cb_t ui_tick_cb;
+static uint32_t seen_transitions;
+static uint32_t seen_ticks;
+
+// ====================== Timing Thread ======================
+
+static void on_core_state(PomodoroState_e state) {
+    (void)state;
+    dirty = true;
+}
+
+static void on_core_tick(uint32_t remaining_ms) {
+    (void)remaining_ms;
+    dirty = true;
+}
+
+// Event queue notify callback, runs on the posting thread
+static void on_event_posted(void) {
+    pthread_mutex_lock(&wake_lock);
+    wake_pending = true;
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+}
+
+static void publish(void) {
+    RuntimeFrame_t *frame = &frames[back_idx];
+
+    pomodoro_get_snapshot(&frame->session);
+    timer_get_tick_latency(&frame->latency);
+    back_idx = atomic_exchange_explicit(&middle, back_idx | FRAME_FRESH, memory_order_acq_rel) & ~FRAME_FRESH;
+    dirty = false;
+
+    if (wakeup_cb) {
+        wakeup_cb();
+    }
+}
+
+/**
+ * @brief Sleep until the next Core deadline, a posted event or a stop request
+ */
+static void wait_for_work(void) {
+    uint64_t deadline = timer_get_next_deadline_ns();
+
+    pthread_mutex_lock(&wake_lock);
+    if (!wake_pending && !atomic_load(&stop_requested)) {
+        if (deadline == TIMER_NO_DEADLINE_NS) {
+            pthread_cond_wait(&wake_cond, &wake_lock);
+        } else {
+            uint64_t now = monotonic_now_ns();
+            if (deadline > now) {
+                // Deadline is on the Core clock; the wait takes an absolute time on RUNTIME_WAIT_CLOCK
+                struct timespec ts;
+                uint64_t abs_ns;
+                clock_gettime(RUNTIME_WAIT_CLOCK, &ts);
+                abs_ns = (uint64_t)ts.tv_sec * MONOTONIC_NS_PER_SEC + (uint64_t)ts.tv_nsec + (deadline - now);
+                ts.tv_sec = (time_t)(abs_ns / MONOTONIC_NS_PER_SEC);
+                ts.tv_nsec = (long)(abs_ns % MONOTONIC_NS_PER_SEC);
+                pthread_cond_timedwait(&wake_cond, &wake_lock, &ts);
+            }
+        }
+    }
+    wake_pending = false;
+    pthread_mutex_unlock(&wake_lock);
+}
+
+/**
+ * @brief Ask the scheduler to run the timing thread ahead of the renderer
+ * @details Best effort: without the rights to do so (EPERM) it keeps the default policy.
+ */
+static void raise_priority(void) {
+#if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__APPLE__)
+    struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) };
+
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        CORE_LOG_USER("[Runtime] No real-time priority for the timing thread\n");
+    }
+#endif
+}
+
+static void *runtime_thread(void *arg) {
+    (void)arg;
+
+    raise_priority();
+    TRACE_THREAD_NAME("core");
+
+    while (!atomic_load(&stop_requested)) {
+        event_process();
+        pomodoro_tick();
+        if (dirty) {
+            publish();
+        }
+        // event_process() takes a bounded batch, come back at once for the rest
+        if (!event_is_pending()) {
+            wait_for_work();
+        }
+    }
+    return NULL;
+}
+
+// ====================== Render Thread ======================
+
+/**
+ * @brief Take the newest frame if there is one
+ */
+static bool adopt_frame(void) {
+    if (!(atomic_load_explicit(&middle, memory_order_relaxed) & FRAME_FRESH)) {
+        return false;
+    }
+    front_idx = atomic_exchange_explicit(&middle, front_idx, memory_order_acq_rel) & ~FRAME_FRESH;
+    pomodoro_set_snapshot_view(&frames[front_idx].session);
+    return true;
+}
+
+// ====================== Public API ======================
+
+bool pomodoro_runtime_start(void) {
+    pthread_condattr_t attr;
+
+    if (running) {
+        return true;
+    }
+
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, RUNTIME_WAIT_CLOCK);
+#endif
+    pthread_cond_init(&wake_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pomodoro_set_state_callback(on_core_state);
+    pomodoro_set_tick_callback(on_core_tick);
+
+    // First frame before the thread exists, so the getters never read an empty one
+    back_idx = 0;
+    front_idx = 1;
+    atomic_store(&middle, 2);
+    publish();
+    adopt_frame();
+    seen_transitions = frames[front_idx].session.transition_count;
+    seen_ticks = frames[front_idx].session.tick_count;
+
+    wake_pending = false;
+    atomic_store(&stop_requested, false);
+    event_set_notify_cb(on_event_posted);
+
+    if (pthread_create(&timing_thread, NULL, runtime_thread, NULL) != 0) {
+        CORE_LOG_WARN("[Runtime] Could not create the timing thread\n");
+        event_set_notify_cb(NULL);
+        pomodoro_set_snapshot_view(NULL);
+        pthread_cond_destroy(&wake_cond);
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void pomodoro_runtime_stop(void) {
+    if (!running) {
+        return;
+    }
+
+    atomic_store(&stop_requested, true);
+    on_event_posted();
+    pthread_join(timing_thread, NULL);
+
+    event_set_notify_cb(NULL);
+    pomodoro_set_snapshot_view(NULL);
+    pthread_cond_destroy(&wake_cond);
+    running = false;
+}
+
+bool pomodoro_runtime_is_running(void) {
+    return running;
+}
+
+void pomodoro_runtime_set_callbacks(pomodoro_state_cb_t state_cb, pomodoro_tick_cb_t tick_cb) {
+    ui_state_cb = state_cb;
+    ui_tick_cb = tick_cb;
+}
+
+void pomodoro_runtime_set_wakeup_cb(pomodoro_runtime_wakeup_cb_t cb) {
+    wakeup_cb = cb;
+}
+
+bool pomodoro_runtime_dispatch(void) {
+    const PomodoroSnapshot_t *snap;
+
+    if (!running || !adopt_frame()) {
+        return false;
+    }
+
+    snap = &frames[front_idx].session;
+    if (snap->transition_count != seen_transitions) {
+        seen_transitions = snap->transition_count;
+        if (ui_state_cb) {
+            ui_state_cb(snap->state);
+        }
+    }
+    if (snap->tick_count != seen_ticks) {
+        seen_ticks = snap->tick_count;
+        if (ui_tick_cb) {
+            ui_tick_cb(snap->remaining_ms);
+        }
+    }
+    return true;
+}
+
+void pomodoro_runtime_get_tick_latency(timer_latency_stats_t *stats) {
+    *stats = frames[front_idx].latency;
+}
+
+#else // !POMODORO_RUNTIME_THREADS
+
+// ====================== Public API ======================
+
+bool pomodoro_runtime_start(void) {
+    CORE_LOG_WARN("[Runtime] Built without thread support, the Core stays on the caller's loop\n");
+    return false;
+}
+
+void pomodoro_runtime_stop(void) {
+}
+
+bool pomodoro_runtime_is_running(void) {
+    return false;
+}
+
+void pomodoro_runtime_set_callbacks(pomodoro_state_cb_t state_cb, pomodoro_tick_cb_t tick_cb) {
+    (void)state_cb;
+    (void)tick_cb;
+}
+
+void pomodoro_runtime_set_wakeup_cb(pomodoro_runtime_wakeup_cb_t cb) {
+    (void)cb;
+}
+
+bool pomodoro_runtime_dispatch(void) {
+    return false;
+}
+
+void pomodoro_runtime_get_tick_latency(timer_latency_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // POMODORO_RUNTIME_THREADS
@@ -0,0 +1,90 @@
+#ifndef POMODORO_RUNTIME_H
+#define POMODORO_RUNTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pomodoro.h"
+#include "timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_runtime.h
+ * @brief Runs the Core on a dedicated timing thread.
+ *
+ * The timing thread owns the Core: it drains the event queue, calls
+ * pomodoro_tick() and sleeps until the next deadline or until an event is
+ * posted. After every change it publishes an immutable PomodoroSnapshot_t
+ * through a lock-free triple buffer, so a slow frame on the render thread
+ * never delays a tick and the timing thread never waits for the renderer.
+ *
+ * The render thread calls pomodoro_runtime_dispatch() once per loop pass. It
+ * adopts the newest snapshot, points the pomodoro_get_*() getters of that
+ * thread at it and replays the state / tick callbacks the UI registered with
+ * pomodoro_runtime_set_callbacks(). Commands go through event_post().
+ *
+ * Snapshots coalesce: a render thread that falls behind sees the latest
+ * state and one tick, not every intermediate one.
+ *
+ * Needs POSIX threads (POMODORO_RUNTIME_THREADS). Without them
+ * pomodoro_runtime_start() returns false and the caller keeps driving the
+ * Core from its own loop.
+ */
+
+/**
+ * @brief Called on the timing thread after a snapshot was published
+ */
+typedef void (*pomodoro_runtime_wakeup_cb_t)(void);
+
+/**
+ * @brief Start the timing thread
+ * @details From now on only the timing thread may call Core functions other than
+ *          event_post(). The calling thread becomes the render thread: its getters
+ *          read the first snapshot right away.
+ * @return false if threads are not available or the thread could not be created
+ */
+bool pomodoro_runtime_start(void);
+
+/**
+ * @brief Stop and join the timing thread
+ * @details The calling thread owns the Core again and reads the live session.
+ *          The Core callbacks still point to the runtime and must be registered again.
+ */
+void pomodoro_runtime_stop(void);
+
+/**
+ * @brief Check if the timing thread is running
+ */
+bool pomodoro_runtime_is_running(void);
+
+/**
+ * @brief Register the callbacks replayed by pomodoro_runtime_dispatch() (render thread)
+ * @param state_cb Called once per adopted snapshot with a new state transition (can be NULL)
+ * @param tick_cb Called once per adopted snapshot with new ticks, with the remaining ms (can be NULL)
+ */
+void pomodoro_runtime_set_callbacks(pomodoro_state_cb_t state_cb, pomodoro_tick_cb_t tick_cb);
+
+/**
+ * @brief Register a callback to wake up the render loop (call before pomodoro_runtime_start)
+ * @details Runs on the timing thread; it must only signal, e.g. push an SDL event.
+ */
+void pomodoro_runtime_set_wakeup_cb(pomodoro_runtime_wakeup_cb_t cb);
+
+/**
+ * @brief Adopt the newest snapshot and replay callbacks (render thread)
+ * @return true if a new snapshot was adopted
+ */
+bool pomodoro_runtime_dispatch(void);
+
+/**
+ * @brief Tick latency of the timing thread, as published with the last adopted snapshot (render thread)
+ */
+void pomodoro_runtime_get_tick_latency(timer_latency_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_RUNTIME_H
@@ -0,0 +1,84 @@
+#include "pomodoro_sim.h"
+#include "pomodoro.h"
+#include "timer.h"
+#include "monotonic.h"
+
+/**
+ * @file pomodoro_sim.c
+ * @brief Virtual-time simulation driver.
+ *
+ * Instead of sleeping until the next deadline like the main loop does, the
+ * virtual clock is moved straight to it. Deadlines come from the timer in ns,
+ * so ticks land exactly on their second boundaries and phase ends on their
+ * expiry: a simulated day behaves like a real one, only faster.
+ */
+
+// ====================== Internal State ======================
+static struct {
+    bool               active;
+    monotonic_source_e prev_src;    /**< Source to return to in pomodoro_sim_end() */
+    PomodoroSimStats_t stats;
+} sim;
+
+// ====================== Public API ======================
+
+bool pomodoro_sim_begin(void) {
+    if (sim.active) return false;
+
+    sim.prev_src = monotonic_get_source();
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+
+    // Start on a whole millisecond: the wheel has 1 ms slots, so ms-aligned
+    // phases expire exactly on time instead of up to 1 ms late
+    uint64_t frac = monotonic_now_ns() % MONOTONIC_NS_PER_MS;
+    if (frac) {
+        monotonic_virtual_advance_ns(MONOTONIC_NS_PER_MS - frac);
+    }
+
+    sim.stats.sim_ns = 0;
+    sim.stats.wakeups = 0;
+    sim.active = true;
+    return true;
+}
+
+void pomodoro_sim_end(void) {
+    if (!sim.active) return;
+
+    monotonic_select(sim.prev_src);
+    sim.active = false;
+}
+
+bool pomodoro_sim_is_active(void) {
+    return sim.active;
+}
+
+uint64_t pomodoro_sim_advance_ms(uint64_t ms) {
+    if (!sim.active) return 0;
+
+    uint64_t now = monotonic_now_ns();
+    uint64_t end = now + ms * MONOTONIC_NS_PER_MS;
+    uint64_t wakeups = 0;
+
+    for (;;) {
+        // Overdue deadlines are served without moving time
+        uint64_t deadline = timer_get_next_deadline_ns();
+        if (deadline > end) deadline = end;
+        if (deadline > now) {
+            monotonic_virtual_advance_ns(deadline - now);
+            now = deadline;
+        }
+
+        pomodoro_tick();
+        wakeups++;
+
+        if (now >= end) break;
+    }
+
+    sim.stats.sim_ns += ms * MONOTONIC_NS_PER_MS;
+    sim.stats.wakeups += wakeups;
+    return wakeups;
+}
+
+void pomodoro_sim_get_stats(PomodoroSimStats_t *stats) {
+    *stats = sim.stats;
+}
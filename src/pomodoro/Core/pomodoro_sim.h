@@ -0,0 +1,56 @@
+#ifndef POMODORO_SIM_H
+#define POMODORO_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file pomodoro_sim.h
+ * @brief Virtual-time simulation of the Pomodoro engine.
+ *
+ * Switches the monotonic clock to its virtual source and jumps it from one
+ * timer deadline to the next, calling pomodoro_tick() at each of them. Every
+ * state and tick callback fires in the same order and with the same values
+ * as in real time, without waiting for it.
+ */
+
+/**
+ * @brief Simulation counters since pomodoro_sim_begin()
+ */
+typedef struct {
+    uint64_t sim_ns;        /**< Virtual time covered */
+    uint64_t wakeups;       /**< pomodoro_tick() calls */
+} PomodoroSimStats_t;
+
+/**
+ * @brief Enter simulation mode
+ * @details Time continues from the current clock value on the virtual source,
+ *          rounded up to the next whole millisecond. Running timers keep their
+ *          remaining time.
+ * @return false if simulation mode is already active
+ */
+bool pomodoro_sim_begin(void);
+
+/**
+ * @brief Leave simulation mode and return to the clock source used before
+ */
+void pomodoro_sim_end(void);
+
+/**
+ * @brief Check if simulation mode is active
+ */
+bool pomodoro_sim_is_active(void);
+
+/**
+ * @brief Fast-forward virtual time, firing every timer callback that comes due
+ * @param ms Virtual milliseconds to advance
+ * @return Number of pomodoro_tick() calls it took, 0 if not in simulation mode
+ */
+uint64_t pomodoro_sim_advance_ms(uint64_t ms);
+
+/**
+ * @brief Get the counters since pomodoro_sim_begin()
+ */
+void pomodoro_sim_get_stats(PomodoroSimStats_t *stats);
+
+#endif // POMODORO_SIM_H
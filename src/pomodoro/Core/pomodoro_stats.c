@@ -0,0 +1,353 @@
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "pomodoro_stats.h"
+#include "pomodoro.h"
+
+// ====================== Data Structures ======================
+
+#define DAY_S                   86400
+
+_Static_assert((POMODORO_STATS_DAYS & (POMODORO_STATS_DAYS - 1u)) == 0, "POMODORO_STATS_DAYS must be a power of two");
+
+/** Days kept when the window moves forward, the rest is room ahead */
+#define KEEP_DAYS               (POMODORO_STATS_DAYS - POMODORO_STATS_DAYS / 4u)
+
+/** At most every other day starts a run */
+#define MAX_RUNS                (POMODORO_STATS_DAYS / 2u + 1u)
+
+/**
+ * @brief Consecutive days with a session
+ */
+typedef struct {
+    int32_t first;
+    int32_t last;
+} StatsRun_t;
+
+// ====================== Internal State ======================
+
+/*
+ * Fenwick trees, node i (1-based) holds the sum of the days i - lowbit(i) + 1 .. i
+ * of the window. Sums are kept modulo 2^32: a prefix over decades of focus time may
+ * wrap, the difference of two prefixes is still exact while the range sum fits.
+ */
+static struct {
+    uint32_t    sessions[POMODORO_STATS_DAYS + 1u];
+    uint32_t    focus_s[POMODORO_STATS_DAYS + 1u];
+    StatsRun_t  runs[MAX_RUNS];             /**< Sorted by day, never adjacent */
+    uint32_t    run_count;
+    uint32_t    longest;
+    int32_t     base;                       /**< Day of node 1 */
+    int32_t     utc_offset_s;
+    bool        empty;
+} stats = { .empty = true };
+
+/** Odd while the index changes, see pomodoro_stats_read_begin() */
+static atomic_uint write_seq;
+
+// ====================== Private Functions ======================
+
+static inline uint32_t lowbit(uint32_t i) {
+    return i & (0u - i);
+}
+
+static void tree_add(uint32_t i, uint32_t sessions, uint32_t focus_s) {
+    for (; i <= POMODORO_STATS_DAYS; i += lowbit(i)) {
+        stats.sessions[i] += sessions;
+        stats.focus_s[i] += focus_s;
+    }
+}
+
+static PomodoroStatsRange_t tree_prefix(uint32_t i) {
+    PomodoroStatsRange_t sum = { 0, 0 };
+
+    for (; i > 0; i -= lowbit(i)) {
+        sum.sessions += stats.sessions[i];
+        sum.focus_s += stats.focus_s[i];
+    }
+    return sum;
+}
+
+static inline uint32_t run_length(const StatsRun_t *run) {
+    return (uint32_t)(run->last - run->first) + 1u;
+}
+
+/**
+ * @brief Number of runs, read once and clamped to MAX_RUNS
+ * @details Readers of other threads run while the Core moves the window or clears it:
+ *          the count is only used as loaded here, so a torn section indexes runs[]
+ *          within bounds until pomodoro_stats_read_retry() discards the result.
+ */
+static inline uint32_t run_count_load(void) {
+    uint32_t count = *(volatile const uint32_t *)&stats.run_count;
+
+    return (count < MAX_RUNS) ? count : MAX_RUNS;
+}
+
+/**
+ * @brief Index of the first run that starts after day
+ */
+static uint32_t runs_upper_bound(int32_t day) {
+    uint32_t lo = 0, hi = run_count_load();
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2u;
+        if (stats.runs[mid].first <= day) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Mark day as having a session, joining the runs around it
+ */
+static void runs_mark(int32_t day) {
+    uint32_t next = runs_upper_bound(day);
+    StatsRun_t *prev = (next > 0) ? &stats.runs[next - 1u] : NULL;
+    bool joins_prev = prev && prev->last + 1 >= day;
+    bool joins_next = next < stats.run_count && stats.runs[next].first == day + 1;
+    StatsRun_t *run;
+
+    if (prev && prev->last >= day) {
+        return;
+    }
+    if (joins_prev && joins_next) {
+        prev->last = stats.runs[next].last;
+        memmove(&stats.runs[next], &stats.runs[next + 1u], (stats.run_count - next - 1u) * sizeof(StatsRun_t));
+        stats.run_count--;
+        run = prev;
+    } else if (joins_prev) {
+        prev->last = day;
+        run = prev;
+    } else if (joins_next) {
+        stats.runs[next].first = day;
+        run = &stats.runs[next];
+    } else {
+        memmove(&stats.runs[next + 1u], &stats.runs[next], (stats.run_count - next) * sizeof(StatsRun_t));
+        stats.runs[next].first = day;
+        stats.runs[next].last = day;
+        stats.run_count++;
+        run = &stats.runs[next];
+    }
+    if (run_length(run) > stats.longest) {
+        stats.longest = run_length(run);
+    }
+}
+
+/**
+ * @brief Move the window so that it starts at new_base, dropping the days before it
+ * @details O(days): the trees are turned back into per-day values, shifted and rebuilt.
+ */
+static void window_move(int32_t new_base) {
+    uint32_t shift = (uint32_t)(new_base - stats.base);
+    uint32_t i, j;
+
+    for (i = POMODORO_STATS_DAYS; i > 0; i--) {
+        j = i + lowbit(i);
+        if (j <= POMODORO_STATS_DAYS) {
+            stats.sessions[j] -= stats.sessions[i];
+            stats.focus_s[j] -= stats.focus_s[i];
+        }
+    }
+    if (shift < POMODORO_STATS_DAYS) {
+        memmove(&stats.sessions[1], &stats.sessions[1u + shift], (POMODORO_STATS_DAYS - shift) * sizeof(uint32_t));
+        memmove(&stats.focus_s[1], &stats.focus_s[1u + shift], (POMODORO_STATS_DAYS - shift) * sizeof(uint32_t));
+    } else {
+        shift = POMODORO_STATS_DAYS;
+    }
+    memset(&stats.sessions[1u + POMODORO_STATS_DAYS - shift], 0, shift * sizeof(uint32_t));
+    memset(&stats.focus_s[1u + POMODORO_STATS_DAYS - shift], 0, shift * sizeof(uint32_t));
+    for (i = 1; i <= POMODORO_STATS_DAYS; i++) {
+        j = i + lowbit(i);
+        if (j <= POMODORO_STATS_DAYS) {
+            stats.sessions[j] += stats.sessions[i];
+            stats.focus_s[j] += stats.focus_s[i];
+        }
+    }
+    stats.base = new_base;
+
+    // Runs: drop the ones before the window, cut the one it starts in
+    uint32_t first = runs_upper_bound(new_base - 1);
+    if (first > 0 && stats.runs[first - 1u].last >= new_base) {
+        first--;
+        stats.runs[first].first = new_base;
+    }
+    memmove(&stats.runs[0], &stats.runs[first], (stats.run_count - first) * sizeof(StatsRun_t));
+    stats.run_count -= first;
+    stats.longest = 0;
+    for (i = 0; i < stats.run_count; i++) {
+        if (run_length(&stats.runs[i]) > stats.longest) {
+            stats.longest = run_length(&stats.runs[i]);
+        }
+    }
+}
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static void write_begin(void) {
+    atomic_fetch_add_explicit(&write_seq, 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void write_end(void) {
+    atomic_fetch_add_explicit(&write_seq, 1u, memory_order_release);
+}
+
+static void clear_all(void) {
+    memset(stats.sessions, 0, sizeof(stats.sessions));
+    memset(stats.focus_s, 0, sizeof(stats.focus_s));
+    stats.run_count = 0;
+    stats.longest = 0;
+    stats.base = 0;
+    stats.empty = true;
+}
+
+static void add_record(const PomodoroHistoryRecord_t *rec) {
+    int32_t day;
+
+    if (rec->type != POMODORO_WORK) {
+        return;
+    }
+    day = pomodoro_stats_day_of(rec->start_s);
+    if (stats.empty) {
+        stats.base = day;
+        stats.empty = false;
+    }
+    if (day < stats.base) {
+        day = stats.base;
+    } else if (day - stats.base >= (int32_t)POMODORO_STATS_DAYS) {
+        window_move(day - (int32_t)KEEP_DAYS + 1);
+    }
+    tree_add((uint32_t)(day - stats.base) + 1u, 1u, rec->duration_s);
+    runs_mark(day);
+}
+
+static bool rebuild_cb(const PomodoroHistoryColumns_t *cols, void *user_data) {
+    (void)user_data;
+
+    for (uint32_t i = 0; i < cols->count; i++) {
+        PomodoroHistoryRecord_t rec = {
+            .start_s = cols->start_s[i],
+            .duration_s = cols->duration_s[i],
+            .type = cols->type[i],
+        };
+        add_record(&rec);
+    }
+    return true;
+}
+
+// ====================== Public API ======================
+
+void pomodoro_stats_set_utc_offset(int32_t offset_s) {
+    stats.utc_offset_s = offset_s;
+}
+
+int32_t pomodoro_stats_day_of(int64_t time_s) {
+    return (int32_t)floor_div(time_s + stats.utc_offset_s, DAY_S);
+}
+
+int64_t pomodoro_stats_day_start(int32_t day) {
+    return (int64_t)day * DAY_S - stats.utc_offset_s;
+}
+
+int32_t pomodoro_stats_today(void) {
+    return pomodoro_stats_day_of((int64_t)(pomodoro_history_now_ms() / 1000u));
+}
+
+void pomodoro_stats_clear(void) {
+    write_begin();
+    clear_all();
+    write_end();
+}
+
+void pomodoro_stats_rebuild(void) {
+    write_begin();
+    clear_all();
+    pomodoro_history_scan(INT64_MIN, INT64_MAX,
+                          POMODORO_HISTORY_COL_START | POMODORO_HISTORY_COL_DURATION | POMODORO_HISTORY_COL_TYPE,
+                          rebuild_cb, NULL);
+    write_end();
+}
+
+void pomodoro_stats_add(const PomodoroHistoryRecord_t *rec) {
+    if (rec->type != POMODORO_WORK) {
+        return;
+    }
+    write_begin();
+    add_record(rec);
+    write_end();
+}
+
+uint32_t pomodoro_stats_read_begin(void) {
+    uint32_t seq;
+
+    while ((seq = atomic_load_explicit(&write_seq, memory_order_acquire)) & 1u) {
+        // A writer is in the middle of an update, the Core finishes it in microseconds
+    }
+    return seq;
+}
+
+bool pomodoro_stats_read_retry(uint32_t seq) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&write_seq, memory_order_relaxed) != seq;
+}
+
+uint32_t pomodoro_stats_change_count(void) {
+    return atomic_load_explicit(&write_seq, memory_order_acquire);
+}
+
+bool pomodoro_stats_span(int32_t *first_day, int32_t *last_day) {
+    uint32_t count = run_count_load();
+
+    if (count == 0) {
+        return false;
+    }
+    *first_day = stats.runs[0].first;
+    *last_day = stats.runs[count - 1u].last;
+    return true;
+}
+
+PomodoroStatsRange_t pomodoro_stats_range(int32_t first_day, int32_t last_day) {
+    PomodoroStatsRange_t hi, lo;
+    int64_t first = (int64_t)first_day - stats.base;
+    int64_t last = (int64_t)last_day - stats.base;
+
+    if (stats.empty) {
+        first = 0;
+        last = -1;
+    }
+    if (first < 0) first = 0;
+    if (last >= (int64_t)POMODORO_STATS_DAYS) last = POMODORO_STATS_DAYS - 1;
+    if (first > last) {
+        return (PomodoroStatsRange_t){ 0, 0 };
+    }
+    hi = tree_prefix((uint32_t)last + 1u);
+    lo = tree_prefix((uint32_t)first);
+    return (PomodoroStatsRange_t){ hi.sessions - lo.sessions, hi.focus_s - lo.focus_s };
+}
+
+uint32_t pomodoro_stats_streak_at(int32_t day) {
+    uint32_t next = runs_upper_bound(day);
+
+    if (next == 0 || stats.runs[next - 1u].last < day) {
+        return 0;
+    }
+    return (uint32_t)(day - stats.runs[next - 1u].first) + 1u;
+}
+
+uint32_t pomodoro_stats_current_streak(void) {
+    int32_t today = pomodoro_stats_today();
+    uint32_t streak = pomodoro_stats_streak_at(today);
+
+    return streak ? streak : pomodoro_stats_streak_at(today - 1);
+}
+
+uint32_t pomodoro_stats_longest_streak(void) {
+    return stats.longest;
+}
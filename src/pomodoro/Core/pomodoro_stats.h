@@ -0,0 +1,134 @@
+#ifndef POMODORO_STATS_H
+#define POMODORO_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pomodoro_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_stats.h
+ * @brief Per-day aggregates of the history: sessions, focus time and streaks.
+ *
+ * Every finished WORK phase counts as one session on the local day it
+ * started, with its duration as focus time. Both live in Fenwick trees over a
+ * window of POMODORO_STATS_DAYS days, so adding a session and summing any
+ * range of days both take O(log days), however many records the history holds.
+ * Days with at least one session are kept as a sorted list of runs of
+ * consecutive days, which answers streaks with a binary search.
+ *
+ * The Core adds each session at the same point it appends it to the history;
+ * pomodoro_stats_rebuild() fills the index from the history at startup. When
+ * a session lands past the window, the window moves forward and its oldest
+ * quarter is dropped.
+ *
+ * Only the thread that drives the Core changes the index. Another thread
+ * (the UI, with the Core on the timing thread) reads it between
+ * pomodoro_stats_read_begin() and pomodoro_stats_read_retry(), and reads
+ * again when the latter returns true.
+ */
+
+/** Days the index covers, a power of two */
+#ifndef POMODORO_STATS_DAYS
+#define POMODORO_STATS_DAYS     4096u
+#endif
+
+/**
+ * @brief Sums over a range of days
+ */
+typedef struct {
+    uint32_t sessions;          /**< Finished WORK phases */
+    uint32_t focus_s;           /**< Time they counted down, pauses excluded */
+} PomodoroStatsRange_t;
+
+/**
+ * @brief Set the offset of local time to UTC, days start at local midnight
+ * @details Changes the day of the records already indexed only after a rebuild.
+ */
+void pomodoro_stats_set_utc_offset(int32_t offset_s);
+
+/**
+ * @brief Local day of a wall clock time, in days since 1970-01-01
+ */
+int32_t pomodoro_stats_day_of(int64_t time_s);
+
+/**
+ * @brief Wall clock time of the local midnight that starts day
+ */
+int64_t pomodoro_stats_day_start(int32_t day);
+
+/**
+ * @brief Local day of pomodoro_history_now_ms()
+ */
+int32_t pomodoro_stats_today(void);
+
+/**
+ * @brief Drop all days
+ */
+void pomodoro_stats_clear(void);
+
+/**
+ * @brief Clear, then add every record of the history
+ */
+void pomodoro_stats_rebuild(void);
+
+/**
+ * @brief Add a finished phase, records of other types than POMODORO_WORK are ignored
+ * @details A day before the window is counted on its first day.
+ */
+void pomodoro_stats_add(const PomodoroHistoryRecord_t *rec);
+
+/**
+ * @brief Start reading from another thread than the Core's
+ * @return Sequence to hand to pomodoro_stats_read_retry()
+ */
+uint32_t pomodoro_stats_read_begin(void);
+
+/**
+ * @brief End reading from another thread than the Core's
+ * @return true if the index changed meanwhile, what was read must be read again
+ */
+bool pomodoro_stats_read_retry(uint32_t seq);
+
+/**
+ * @brief Changes of the index so far
+ * @return A count that differs after every add, clear or rebuild, for readers to
+ *         skip queries when nothing changed since they last read
+ */
+uint32_t pomodoro_stats_change_count(void);
+
+/**
+ * @brief First and last day with a session
+ * @return false if there is none
+ */
+bool pomodoro_stats_span(int32_t *first_day, int32_t *last_day);
+
+/**
+ * @brief Sum the days first_day..last_day, both included
+ */
+PomodoroStatsRange_t pomodoro_stats_range(int32_t first_day, int32_t last_day);
+
+/**
+ * @brief Consecutive days with a session, ending with day
+ * @return 0 if day has no session
+ */
+uint32_t pomodoro_stats_streak_at(int32_t day);
+
+/**
+ * @brief Streak that ends today, or yesterday while today has no session yet
+ */
+uint32_t pomodoro_stats_current_streak(void);
+
+/**
+ * @brief Longest streak in the window
+ */
+uint32_t pomodoro_stats_longest_streak(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_STATS_H
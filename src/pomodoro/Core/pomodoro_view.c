@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <string.h>
+#include "pomodoro_view.h"
+
+// ====================== Private Functions ======================
+
+/* Percent of the phase done, 64-bit so day-long phases do not overflow */
+static uint32_t phase_percent(const PomodoroSnapshot_t *snap) {
+    uint32_t done;
+
+    if (snap->phase_duration_ms == 0 || snap->remaining_ms > snap->phase_duration_ms) {
+        return 0;
+    }
+    done = snap->phase_duration_ms - snap->remaining_ms;
+    return (uint32_t)((uint64_t)done * 100u / snap->phase_duration_ms);
+}
+
+static uint8_t band_of(PomodoroState_e state, uint32_t percent) {
+    if (state != POMODORO_WORK && state != POMODORO_PAUSED_WORK) {
+        return POMODORO_BAND_CALM;
+    }
+    if (percent >= 80u) return POMODORO_BAND_SPEED;
+    if (percent > 50u) return POMODORO_BAND_RACE;
+    return POMODORO_BAND_CALM;
+}
+
+static uint8_t icons_of(const PomodoroSnapshot_t *snap, uint32_t percent) {
+    switch (snap->state) {
+        case POMODORO_WORK:
+        case POMODORO_PAUSED_WORK:
+            // The race and the speed icon join the runner as the phase goes on
+            return (uint8_t)(POMODORO_ICON_RUN | ((percent > 50u) ? POMODORO_ICON_RACE : 0u) |
+                             ((percent >= 80u) ? POMODORO_ICON_SPEED : 0u));
+        case POMODORO_SHORT_BREAK:
+            return POMODORO_ICON_SHORT_BREAK;
+        case POMODORO_LONG_BREAK:
+            return POMODORO_ICON_LONG_BREAK;
+        case POMODORO_PAUSED_BREAK:
+            return (snap->previous_state == POMODORO_LONG_BREAK) ? POMODORO_ICON_LONG_BREAK
+                                                                 : POMODORO_ICON_SHORT_BREAK;
+        default:
+            return POMODORO_ICON_READY;
+    }
+}
+
+static uint8_t controls_of(PomodoroState_e state) {
+    switch (state) {
+        case POMODORO_WORK:
+        case POMODORO_SHORT_BREAK:
+        case POMODORO_LONG_BREAK:
+            return POMODORO_CONTROLS_RUNNING;
+        case POMODORO_PAUSED_WORK:
+        case POMODORO_PAUSED_BREAK:
+            return POMODORO_CONTROLS_PAUSED;
+        default:
+            return POMODORO_CONTROLS_IDLE;
+    }
+}
+
+// ====================== Public API ======================
+
+void pomodoro_view_build(PomodoroViewModel_t *view, const PomodoroSnapshot_t *snap) {
+    uint32_t percent = phase_percent(snap);
+    uint32_t remaining_s = (uint32_t)(((uint64_t)snap->remaining_ms + 999u) / 1000u);
+
+    view->state = (uint8_t)snap->state;
+    view->band = band_of(snap->state, percent);
+    view->icons = icons_of(snap, percent);
+    view->controls = controls_of(snap->state);
+    view->arc_range_s = (uint32_t)(((uint64_t)snap->phase_duration_ms + 999u) / 1000u);
+    view->arc_value_s = remaining_s;
+    snprintf(view->time_text, sizeof(view->time_text), "%02u:%02u",
+             (unsigned)(remaining_s / 60u), (unsigned)(remaining_s % 60u));
+    snprintf(view->cycle_text, sizeof(view->cycle_text), "Cycle: %u / %u",
+             (unsigned)snap->cycle_count, (unsigned)snap->max_cycles);
+}
+
+void pomodoro_view_get(PomodoroViewModel_t *view) {
+    PomodoroSnapshot_t snap;
+
+    pomodoro_read_snapshot(&snap);
+    pomodoro_view_build(view, &snap);
+}
+
+uint32_t pomodoro_view_diff(const PomodoroViewModel_t *a, const PomodoroViewModel_t *b) {
+    uint32_t changed = 0;
+
+    if (a->state != b->state) changed |= POMODORO_VIEW_STATE;
+    if (strcmp(a->time_text, b->time_text) != 0) changed |= POMODORO_VIEW_TIME;
+    if (a->arc_range_s != b->arc_range_s) changed |= POMODORO_VIEW_ARC_RANGE;
+    if (a->arc_value_s != b->arc_value_s) changed |= POMODORO_VIEW_ARC_VALUE;
+    if (a->band != b->band) changed |= POMODORO_VIEW_BAND;
+    if (a->icons != b->icons) changed |= POMODORO_VIEW_ICONS;
+    if (a->controls != b->controls) changed |= POMODORO_VIEW_CONTROLS;
+    if (strcmp(a->cycle_text, b->cycle_text) != 0) changed |= POMODORO_VIEW_CYCLE;
+    return changed;
+}
@@ -0,0 +1,103 @@
+#ifndef POMODORO_VIEW_H
+#define POMODORO_VIEW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pomodoro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file pomodoro_view.h
+ * @brief What the main screen shows of the session, and what changed.
+ *
+ * A PomodoroViewModel_t holds every value the main screen displays: state,
+ * "MM:SS", arc range and value, colour band, icons, buttons and cycle text.
+ * It is built from one read of the session, on any thread (the snapshot view
+ * of pomodoro_runtime included). pomodoro_view_diff() compares two of them
+ * field by field, so the UI can write only the widget properties that
+ * differ from what it applied last: a WORK tick changes the time and the
+ * arc value, the colour only at 50 and 80%.
+ */
+
+/**
+ * @brief Colour of the timer text and the arc indicator
+ */
+typedef enum {
+    POMODORO_BAND_CALM,     /**< Up to 50% of WORK, breaks and IDLE */
+    POMODORO_BAND_RACE,     /**< Past 50% of WORK */
+    POMODORO_BAND_SPEED,    /**< From 80% of WORK */
+} PomodoroBand_e;
+
+/**
+ * @brief Button row: labels and which buttons are shown
+ */
+typedef enum {
+    POMODORO_CONTROLS_IDLE,     /**< Start and Settings */
+    POMODORO_CONTROLS_RUNNING,  /**< Pause and Stop, the quote scrolls */
+    POMODORO_CONTROLS_PAUSED,   /**< Resume and Stop, "Paused" shown */
+} PomodoroControls_e;
+
+/** Mode icons shown, several at once late in WORK */
+#define POMODORO_ICON_READY         (1u << 0)
+#define POMODORO_ICON_RUN           (1u << 1)
+#define POMODORO_ICON_RACE          (1u << 2)
+#define POMODORO_ICON_SPEED         (1u << 3)
+#define POMODORO_ICON_SHORT_BREAK   (1u << 4)
+#define POMODORO_ICON_LONG_BREAK    (1u << 5)
+#define POMODORO_ICON_COUNT         6u
+
+/** Fields of PomodoroViewModel_t, as returned by pomodoro_view_diff() */
+#define POMODORO_VIEW_STATE         (1u << 0)
+#define POMODORO_VIEW_TIME          (1u << 1)
+#define POMODORO_VIEW_ARC_RANGE     (1u << 2)
+#define POMODORO_VIEW_ARC_VALUE     (1u << 3)
+#define POMODORO_VIEW_BAND          (1u << 4)
+#define POMODORO_VIEW_ICONS         (1u << 5)
+#define POMODORO_VIEW_CONTROLS      (1u << 6)
+#define POMODORO_VIEW_CYCLE         (1u << 7)
+#define POMODORO_VIEW_ALL           0xFFu
+
+/** "MMMMM:SS": minutes are not wrapped, a uint32_t of ms is at most 71582:48 */
+#define POMODORO_VIEW_TIME_LEN      9u
+#define POMODORO_VIEW_CYCLE_LEN     20u
+
+/**
+ * @brief Everything the main screen shows of the default session
+ */
+typedef struct {
+    uint8_t  state;                             /**< PomodoroState_e */
+    uint8_t  band;                              /**< PomodoroBand_e */
+    uint8_t  icons;                             /**< POMODORO_ICON_* */
+    uint8_t  controls;                          /**< PomodoroControls_e */
+    uint32_t arc_range_s;                       /**< Length of the phase in seconds */
+    uint32_t arc_value_s;                       /**< Remaining seconds, counted up */
+    char     time_text[POMODORO_VIEW_TIME_LEN]; /**< Remaining time, "MM:SS", more minute digits as needed */
+    char     cycle_text[POMODORO_VIEW_CYCLE_LEN];   /**< "Cycle: 1 / 4" */
+} PomodoroViewModel_t;
+
+/**
+ * @brief Build the view of a session copy
+ * @param view Destination
+ * @param snap Session, e.g. from pomodoro_read_snapshot()
+ */
+void pomodoro_view_build(PomodoroViewModel_t *view, const PomodoroSnapshot_t *snap);
+
+/**
+ * @brief pomodoro_view_build() of the default session, as the calling thread sees it
+ */
+void pomodoro_view_get(PomodoroViewModel_t *view);
+
+/**
+ * @brief Fields that differ between two views
+ * @return POMODORO_VIEW_* bits, 0 if the views show the same
+ */
+uint32_t pomodoro_view_diff(const PomodoroViewModel_t *a, const PomodoroViewModel_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POMODORO_VIEW_H
@@ -0,0 +1,498 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 200809L /* needed for ftruncate() */
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include "settings_store.h"
+#include "crc32.h"
+#include "core_log.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define SETTINGS_HAS_MMAP   1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define SETTINGS_HAS_MMAP   0
+#endif
+
+// ====================== Data Structures ======================
+
+#define SETTINGS_MAGIC          "PSET"
+#define SETTINGS_VERSION        1u
+
+/** Erased flash reads as all ones */
+#define FLASH_ERASED_BYTE       0xFFu
+#define SEQ_BLANK               UINT32_MAX
+
+/** Returned when a bank holds no valid record */
+#define SLOT_NONE               UINT32_MAX
+
+#define FILE_SIZE               ((size_t)SETTINGS_STORE_BANKS * SETTINGS_STORE_SECTOR_SIZE)
+
+/**
+ * @brief First SETTINGS_STORE_RECORD_SIZE bytes of a sector, programmed right after its erase
+ */
+typedef struct {
+    char     magic[4];          /**< SETTINGS_MAGIC */
+    uint16_t version;           /**< SETTINGS_VERSION */
+    uint16_t record_size;       /**< SETTINGS_STORE_RECORD_SIZE */
+    uint32_t erase_count;       /**< Erases of this sector, the one before this header included */
+    uint32_t reserved[12];
+    uint32_t crc;               /**< CRC-32 of the bytes before it */
+} SectorHeader_t;
+
+/**
+ * @brief One record: every key, as stored in the flash (host byte order)
+ */
+typedef struct {
+    uint32_t seq;                               /**< 1, 2, 3... across both banks, SEQ_BLANK in an erased slot */
+    uint32_t present;                           /**< Bit per key that has a value */
+    int32_t  values[SETTINGS_STORE_MAX_KEYS];   /**< Indexed by settings_key_e */
+    uint32_t reserved;
+    uint32_t crc;                               /**< CRC-32 of the bytes before it */
+} SettingsRecord_t;
+
+_Static_assert(sizeof(SectorHeader_t) == SETTINGS_STORE_RECORD_SIZE, "sector header layout");
+_Static_assert(sizeof(SettingsRecord_t) == SETTINGS_STORE_RECORD_SIZE, "settings record layout");
+_Static_assert(SETTINGS_KEY_COUNT <= SETTINGS_STORE_MAX_KEYS, "too many settings keys for a record");
+_Static_assert(SETTINGS_STORE_SLOTS >= 2u && SETTINGS_STORE_SLOTS <= UINT8_MAX, "sector size");
+
+// ====================== Internal State ======================
+
+static struct {
+    bool        open;
+    int         fd;
+    uint8_t     *map;                           /**< FILE_SIZE bytes, bank b at b * SETTINGS_STORE_SECTOR_SIZE */
+    uint32_t    present;                        /**< Current values */
+    int32_t     values[SETTINGS_STORE_MAX_KEYS];
+    uint32_t    saved_present;                  /**< Values of the newest record */
+    int32_t     saved_values[SETTINGS_STORE_MAX_KEYS];
+    uint32_t    seq;
+    uint8_t     bank;
+    uint32_t    next_slot;
+    uint32_t    erase_count[SETTINGS_STORE_BANKS];
+    uint32_t    records_written;
+    uint32_t    commits_skipped;
+} store = {
+    .fd = -1,
+};
+
+// ====================== Private Functions ======================
+
+static uint32_t header_crc(const SectorHeader_t *hdr) {
+    return crc32_update(0, hdr, offsetof(SectorHeader_t, crc));
+}
+
+static uint32_t record_crc(const SettingsRecord_t *rec) {
+    return crc32_update(0, rec, offsetof(SettingsRecord_t, crc));
+}
+
+static const SectorHeader_t *bank_header(uint8_t bank) {
+    return (const SectorHeader_t *)(store.map + (size_t)bank * SETTINGS_STORE_SECTOR_SIZE);
+}
+
+static const SettingsRecord_t *bank_slots(uint8_t bank) {
+    return (const SettingsRecord_t *)(store.map + (size_t)bank * SETTINGS_STORE_SECTOR_SIZE) + 1;
+}
+
+static bool header_valid(const SectorHeader_t *hdr) {
+    return memcmp(hdr->magic, SETTINGS_MAGIC, sizeof(hdr->magic)) == 0 && hdr->crc == header_crc(hdr) &&
+           hdr->version == SETTINGS_VERSION && hdr->record_size == SETTINGS_STORE_RECORD_SIZE;
+}
+
+static bool record_valid(const SettingsRecord_t *rec) {
+    return rec->seq != 0 && rec->seq != SEQ_BLANK && rec->crc == record_crc(rec) &&
+           (rec->present >> SETTINGS_STORE_MAX_KEYS) == 0;
+}
+
+static bool slot_blank(const SettingsRecord_t *rec) {
+    const uint8_t *p = (const uint8_t *)rec;
+
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (p[i] != FLASH_ERASED_BYTE) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Newest valid record of a bank
+ * @details Slots are programmed in order and a slot that cannot be used is burnt by
+ *          clearing its sequence number, so the used slots are a prefix of the bank and
+ *          its end is found by binary search. Only the last record can be torn by a
+ *          power cut; it fails its CRC and the one before it wins.
+ * @param next_slot Set to the first slot past the used ones
+ * @return Slot, or SLOT_NONE
+ */
+static uint32_t bank_latest(uint8_t bank, uint32_t *next_slot) {
+    const SettingsRecord_t *slots = bank_slots(bank);
+    uint32_t lo = 0;
+    uint32_t hi = SETTINGS_STORE_SLOTS;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2u;
+        if (slots[mid].seq != SEQ_BLANK) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    *next_slot = lo;
+
+    while (lo > 0 && !record_valid(&slots[lo - 1u])) {
+        lo--;
+    }
+    return lo ? lo - 1u : SLOT_NONE;
+}
+
+#if SETTINGS_HAS_MMAP
+
+/**
+ * @brief msync() the pages holding [offset, offset + len)
+ */
+static bool flash_sync(size_t offset, size_t len) {
+    static uintptr_t page_size;
+
+    if (!page_size) {
+        page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    }
+
+    uintptr_t start = (uintptr_t)(store.map + offset) & ~(page_size - 1u);
+    uintptr_t end = (uintptr_t)(store.map + offset + len);
+
+    return msync((void *)start, end - start, MS_SYNC) == 0;
+}
+
+/**
+ * @brief Program bytes like NOR flash: bits can only go from 1 to 0
+ */
+static bool flash_program(size_t offset, const void *data, size_t len) {
+    const uint8_t *src = data;
+    uint8_t *dst = store.map + offset;
+
+    for (size_t i = 0; i < len; i++) {
+        dst[i] &= src[i];
+    }
+    return flash_sync(offset, len);
+}
+
+/**
+ * @brief Erase a sector to all ones
+ */
+static bool flash_erase(uint8_t bank) {
+    size_t offset = (size_t)bank * SETTINGS_STORE_SECTOR_SIZE;
+
+    memset(store.map + offset, FLASH_ERASED_BYTE, SETTINGS_STORE_SECTOR_SIZE);
+    return flash_sync(offset, SETTINGS_STORE_SECTOR_SIZE);
+}
+
+/**
+ * @brief Map the file, creating a blank (erased) one if it does not have the store's size
+ */
+static bool flash_map(void) {
+    struct stat st;
+    bool fresh;
+
+    if (fstat(store.fd, &st) != 0) {
+        return false;
+    }
+
+    fresh = (size_t)st.st_size != FILE_SIZE;
+    if (fresh && st.st_size != 0) {
+        CORE_LOG_WARN("[Settings] Not a settings store of this layout, starting a new one\n");
+    }
+    if (fresh && (ftruncate(store.fd, 0) != 0 || ftruncate(store.fd, (off_t)FILE_SIZE) != 0)) {
+        return false;
+    }
+
+    void *map = mmap(NULL, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, store.fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    store.map = map;
+
+    if (fresh) {
+        memset(store.map, FLASH_ERASED_BYTE, FILE_SIZE);
+        flash_sync(0, FILE_SIZE);
+    }
+    return true;
+}
+
+static void flash_unmap(void) {
+    if (store.map) {
+        munmap(store.map, FILE_SIZE);
+    }
+    close(store.fd);
+    store.map = NULL;
+    store.fd = -1;
+}
+
+static int flash_open(const char *path) {
+    return open(path, O_RDWR | O_CREAT, 0644);
+}
+
+#else // !SETTINGS_HAS_MMAP
+
+static bool flash_program(size_t offset, const void *data, size_t len) {
+    (void)offset;
+    (void)data;
+    (void)len;
+    return false;
+}
+
+static bool flash_erase(uint8_t bank) {
+    (void)bank;
+    return false;
+}
+
+static bool flash_map(void) {
+    return false;
+}
+
+static void flash_unmap(void) {
+}
+
+static int flash_open(const char *path) {
+    CORE_LOG_WARN("[Settings] No mmap() on this platform, %s not opened\n", path);
+    return -1;
+}
+
+#endif // SETTINGS_HAS_MMAP
+
+/**
+ * @brief Erase a bank and program its header, counting the erase
+ * @details A bank that is still blank is not erased again.
+ */
+static bool bank_format(uint8_t bank) {
+    const uint8_t *sector = store.map + (size_t)bank * SETTINGS_STORE_SECTOR_SIZE;
+    bool blank = true;
+    SectorHeader_t hdr;
+
+    for (uint32_t i = 0; i < SETTINGS_STORE_SECTOR_SIZE && blank; i++) {
+        blank = sector[i] == FLASH_ERASED_BYTE;
+    }
+    if (!blank) {
+        if (!flash_erase(bank)) {
+            return false;
+        }
+        store.erase_count[bank]++;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, SETTINGS_MAGIC, sizeof(hdr.magic));
+    hdr.version = SETTINGS_VERSION;
+    hdr.record_size = SETTINGS_STORE_RECORD_SIZE;
+    hdr.erase_count = store.erase_count[bank];
+    hdr.crc = header_crc(&hdr);
+    return flash_program((size_t)bank * SETTINGS_STORE_SECTOR_SIZE, &hdr, sizeof(hdr));
+}
+
+static bool values_changed(void) {
+    if (store.present != store.saved_present) {
+        return true;
+    }
+    for (uint32_t k = 0; k < SETTINGS_STORE_MAX_KEYS; k++) {
+        if ((store.present >> k) & 1u && store.values[k] != store.saved_values[k]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ====================== Public API ======================
+
+bool settings_store_open(const char *path) {
+    uint32_t latest[SETTINGS_STORE_BANKS];
+    uint32_t next[SETTINGS_STORE_BANKS];
+    const SettingsRecord_t *newest = NULL;
+    uint32_t max_erases = 0;
+
+    if (store.open) {
+        settings_store_close();
+    }
+
+    store.fd = flash_open(path);
+    if (store.fd < 0) {
+        return false;
+    }
+    if (!flash_map()) {
+        CORE_LOG_WARN("[Settings] Cannot map %s\n", path);
+        flash_unmap();
+        return false;
+    }
+
+    store.seq = 0;
+    store.bank = 0;
+    store.records_written = 0;
+    store.commits_skipped = 0;
+
+    for (uint8_t b = 0; b < SETTINGS_STORE_BANKS; b++) {
+        const SectorHeader_t *hdr = bank_header(b);
+
+        store.erase_count[b] = header_valid(hdr) ? hdr->erase_count : 0;
+        latest[b] = bank_latest(b, &next[b]);
+        if (latest[b] != SLOT_NONE && (!newest || bank_slots(b)[latest[b]].seq > newest->seq)) {
+            newest = &bank_slots(b)[latest[b]];
+            store.bank = b;
+        }
+        if (store.erase_count[b] > max_erases) {
+            max_erases = store.erase_count[b];
+        }
+    }
+    // A header lost to a torn erase takes the count of the other bank, they wear in turn
+    for (uint8_t b = 0; b < SETTINGS_STORE_BANKS; b++) {
+        if (!header_valid(bank_header(b))) {
+            store.erase_count[b] = max_erases;
+        }
+    }
+    store.next_slot = next[store.bank];
+    // A bank without a header (new file, torn erase) is formatted before its first record
+    if (!header_valid(bank_header(store.bank))) {
+        store.next_slot = SETTINGS_STORE_SLOTS;
+    }
+
+    if (newest) {
+        store.seq = newest->seq;
+        store.present = store.saved_present = newest->present;
+        memcpy(store.values, newest->values, sizeof(store.values));
+        memcpy(store.saved_values, newest->values, sizeof(store.saved_values));
+        CORE_LOG_USER("[Settings] Loaded record %u from bank %u\n", (unsigned)store.seq, (unsigned)store.bank);
+    } else {
+        // Keep values set before the store was opened, they go into the first record
+        store.saved_present = 0;
+    }
+
+    store.open = true;
+    return true;
+}
+
+void settings_store_close(void) {
+    if (!store.open) {
+        return;
+    }
+    flash_unmap();
+    store.open = false;
+}
+
+bool settings_store_is_open(void) {
+    return store.open;
+}
+
+bool settings_store_get(settings_key_e key, int32_t *value) {
+    if ((uint32_t)key >= SETTINGS_STORE_MAX_KEYS || !((store.present >> key) & 1u)) {
+        return false;
+    }
+    *value = store.values[key];
+    return true;
+}
+
+void settings_store_set(settings_key_e key, int32_t value) {
+    if ((uint32_t)key >= SETTINGS_STORE_MAX_KEYS) {
+        return;
+    }
+    store.values[key] = value;
+    store.present |= 1u << key;
+}
+
+bool settings_store_commit(void) {
+    SettingsRecord_t rec;
+    bool full_once = false;
+
+    if (!values_changed()) {
+        store.commits_skipped++;
+        return true;
+    }
+    if (!store.open) {
+        return false;
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    rec.seq = store.seq + 1u;
+    rec.present = store.present;
+    for (uint32_t k = 0; k < SETTINGS_STORE_MAX_KEYS; k++) {
+        rec.values[k] = ((store.present >> k) & 1u) ? store.values[k] : 0;
+    }
+    rec.crc = record_crc(&rec);
+
+    for (;;) {
+        if (store.next_slot >= SETTINGS_STORE_SLOTS) {
+            // Full: the other bank takes over, this one keeps the newest record until then
+            uint8_t target = (store.seq == 0) ? store.bank : (uint8_t)((store.bank + 1u) % SETTINGS_STORE_BANKS);
+
+            if (full_once || !bank_format(target)) {
+                CORE_LOG_WARN("[Settings] Cannot format bank %u\n", (unsigned)target);
+                return false;
+            }
+            full_once = true;
+            store.bank = target;
+            store.next_slot = 0;
+        }
+
+        size_t offset = (size_t)store.bank * SETTINGS_STORE_SECTOR_SIZE +
+                        (size_t)(store.next_slot + 1u) * SETTINGS_STORE_RECORD_SIZE;
+        const SettingsRecord_t *slot = &bank_slots(store.bank)[store.next_slot];
+
+        if (slot_blank(slot)) {
+            if (!flash_program(offset, &rec, sizeof(rec))) {
+                CORE_LOG_WARN("[Settings] Cannot write record %u\n", (unsigned)rec.seq);
+                return false;
+            }
+            store.next_slot++;
+            break;
+        }
+
+        // Half-programmed by a power cut: burn it so the used slots stay a prefix
+        uint32_t burnt = 0;
+        flash_program(offset + offsetof(SettingsRecord_t, seq), &burnt, sizeof(burnt));
+        store.next_slot++;
+    }
+
+    store.seq = rec.seq;
+    store.saved_present = rec.present;
+    memcpy(store.saved_values, rec.values, sizeof(store.saved_values));
+    store.records_written++;
+    return true;
+}
+
+void settings_store_load_pomodoro(PomodoroSettings_t *settings) {
+    static const struct {
+        settings_key_e  key;
+        int32_t         def;
+        int32_t         max;
+    } fields[] = {
+        { SETTINGS_KEY_WORK_MIN,            POMODORO_DEF_WORK_MIN,              24 * 60 },
+        { SETTINGS_KEY_SHORT_BREAK_MIN,     POMODORO_DEF_SHORT_BREAK_MIN,       24 * 60 },
+        { SETTINGS_KEY_LONG_BREAK_MIN,      POMODORO_DEF_LONG_BREAK_MIN,        24 * 60 },
+        { SETTINGS_KEY_CYCLES_BEFORE_LONG,  POMODORO_DEF_CYCLES_BEFORE_LONG,    UINT8_MAX },
+    };
+    int32_t v[sizeof(fields) / sizeof(fields[0])];
+
+    for (uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (!settings_store_get(fields[i].key, &v[i]) || v[i] < 1 || v[i] > fields[i].max) {
+            v[i] = fields[i].def;
+        }
+    }
+    settings->work_min = v[0];
+    settings->short_break_min = v[1];
+    settings->long_break_min = v[2];
+    settings->cycles_before_long = v[3];
+}
+
+bool settings_store_save_pomodoro(const PomodoroSettings_t *settings) {
+    settings_store_set(SETTINGS_KEY_WORK_MIN, settings->work_min);
+    settings_store_set(SETTINGS_KEY_SHORT_BREAK_MIN, settings->short_break_min);
+    settings_store_set(SETTINGS_KEY_LONG_BREAK_MIN, settings->long_break_min);
+    settings_store_set(SETTINGS_KEY_CYCLES_BEFORE_LONG, settings->cycles_before_long);
+    return settings_store_commit();
+}
+
+void settings_store_get_stats(SettingsStoreStats_t *stats) {
+    memcpy(stats->erase_count, store.erase_count, sizeof(stats->erase_count));
+    stats->seq = store.seq;
+    stats->records_written = store.records_written;
+    stats->commits_skipped = store.commits_skipped;
+    stats->active_bank = store.bank;
+    stats->next_slot = (uint8_t)store.next_slot;
+}
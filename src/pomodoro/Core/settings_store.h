@@ -0,0 +1,134 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file settings_store.h
+ * @brief Persistent key-value store for the settings and other preferences.
+ *
+ * The store lives in a file that emulates NOR flash: two sectors (banks) that
+ * are erased to 0xFF as a whole and programmed by clearing bits. Each commit
+ * programs one fixed-size record holding every key, with a sequence number and
+ * a CRC, into the next blank slot of the active bank. Only when the bank is
+ * full is the other one erased and the record written there, so a sector is
+ * erased once every SETTINGS_STORE_SLOTS commits and the banks wear evenly.
+ * The previous bank keeps the last record until then: a commit interrupted at
+ * any point, the erase included, leaves the record before it readable.
+ *
+ * Opening reads the two sector headers and finds the newest record of each
+ * bank by binary search over a fixed number of slots, so loading at boot does
+ * not depend on how often the settings were saved. Afterwards the values are
+ * served from RAM.
+ *
+ * The file is memory-mapped where mmap() exists; elsewhere
+ * settings_store_open() fails and the store keeps the values in RAM only.
+ * Not thread safe: use it from the UI thread.
+ */
+
+/** Bytes per emulated flash sector, one bank */
+#ifndef SETTINGS_STORE_SECTOR_SIZE
+#define SETTINGS_STORE_SECTOR_SIZE      4096u
+#endif
+
+/** Banks in the file, written in turn */
+#define SETTINGS_STORE_BANKS            2u
+
+/** Values in a record */
+#define SETTINGS_STORE_MAX_KEYS         12u
+
+/** Bytes per record, also the size of the sector header */
+#define SETTINGS_STORE_RECORD_SIZE      64u
+
+/** Record slots per bank, after the sector header */
+#define SETTINGS_STORE_SLOTS            (SETTINGS_STORE_SECTOR_SIZE / SETTINGS_STORE_RECORD_SIZE - 1u)
+
+/**
+ * @brief Keys. New preferences are added at the end, the value of a key is
+ *        kept at its position in the record.
+ */
+typedef enum {
+    SETTINGS_KEY_WORK_MIN,              /**< Work duration in minutes */
+    SETTINGS_KEY_SHORT_BREAK_MIN,       /**< Short break duration in minutes */
+    SETTINGS_KEY_LONG_BREAK_MIN,        /**< Long break duration in minutes */
+    SETTINGS_KEY_CYCLES_BEFORE_LONG,    /**< Work sessions before a long break */
+    SETTINGS_KEY_COUNT
+} settings_key_e;
+
+/**
+ * @brief Counters for tests and benchmarks
+ */
+typedef struct {
+    uint32_t erase_count[SETTINGS_STORE_BANKS]; /**< Erases of each sector over the file's lifetime */
+    uint32_t seq;                               /**< Sequence number of the newest record, 0 if none */
+    uint32_t records_written;                   /**< Records programmed since settings_store_open() */
+    uint32_t commits_skipped;                   /**< Commits without a change, nothing programmed */
+    uint8_t  active_bank;                       /**< Bank of the newest record */
+    uint8_t  next_slot;                         /**< Slot the next record goes to in the active bank */
+} SettingsStoreStats_t;
+
+/**
+ * @brief Open or create the store and load the newest valid record
+ * @param path Flash image file, created blank (erased) if missing or not a store of this layout
+ * @return false if the file could not be opened or mapped, values are then kept in RAM only
+ */
+bool settings_store_open(const char *path);
+
+/**
+ * @brief Close the store. Values that were set but not committed are lost.
+ */
+void settings_store_close(void);
+
+/**
+ * @brief Check if a store file is open
+ */
+bool settings_store_is_open(void);
+
+/**
+ * @brief Read a value
+ * @param key Key to read
+ * @param value Set to the value if the key has one
+ * @return false if the key was never set
+ */
+bool settings_store_get(settings_key_e key, int32_t *value);
+
+/**
+ * @brief Set a value in RAM, settings_store_commit() makes it persistent
+ */
+void settings_store_set(settings_key_e key, int32_t value);
+
+/**
+ * @brief Program the current values as a new record
+ * @details Does nothing if no value changed since the last record, so callers can
+ *          commit on every save without wearing the flash.
+ * @return false if the record could not be written
+ */
+bool settings_store_commit(void);
+
+/**
+ * @brief Read the Pomodoro settings, defaults for the keys never set
+ */
+void settings_store_load_pomodoro(PomodoroSettings_t *settings);
+
+/**
+ * @brief Set and commit the Pomodoro settings
+ * @return false if the record could not be written
+ */
+bool settings_store_save_pomodoro(const PomodoroSettings_t *settings);
+
+/**
+ * @brief Get the wear and write counters
+ */
+void settings_store_get_stats(SettingsStoreStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SETTINGS_STORE_H
@@ -1,72 +1,619 @@
+#include <stddef.h>
 #include "timer.h"
-#include "lvgl.h"
+#include "monotonic.h"
+#include "core_log.h"
+#include "trace.h"
 
-#ifdef USE_HAL_TICK
-    #include "stm32f4xx_hal.h"   // Or your MCU HAL header
-#elif defined HAL_PICO
-    //Nothing to include
-#else
-    #include <SDL.h>  // Add SDL include for tick counter
+// ====================== Timing Wheel ======================
+//
+// Hierarchical timing wheel with 1 ms resolution. Level 0 holds the next
+// 64 ms, every higher level covers 64x the span of the one below it.
+// Timers are inserted in O(1), cascaded one level down when their slot comes
+// due and fired from level 0. A per-level occupancy bitmap lets the tick
+// handler jump over empty slots, so its cost follows the number of expiries
+// and not the number of armed timers.
+//
+// Expiries are kept in nanoseconds from the monotonic clock; the wheel only
+// uses them rounded up to the next millisecond to pick a slot.
+//
+// Timers with a tick callback are also kept in a binary min-heap ordered by
+// their next whole-second boundary, so the tick handler and the deadline
+// query only look at its top: a tick costs O(log n) in the number of ticking
+// timers, and nothing is walked per handler call.
+
+#define WHEEL_BITS          6
+#define WHEEL_SIZE          (1u << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SIZE - 1u)
+#define WHEEL_LEVELS        6       /* 2^36 ms, ~795 days */
+#define WHEEL_MAX_DELTA     ((1ull << (WHEEL_BITS * WHEEL_LEVELS)) - 1ull)
+
+#define TIMER_NIL           UINT32_MAX
+#define TIMER_INDEX_BITS    20
+#define TIMER_INDEX_MASK    ((1u << TIMER_INDEX_BITS) - 1u)
+#define TIMER_GEN_MASK      ((1u << (32 - TIMER_INDEX_BITS)) - 1u)
+
+#define NS_PER_MS           MONOTONIC_NS_PER_MS
+#define TIMER_TICK_NS       MONOTONIC_NS_PER_SEC
+#define TIMER_LEAD_MAX_NS   (4 * (int64_t)NS_PER_MS)    /* Upper bound of the wake-ahead drift correction */
+#define TIMER_LEAD_WINDOW   (16 * (int64_t)NS_PER_MS)   /* Wake errors above this were not deadline driven */
+
+#define LAT_HIST_MIN_MS     (-16)
+#define LAT_HIST_BUCKETS    256     /* 1 ms buckets, -16 .. 239 ms */
+
+#define LIST_NONE           0xFF    /* Not linked in any wheel list */
+#define LIST_EXPIRING       0xFE    /* Linked in the list being fired */
+
+#if TIMER_MAX_COUNT >= (1 << TIMER_INDEX_BITS)
+    #error "TIMER_MAX_COUNT does not fit in a timer_handle_t"
+#endif
+
+typedef enum {
+    TIMER_FREE,
+    TIMER_ARMED,
+    TIMER_PAUSED
+} TimerEntryState_e;
+
+typedef struct {
+    uint64_t            expires_ns;     /**< Absolute expiry time */
+    uint64_t            tick_due_ns;    /**< Absolute time of the next whole-second boundary */
+    uint64_t            paused_ns;      /**< Time left when paused */
+    uint32_t            next;           /**< Wheel list links (or free list) */
+    uint32_t            prev;
+    uint32_t            tick_pos;       /**< Index in tick_heap, TIMER_NIL when no tick is left */
+    uint32_t            arm_seq;        /**< Handler sequence number when armed */
+    uint16_t            gen;            /**< Generation, invalidates stale handles */
+    uint8_t             state;          /**< TimerEntryState_e */
+    uint8_t             level;          /**< Wheel level, LIST_NONE or LIST_EXPIRING */
+    uint8_t             slot;           /**< Slot within the level */
+    timer_tick_cb_t     on_tick;
+    timer_expired_cb_t  on_expired;
+    void               *user_data;
+} TimerEntry_t;
+
+static struct {
+    bool     ready;
+    uint64_t next_ms;                           /**< Next ms to process, everything before has fired */
+    uint32_t head[WHEEL_LEVELS][WHEEL_SIZE];
+    uint64_t occupied[WHEEL_LEVELS];            /**< Bit n set if slot n is non-empty */
+    uint32_t expiring;                          /**< Timers being fired in the current step */
+    uint32_t tick_count;                        /**< Entries in tick_heap */
+    uint32_t free_head;
+    uint32_t active;
+    uint32_t seq;
+    int64_t  tick_lead_ns;                      /**< Wake-ahead for ticks */
+} wheel;
+
+#if TIMER_USE_LATENCY_STATS
+static struct {
+    uint32_t hist[LAT_HIST_BUCKETS];
+    uint32_t count;
+    int32_t  min_ms;
+    int32_t  max_ms;
+} lat;
 #endif
 
+static TimerEntry_t pool[TIMER_MAX_COUNT];
+static uint32_t tick_heap[TIMER_MAX_COUNT];     /**< Ticking timers, min-heap on tick_due_ns */
 
+// Default countdown used by the single-timer API (timer_start() and friends)
 static struct Timer_t {
-    bool running;
-    bool paused;
+    timer_handle_t handle;
     uint32_t duration;
-    uint32_t start_tick;
-    uint32_t pause_tick;
-    uint32_t pause_duration;
-    uint32_t last_tick;        // Add tracking of last tick time
-    uint32_t current_remaining; // Add current remaining time
     void (*on_tick)(uint32_t);
     void (*on_finished)(void);
 } tmr;
 
 
-// Portable tick getter
-static inline uint32_t get_tick_ms(void) {
-    uint32_t tick = 0;
-#ifdef USE_HAL_TICK
-    tick = HAL_GetTick();
-#elif defined HAL_PICO
-    extern uint32_t tick_timer();
-    tick = tick_timer();
+static inline uint32_t ctz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(v);
+#else
+    uint32_t n = 0;
+    while (!(v & 1u)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// ====================== Private Functions ======================
+
+static inline timer_handle_t make_handle(uint32_t idx) {
+    return ((uint32_t)pool[idx].gen << TIMER_INDEX_BITS) | (idx + 1u);
+}
+
+static TimerEntry_t *entry_from_handle(timer_handle_t handle) {
+    uint32_t idx = handle & TIMER_INDEX_MASK;
+
+    if (idx == 0 || idx > TIMER_MAX_COUNT) return NULL;
+
+    TimerEntry_t *e = &pool[idx - 1u];
+    if (e->state == TIMER_FREE || e->gen != (handle >> TIMER_INDEX_BITS)) return NULL;
+
+    return e;
+}
+
+static inline uint32_t entry_index(const TimerEntry_t *e) {
+    return (uint32_t)(e - pool);
+}
+
+static uint32_t *list_head(const TimerEntry_t *e) {
+    if (e->level == LIST_EXPIRING) return &wheel.expiring;
+    return &wheel.head[e->level][e->slot];
+}
+
+static void list_unlink(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+    uint32_t *head = list_head(e);
+
+    if (e->prev != TIMER_NIL) pool[e->prev].next = e->next;
+    else *head = e->next;
+    if (e->next != TIMER_NIL) pool[e->next].prev = e->prev;
+
+    if (e->level < WHEEL_LEVELS && *head == TIMER_NIL) {
+        wheel.occupied[e->level] &= ~(1ull << e->slot);
+    }
+    e->level = LIST_NONE;
+    e->next = TIMER_NIL;
+    e->prev = TIMER_NIL;
+}
+
+static void wheel_insert(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+    uint64_t expires = (e->expires_ns + NS_PER_MS - 1u) / NS_PER_MS;
+
+    if (expires < wheel.next_ms) expires = wheel.next_ms;
+    uint64_t delta = expires - wheel.next_ms;
+    uint8_t level = 0;
+
+    if (delta > WHEEL_MAX_DELTA) {
+        // Park at the far end, it gets re-placed when cascaded
+        expires = wheel.next_ms + WHEEL_MAX_DELTA;
+        delta = WHEEL_MAX_DELTA;
+    }
+    while (level < WHEEL_LEVELS - 1 && delta >= (1ull << (WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+
+    e->level = level;
+    e->slot = (uint8_t)((expires >> (WHEEL_BITS * level)) & WHEEL_MASK);
+    e->prev = TIMER_NIL;
+    e->next = wheel.head[level][e->slot];
+    if (e->next != TIMER_NIL) pool[e->next].prev = idx;
+    wheel.head[level][e->slot] = idx;
+    wheel.occupied[level] |= (1ull << e->slot);
+}
+
+// Move every timer of the current slot at `level` down the hierarchy.
+// Returns true when that slot index is 0, i.e. the next level is due as well.
+static bool wheel_cascade(uint8_t level) {
+    uint32_t slot = (uint32_t)(wheel.next_ms >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    uint32_t idx = wheel.head[level][slot];
+
+    wheel.head[level][slot] = TIMER_NIL;
+    wheel.occupied[level] &= ~(1ull << slot);
+
+    while (idx != TIMER_NIL) {
+        uint32_t next = pool[idx].next;
+        wheel_insert(idx);
+        idx = next;
+    }
+
+    return slot == 0;
+}
+
+static inline void tick_heap_set(uint32_t pos, uint32_t idx) {
+    tick_heap[pos] = idx;
+    pool[idx].tick_pos = pos;
+}
+
+// Restore the heap order around pos after its entry changed or moved there
+static void tick_heap_fix(uint32_t pos) {
+    uint32_t idx = tick_heap[pos];
+    uint64_t due = pool[idx].tick_due_ns;
+
+    while (pos > 0) {
+        uint32_t parent = (pos - 1u) / 2u;
+        if (pool[tick_heap[parent]].tick_due_ns <= due) break;
+        tick_heap_set(pos, tick_heap[parent]);
+        pos = parent;
+    }
+    for (;;) {
+        uint32_t child = 2u * pos + 1u;
+        if (child >= wheel.tick_count) break;
+        if (child + 1u < wheel.tick_count &&
+            pool[tick_heap[child + 1u]].tick_due_ns < pool[tick_heap[child]].tick_due_ns) {
+            child++;
+        }
+        if (pool[tick_heap[child]].tick_due_ns >= due) break;
+        tick_heap_set(pos, tick_heap[child]);
+        pos = child;
+    }
+    tick_heap_set(pos, idx);
+}
+
+static void tick_unlink(uint32_t idx) {
+    uint32_t pos = pool[idx].tick_pos;
+    uint32_t last = tick_heap[--wheel.tick_count];
+
+    pool[idx].tick_pos = TIMER_NIL;
+    if (last != idx) {
+        tick_heap_set(pos, last);
+        tick_heap_fix(pos);
+    }
+}
+
+// Put the entry in the heap while it has a tick left before its expiry, at its tick_due_ns
+static void tick_sync(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+    bool ticks = (e->state == TIMER_ARMED && e->on_tick && e->tick_due_ns < e->expires_ns);
+
+    if (!ticks) {
+        if (e->tick_pos != TIMER_NIL) tick_unlink(idx);
+    } else if (e->tick_pos == TIMER_NIL) {
+        tick_heap_set(wheel.tick_count++, idx);
+        tick_heap_fix(e->tick_pos);
+    } else {
+        tick_heap_fix(e->tick_pos);
+    }
+}
+
+static void entry_release(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+
+    if (e->level != LIST_NONE) list_unlink(idx);
+    if (e->tick_pos != TIMER_NIL) tick_unlink(idx);
+
+    e->state = TIMER_FREE;
+    e->gen = (uint16_t)((e->gen + 1u) & TIMER_GEN_MASK);
+    e->on_tick = NULL;
+    e->on_expired = NULL;
+    e->user_data = NULL;
+    e->next = wheel.free_head;
+    wheel.free_head = idx;
+    wheel.active--;
+}
+
+// Next time the remaining time reaches a whole second, or the expiry itself
+static inline uint64_t next_tick_due(const TimerEntry_t *e, uint64_t now) {
+    uint64_t remaining = (e->expires_ns > now) ? (e->expires_ns - now) : 0;
+    if (remaining == 0) return e->expires_ns;
+
+    return e->expires_ns - ((remaining - 1u) / TIMER_TICK_NS) * TIMER_TICK_NS;
+}
+
+static inline uint32_t ns_to_ms_ceil(uint64_t ns) {
+    uint64_t ms = (ns + NS_PER_MS - 1u) / NS_PER_MS;
+    return (ms > UINT32_MAX) ? UINT32_MAX : (uint32_t)ms;
+}
+
+static void entry_arm(uint32_t idx, uint64_t duration_ns) {
+    TimerEntry_t *e = &pool[idx];
+    uint64_t now = monotonic_now_ns();
+
+    e->state = TIMER_ARMED;
+    e->arm_seq = wheel.seq;
+    e->expires_ns = now + duration_ns;
+    e->tick_due_ns = next_tick_due(e, now);
+    wheel_insert(idx);
+    tick_sync(idx);
+}
+
+// Take the timer off the wheel with its exact remaining time
+static uint64_t entry_pause(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+    uint64_t now = monotonic_now_ns();
+
+    list_unlink(idx);
+    e->state = TIMER_PAUSED;
+    e->paused_ns = (e->expires_ns > now) ? (e->expires_ns - now) : 0;
+    tick_sync(idx);
+    return e->paused_ns;
+}
+
+static void entry_fire(uint32_t idx) {
+    TimerEntry_t *e = &pool[idx];
+    timer_handle_t handle = make_handle(idx);
+    timer_expired_cb_t cb = e->on_expired;
+    void *user_data = e->user_data;
+
+    // Release first so the callback may immediately reuse the slot
+    entry_release(idx);
+    if (cb) {
+        cb(handle, user_data);
+    }
+}
+
+// Lower bound of the next expiry on the wheel. Exact for level 0, for the
+// upper levels it is the time their next occupied slot cascades.
+static uint64_t wheel_next_event(void) {
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        uint64_t occupied = wheel.occupied[level];
+        if (!occupied) continue;
+
+        uint32_t shift = WHEEL_BITS * level;
+        uint64_t block = wheel.next_ms >> shift;
+        uint64_t t;
+
+        if (level == 0) {
+            // Slots at or after the current index, then the wrapped ones
+            uint32_t cur = (uint32_t)block & WHEEL_MASK;
+            uint64_t ahead = occupied >> cur;
+            t = ahead ? (wheel.next_ms + ctz64(ahead))
+                      : (wheel.next_ms + (WHEEL_SIZE - cur) + ctz64(occupied));
+        }
+        else if ((wheel.next_ms & ((1ull << shift) - 1u)) == 0 &&
+                 (occupied & (1ull << ((uint32_t)block & WHEEL_MASK)))) {
+            // Sitting on a block boundary whose cascade has not run yet
+            t = wheel.next_ms;
+        }
+        else {
+            // The current slot of an upper level was already cascaded,
+            // so its entries belong to the next round
+            uint32_t cur = (uint32_t)block & WHEEL_MASK;
+            uint32_t from = (cur + 1u) & WHEEL_MASK;
+            uint64_t rotated = (from == 0) ? occupied
+                                           : ((occupied >> from) | (occupied << (WHEEL_SIZE - from)));
+            t = (block + 1u + ctz64(rotated)) << shift;
+        }
+
+        if (t < best) best = t;
+    }
+
+    return best;
+}
+
+static void wheel_advance(uint64_t now) {
+    while (wheel.next_ms <= now) {
+        uint32_t idx0 = (uint32_t)wheel.next_ms & WHEEL_MASK;
+
+        if (idx0 == 0) {
+            uint8_t level = 1;
+            while (level < WHEEL_LEVELS && wheel_cascade(level)) {
+                level++;
+            }
+        }
+
+        uint64_t pending = wheel.occupied[0] >> idx0;
+        if (!(pending & 1u)) {
+            // Jump to the next occupied slot or the next cascade with work to do,
+            // empty blocks in between need no visit
+            uint64_t target = pending ? (wheel.next_ms + ctz64(pending)) : wheel_next_event();
+            wheel.next_ms = (target > now) ? (now + 1u) : target;
+            continue;
+        }
+
+        // Detach the due slot so timers re-armed from callbacks cannot land in it
+        wheel.expiring = wheel.head[0][idx0];
+        wheel.head[0][idx0] = TIMER_NIL;
+        wheel.occupied[0] &= ~(1ull << idx0);
+        for (uint32_t i = wheel.expiring; i != TIMER_NIL; i = pool[i].next) {
+            pool[i].level = LIST_EXPIRING;
+        }
+        wheel.next_ms++;
+
+        while (wheel.expiring != TIMER_NIL) {
+            uint32_t idx = wheel.expiring;
+            list_unlink(idx);
+            entry_fire(idx);
+        }
+    }
+}
+
+static void latency_record(int64_t latency_ns) {
+#if TIMER_USE_LATENCY_STATS
+    // Floor to whole ms, also for negative values
+    int64_t latency_ms = (latency_ns >= 0) ? (latency_ns / (int64_t)NS_PER_MS)
+                                           : -((-latency_ns + (int64_t)NS_PER_MS - 1) / (int64_t)NS_PER_MS);
+    int64_t bucket = latency_ms - LAT_HIST_MIN_MS;
+
+    if (bucket < 0) bucket = 0;
+    if (bucket >= LAT_HIST_BUCKETS) bucket = LAT_HIST_BUCKETS - 1;
+    lat.hist[bucket]++;
+
+    if (lat.count == 0 || latency_ms < lat.min_ms) lat.min_ms = (int32_t)latency_ms;
+    if (lat.count == 0 || latency_ms > lat.max_ms) lat.max_ms = (int32_t)latency_ms;
+    lat.count++;
 #else
-    tick = SDL_GetTicks();  // Use SDL's tick counter instead of fake increment
+    (void)latency_ns;
 #endif
+}
+
+// Deliver on_tick for the latest whole-second boundary reached by now + lead.
+// The reported value is the boundary itself, so the display stays phase-locked
+// to the countdown's start no matter how late or early the loop woke up.
+static void tick_deliver(uint32_t idx, uint64_t now, uint64_t lead) {
+    TimerEntry_t *e = &pool[idx];
+    uint64_t target = now + lead;
+
+    if (target >= e->expires_ns) {
+        // Phase end is imminent, let the expiry report it
+        e->tick_due_ns = e->expires_ns;
+        tick_sync(idx);
+        return;
+    }
+
+    uint64_t boundary_rem = ((e->expires_ns - target + TIMER_TICK_NS - 1u) / TIMER_TICK_NS) * TIMER_TICK_NS;
+    uint64_t boundary = e->expires_ns - boundary_rem;
+
+    // Drift correction: learn how late deadline-driven wakeups land and wake that much earlier
+    int64_t wake_err = (int64_t)now - (int64_t)(e->tick_due_ns - lead);
+    if (wake_err >= 0 && wake_err <= TIMER_LEAD_WINDOW) {
+        wheel.tick_lead_ns += (wake_err - wheel.tick_lead_ns) / 8;
+        if (wheel.tick_lead_ns < 0) wheel.tick_lead_ns = 0;
+        if (wheel.tick_lead_ns > TIMER_LEAD_MAX_NS) wheel.tick_lead_ns = TIMER_LEAD_MAX_NS;
+    }
+
+    latency_record((int64_t)now - (int64_t)boundary);
+
+    // Re-keyed before the callback, which may cancel, pause or re-arm it
+    e->tick_due_ns = (boundary_rem > TIMER_TICK_NS) ? (boundary + TIMER_TICK_NS) : e->expires_ns;
+    tick_sync(idx);
+    e->on_tick((uint32_t)(boundary_rem / NS_PER_MS));
+}
+
+static void wheel_ensure_init(void) {
+    if (!wheel.ready) {
+        timer_init();
+    }
+}
+
+static void legacy_expired(timer_handle_t handle, void *user_data) {
+    (void)handle;
+    (void)user_data;
 
-    return tick;
+    tmr.handle = TIMER_INVALID_HANDLE;
+    if (tmr.on_finished) {
+        tmr.on_finished();
+    }
 }
 
+// ====================== Public API ======================
+
 void timer_init(void) {
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < WHEEL_SIZE; slot++) {
+            wheel.head[level][slot] = TIMER_NIL;
+        }
+        wheel.occupied[level] = 0;
+    }
+
+    for (uint32_t i = 0; i < TIMER_MAX_COUNT; i++) {
+        pool[i].gen = (uint16_t)((pool[i].gen + 1u) & TIMER_GEN_MASK);
+        pool[i].state = TIMER_FREE;
+        pool[i].level = LIST_NONE;
+        pool[i].tick_pos = TIMER_NIL;
+        pool[i].on_tick = NULL;
+        pool[i].on_expired = NULL;
+        pool[i].next = (i + 1u < TIMER_MAX_COUNT) ? (i + 1u) : TIMER_NIL;
+    }
+
+    wheel.next_ms = monotonic_now_ms();
+    wheel.expiring = TIMER_NIL;
+    wheel.tick_count = 0;
+    wheel.free_head = 0;
+    wheel.active = 0;
+    wheel.ready = true;
+
+    tmr.handle = TIMER_INVALID_HANDLE;
     tmr.duration = 0;
-    tmr.start_tick = 0;
     tmr.on_tick = 0;
     tmr.on_finished = 0;
-    tmr.running = false;
-    tmr.paused = false;
-    tmr.pause_duration = 0;
-    tmr.current_remaining = 0;
+}
+
+timer_handle_t timer_handle_create(uint32_t ms,
+                                   timer_tick_cb_t on_tick,
+                                   timer_expired_cb_t on_expired,
+                                   void *user_data) {
+    wheel_ensure_init();
+
+    uint32_t idx = wheel.free_head;
+    if (idx == TIMER_NIL) {
+        CORE_LOG_WARN("[TIMER] Pool exhausted (%d timers)\n", TIMER_MAX_COUNT);
+        return TIMER_INVALID_HANDLE;
+    }
+    wheel.free_head = pool[idx].next;
+    wheel.active++;
+
+    TimerEntry_t *e = &pool[idx];
+    e->on_tick = on_tick;
+    e->on_expired = on_expired;
+    e->user_data = user_data;
+    e->level = LIST_NONE;
+    e->tick_pos = TIMER_NIL;
+    entry_arm(idx, (uint64_t)ms * NS_PER_MS);
+
+    return make_handle(idx);
+}
+
+bool timer_handle_cancel(timer_handle_t handle) {
+    TimerEntry_t *e = entry_from_handle(handle);
+    if (!e) return false;
+
+    entry_release(entry_index(e));
+    return true;
+}
+
+bool timer_handle_pause(timer_handle_t handle) {
+    TimerEntry_t *e = entry_from_handle(handle);
+    if (!e || e->state != TIMER_ARMED) return false;
+
+    entry_pause(entry_index(e));
+    return true;
+}
+
+bool timer_handle_resume(timer_handle_t handle) {
+    TimerEntry_t *e = entry_from_handle(handle);
+    if (!e || e->state != TIMER_PAUSED) return false;
+
+    entry_arm(entry_index(e), e->paused_ns);
+    return true;
+}
+
+bool timer_handle_is_active(timer_handle_t handle) {
+    return entry_from_handle(handle) != NULL;
+}
+
+uint32_t timer_handle_get_remaining(timer_handle_t handle) {
+    TimerEntry_t *e = entry_from_handle(handle);
+    if (!e) return 0;
+    if (e->state == TIMER_PAUSED) return ns_to_ms_ceil(e->paused_ns);
+
+    uint64_t now = monotonic_now_ns();
+    return (e->expires_ns > now) ? ns_to_ms_ceil(e->expires_ns - now) : 0;
+}
+
+uint32_t timer_get_active_count(void) {
+    return wheel.active;
+}
+
+uint64_t timer_get_next_deadline_ns(void) {
+    if (!wheel.ready || wheel.active == 0) return TIMER_NO_DEADLINE_NS;
+
+    uint64_t deadline = wheel_next_event();
+    if (deadline != UINT64_MAX) deadline *= NS_PER_MS;
+
+    if (wheel.tick_count > 0) {
+        uint64_t lead = (uint64_t)wheel.tick_lead_ns;
+        uint64_t due = pool[tick_heap[0]].tick_due_ns;
+        uint64_t wake = (due > lead) ? (due - lead) : 0;
+        if (wake < deadline) deadline = wake;
+    }
+    return deadline;
+}
+
+uint32_t timer_get_next_deadline_ms(void) {
+    uint64_t deadline = timer_get_next_deadline_ns();
+    if (deadline == TIMER_NO_DEADLINE_NS) return TIMER_NO_DEADLINE;
+
+    uint64_t now = monotonic_now_ns();
+    if (deadline <= now) return 0;
+
+    uint32_t wait = ns_to_ms_ceil(deadline - now);
+    return (wait == TIMER_NO_DEADLINE) ? (TIMER_NO_DEADLINE - 1u) : wait;
 }
 
 void timer_start(uint32_t ms,
                  void (*on_tick)(uint32_t),
                  void (*on_finished)(void)) {
+    // Lazy init would reset the callbacks set below
+    wheel_ensure_init();
+
+    // The default countdown is a singleton: starting it again replaces it
+    timer_handle_cancel(tmr.handle);
+
     tmr.duration = ms;
-    tmr.start_tick = get_tick_ms();
     tmr.on_tick = on_tick;
     tmr.on_finished = on_finished;
-    tmr.running = true;
-    tmr.paused = false;
-
-    tmr.current_remaining = ms; // Initialize current remaining time
-    tmr.pause_duration = 0;
+    tmr.handle = timer_handle_create(ms, on_tick, legacy_expired, NULL);
 }
 
 void timer_stop(void) {
-    tmr.running = false;
-    tmr.paused = false;
+    timer_handle_cancel(tmr.handle);
+    tmr.handle = TIMER_INVALID_HANDLE;
 }
 
 void timer_restart(uint32_t ms) {
@@ -75,67 +622,119 @@ void timer_restart(uint32_t ms) {
     }
 }
 
+void timer_set_tick_callback(void (*on_tick)(uint32_t)) {
+    TimerEntry_t *e = entry_from_handle(tmr.handle);
+
+    tmr.on_tick = on_tick;
+    if (!e) return;
+
+    if (!e->on_tick && on_tick && e->state == TIMER_ARMED) {
+        e->tick_due_ns = next_tick_due(e, monotonic_now_ns());
+    }
+    e->on_tick = on_tick;
+    tick_sync(entry_index(e));
+}
+
 bool timer_is_running(void) {
-    return tmr.running;
+    return timer_handle_is_active(tmr.handle);
 }
 
 void timer_tick_handler(void)
 {
-    if (!tmr.running || tmr.paused) {
-        LV_LOG_USER("[TIMER] Not running or paused\n");
+    wheel_ensure_init();
+
+    if (wheel.active == 0) {
         return;
     }
 
-    uint32_t now = get_tick_ms();
-    uint32_t elapsed = now - tmr.start_tick - tmr.pause_duration;
-    
-    // Store current remaining time
-    tmr.current_remaining = (elapsed >= tmr.duration) ? 0 : (tmr.duration - elapsed);
-    tmr.last_tick = now;
-    
-    if (tmr.current_remaining > 0) {
-        if (tmr.on_tick) {
-            tmr.on_tick(tmr.current_remaining);
+    TRACE_BEGIN(TRACE_TIMER_TICK);
+    // Timers armed from callbacks below get this sequence and skip this round
+    wheel.seq++;
+
+    uint64_t now = monotonic_now_ns();
+    wheel_advance(now / NS_PER_MS);
+
+    // Every delivery moves the top a second on or drops it, the loop ends at the first one not due.
+    // One armed from a callback this round stops it too, the rest follows on the next call.
+    uint64_t lead = (uint64_t)wheel.tick_lead_ns;
+    uint32_t delivered = 0;
+    while (wheel.tick_count > 0) {
+        uint32_t idx = tick_heap[0];
+
+        if (now + lead < pool[idx].tick_due_ns || pool[idx].arm_seq == wheel.seq) break;
+        tick_deliver(idx, now, lead);
+        delivered++;
+    }
+    TRACE_END(TRACE_TIMER_TICK, delivered);
+    (void)delivered;
+}
+
+void timer_get_tick_latency(timer_latency_stats_t *stats)
+{
+    stats->count = 0;
+    stats->min_ms = 0;
+    stats->p50_ms = 0;
+    stats->p99_ms = 0;
+    stats->max_ms = 0;
+    stats->lead_ms = (uint32_t)(wheel.tick_lead_ns / (int64_t)NS_PER_MS);
+
+#if TIMER_USE_LATENCY_STATS
+    if (lat.count == 0) return;
+
+    uint32_t rank50 = (lat.count * 50u + 99u) / 100u;
+    uint32_t rank99 = (lat.count * 99u + 99u) / 100u;
+    uint32_t seen = 0;
+    bool have50 = false;
+
+    for (int32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+        seen += lat.hist[i];
+        if (!have50 && seen >= rank50) {
+            stats->p50_ms = i + LAT_HIST_MIN_MS;
+            have50 = true;
         }
-    } else {
-        tmr.running = false;
-        if (tmr.on_finished) {
-            tmr.on_finished();
+        if (seen >= rank99) {
+            stats->p99_ms = i + LAT_HIST_MIN_MS;
+            break;
         }
     }
+    stats->count = lat.count;
+    stats->min_ms = lat.min_ms;
+    stats->max_ms = lat.max_ms;
+#endif
+}
 
+void timer_reset_tick_latency(void)
+{
+#if TIMER_USE_LATENCY_STATS
+    for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+        lat.hist[i] = 0;
+    }
+    lat.count = 0;
+#endif
 }
 
 void timer_pause(void)
 {
-    if (tmr.running && !tmr.paused) {
-        tmr.paused = true;
-        tmr.pause_tick = tmr.last_tick; // Use last tick time instead of current time
-        
-        // Use stored remaining time from last tick
+    TimerEntry_t *e = entry_from_handle(tmr.handle);
+
+    if (e && e->state == TIMER_ARMED) {
+        // Keep the exact remaining time, report it the way ticks display it
+        uint64_t remaining_ns = entry_pause(entry_index(e));
+
         if (tmr.on_tick) {
-            tmr.on_tick(tmr.current_remaining);
+            uint64_t shown = (remaining_ns + TIMER_TICK_NS - 1u) / TIMER_TICK_NS;
+            tmr.on_tick((uint32_t)(shown * 1000u));
         }
     }
 }
 
 void timer_resume(void) {
-    if (tmr.paused) {
-        // Calculate how long we were paused
-        uint32_t now = get_tick_ms();
-        tmr.pause_duration += (now - tmr.pause_tick);
-        
-        // Clear pause state
-        tmr.paused = false;
-    }
+    timer_handle_resume(tmr.handle);
 }
 
 uint32_t timer_get_remaining(void)
 {
-    if (!tmr.running) return tmr.duration;
-    if (tmr.paused) return tmr.current_remaining;
-    
-    uint32_t now = get_tick_ms();
-    uint32_t elapsed = now - tmr.start_tick - tmr.pause_duration;
-    return (elapsed >= tmr.duration) ? 0 : (tmr.duration - elapsed);
+    if (!timer_handle_is_active(tmr.handle)) return tmr.duration;
+
+    return timer_handle_get_remaining(tmr.handle);
 }
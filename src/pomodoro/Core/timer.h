@@ -4,14 +4,53 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-// #define USE_HAL_TICK   1
+// Tick source selection (USE_HAL_TICK / HAL_PICO / SDL) lives in monotonic.h
 
-/// Initialize timer system
+/// Maximum number of concurrently allocated timers (armed or paused).
+/// Storage is a static pool, override at build time for large hosts.
+#ifndef TIMER_MAX_COUNT
+#define TIMER_MAX_COUNT     64
+#endif
+
+/// Record when tick callbacks run relative to their second boundary (1 KB of RAM)
+#ifndef TIMER_USE_LATENCY_STATS
+#define TIMER_USE_LATENCY_STATS 1
+#endif
+
+/// Handle to a timer created with timer_handle_create(). 0 is never valid.
+typedef uint32_t timer_handle_t;
+
+#define TIMER_INVALID_HANDLE    ((timer_handle_t)0)
+
+/// Returned by timer_get_next_deadline_ms() when no timer is armed
+#define TIMER_NO_DEADLINE       UINT32_MAX
+
+/// Returned by timer_get_next_deadline_ns() when no timer is armed
+#define TIMER_NO_DEADLINE_NS    UINT64_MAX
+
+/// Tick callback. Parameter = remaining time in ms
+typedef void (*timer_tick_cb_t)(uint32_t remaining_ms);
+
+/// Expiry callback for handle based timers
+typedef void (*timer_expired_cb_t)(timer_handle_t handle, void *user_data);
+
+/// Tick callback latency relative to the true second boundary (negative = early)
+typedef struct {
+    uint32_t count;     ///< Ticks recorded since the last reset
+    int32_t  min_ms;
+    int32_t  p50_ms;
+    int32_t  p99_ms;
+    int32_t  max_ms;
+    uint32_t lead_ms;   ///< Current wake-ahead applied by the drift correction
+} timer_latency_stats_t;
+
+/// Initialize timer system, drops every timer (including the default countdown)
 void timer_init(void);
 
 /// Start a countdown timer
 /// @param ms duration in milliseconds
-/// @param on_tick callback for each tick (can be NULL). Parameter = remaining time in ms
+/// @param on_tick called each time the remaining time reaches a whole second (can be NULL).
+///                Parameter = remaining time in ms, always a multiple of 1000
 /// @param on_finished callback when timer expires (can be NULL)
 void timer_start(uint32_t ms,
                  void (*on_tick)(uint32_t),
@@ -23,6 +62,10 @@ void timer_stop(void);
 /// Restart timer with new duration (keeps same callbacks)
 void timer_restart(uint32_t ms);
 
+/// Replace the tick callback of the default countdown, also while it runs or is paused
+/// @param on_tick new callback, NULL stops ticking (the countdown still expires)
+void timer_set_tick_callback(void (*on_tick)(uint32_t));
+
 /// Check if timer is running
 bool timer_is_running(void);
 
@@ -33,7 +76,55 @@ uint32_t timer_get_remaining(void);
 void timer_pause(void);
 void timer_resume(void);
 
-/// To be called periodically from main loop or SysTick
+/// To be called from main loop or SysTick, as often as convenient.
+/// Advances the timing wheel, fires every timer that expired since the last call
+/// and delivers on_tick for every countdown that crossed a whole second.
 void timer_tick_handler(void);
 
+/// Time until timer_tick_handler() has work to do: the next whole-second
+/// boundary of a ticking countdown or the next expiry, whichever is first.
+/// May return early (never late) for timers far in the future.
+/// @return ms to wait, 0 if overdue, TIMER_NO_DEADLINE if nothing is armed
+uint32_t timer_get_next_deadline_ms(void);
+
+/// Same as timer_get_next_deadline_ms() as an absolute monotonic_now_ns() time
+/// @return deadline in ns (may be in the past), TIMER_NO_DEADLINE_NS if nothing is armed
+uint64_t timer_get_next_deadline_ns(void);
+
+/// Create and arm an independent countdown on the timing wheel
+/// @param ms duration in milliseconds
+/// @param on_tick called on each whole second of remaining time while armed (can be NULL)
+/// @param on_expired called once when the countdown reaches 0 (can be NULL)
+/// @param user_data passed back to on_expired
+/// @return handle, or TIMER_INVALID_HANDLE when the pool is exhausted
+timer_handle_t timer_handle_create(uint32_t ms,
+                                   timer_tick_cb_t on_tick,
+                                   timer_expired_cb_t on_expired,
+                                   void *user_data);
+
+/// Cancel a timer and release its handle. Safe to call from any timer callback.
+/// @return false if the handle is stale or invalid
+bool timer_handle_cancel(timer_handle_t handle);
+
+/// Take an armed timer off the wheel, keeping its remaining time
+bool timer_handle_pause(timer_handle_t handle);
+
+/// Re-arm a paused timer for its remaining time
+bool timer_handle_resume(timer_handle_t handle);
+
+/// Check if the handle refers to a live timer (armed or paused)
+bool timer_handle_is_active(timer_handle_t handle);
+
+/// Get remaining time (ms) of a live timer, 0 for stale handles
+uint32_t timer_handle_get_remaining(timer_handle_t handle);
+
+/// Number of live timers in the pool
+uint32_t timer_get_active_count(void);
+
+/// Get tick latency percentiles since the last reset (all 0 when TIMER_USE_LATENCY_STATS is off)
+void timer_get_tick_latency(timer_latency_stats_t *stats);
+
+/// Clear the tick latency histogram
+void timer_reset_tick_latency(void);
+
 #endif // TIMER_H
@@ -0,0 +1,309 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <string.h>
+#include "trace.h"
+
+// ====================== Event Names ======================
+
+/**
+ * @brief How an event appears in the export
+ */
+typedef struct {
+    const char *name;
+    const char *cat;
+    const char *arg;                    /**< Name of the argument, NULL if it has none */
+} TraceIdInfo_t;
+
+static const TraceIdInfo_t id_info[TRACE_ID_COUNT] = {
+    [TRACE_STATE] = { "state", "core", "state" },
+    [TRACE_TIMER_TICK] = { "timer_tick", "core", "delivered" },
+    [TRACE_UI_STATE_CB] = { "ui_state_cb", "ui", "state" },
+    [TRACE_UI_TICK_CB] = { "ui_tick_cb", "ui", "remaining_ms" },
+    [TRACE_LV_TIMER] = { "lv_timer_handler", "ui", "next_ms" },
+    [TRACE_FLUSH] = { "flush", "display", "pixels" },
+};
+
+#if POMODORO_TRACE
+
+#include <stdatomic.h>
+#include "monotonic.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <time.h>
+    #define TRACE_CLOCK_POSIX   1
+#elif defined(_WIN32)
+    #include <windows.h>
+    #define TRACE_CLOCK_QPC     1
+#endif
+
+// Records take the time stamp counter where there is one, about half the cost of a clock read.
+// The export converts it against the clock (constant-rate TSC, as on any x86 of the last 15 years).
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define TRACE_TICKS_TSC     1
+#elif defined(_M_X64) || defined(_M_IX86)
+    #include <intrin.h>
+    #define TRACE_TICKS_TSC     1
+#endif
+
+#define RING_MASK           (TRACE_RING_RECORDS - 1u)
+#define NAME_LEN            16u
+
+// ====================== Data Structures ======================
+
+/**
+ * @brief Ring of one thread
+ */
+typedef struct {
+    _Alignas(64) atomic_uint head;      /**< Records written, the owner stores it after each record */
+    char            name[NAME_LEN];     /**< Thread name in the export */
+    _Alignas(64) trace_record_t records[TRACE_RING_RECORDS];   /**< Own cache lines, no false sharing with the next ring */
+} TraceRing_t;
+
+static TraceRing_t rings[TRACE_MAX_THREADS];
+static atomic_uint rings_claimed;
+static atomic_bool enabled = true;
+static atomic_flag dumping = ATOMIC_FLAG_INIT;
+static uint64_t origin_ns;             /**< Clock when the first ring was claimed */
+static atomic_uint_fast64_t origin_ticks;   /**< Ticks at origin_ns, stored after it, 0 until then */
+
+static _Thread_local TraceRing_t *my_ring;
+static _Thread_local bool my_ring_denied;
+
+// Copy of one ring for the export, the rings keep being written meanwhile
+static trace_record_t snapshot[TRACE_RING_RECORDS];
+
+// ====================== Private Functions ======================
+
+/* Own clock: monotonic_now_ns() keeps state for one thread, records come from several */
+static inline uint64_t clock_ns(void) {
+#if defined(TRACE_CLOCK_POSIX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * MONOTONIC_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+#elif defined(TRACE_CLOCK_QPC)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * MONOTONIC_NS_PER_SEC +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * MONOTONIC_NS_PER_SEC / (uint64_t)freq.QuadPart;
+#else
+    return monotonic_now_ns();
+#endif
+}
+
+static inline uint64_t ticks(void) {
+#if TRACE_TICKS_TSC
+    return __rdtsc();
+#else
+    return clock_ns();
+#endif
+}
+
+static TraceRing_t *ring_claim(void) {
+    unsigned int n;
+
+    if (my_ring_denied) {
+        return NULL;
+    }
+    n = atomic_fetch_add_explicit(&rings_claimed, 1u, memory_order_acq_rel);
+    if (n >= TRACE_MAX_THREADS) {
+        my_ring_denied = true;
+        return NULL;
+    }
+    // The first thread to record sets time zero
+    if (n == 0) {
+        origin_ns = clock_ns();
+        atomic_store_explicit(&origin_ticks, ticks(), memory_order_release);
+    }
+    my_ring = &rings[n];
+    return my_ring;
+}
+
+/* Records of a ring that are whole: head read before and after the copy */
+static uint32_t ring_copy(TraceRing_t *ring, uint32_t *first) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t start = (head > TRACE_RING_RECORDS) ? head - TRACE_RING_RECORDS : 0;
+
+    for (uint32_t i = start; i < head; i++) {
+        snapshot[i & RING_MASK] = ring->records[i & RING_MASK];
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    // The owner may have lapped us: its slot for record h is the one of h - RECORDS
+    uint32_t later = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (later - start >= TRACE_RING_RECORDS) {
+        start = later - TRACE_RING_RECORDS + 1u;
+    }
+    *first = start;
+    return (head > start) ? head - start : 0;
+}
+
+/* Nanoseconds per tick, measured over the time since the origin */
+static double ns_per_tick(uint64_t origin) {
+#if TRACE_TICKS_TSC
+    uint64_t dt = ticks() - origin;
+    uint64_t dns = clock_ns() - origin_ns;
+
+    return (dt != 0 && dns != 0) ? (double)dns / (double)dt : 1.0;
+#else
+    (void)origin;
+    return 1.0;
+#endif
+}
+
+static void write_ts(FILE *f, uint64_t ts, uint64_t origin, double scale) {
+    // Microseconds, the unit of the format; a thread may have stamped a record just before the origin
+    uint64_t ns = (ts > origin) ? (uint64_t)((double)(ts - origin) * scale) : 0;
+    fprintf(f, "%llu.%03u", (unsigned long long)(ns / 1000u), (unsigned)(ns % 1000u));
+}
+
+// ====================== Public API ======================
+
+void trace_record(uint8_t id, uint8_t ph, uint32_t arg) {
+    TraceRing_t *ring = my_ring;
+    uint32_t head;
+    trace_record_t *rec;
+
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) {
+        return;
+    }
+    if (ring == NULL && (ring = ring_claim()) == NULL) {
+        return;
+    }
+
+    // Only this thread moves the head, a plain load and store suffice
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    rec = &ring->records[head & RING_MASK];
+    rec->ts = ticks();
+    rec->arg = arg;
+    rec->id = id;
+    rec->ph = ph;
+    atomic_store_explicit(&ring->head, head + 1u, memory_order_release);
+}
+
+void trace_set_thread_name(const char *name) {
+    TraceRing_t *ring = my_ring ? my_ring : ring_claim();
+
+    if (ring != NULL) {
+        strncpy(ring->name, name, NAME_LEN - 1u);
+        ring->name[NAME_LEN - 1u] = '\0';
+    }
+}
+
+void trace_set_enabled(bool on) {
+    atomic_store_explicit(&enabled, on, memory_order_relaxed);
+}
+
+uint64_t trace_get_count(void) {
+    uint32_t n = atomic_load_explicit(&rings_claimed, memory_order_acquire);
+    uint64_t count = 0;
+
+    for (uint32_t r = 0; r < n && r < TRACE_MAX_THREADS; r++) {
+        count += atomic_load_explicit(&rings[r].head, memory_order_relaxed);
+    }
+    return count;
+}
+
+bool trace_write_json(FILE *f) {
+    uint64_t origin;
+    double scale;
+    uint32_t n;
+    bool comma = false;
+
+    if (atomic_flag_test_and_set(&dumping)) {
+        return false;
+    }
+    origin = atomic_load_explicit(&origin_ticks, memory_order_acquire);
+    scale = ns_per_tick(origin);
+    // No origin yet: the first ring is being claimed, nothing is recorded
+    n = origin ? atomic_load_explicit(&rings_claimed, memory_order_acquire) : 0;
+    if (n > TRACE_MAX_THREADS) n = TRACE_MAX_THREADS;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (uint32_t r = 0; r < n; r++) {
+        uint32_t first;
+        uint32_t count = ring_copy(&rings[r], &first);
+        uint32_t depth = 0;
+
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                comma ? ",\n" : "", r + 1u, rings[r].name[0] ? rings[r].name : "thread");
+        comma = true;
+
+        for (uint32_t i = first; i < first + count; i++) {
+            const trace_record_t *rec = &snapshot[i & RING_MASK];
+            const TraceIdInfo_t *info;
+            static const char ph_char[] = { 'B', 'E', 'i' };
+
+            if (rec->id >= TRACE_ID_COUNT || rec->ph > TRACE_PH_INSTANT) continue;
+            // The begin of a span may have been overwritten, its end alone would close an outer one
+            if (rec->ph == TRACE_PH_END && depth == 0) continue;
+            depth += (rec->ph == TRACE_PH_BEGIN) - (rec->ph == TRACE_PH_END);
+
+            info = &id_info[rec->id];
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":",
+                    info->name, info->cat, ph_char[rec->ph], r + 1u);
+            write_ts(f, rec->ts, origin, scale);
+            if (rec->ph == TRACE_PH_INSTANT) {
+                fprintf(f, ",\"s\":\"t\"");
+            }
+            if (info->arg != NULL && rec->ph != TRACE_PH_BEGIN) {
+                fprintf(f, ",\"args\":{\"%s\":%u}", info->arg, (unsigned)rec->arg);
+            }
+            fputc('}', f);
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    atomic_flag_clear(&dumping);
+    return !ferror(f);
+}
+
+#else // !POMODORO_TRACE
+
+void trace_record(uint8_t id, uint8_t ph, uint32_t arg) {
+    (void)id;
+    (void)ph;
+    (void)arg;
+}
+
+void trace_set_thread_name(const char *name) {
+    (void)name;
+}
+
+void trace_set_enabled(bool on) {
+    (void)on;
+}
+
+uint64_t trace_get_count(void) {
+    return 0;
+}
+
+bool trace_write_json(FILE *f) {
+    (void)f;
+    return false;
+}
+
+#endif // POMODORO_TRACE
+
+bool trace_dump_json(const char *path) {
+    FILE *f;
+    bool ok;
+
+    if (!POMODORO_TRACE) {
+        return false;
+    }
+    f = fopen(path, "w");
+    if (f == NULL) {
+        return false;
+    }
+    ok = trace_write_json(f);
+    return (fclose(f) == 0) && ok;
+}
+
+const char *trace_id_name(trace_id_e id) {
+    return ((unsigned)id < TRACE_ID_COUNT) ? id_info[id].name : "UNKNOWN";
+}
@@ -0,0 +1,127 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @file trace.h
+ * @brief Flight recorder of timing events, exported as Chrome trace JSON.
+ *
+ * Every thread that records gets its own ring of TRACE_RING_RECORDS binary
+ * records (timestamp, event, phase, argument; 16 bytes), claimed on its first
+ * event. Only that thread writes its ring: a record is one read of the time
+ * stamp counter (the clock where there is none), four stores and a release
+ * store of the ring head, no lock and no atomic read-modify-write. The oldest records are overwritten, so the rings always
+ * hold the last moments before a problem was noticed.
+ *
+ * trace_dump_json() copies the rings while they are written (a record that
+ * was overwritten during the copy is dropped) and writes them as Chrome trace
+ * event JSON, which chrome://tracing and ui.perfetto.dev open as is.
+ *
+ * Compiled in with POMODORO_TRACE=1 (CMake option POMODORO_TRACE). Without
+ * it the TRACE_* macros expand to nothing, arguments included, and the
+ * functions below are stubs that record nothing.
+ */
+
+#ifndef POMODORO_TRACE
+#define POMODORO_TRACE          0
+#endif
+
+/** Records per thread, power of 2 */
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS      4096u
+#endif
+
+/** Threads that can record, later ones are ignored */
+#ifndef TRACE_MAX_THREADS
+#define TRACE_MAX_THREADS       4u
+#endif
+
+#if (TRACE_RING_RECORDS & (TRACE_RING_RECORDS - 1u)) != 0
+#error "TRACE_RING_RECORDS must be a power of 2"
+#endif
+
+/**
+ * @brief What a record is about
+ */
+typedef enum {
+    TRACE_STATE,            /**< Instant: the default session changed state, arg = PomodoroState_e */
+    TRACE_TIMER_TICK,       /**< Span: timer_tick_handler() with timers armed, arg = callbacks delivered */
+    TRACE_UI_STATE_CB,      /**< Span: state callback of the UI, arg = PomodoroState_e */
+    TRACE_UI_TICK_CB,       /**< Span: tick callback of the UI, arg = remaining ms */
+    TRACE_LV_TIMER,         /**< Span: one lv_timer_handler() iteration, arg = ms until it wants to run again */
+    TRACE_FLUSH,            /**< Span: the display driver flushing an area, arg = pixels */
+    TRACE_ID_COUNT
+} trace_id_e;
+
+/**
+ * @brief Kind of record, as in the Chrome trace format
+ */
+typedef enum {
+    TRACE_PH_BEGIN,         /**< Start of a span */
+    TRACE_PH_END,           /**< End of the innermost open span */
+    TRACE_PH_INSTANT,       /**< A point in time */
+} trace_phase_e;
+
+/**
+ * @brief One record
+ */
+typedef struct {
+    uint64_t ts;            /**< Clock ticks: time stamp counter on x86, ns elsewhere */
+    uint32_t arg;           /**< Meaning depends on the event, see trace_id_e */
+    uint8_t  id;            /**< trace_id_e */
+    uint8_t  ph;            /**< trace_phase_e */
+    uint16_t reserved;
+} trace_record_t;
+
+#if POMODORO_TRACE
+  #define TRACE_BEGIN(id)               trace_record((id), TRACE_PH_BEGIN, 0)
+  #define TRACE_END(id, arg)            trace_record((id), TRACE_PH_END, (uint32_t)(arg))
+  #define TRACE_INSTANT(id, arg)        trace_record((id), TRACE_PH_INSTANT, (uint32_t)(arg))
+  #define TRACE_THREAD_NAME(name)       trace_set_thread_name(name)
+#else
+  #define TRACE_BEGIN(id)               ((void)0)
+  #define TRACE_END(id, arg)            ((void)0)
+  #define TRACE_INSTANT(id, arg)        ((void)0)
+  #define TRACE_THREAD_NAME(name)       ((void)0)
+#endif
+
+/**
+ * @brief Append a record to the calling thread's ring, use the TRACE_* macros
+ */
+void trace_record(uint8_t id, uint8_t ph, uint32_t arg);
+
+/**
+ * @brief Name the calling thread in the exported trace: plain ASCII, at most 15 characters kept
+ */
+void trace_set_thread_name(const char *name);
+
+/**
+ * @brief Pause or continue recording, on at startup
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * @brief Records written so far by all threads, overwritten ones included
+ */
+uint64_t trace_get_count(void);
+
+/**
+ * @brief Write the rings as Chrome trace JSON (any thread, one dump at a time)
+ * @return false if tracing is compiled out, another dump is running or the write failed
+ */
+bool trace_write_json(FILE *f);
+
+/**
+ * @brief trace_write_json() to a new file
+ */
+bool trace_dump_json(const char *path);
+
+/**
+ * @brief Name of an event, as it appears in the trace
+ */
+const char *trace_id_name(trace_id_e id);
+
+#endif // TRACE_H
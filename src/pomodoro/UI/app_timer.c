@@ -0,0 +1,93 @@
+#include <stdbool.h>
+#include "lvgl.h"
+#include "app_timer.h"
+
+typedef struct AppTimer_s {
+    struct AppTimer_s *next;
+    lv_timer_t *timer;
+    lv_timer_cb_t cb;
+    uint32_t period_ms;
+    uint32_t last_run;              // lv_tick_get() when created or last run
+    bool paused;
+} AppTimer_t;
+
+static AppTimer_t *app_timers;
+
+static void app_timer_cb(lv_timer_t *timer)
+{
+    AppTimer_t *at = lv_timer_get_user_data(timer);
+
+    // LVGL restarts the period as it runs the timer, before the callback
+    at->last_run = lv_tick_get();
+    at->cb(timer);
+}
+
+lv_timer_t *app_timer_create(lv_timer_cb_t cb, uint32_t period_ms)
+{
+    AppTimer_t *at = lv_malloc_zeroed(sizeof(AppTimer_t));
+
+    if (!at) return NULL;
+    at->timer = lv_timer_create(app_timer_cb, period_ms, at);
+    if (!at->timer) {
+        lv_free(at);
+        return NULL;
+    }
+    at->cb = cb;
+    at->period_ms = period_ms;
+    at->last_run = lv_tick_get();
+    at->next = app_timers;
+    app_timers = at;
+    return at->timer;
+}
+
+void app_timer_delete(lv_timer_t *timer)
+{
+    for (AppTimer_t **link = &app_timers; *link; link = &(*link)->next) {
+        AppTimer_t *at = *link;
+
+        if (at->timer == timer) {
+            *link = at->next;
+            lv_timer_delete(timer);
+            lv_free(at);
+            return;
+        }
+    }
+}
+
+void app_timer_pause(lv_timer_t *timer)
+{
+    AppTimer_t *at = lv_timer_get_user_data(timer);
+
+    at->paused = true;
+    lv_timer_pause(timer);
+}
+
+void app_timer_resume(lv_timer_t *timer)
+{
+    AppTimer_t *at = lv_timer_get_user_data(timer);
+
+    at->paused = false;
+    lv_timer_resume(timer);
+}
+
+void app_timer_set_period(lv_timer_t *timer, uint32_t period_ms)
+{
+    AppTimer_t *at = lv_timer_get_user_data(timer);
+
+    at->period_ms = period_ms;
+    lv_timer_set_period(timer, period_ms);
+}
+
+uint32_t app_timer_wait_ms(void)
+{
+    uint32_t wait_ms = LV_NO_TIMER_READY;
+
+    for (AppTimer_t *at = app_timers; at; at = at->next) {
+        if (at->paused) continue;
+
+        uint32_t elapsed_ms = lv_tick_elaps(at->last_run);
+        uint32_t left_ms = (elapsed_ms >= at->period_ms) ? 0 : at->period_ms - elapsed_ms;
+        if (left_ms < wait_ms) wait_ms = left_ms;
+    }
+    return wait_ms;
+}
@@ -0,0 +1,33 @@
+#ifndef __H_APP_TIMER_H__
+#define __H_APP_TIMER_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * App timers: the lv_timers the app creates itself (ring frames, screen
+ * refreshes, the profiler overlay), kept on a list of their own. In IDLE and
+ * paused the main loop sleeps until the next of them is due; LVGL's own
+ * timers (display refresh, input reads, SDL events) only have work after an
+ * SDL event or an invalidation, which wakes the loop anyway.
+ *
+ * The due time is tracked here from the period and the last run, LVGL's
+ * timer fields are not read. Pause, resume, period and delete go through
+ * these functions. The callback gets its lv_timer_t as usual, but the
+ * timer's user data is the list entry.
+ */
+
+/* A repeating timer, cb runs every period_ms. NULL without memory */
+lv_timer_t *app_timer_create(lv_timer_cb_t cb, uint32_t period_ms);
+
+/* Delete a timer of app_timer_create(), also from its own callback */
+void app_timer_delete(lv_timer_t *timer);
+
+void app_timer_pause(lv_timer_t *timer);
+void app_timer_resume(lv_timer_t *timer);
+void app_timer_set_period(lv_timer_t *timer, uint32_t period_ms);
+
+/* ms until the next app timer runs, 0 if one is due, LV_NO_TIMER_READY if none is running */
+uint32_t app_timer_wait_ms(void);
+
+#endif/* __H_APP_TIMER_H__ */
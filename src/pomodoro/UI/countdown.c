@@ -0,0 +1,322 @@
+#include <string.h>
+#include "lvgl.h"
+#include "countdown.h"
+
+#define COUNTDOWN_GLYPHS        11  /* 0-9 and ':' */
+#define COUNTDOWN_COLON         10
+
+typedef struct {
+    const lv_font_t *font;
+    uint32_t color;                 // lv_color_to_u32() of the glyphs
+    uint32_t refs;                  // Countdowns drawing from it, 0 = cached
+    int32_t cell_w;                 // Digit cell: widest digit advance
+    int32_t colon_w;
+    int32_t cell_h;                 // Line height of the font
+    lv_draw_buf_t *buf;             // Glyphs stacked top to bottom, NULL = not allocated
+    lv_image_dsc_t glyph[COUNTDOWN_GLYPHS];    // One image per cell, into buf
+} CountdownAtlas_t;
+
+typedef struct {
+    const lv_font_t *font;
+    lv_color_t color;
+    CountdownAtlas_t *atlas;        // NULL: cells are drawn as text
+    char text[COUNTDOWN_MAX_CELLS + 1];
+} Countdown_t;
+
+static CountdownAtlas_t atlases[COUNTDOWN_MAX_ATLASES];
+static const char *const glyph_text[COUNTDOWN_GLYPHS] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ":"
+};
+
+static int32_t glyph_index(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c == ':') return COUNTDOWN_COLON;
+    return -1;
+}
+
+static int32_t digit_width(const lv_font_t *font)
+{
+    int32_t w = 0;
+
+    for (char c = '0'; c <= '9'; c++) {
+        int32_t g = (int32_t)lv_font_get_glyph_width(font, (uint32_t)c, 0);
+        if (g > w) w = g;
+    }
+    return w;
+}
+
+static int32_t cell_width(const Countdown_t *cd, char c)
+{
+    if (cd->atlas) return (c == ':') ? cd->atlas->colon_w : cd->atlas->cell_w;
+    return (c == ':') ? (int32_t)lv_font_get_glyph_width(cd->font, ':', 0) : digit_width(cd->font);
+}
+
+/* Draw the glyphs into the atlas through a canvas that is deleted afterwards */
+static void atlas_paint(CountdownAtlas_t *atlas)
+{
+    lv_obj_t *canvas = lv_canvas_create(lv_layer_sys());
+    lv_layer_t layer;
+
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, atlas->buf);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+    lv_canvas_init_layer(canvas, &layer);
+
+    for (int32_t i = 0; i < COUNTDOWN_GLYPHS; i++) {
+        lv_draw_label_dsc_t dsc;
+        lv_area_t area;
+
+        lv_draw_label_dsc_init(&dsc);
+        dsc.font = atlas->font;
+        dsc.color = lv_color_hex(atlas->color & 0xFFFFFFu);
+        dsc.align = LV_TEXT_ALIGN_CENTER;
+        dsc.text = glyph_text[i];
+        area.x1 = 0;
+        area.y1 = i * atlas->cell_h;
+        area.x2 = ((i == COUNTDOWN_COLON) ? atlas->colon_w : atlas->cell_w) - 1;
+        area.y2 = area.y1 + atlas->cell_h - 1;
+        lv_draw_label(&layer, &dsc, &area);
+    }
+
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_obj_delete(canvas);
+}
+
+static void atlas_free(CountdownAtlas_t *atlas)
+{
+    // A new atlas may get the same addresses: the image cache must not hand out these cells
+    for (int32_t i = 0; i < COUNTDOWN_GLYPHS; i++) {
+        lv_image_cache_drop(&atlas->glyph[i]);
+    }
+    lv_draw_buf_destroy(atlas->buf);
+    lv_memzero(atlas, sizeof(*atlas));
+}
+
+/* The atlas of font and color, painted on first use, NULL if there is no room */
+static CountdownAtlas_t *atlas_acquire(const lv_font_t *font, lv_color_t color)
+{
+    uint32_t key = lv_color_to_u32(color);
+    CountdownAtlas_t *slot = NULL;
+    CountdownAtlas_t *atlas;
+
+    for (uint32_t i = 0; i < COUNTDOWN_MAX_ATLASES; i++) {
+        atlas = &atlases[i];
+        if (atlas->buf && atlas->font == font && atlas->color == key) {
+            atlas->refs++;
+            return atlas;
+        }
+        // A free slot, else a cached atlas nobody uses
+        if (!atlas->buf) slot = atlas;
+        else if (atlas->refs == 0 && (!slot || slot->buf)) slot = atlas;
+    }
+    if (!slot) return NULL;
+    if (slot->buf) atlas_free(slot);
+
+    atlas = slot;
+    atlas->font = font;
+    atlas->color = key;
+    atlas->cell_w = digit_width(font);
+    atlas->colon_w = (int32_t)lv_font_get_glyph_width(font, ':', 0);
+    atlas->cell_h = lv_font_get_line_height(font);
+    atlas->buf = lv_draw_buf_create((uint32_t)LV_MAX(atlas->cell_w, atlas->colon_w),
+                                    (uint32_t)(atlas->cell_h * COUNTDOWN_GLYPHS),
+                                    LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    if (!atlas->buf) {
+        LV_LOG_WARN("countdown: no memory for a %dx%d atlas", (int)atlas->cell_w, (int)atlas->cell_h);
+        lv_memzero(atlas, sizeof(*atlas));
+        return NULL;
+    }
+    atlas_paint(atlas);
+
+    for (int32_t i = 0; i < COUNTDOWN_GLYPHS; i++) {
+        lv_image_dsc_t *g = &atlas->glyph[i];
+
+        g->header.magic = LV_IMAGE_HEADER_MAGIC;
+        g->header.cf = LV_COLOR_FORMAT_ARGB8888;
+        g->header.w = (uint32_t)((i == COUNTDOWN_COLON) ? atlas->colon_w : atlas->cell_w);
+        g->header.h = (uint32_t)atlas->cell_h;
+        g->header.stride = atlas->buf->header.stride;
+        g->data_size = atlas->buf->header.stride * (uint32_t)atlas->cell_h;
+        g->data = atlas->buf->data + (uint32_t)i * g->data_size;
+    }
+    atlas->refs = 1;
+    return atlas;
+}
+
+static void atlas_release(CountdownAtlas_t *atlas)
+{
+    if (atlas && atlas->refs) atlas->refs--;
+}
+
+static void countdown_update_size(lv_obj_t *obj, const Countdown_t *cd)
+{
+    int32_t w = 0;
+
+    for (const char *c = cd->text; *c; c++) w += cell_width(cd, *c);
+    lv_obj_set_size(obj, w, lv_font_get_line_height(cd->font));
+}
+
+static void countdown_draw(lv_obj_t *obj, const Countdown_t *cd, lv_layer_t *layer)
+{
+    lv_area_t coords;
+    lv_area_t cell;
+
+    lv_obj_get_coords(obj, &coords);
+    cell.x1 = coords.x1;
+    cell.y1 = coords.y1;
+    cell.y2 = coords.y2;
+
+    for (const char *c = cd->text; *c; c++) {
+        int32_t g = glyph_index(*c);
+
+        cell.x2 = cell.x1 + cell_width(cd, *c) - 1;
+        if (g >= 0 && cd->atlas) {
+            lv_draw_image_dsc_t dsc;
+
+            lv_draw_image_dsc_init(&dsc);
+            lv_obj_init_draw_image_dsc(obj, LV_PART_MAIN, &dsc);
+            dsc.src = &cd->atlas->glyph[g];
+            lv_draw_image(layer, &dsc, &cell);
+        }
+        else if (g >= 0) {
+            lv_draw_label_dsc_t dsc;
+
+            lv_draw_label_dsc_init(&dsc);
+            lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+            dsc.font = cd->font;
+            dsc.color = cd->color;
+            dsc.align = LV_TEXT_ALIGN_CENTER;
+            dsc.text = glyph_text[g];
+            lv_draw_label(layer, &dsc, &cell);
+        }
+        cell.x1 = cell.x2 + 1;
+    }
+}
+
+static void countdown_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    Countdown_t *cd = lv_obj_get_user_data(obj);
+
+    if (!cd) return;
+    if (lv_event_get_code(e) == LV_EVENT_DRAW_MAIN) {
+        countdown_draw(obj, cd, lv_event_get_layer(e));
+    }
+    else if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+        atlas_release(cd->atlas);
+        lv_free(cd);
+        lv_obj_set_user_data(obj, NULL);
+    }
+}
+
+lv_obj_t *countdown_create(lv_obj_t *parent, const lv_font_t *font, lv_color_t color)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    Countdown_t *cd = lv_malloc_zeroed(sizeof(Countdown_t));
+
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    if (!cd) return obj;
+
+    cd->font = font;
+    cd->color = color;
+    cd->atlas = atlas_acquire(font, color);
+    strcpy(cd->text, "00:00");
+    lv_obj_set_user_data(obj, cd);
+    lv_obj_add_event_cb(obj, countdown_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, countdown_event_cb, LV_EVENT_DELETE, NULL);
+    countdown_update_size(obj, cd);
+    return obj;
+}
+
+void countdown_set_text(lv_obj_t *obj, const char *text)
+{
+    Countdown_t *cd = lv_obj_get_user_data(obj);
+    size_t len = 0;
+    lv_area_t coords;
+    lv_area_t cell;
+    bool same_layout;
+
+    if (!cd) return;
+    while (len < COUNTDOWN_MAX_CELLS && text[len]) len++;
+
+    // Cells keep their place only if the colons do
+    same_layout = strlen(cd->text) == len;
+    for (size_t i = 0; same_layout && i < len; i++) {
+        same_layout = (text[i] == ':') == (cd->text[i] == ':');
+    }
+    if (!same_layout) {
+        memcpy(cd->text, text, len);
+        cd->text[len] = '\0';
+        countdown_update_size(obj, cd);
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    lv_obj_get_coords(obj, &coords);
+    cell.x1 = coords.x1;
+    cell.y1 = coords.y1;
+    cell.y2 = coords.y2;
+    for (size_t i = 0; i < len; i++) {
+        cell.x2 = cell.x1 + cell_width(cd, text[i]) - 1;
+        if (text[i] != cd->text[i]) {
+            cd->text[i] = text[i];
+            lv_obj_invalidate_area(obj, &cell);
+        }
+        cell.x1 = cell.x2 + 1;
+    }
+}
+
+void countdown_set_seconds(lv_obj_t *obj, uint32_t seconds)
+{
+    char buf[COUNTDOWN_MAX_CELLS + 1];
+    char digits[5];
+    uint32_t minutes = seconds / 60u;
+    size_t n = 0;
+    char *p = buf;
+
+    // Past the 71582 minutes of the Core's uint32_t ms, the cells run out
+    if (minutes > 99999u) {
+        minutes = 99999u;
+        seconds = 59u;
+    }
+
+    // "%02u:%02u" without a printf on every tick
+    do {
+        digits[n++] = (char)('0' + minutes % 10u);
+        minutes /= 10u;
+    } while (minutes != 0u || n < 2u);
+    while (n > 0u) *p++ = digits[--n];
+    *p++ = ':';
+    *p++ = (char)('0' + seconds % 60u / 10u);
+    *p++ = (char)('0' + seconds % 10u);
+    *p = '\0';
+    countdown_set_text(obj, buf);
+}
+
+void countdown_set_color(lv_obj_t *obj, lv_color_t color)
+{
+    Countdown_t *cd = lv_obj_get_user_data(obj);
+    CountdownAtlas_t *atlas;
+
+    if (!cd || lv_color_eq(cd->color, color)) return;
+
+    // Take the new atlas before releasing the old one, so it is not the one evicted
+    atlas = atlas_acquire(cd->font, color);
+    atlas_release(cd->atlas);
+    cd->atlas = atlas;
+    cd->color = color;
+    countdown_update_size(obj, cd);
+    lv_obj_invalidate(obj);
+}
+
+uint32_t countdown_get_atlas_bytes(void)
+{
+    uint32_t bytes = 0;
+
+    for (uint32_t i = 0; i < COUNTDOWN_MAX_ATLASES; i++) {
+        if (atlases[i].buf) bytes += atlases[i].buf->data_size;
+    }
+    return bytes;
+}
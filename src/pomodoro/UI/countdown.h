@@ -0,0 +1,43 @@
+#ifndef __H_COUNTDOWN_H__
+#define __H_COUNTDOWN_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * Countdown: "MM:SS" from a pre-rendered atlas instead of a label.
+ *
+ * The digits 0-9 and ':' are drawn once per font and colour into an
+ * ARGB8888 atlas, one cell per glyph. Digit cells share the widest advance
+ * of the font, so the text does not move as digits change. Setting a new
+ * text invalidates only the cells that differ, usually the last one, and
+ * each cell is drawn as an image from the atlas: no label layout, no glyph
+ * lookup or font decompression on a tick.
+ *
+ * Atlases are shared by all countdowns of the same font and colour and kept
+ * after the last one is deleted, up to COUNTDOWN_MAX_ATLASES. If an atlas
+ * cannot be allocated the countdown draws its cells as text.
+ */
+
+#ifndef COUNTDOWN_MAX_ATLASES
+#define COUNTDOWN_MAX_ATLASES   6
+#endif
+
+#define COUNTDOWN_MAX_CELLS     8   /* "MMMMM:SS", the time_text of the view model */
+
+/* A countdown showing "00:00" */
+lv_obj_t *countdown_create(lv_obj_t *parent, const lv_font_t *font, lv_color_t color);
+
+/* Show text, digits and ':' only, other characters are left blank */
+void countdown_set_text(lv_obj_t *obj, const char *text);
+
+/* Show seconds as "MM:SS", minutes past 99 with all their digits, held at 99999:59 */
+void countdown_set_seconds(lv_obj_t *obj, uint32_t seconds);
+
+/* Redraw every cell in color, from its own atlas */
+void countdown_set_color(lv_obj_t *obj, lv_color_t color);
+
+/* Bytes held by the atlases, used or cached */
+uint32_t countdown_get_atlas_bytes(void);
+
+#endif/* __H_COUNTDOWN_H__ */
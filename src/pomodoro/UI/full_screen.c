@@ -1,9 +1,10 @@
 #include <stdint.h>
 #include "lvgl.h"
 #include "settings_screen.h"
+#include "countdown.h"
 
 static lv_obj_t *fullscreen_timer_cont = NULL;
-static lv_obj_t *fullscreen_timer_label = NULL;
+static lv_obj_t *fullscreen_countdown = NULL;
 
 static void ui_full_screen_set_bg_by_theme(lv_obj_t *parent);
 static void ui_full_screen_fade_in_obj(lv_obj_t *obj, uint32_t duration_ms);
@@ -17,21 +18,17 @@ void show_fullscreen_timer(lv_obj_t *parent)
     ui_full_screen_set_bg_by_theme(fullscreen_timer_cont);
     ui_full_screen_fade_in_obj(fullscreen_timer_cont, 2000); // Fade in over 2 seconds
 
-    fullscreen_timer_label = lv_label_create(fullscreen_timer_cont);
-    lv_obj_center(fullscreen_timer_label);
-    lv_obj_set_style_text_font(fullscreen_timer_label, &lv_font_montserrat_48, 0);
-    lv_label_set_text(fullscreen_timer_label, "00:00");
-    lv_obj_set_style_text_color(fullscreen_timer_label, lv_color_hex(0x008080), 0);
+    // Shows "00:00" until the first update
+    fullscreen_countdown = countdown_create(fullscreen_timer_cont, &lv_font_montserrat_48, lv_color_hex(0x008080));
+    lv_obj_center(fullscreen_countdown);
     lv_obj_move_foreground(fullscreen_timer_cont);
 }
 
 void update_fullscreen_timer(uint32_t remaining)
 {
-    remaining /= 1000; // Convert ms to seconds
-    if (!fullscreen_timer_label) return;
-    char buf[8];
-    lv_snprintf(buf, sizeof(buf), "%02d:%02d", remaining / 60, remaining % 60);
-    lv_label_set_text(fullscreen_timer_label, buf);
+    if (!fullscreen_countdown) return;
+    // Redraws only the digits that changed
+    countdown_set_seconds(fullscreen_countdown, remaining / 1000);
 }
 
 void hide_fullscreen_timer(void)
@@ -39,10 +36,15 @@ void hide_fullscreen_timer(void)
     if (fullscreen_timer_cont) {
         lv_obj_del(fullscreen_timer_cont);
         fullscreen_timer_cont = NULL;
-        fullscreen_timer_label = NULL;
+        fullscreen_countdown = NULL;
     }
 }
 
+bool is_fullscreen_timer_shown(void)
+{
+    return fullscreen_timer_cont != NULL;
+}
+
 static void ui_full_screen_set_bg_by_theme(lv_obj_t *parent)
 {
     if (ui_get_theme() == POMO_DARK_THEME) {
@@ -0,0 +1,180 @@
+#include <stddef.h>
+#include "history_model.h"
+#include "pomodoro_stats.h"
+
+/* Weeks the stats window can hold */
+#define HISTORY_MAX_WEEKS   (POMODORO_STATS_DAYS / 7u + 2u)
+
+static uint32_t weekly_min[HISTORY_MAX_WEEKS];
+static uint32_t chart_idx[HISTORY_CHART_POINTS];
+
+/* 1970-01-01, day 0, was a Thursday */
+static int32_t monday_of(int32_t day)
+{
+    int32_t weekday = (day + 3) % 7;
+
+    if (weekday < 0) weekday += 7;
+    return day - weekday;
+}
+
+void history_model_date(int32_t day, int32_t *year, uint32_t *month, uint32_t *mday)
+{
+    // Days since 1970-01-01 to the civil calendar, in 400 year eras from 0000-03-01
+    int32_t z = day + 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+
+    *mday = doy - (153 * mp + 2) / 5 + 1;
+    *month = (mp < 10) ? mp + 3 : mp - 9;
+    *year = (int32_t)yoe + era * 400 + (*month <= 2);
+}
+
+uint8_t history_model_level(uint32_t sessions)
+{
+    if (sessions == 0) return 0;
+    if (sessions <= 2) return 1;
+    if (sessions <= 5) return 2;
+    if (sessions <= 8) return 3;
+    return 4;
+}
+
+uint32_t history_model_lttb(const uint32_t *y, uint32_t n, uint32_t *out_idx, uint32_t out_max)
+{
+    uint32_t count = 0;
+    uint32_t a = 0;
+
+    if (n <= out_max || out_max < 3) {
+        n = (n < out_max) ? n : out_max;
+        for (uint32_t i = 0; i < n; i++) out_idx[i] = i;
+        return n;
+    }
+
+    // Buckets between the first and the last point, each keeps the point that spans
+    // the largest triangle with the point kept before it and the next bucket's average
+    double every = (double)(n - 2) / (double)(out_max - 2);
+
+    out_idx[count++] = 0;
+    for (uint32_t b = 0; b < out_max - 2; b++) {
+        uint32_t start = (uint32_t)(b * every) + 1;
+        uint32_t end = (uint32_t)((b + 1) * every) + 1;
+        uint32_t next_end = (uint32_t)((b + 2) * every) + 1;
+        double avg_x = 0, avg_y = 0, max_area = -1;
+        uint32_t pick = start;
+
+        if (next_end > n) next_end = n;
+        for (uint32_t j = end; j < next_end; j++) {
+            avg_x += j;
+            avg_y += y[j];
+        }
+        if (next_end > end) {
+            avg_x /= (double)(next_end - end);
+            avg_y /= (double)(next_end - end);
+        }
+        else {
+            avg_x = n - 1;
+            avg_y = y[n - 1];
+        }
+
+        for (uint32_t j = start; j < end; j++) {
+            double area = ((double)a - avg_x) * ((double)y[j] - y[a]) - ((double)a - j) * (avg_y - y[a]);
+            if (area < 0) area = -area;
+            if (area > max_area) {
+                max_area = area;
+                pick = j;
+            }
+        }
+        out_idx[count++] = pick;
+        a = pick;
+    }
+    out_idx[count++] = n - 1;
+    return count;
+}
+
+static void build(HistoryModel_t *model)
+{
+    int32_t first, last;
+
+    model->today = pomodoro_stats_today();
+    model->first_day = monday_of(model->today) - (HISTORY_HEATMAP_WEEKS - 1) * 7;
+
+    for (int32_t i = 0; i < HISTORY_HEATMAP_CELLS; i++) {
+        int32_t day = model->first_day + i;
+        model->level[i] = (day > model->today)
+                          ? HISTORY_LEVEL_FUTURE
+                          : history_model_level(pomodoro_stats_range(day, day).sessions);
+    }
+
+    PomodoroStatsRange_t year = pomodoro_stats_range(model->first_day, model->today);
+    model->year_sessions = year.sessions;
+    model->year_focus_s = year.focus_s;
+    model->current_streak = pomodoro_stats_current_streak();
+    model->longest_streak = pomodoro_stats_longest_streak();
+
+    model->weeks = 0;
+    model->chart_count = 0;
+    if (!pomodoro_stats_span(&first, &last)) {
+        return;
+    }
+    int32_t last_monday = monday_of(model->today > last ? model->today : last);
+    int32_t first_monday = monday_of(first);
+    uint32_t weeks = (uint32_t)(last_monday - first_monday) / 7u + 1u;
+
+    if (weeks > HISTORY_MAX_WEEKS) {
+        weeks = HISTORY_MAX_WEEKS;
+        first_monday = last_monday - (int32_t)(weeks - 1u) * 7;
+    }
+    for (uint32_t w = 0; w < weeks; w++) {
+        int32_t monday = first_monday + (int32_t)w * 7;
+        weekly_min[w] = pomodoro_stats_range(monday, monday + 6).focus_s / 60u;
+    }
+    model->weeks = weeks;
+    model->chart_count = history_model_lttb(weekly_min, weeks, chart_idx, HISTORY_CHART_POINTS);
+    for (uint32_t i = 0; i < model->chart_count; i++) {
+        model->chart_week[i] = first_monday + (int32_t)chart_idx[i] * 7;
+        model->chart_focus_min[i] = weekly_min[chart_idx[i]];
+    }
+}
+
+void history_model_build(HistoryModel_t *model)
+{
+    uint32_t seq;
+
+    // The Core may add a session meanwhile (threaded runtime), then read again
+    do {
+        seq = pomodoro_stats_read_begin();
+        build(model);
+    } while (pomodoro_stats_read_retry(seq));
+    model->stats_changes = seq;
+}
+
+static void fill(uint16_t *px, uint32_t stride_px, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint16_t color)
+{
+    for (uint32_t row = y; row < y + h; row++) {
+        uint16_t *p = px + (size_t)row * stride_px + x;
+        for (uint32_t col = 0; col < w; col++) p[col] = color;
+    }
+}
+
+uint32_t history_model_paint_tile(uint16_t *px, uint32_t stride_px, const HistoryModel_t *model,
+                                  uint8_t *cached, const uint16_t palette[HISTORY_HEATMAP_LEVELS + 1], bool full)
+{
+    const uint32_t pitch = HISTORY_CELL_PX + HISTORY_CELL_GAP_PX;
+    uint32_t painted = 0;
+
+    if (full) {
+        fill(px, stride_px, 0, 0, HISTORY_TILE_W, HISTORY_TILE_H, palette[HISTORY_HEATMAP_LEVELS]);
+    }
+    for (uint32_t i = 0; i < HISTORY_HEATMAP_CELLS; i++) {
+        uint8_t level = model->level[i];
+
+        if (!full && cached[i] == level) continue;
+        cached[i] = level;
+        fill(px, stride_px, (i / 7u) * pitch, (i % 7u) * pitch, HISTORY_CELL_PX, HISTORY_CELL_PX,
+             palette[level == HISTORY_LEVEL_FUTURE ? HISTORY_HEATMAP_LEVELS : level]);
+        painted++;
+    }
+    return painted;
+}
@@ -0,0 +1,64 @@
+#ifndef __H_HISTORY_MODEL_H__
+#define __H_HISTORY_MODEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * What the history screen shows, built from the stats index without LVGL:
+ * the heatmap levels of the last 53 weeks, and the focus time of every week
+ * of the history, downsampled with LTTB to at most HISTORY_CHART_POINTS bars.
+ * Building takes a few hundred range queries of O(log days) each, whatever
+ * the size of the history.
+ */
+
+#define HISTORY_HEATMAP_WEEKS   53
+#define HISTORY_HEATMAP_CELLS   (HISTORY_HEATMAP_WEEKS * 7)
+#define HISTORY_HEATMAP_LEVELS  5
+#define HISTORY_CHART_POINTS    48
+
+/* Heatmap tile: one cell per day, a column per week, Monday on top */
+#define HISTORY_CELL_PX         7
+#define HISTORY_CELL_GAP_PX     1
+#define HISTORY_TILE_W          (HISTORY_HEATMAP_WEEKS * (HISTORY_CELL_PX + HISTORY_CELL_GAP_PX))
+#define HISTORY_TILE_H          (7 * (HISTORY_CELL_PX + HISTORY_CELL_GAP_PX))
+
+/* Level stored for days after today, they are left blank */
+#define HISTORY_LEVEL_FUTURE    0xFF
+
+typedef struct {
+    int32_t  first_day;                             // Monday of the first column
+    int32_t  today;
+    uint32_t stats_changes;                         // pomodoro_stats_change_count() it was built from
+    uint8_t  level[HISTORY_HEATMAP_CELLS];          // Column major: week * 7 + weekday
+    uint32_t year_sessions;
+    uint32_t year_focus_s;
+    uint32_t current_streak;
+    uint32_t longest_streak;
+    uint32_t weeks;                                 // Weeks of history before downsampling
+    uint32_t chart_count;
+    int32_t  chart_week[HISTORY_CHART_POINTS];      // Monday of each bar's week
+    uint32_t chart_focus_min[HISTORY_CHART_POINTS];
+} HistoryModel_t;
+
+/* Build the model for the week of today, safe to call from the UI thread while the Core runs */
+void history_model_build(HistoryModel_t *model);
+
+/* Calendar date of a day since 1970-01-01, for the week labels of the chart */
+void history_model_date(int32_t day, int32_t *year, uint32_t *month, uint32_t *mday);
+
+/* Level of a number of sessions on one day */
+uint8_t history_model_level(uint32_t sessions);
+
+/* Pick at most out_max indices of y[0..n) with Largest-Triangle-Three-Buckets, first and last included */
+uint32_t history_model_lttb(const uint32_t *y, uint32_t n, uint32_t *out_idx, uint32_t out_max);
+
+/*
+ * Paint the cells whose level differs from cached[] into an RGB565 tile of
+ * HISTORY_TILE_W x HISTORY_TILE_H pixels and update cached[]; with
+ * full set, paint every cell. Returns the number of cells painted.
+ */
+uint32_t history_model_paint_tile(uint16_t *px, uint32_t stride_px, const HistoryModel_t *model,
+                                  uint8_t *cached, const uint16_t palette[HISTORY_HEATMAP_LEVELS + 1], bool full);
+
+#endif/* __H_HISTORY_MODEL_H__ */
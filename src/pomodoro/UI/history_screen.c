@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "history_screen.h"
+#include "history_model.h"
+#include "pomodoro_stats.h"
+#include "pomodoro_history.h"
+#include "settings_screen.h"
+#include "app_timer.h"
+
+// Wakes at the next midnight, or within the hour if the wall clock moved
+#define HISTORY_REFRESH_MAX_MS  (3600u * 1000u)
+
+/*
+ * The heatmap is a canvas over a tile that outlives the screen: cells are
+ * painted into it once, and afterwards only the cells whose level changed
+ * (today's, as sessions finish) or all of them when a new week starts.
+ */
+LV_DRAW_BUF_DEFINE_STATIC(tile_buf, HISTORY_TILE_W, HISTORY_TILE_H, LV_COLOR_FORMAT_RGB565);
+static uint8_t tile_levels[HISTORY_HEATMAP_CELLS];
+static int32_t tile_first_day;
+static bool tile_ready;
+
+static HistoryModel_t model;
+
+static lv_obj_t *history_screen;
+static lv_obj_t *heatmap;
+static lv_obj_t *label_year;
+static lv_obj_t *label_streak;
+static lv_obj_t *chart;
+static lv_obj_t *label_weeks;
+static lv_chart_series_t *chart_series;
+static lv_timer_t *refresh_timer;
+static lv_style_t label_style;
+static lv_style_t title_style;
+static lv_style_t btn_style;
+
+static void ui_history_screen_init_style(void);
+static void ui_history_screen_set_bg_by_theme(lv_obj_t *parent);
+
+static void ui_history_screen_init_style(void)
+{
+    static bool style_inited = false;
+
+    if (style_inited) return;
+    style_inited = true;
+
+    lv_style_init(&title_style);
+    lv_style_set_text_font(&title_style, &lv_font_montserrat_22);
+    lv_style_set_text_color(&title_style, lv_color_hex(0x4169E1));
+
+    lv_style_init(&label_style);
+    lv_style_set_text_font(&label_style, &lv_font_montserrat_14);
+    lv_style_set_text_color(&label_style, lv_color_hex(0xADD8E6));
+
+    lv_style_init(&btn_style);
+    lv_style_set_bg_color(&btn_style, lv_color_hex(0x2563EB));
+    lv_style_set_bg_grad_color(&btn_style, lv_color_hex(0x1E40AF));
+    lv_style_set_bg_grad_dir(&btn_style, LV_GRAD_DIR_VER);
+    lv_style_set_text_color(&btn_style, lv_color_hex(0xEAEAEA));
+    lv_style_set_shadow_width(&btn_style, 8);
+    lv_style_set_shadow_color(&btn_style, lv_color_hex(0x1A1A26));
+    lv_style_set_shadow_ofs_y(&btn_style, 4);
+}
+
+// Paint the changed cells into the tile, returns true if any was painted
+static bool ui_history_update_tile(void)
+{
+    // Empty, 4 levels of sessions, then gaps and days to come in the screen's background
+    const uint16_t palette[HISTORY_HEATMAP_LEVELS + 1] = {
+        lv_color_to_u16(lv_color_hex(0x45425C)),
+        lv_color_to_u16(lv_color_hex(0x0E4429)),
+        lv_color_to_u16(lv_color_hex(0x006D32)),
+        lv_color_to_u16(lv_color_hex(0x26A641)),
+        lv_color_to_u16(lv_color_hex(0x39D353)),
+        lv_color_to_u16(lv_color_hex(0x343247)),
+    };
+    bool full = !tile_ready || tile_first_day != model.first_day;
+    uint32_t painted;
+
+    if (!tile_ready) {
+        LV_DRAW_BUF_INIT_STATIC(tile_buf);
+    }
+    painted = history_model_paint_tile((uint16_t *)tile_buf.data, tile_buf.header.stride / sizeof(uint16_t),
+                                       &model, tile_levels, palette, full);
+    tile_ready = true;
+    tile_first_day = model.first_day;
+
+    if (painted) {
+        // The image cache may hold the previous tile
+        lv_image_cache_drop(&tile_buf);
+    }
+    return painted != 0;
+}
+
+static void ui_history_update_labels(void)
+{
+    char buf[64];
+
+    lv_snprintf(buf, sizeof(buf), "Last 12 months: %u sessions, %u h %02u min",
+                (unsigned)model.year_sessions, (unsigned)(model.year_focus_s / 3600u),
+                (unsigned)(model.year_focus_s / 60u % 60u));
+    lv_label_set_text(label_year, buf);
+
+    lv_snprintf(buf, sizeof(buf), "Streak: %u days, longest %u days",
+                (unsigned)model.current_streak, (unsigned)model.longest_streak);
+    lv_label_set_text(label_streak, buf);
+}
+
+static void ui_history_update_chart(void)
+{
+    uint32_t count = model.chart_count ? model.chart_count : 1;
+    uint32_t max = 60;
+
+    for (uint32_t i = 0; i < model.chart_count; i++) {
+        if (model.chart_focus_min[i] > max) max = model.chart_focus_min[i];
+    }
+    lv_chart_set_point_count(chart, count);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, (int32_t)max);
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t value = model.chart_count ? (int32_t)model.chart_focus_min[i] : 0;
+        lv_chart_set_value_by_id(chart, chart_series, i, value);
+    }
+    lv_chart_refresh(chart);
+
+    // The weeks of the first and the last bar
+    if (model.chart_count) {
+        int32_t y0, y1;
+        uint32_t m0, d0, m1, d1;
+        char buf[48];
+
+        history_model_date(model.chart_week[0], &y0, &m0, &d0);
+        history_model_date(model.chart_week[model.chart_count - 1], &y1, &m1, &d1);
+        lv_snprintf(buf, sizeof(buf), "%04d-%02u-%02u .. %04d-%02u-%02u",
+                    (int)y0, (unsigned)m0, (unsigned)d0, (int)y1, (unsigned)m1, (unsigned)d1);
+        lv_label_set_text(label_weeks, buf);
+    }
+    else {
+        lv_label_set_text(label_weeks, "");
+    }
+}
+
+// Until the day of the model ends: sessions that finish meanwhile come through history_screen_refresh()
+static uint32_t ui_history_ms_to_next_day(void)
+{
+    int64_t next_ms = pomodoro_stats_day_start(model.today + 1) * 1000;
+    int64_t left_ms = next_ms - (int64_t)pomodoro_history_now_ms();
+
+    if (left_ms < 0) return 0;
+    // Past midnight by a second, so that pomodoro_stats_today() has moved
+    return (left_ms + 1000 < (int64_t)HISTORY_REFRESH_MAX_MS) ? (uint32_t)left_ms + 1000u : HISTORY_REFRESH_MAX_MS;
+}
+
+// Repaint only what changed
+static void ui_history_refresh(void)
+{
+    static HistoryModel_t prev;
+
+    // The model only changes with the index or the day
+    if (pomodoro_stats_change_count() == model.stats_changes && pomodoro_stats_today() == model.today) {
+        return;
+    }
+    prev = model;
+    history_model_build(&model);
+
+    if (ui_history_update_tile()) {
+        lv_obj_invalidate(heatmap);
+    }
+    if (model.year_sessions != prev.year_sessions || model.current_streak != prev.current_streak ||
+        model.longest_streak != prev.longest_streak) {
+        ui_history_update_labels();
+    }
+    if (model.chart_count != prev.chart_count || model.weeks != prev.weeks ||
+        memcmp(model.chart_week, prev.chart_week, model.chart_count * sizeof(int32_t)) != 0 ||
+        memcmp(model.chart_focus_min, prev.chart_focus_min, model.chart_count * sizeof(uint32_t)) != 0) {
+        ui_history_update_chart();
+    }
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    ui_history_refresh();
+    app_timer_set_period(timer, ui_history_ms_to_next_day());
+}
+
+void history_screen_refresh(void)
+{
+    if (!history_screen) return;
+    ui_history_refresh();
+}
+
+static void back_event_cb(lv_event_t *e)
+{
+    (void)e;
+    LV_LOG_USER("Returning to Main screen...\n");
+    hide_history_screen();
+}
+
+void show_history_screen(lv_obj_t *parent)
+{
+    if (history_screen) return; // Already shown
+
+    uint32_t start = lv_tick_get();
+
+    ui_history_screen_init_style();
+    history_model_build(&model);
+    ui_history_update_tile();
+
+    history_screen = lv_obj_create(parent);
+    ui_history_screen_set_bg_by_theme(history_screen);
+    lv_obj_set_flex_flow(history_screen, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(history_screen, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_row(history_screen, 10, 0);
+    lv_obj_set_style_pad_top(history_screen, 16, 0);
+
+    lv_obj_t *title = lv_label_create(history_screen);
+    lv_label_set_text(title, "History");
+    lv_obj_add_style(title, &title_style, 0);
+
+    label_year = lv_label_create(history_screen);
+    lv_obj_add_style(label_year, &label_style, 0);
+
+    heatmap = lv_canvas_create(history_screen);
+    lv_canvas_set_draw_buf(heatmap, &tile_buf);
+
+    label_streak = lv_label_create(history_screen);
+    lv_obj_add_style(label_streak, &label_style, 0);
+
+    lv_obj_t *chart_label = lv_label_create(history_screen);
+    lv_label_set_text(chart_label, "Focus minutes per week");
+    lv_obj_add_style(chart_label, &label_style, 0);
+
+    chart = lv_chart_create(history_screen);
+    lv_obj_set_size(chart, HISTORY_TILE_W, 170);
+    lv_chart_set_type(chart, LV_CHART_TYPE_BAR);
+    lv_chart_set_div_line_count(chart, 4, 0);
+    lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(chart, 0, 0);
+    lv_obj_set_style_pad_column(chart, 1, 0);
+    chart_series = lv_chart_add_series(chart, lv_color_hex(0x26A641), LV_CHART_AXIS_PRIMARY_Y);
+
+    label_weeks = lv_label_create(history_screen);
+    lv_obj_add_style(label_weeks, &label_style, 0);
+
+    lv_obj_t *btn_back = lv_btn_create(history_screen);
+    lv_obj_add_style(btn_back, &btn_style, 0);
+    lv_obj_add_event_cb(btn_back, back_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *label_back = lv_label_create(btn_back);
+    lv_label_set_text(label_back, "Back");
+    lv_obj_center(label_back);
+
+    ui_history_update_labels();
+    ui_history_update_chart();
+
+    refresh_timer = app_timer_create(refresh_timer_cb, ui_history_ms_to_next_day());
+    lv_obj_move_foreground(history_screen);
+
+    LV_LOG_USER("History screen built in %u ms, %u weeks in %u bars\n",
+                (unsigned)lv_tick_elaps(start), (unsigned)model.weeks, (unsigned)model.chart_count);
+}
+
+void hide_history_screen(void)
+{
+    if (refresh_timer) {
+        app_timer_delete(refresh_timer);
+        refresh_timer = NULL;
+    }
+    if (history_screen) {
+        lv_obj_del(history_screen);
+        history_screen = NULL;
+        heatmap = NULL;
+        chart = NULL;
+        label_weeks = NULL;
+    }
+}
+
+static void ui_history_screen_set_bg_by_theme(lv_obj_t *parent)
+{
+    if (ui_get_theme() == POMO_DARK_THEME) {
+        lv_obj_remove_style_all(parent);
+        lv_obj_set_size(parent, LV_PCT(100), LV_PCT(100));
+        lv_obj_set_style_bg_color(parent, lv_color_hex(0x343247), 0);
+        lv_obj_set_style_bg_opa(parent, LV_OPA_COVER, 0);
+        lv_obj_set_style_pad_all(parent, 0, 0);
+        lv_obj_set_style_margin_all(parent, 0, 0);
+        lv_obj_set_style_border_width(parent, 0, 0);
+        lv_obj_clear_flag(parent, LV_OBJ_FLAG_SCROLLABLE);
+    }
+    else {
+        lv_obj_set_style_bg_color(parent, lv_color_hex(0xffffff), 0);
+    }
+}
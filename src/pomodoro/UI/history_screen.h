@@ -0,0 +1,12 @@
+#ifndef __H_HISTORY_SCREEN_H__
+#define __H_HISTORY_SCREEN_H__
+
+#include "lvgl.h"
+
+void show_history_screen(lv_obj_t *parent);
+void hide_history_screen(void);
+
+/* The stats may have changed (a phase ended): repaint what changed, if shown */
+void history_screen_refresh(void);
+
+#endif/* __H_HISTORY_SCREEN_H__ */
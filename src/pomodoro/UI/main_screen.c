@@ -4,26 +4,42 @@
 #include "event.h"
 #include "timer.h"
 #include "pomodoro.h"
+#include "pomodoro_runtime.h"
+#include "pomodoro_journal.h"
+#include "pomodoro_view.h"
+#include "trace.h"
 #include "settings_screen.h"
 #include "main_screen.h"
 #include "full_screen.h"
+#include "countdown.h"
+#include "progress_ring.h"
+#include "history_screen.h"
+#include "app_timer.h"
 
 #define POMO_MOVE_TO_FULLSCREEN_SEC     10
+#define RING_FRAME_MS                   LV_DEF_REFR_PERIOD
+
+// Set by the pomodoro_icons_<layout> library when the icons are A8 masks
+#ifndef POMODORO_ICONS_A8
+#define POMODORO_ICONS_A8               0
+#endif
 
 static lv_obj_t *main_cont;
 
 static lv_obj_t *label_mode;
-static lv_obj_t *label_timer;
+static lv_obj_t *timer_countdown;
 static lv_obj_t *label_cycle;
 static lv_obj_t *progress;
 static lv_obj_t *label_pause;
+static lv_obj_t *label_quote;
 
 static lv_obj_t *btn_start;
 static lv_obj_t *btn_reset;
 static lv_obj_t *btn_setting;
+static lv_obj_t *btn_history;
 
-static lv_style_t progress_main_style;
-static lv_style_t progress_indic_style;
+static int32_t progress_width;
+static lv_color_t progress_track_color;
 static lv_style_t font_style;
 static lv_style_t btn_style;
 
@@ -41,22 +57,32 @@ static bool timer_running = false;
 static int work_state_elapsed_sec = 0;
 static bool fullscreen_timer_active = false;
 static bool fullscreen_enable = false;
+static bool low_power = false;
+static lv_timer_t *ring_timer;              // Moves the ring every frame, NULL: it steps with the ticks
+
+// Last view written to the widgets: the next one only writes the properties that differ
+static PomodoroViewModel_t applied_view;
+static bool applied_view_valid = false;
+static uint32_t prop_writes;
+
+// Timer text and arc indicator per PomodoroBand_e
+static const uint32_t band_color[] = { 0x4A90E2, 0x9B59B6, 0xE74C3C };
 
 /* Forward declarations */
 static void ui_main_screen_set_bg_by_theme(lv_obj_t *parent);
 static void ui_main_screen_init_style_by_theme(void);
-static void update_timer_label(uint32_t remaining_ms);
 
 static void start_event_cb(lv_event_t *e);
 static void reset_event_cb(lv_event_t *e);
 static void setting_event_cb(lv_event_t *e);
+static void history_event_cb(lv_event_t *e);
 
 static void pomodoro_state_changed(PomodoroState_e state);
-static void timer_tick_cb(lv_timer_t * timer);
 static void ui_tick_cb(uint32_t remaining);
-static void ui_update_ctrl_button(PomodoroState_e state);
+static void ui_update_quote_scroll(void);
 static void ui_update_state_text(PomodoroState_e state);
-static void ui_update_cycle_counter(void);
+static uint32_t ui_apply_view(const PomodoroViewModel_t *view);
+static void ui_update_ring_anim(uint8_t state);
 
 /* --- UI Functions --- */
 
@@ -82,18 +108,12 @@ static void ui_main_screen_set_bg_by_theme(lv_obj_t *parent)
 
 static void ui_main_screen_init_style_by_theme(void) {
 
-    lv_style_init(&progress_main_style);
-    lv_style_init(&progress_indic_style);
     lv_style_init(&font_style);
     lv_style_init(&btn_style);
 
     if (ui_get_theme() == POMO_DARK_THEME) {
-        lv_style_set_width(&progress_main_style, 10);
-        lv_style_set_arc_color(&progress_main_style, lv_color_hex(0x1E1E2A));
-        // lv_style_set_arc_opa(&progress_main_style, LV_OPA_50);
-
-        lv_style_set_width(&progress_indic_style, 10);
-        lv_style_set_arc_color(&progress_indic_style, lv_color_hex(0x4A90E2));
+        progress_width = 10;
+        progress_track_color = lv_color_hex(0x1E1E2A);
 
         #ifdef SCREEN_SIZE_240x320
         lv_style_set_text_font(&font_style, &lv_font_montserrat_12);
@@ -116,11 +136,8 @@ static void ui_main_screen_init_style_by_theme(void) {
     }
     else {
         //TODO: adjust colors for light theme
-        lv_style_set_width(&progress_main_style, 20);
-        lv_style_set_arc_color(&progress_main_style, lv_color_hex(0x00ff00));
-
-        lv_style_set_width(&progress_indic_style, 20);
-        lv_style_set_arc_color(&progress_indic_style, lv_color_hex(0xff0000));
+        progress_width = 20;
+        progress_track_color = lv_color_hex(0x00ff00);
     }
 }
 
@@ -134,65 +151,64 @@ static void label_event_cb(lv_event_t * e)
         lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
     }
     else if(code == LV_EVENT_RELEASED || code == LV_EVENT_DEFOCUSED || code == LV_EVENT_HOVER_LEAVE) {
-        // Resume scrolling: enable scroll again
-        lv_label_set_long_mode(label, LV_LABEL_LONG_SCROLL_CIRCULAR);
+        // Resume scrolling if a session is running
+        ui_update_quote_scroll();
     }
 }
 
-void ui_main_screen_update_mode_icon(PomodoroState_e curr_state) {
-
-    // Hide all icons initially
-    if (ready_icon)         lv_obj_add_flag(ready_icon, LV_OBJ_FLAG_HIDDEN);
-    if (work_race_icon)     lv_obj_add_flag(work_race_icon, LV_OBJ_FLAG_HIDDEN);
-    if (work_run_icon)      lv_obj_add_flag(work_run_icon, LV_OBJ_FLAG_HIDDEN);
-    if (work_speed_icon)    lv_obj_add_flag(work_speed_icon, LV_OBJ_FLAG_HIDDEN);
-    // if (objective_icon)     lv_obj_add_flag(objective_icon, LV_OBJ_FLAG_HIDDEN);
-    if (short_break_icon)   lv_obj_add_flag(short_break_icon, LV_OBJ_FLAG_HIDDEN);
-    if (long_break_icon)    lv_obj_add_flag(long_break_icon, LV_OBJ_FLAG_HIDDEN);
-
-    switch (curr_state) {
-        case POMODORO_IDLE:
-            lv_obj_clear_flag(ready_icon, LV_OBJ_FLAG_HIDDEN);
-            break;
-        case POMODORO_WORK:
-        case POMODORO_PAUSED_WORK:
-            lv_obj_clear_flag(work_run_icon, LV_OBJ_FLAG_HIDDEN);
-            // lv_obj_clear_flag(objective_icon, LV_OBJ_FLAG_HIDDEN);
-            break;
-        case POMODORO_SHORT_BREAK:
-            lv_obj_clear_flag(short_break_icon, LV_OBJ_FLAG_HIDDEN);
-            break;
-        case POMODORO_LONG_BREAK:
-            lv_obj_clear_flag(long_break_icon, LV_OBJ_FLAG_HIDDEN);
-            break;
-        case POMODORO_PAUSED_BREAK:
-            if(pomodoro_get_pause_break_type() == POMODORO_SHORT_BREAK) {
-                lv_obj_clear_flag(short_break_icon, LV_OBJ_FLAG_HIDDEN);
-            }
-            else {
-                lv_obj_clear_flag(long_break_icon, LV_OBJ_FLAG_HIDDEN);
-            }
+/* Show or hide the icons whose bit is set in toggle, as shown says */
+static void ui_apply_icons(uint32_t toggle, uint32_t shown)
+{
+    lv_obj_t *icons[POMODORO_ICON_COUNT] = {
+        ready_icon, work_run_icon, work_race_icon, work_speed_icon, short_break_icon, long_break_icon
+    };
 
-        default:
-            // Optionally hide all
-            break;
+    for (uint32_t i = 0; i < POMODORO_ICON_COUNT; i++) {
+        if (!(toggle & (1u << i)) || !icons[i]) continue;
+        if (shown & (1u << i)) {
+            lv_obj_clear_flag(icons[i], LV_OBJ_FLAG_HIDDEN);
+        }
+        else {
+            lv_obj_add_flag(icons[i], LV_OBJ_FLAG_HIDDEN);
+        }
+        prop_writes++;
     }
 }
 
 void ui_main_screen(lv_obj_t *parent)
 {
-    // Initialize systems
-    event_init();
-    timer_init();
+    static bool first_build = true;
+    // A session restored from the journal at startup is kept, later builds start fresh
+    bool keep_session = first_build && pomodoro_journal_restored();
+
+    first_build = false;
     ui_main_screen_init_style_by_theme();
 
-    // Register callbacks
-    pomodoro_set_state_callback(pomodoro_state_changed);
-    pomodoro_set_tick_callback(ui_tick_cb);
+    if (keep_session) {
+        if (pomodoro_runtime_is_running()) {
+            pomodoro_runtime_set_callbacks(pomodoro_state_changed, ui_tick_cb);
+        } else {
+            pomodoro_set_state_callback(pomodoro_state_changed);
+            pomodoro_set_tick_callback(ui_tick_cb);
+        }
+    } else if (pomodoro_runtime_is_running()) {
+        // The Core runs on its own timing thread: restart the session through the
+        // queue, callbacks are replayed from its snapshots by pomodoro_runtime_dispatch()
+        event_post(EVENT_RESET);
+        pomodoro_runtime_set_callbacks(pomodoro_state_changed, ui_tick_cb);
+    } else {
+        // Initialize systems. The timer wheel is up before the store and the journal
+        // (main.c): wiping it here would drop the journal flush that event_init() arms
+        event_init();
+
+        // Register callbacks
+        pomodoro_set_state_callback(pomodoro_state_changed);
+        pomodoro_set_tick_callback(ui_tick_cb);
+
+        // The Core is driven by pomodoro_tick() from the main loop,
+        // see pomodoro_get_next_deadline_ms()
+    }
 
-    // Create periodic timer check using LVGL
-    lv_timer_create(timer_tick_cb, 1000, NULL);  // Check every 1000ms
-    
     /* Grid: 6 rows, 1 column */
     static int col_dsc[] = {LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
     static int row_dsc[] = {
@@ -233,8 +249,9 @@ void ui_main_screen(lv_obj_t *parent)
     lv_style_set_img_recolor(&icon_style, lv_color_hex(0x000000));
     lv_style_set_img_recolor_opa(&icon_style, LV_OPA_100);
 
+    // A8 icons are built at the size of the layout, the ARGB8888 ones are scaled here
     int img_zoom = 256;
-    #ifdef SCREEN_SIZE_240x320
+    #if defined(SCREEN_SIZE_240x320) && !POMODORO_ICONS_A8
     img_zoom = 256 * 0.7;
     #endif
 
@@ -311,7 +328,7 @@ void ui_main_screen(lv_obj_t *parent)
     lv_obj_set_style_img_recolor(long_break_icon, lv_color_hex(0xBBBBBB), 0);
     lv_img_set_zoom(long_break_icon, img_zoom);
 
-    ui_main_screen_update_mode_icon(POMODORO_IDLE);
+    ui_apply_icons(0xFF, POMODORO_ICON_READY);
 
     /* Timer row */
     lv_obj_t *timer_cont = lv_obj_create(main_cont);
@@ -319,45 +336,27 @@ void ui_main_screen(lv_obj_t *parent)
     lv_obj_clear_flag(timer_cont, LV_OBJ_FLAG_SCROLLABLE);
     lv_obj_set_grid_cell(timer_cont, LV_GRID_ALIGN_STRETCH, 0, 1, LV_GRID_ALIGN_STRETCH, 1, 1);
 
-    /* Circular progress indicator */
-    progress = lv_arc_create(timer_cont);
-    int32_t progress_w = 200;
-    int32_t progress_h = 200;
+    /* Circular progress indicator: counts down from 12 o'clock, redraws only the part that moved */
     #ifdef SCREEN_SIZE_240x320
-    progress_w = 130;
-    progress_h = 130;
+    int32_t progress_d = 130;
     #else
-    progress_w = 200;
-    progress_h = 200;
+    int32_t progress_d = 200;
     #endif
-    lv_obj_set_size(progress, progress_w, progress_h);
+    progress = progress_ring_create(timer_cont, progress_d, progress_width, progress_track_color,
+                                    lv_color_hex(band_color[POMODORO_BAND_CALM]));
     lv_obj_center(progress);
+    progress_ring_set_range(progress, pomodoro_get_remaining_sec());
+    progress_ring_set_value(progress, pomodoro_get_remaining_sec());
 
-    lv_obj_remove_style(progress, NULL, LV_PART_KNOB);   // Remove the knob
-    lv_obj_clear_flag(progress, LV_OBJ_FLAG_CLICKABLE);  // Make it non-interactive
-
-    lv_arc_set_range(progress, 0, pomodoro_get_remaining_sec());
-    lv_arc_set_value(progress, pomodoro_get_remaining_sec());
-    lv_arc_set_bg_angles(progress, 0, 360);
-
-    // Set rotation to start from top
-    lv_arc_set_rotation(progress, 270);  // Rotate so 0 degrees is at 12 o'clock
-    lv_arc_set_mode(progress, LV_ARC_MODE_REVERSE);
-
-    lv_obj_add_style(progress, &progress_main_style, LV_PART_MAIN);
-    lv_obj_add_style(progress, &progress_indic_style, LV_PART_INDICATOR);
-
-    /* Timer label - positioned in center of circle */
-    label_timer = lv_label_create(progress);  // Create as child of arc for centering
-    lv_label_set_text(label_timer, "25:00");
-    lv_obj_set_style_text_color(label_timer, lv_color_hex(0x4A90E2), 0);
-    lv_obj_set_style_text_font(label_timer, &lv_font_montserrat_28, 0);
-    lv_obj_center(label_timer);  // Center within the arc
+    /* Timer - positioned in center of circle, digits from an atlas (countdown.h) */
+    timer_countdown = countdown_create(progress, &lv_font_montserrat_28, lv_color_hex(band_color[POMODORO_BAND_CALM]));
+    countdown_set_text(timer_countdown, "25:00");
+    lv_obj_center(timer_countdown);  // Center within the arc
 
     label_pause = lv_label_create(timer_cont);
     lv_label_set_text(label_pause, "Paused>");
     lv_obj_add_style(label_pause, &font_style, 0);
-    lv_obj_align_to(label_pause, label_timer, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
+    lv_obj_align_to(label_pause, timer_countdown, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
     lv_obj_add_flag(label_pause, LV_OBJ_FLAG_HIDDEN);
 
     /* Buttons */
@@ -407,14 +406,24 @@ void ui_main_screen(lv_obj_t *parent)
     lv_obj_add_style(label_setting, &font_style, 0);
     lv_obj_center(label_setting);
 
+    btn_history = lv_btn_create(btn_row);
+    lv_obj_set_size(btn_history, LV_PCT(btn_w), LV_PCT(btn_h));
+    lv_obj_add_style(btn_history, &btn_style, 0);
+    lv_obj_add_event_cb(btn_history, history_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *label_history = lv_label_create(btn_history);
+    lv_label_set_text(label_history, "History");
+    lv_obj_add_style(label_history, &font_style, 0);
+    lv_obj_center(label_history);
+
     /* Cycle status */
     label_cycle = lv_label_create(main_cont);
     lv_label_set_text(label_cycle, "Cycle: 0 / 4");
+    lv_obj_set_style_text_color(label_cycle, lv_color_hex(0x00FFFF), 0);
     lv_obj_set_grid_cell(label_cycle,
                          LV_GRID_ALIGN_CENTER, 0, 1,
                          LV_GRID_ALIGN_CENTER, 3, 1);
     
-    lv_obj_t *label_quote = lv_label_create(main_cont);
+    label_quote = lv_label_create(main_cont);
     lv_label_set_text(label_quote, "Focus on being productive instead of busy");
     lv_obj_set_grid_cell(label_quote, LV_GRID_ALIGN_CENTER, 0, 1, LV_GRID_ALIGN_CENTER, 4, 1);
     lv_obj_set_style_text_color(label_quote, lv_color_hex(0x00FF00), 0);
@@ -427,30 +436,19 @@ void ui_main_screen(lv_obj_t *parent)
     lv_obj_add_event_cb(label_quote, label_event_cb, LV_EVENT_ALL, NULL);
 
 
-    /* Update initial timer display */
-    update_timer_label(pomodoro_get_remaining_sec() * 1000);
-
-    // Initialize to IDLE state
-    pomodoro_state_changed(POMODORO_IDLE);
-}
-
-static void update_timer_label(uint32_t remaining_ms)
-{
-    uint32_t total_seconds = remaining_ms / 1000;
-    uint32_t minutes = total_seconds / 60;
-    uint32_t seconds = total_seconds % 60;
-
-    static char buf[8];
-    lv_snprintf(buf, sizeof(buf), "%02d:%02d", minutes, seconds);
-    lv_label_set_text(label_timer, buf);
-
-    // Update progress bar using seconds
-    lv_arc_set_value(progress, total_seconds);
+    // New widgets: the first view writes every property, for IDLE or the restored session
+    if (ring_timer) {
+        app_timer_delete(ring_timer);
+        ring_timer = NULL;
+    }
+    applied_view_valid = false;
+    pomodoro_state_changed(keep_session ? pomodoro_get_state() : POMODORO_IDLE);
 }
 
-static void ui_update_ctrl_button(PomodoroState_e state)
+/* Button row of a PomodoroControls_e, written only when it changes */
+static void ui_apply_controls(uint8_t controls)
 {
-    if(state == POMODORO_IDLE) {
+    if (controls == POMODORO_CONTROLS_IDLE) {
         lv_obj_add_flag(btn_reset, LV_OBJ_FLAG_HIDDEN); // Hide Reset
         lv_obj_set_align(btn_start, LV_ALIGN_CENTER);   // Center Start button
 
@@ -458,26 +456,24 @@ static void ui_update_ctrl_button(PomodoroState_e state)
         lv_obj_add_flag(label_pause, LV_OBJ_FLAG_HIDDEN); // Hide "Paused" label
         lv_obj_clear_flag(btn_setting, LV_OBJ_FLAG_HIDDEN); // Show Settings when idle
     }
-    else if (state == POMODORO_WORK ||
-                state == POMODORO_SHORT_BREAK ||
-                state == POMODORO_LONG_BREAK) {
+    else if (controls == POMODORO_CONTROLS_RUNNING) {
         lv_label_set_text(lv_obj_get_child(btn_start, 0), "Pause");
         lv_obj_add_flag(label_pause, LV_OBJ_FLAG_HIDDEN); // Hide "Paused" label
         lv_obj_set_align(btn_reset, LV_ALIGN_RIGHT_MID);  // Align Reset to right
         lv_obj_clear_flag(btn_reset, LV_OBJ_FLAG_HIDDEN); // Show Reset
         lv_obj_add_flag(btn_setting, LV_OBJ_FLAG_HIDDEN); // Hide Settings when running
     }
-    else if (state == POMODORO_PAUSED_WORK ||
-            state == POMODORO_PAUSED_BREAK) {
+    else {
         lv_label_set_text(lv_obj_get_child(btn_start, 0), "Resume");
         lv_obj_clear_flag(label_pause, LV_OBJ_FLAG_HIDDEN); // Show "Paused" label
+        lv_obj_set_align(btn_reset, LV_ALIGN_RIGHT_MID);
+        lv_obj_clear_flag(btn_reset, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_flag(btn_setting, LV_OBJ_FLAG_HIDDEN);
     }
-    else {
-        lv_obj_clear_flag(btn_reset, LV_OBJ_FLAG_HIDDEN); // Show Reset
-        lv_obj_set_align(btn_start, LV_ALIGN_LEFT_MID);   // Align Start to left
-        lv_obj_set_align(btn_reset, LV_ALIGN_RIGHT_MID);  // Align Reset to right
-        lv_obj_add_flag(label_pause, LV_OBJ_FLAG_HIDDEN);
-    }
+    prop_writes += 5;
+
+    ui_update_quote_scroll();
+    prop_writes++;
 }
 
 #if 0
@@ -521,43 +517,137 @@ static void ui_update_state_text(PomodoroState_e state)
 }
 #endif
 
-static void ui_update_cycle_counter(void)
+void ui_main_screen_set_fullscreen(bool enable)
 {
-    char buf[32];
-    snprintf(buf, sizeof(buf), "Cycle: %d / %d", 
-             pomodoro_get_current_cycle(),
-             pomodoro_get_max_cycles());
-    lv_label_set_text(label_cycle, buf);
-    lv_obj_set_style_text_color(label_cycle, lv_color_hex(0x00FFFF), 0);
+    fullscreen_enable = enable;
 }
 
-static void update_timer_and_progress(PomodoroState_e state)
+void ui_main_screen_set_low_power(bool enable)
 {
-    if (!pomodoro_is_resume_transition() && !pomodoro_is_pause_transition()) {
-        lv_arc_set_range(progress, 0, pomodoro_get_remaining_sec());
+    low_power = enable;
+    if (progress) {
+        ui_update_ring_anim(pomodoro_get_state());
     }
+}
 
-    // Update remaining time and progress bar
-    update_timer_label(pomodoro_get_remaining_sec() * 1000);
+/* A frame of the animated ring: where the phase is now, rendered in this pass */
+static void ring_frame_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    if (progress_ring_set_progress_q16(progress, pomodoro_get_progress_q16())) {
+        lv_timer_t *refr_timer = lv_display_get_refr_timer(lv_display_get_default());
+        if (refr_timer) {
+            lv_timer_ready(refr_timer);
+        }
+        prop_writes++;
+    }
+}
+
+/* The ring moves every frame while a phase runs, each frame invalidates the
+ * few pixels it moved. In low-power mode, or under the fullscreen timer, it
+ * steps with the ticks and the main loop wakes once a second */
+static void ui_update_ring_anim(uint8_t state)
+{
+    bool smooth = !low_power && !fullscreen_timer_active &&
+                  (state == POMODORO_WORK || state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK);
+
+    if (smooth) {
+        if (!ring_timer) {
+            ring_timer = app_timer_create(ring_frame_cb, RING_FRAME_MS);
+        }
+        ring_frame_cb(ring_timer);
+    }
+    else if (ring_timer) {
+        app_timer_delete(ring_timer);
+        ring_timer = NULL;
+        // Back to the value of the view, the ticks move it from here
+        progress_ring_set_range(progress, applied_view.arc_range_s);
+        progress_ring_set_value(progress, applied_view.arc_value_s);
+        prop_writes += 2;
+    }
+}
+
+/* The marquee is an endless animation: only run it while a session is running
+ * so the main loop can sleep until input in IDLE and PAUSED_* */
+static void ui_update_quote_scroll(void)
+{
+    PomodoroState_e state = pomodoro_get_state();
 
-    if (state == POMODORO_IDLE) {
-        lv_obj_set_style_text_color(label_timer, lv_color_hex(0x4A90E2), 0);
-        lv_obj_set_style_arc_color(progress, lv_color_hex(0x4A90E2), LV_PART_INDICATOR);
+    if (!label_quote) return;
+
+    if (state == POMODORO_WORK || state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK) {
+        lv_label_set_long_mode(label_quote, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    }
+    else {
+        lv_label_set_long_mode(label_quote, LV_LABEL_LONG_CLIP);
+    }
+}
+
+/* Write the properties that differ from the last applied view, return the POMODORO_VIEW_* bits written */
+static uint32_t ui_apply_view(const PomodoroViewModel_t *view)
+{
+    uint32_t changed = applied_view_valid ? pomodoro_view_diff(&applied_view, view) : POMODORO_VIEW_ALL;
+
+    if (changed & POMODORO_VIEW_ICONS) {
+        ui_apply_icons(applied_view_valid ? (uint32_t)(applied_view.icons ^ view->icons) : 0xFF, view->icons);
+    }
+    if (changed & POMODORO_VIEW_CONTROLS) {
+        ui_apply_controls(view->controls);
+    }
+    // While animated the ring follows the clock, not the view
+    if ((changed & POMODORO_VIEW_ARC_RANGE) && !ring_timer) {
+        progress_ring_set_range(progress, view->arc_range_s);
+        prop_writes++;
+    }
+    if ((changed & POMODORO_VIEW_ARC_VALUE) && !ring_timer) {
+        progress_ring_set_value(progress, view->arc_value_s);
+        prop_writes++;
+    }
+    if (changed & POMODORO_VIEW_TIME) {
+        countdown_set_text(timer_countdown, view->time_text);
+        prop_writes++;
+    }
+    if (changed & POMODORO_VIEW_BAND) {
+        countdown_set_color(timer_countdown, lv_color_hex(band_color[view->band]));
+        progress_ring_set_indicator_color(progress, lv_color_hex(band_color[view->band]));
+        prop_writes += 2;
     }
+    if (changed & POMODORO_VIEW_CYCLE) {
+        lv_label_set_text(label_cycle, view->cycle_text);
+        prop_writes++;
+    }
+
+    applied_view = *view;
+    applied_view_valid = true;
+    return changed;
 }
 
 static void pomodoro_state_changed(PomodoroState_e state)
 {
-    ui_main_screen_update_mode_icon(state);
-    ui_update_ctrl_button(state);
-    #if 0
-    ui_update_state_text(state);
-    #endif
+    PomodoroViewModel_t view;
 
-    update_timer_and_progress(state);
-    ui_update_cycle_counter();
+    TRACE_BEGIN(TRACE_UI_STATE_CB);
+    pomodoro_view_get(&view);
+    ui_apply_view(&view);
 
+    // Left WORK (pause, reset, end of phase): no tick arrives to take the overlay down
+    if (state != POMODORO_WORK && fullscreen_timer_active) {
+        hide_fullscreen_timer();
+        fullscreen_timer_active = false;
+    }
     work_state_elapsed_sec = 0;
+    ui_update_ring_anim(state);
+    // A finished phase is in the stats before its state change
+    history_screen_refresh();
+    TRACE_END(TRACE_UI_STATE_CB, state);
+}
+
+uint32_t ui_main_screen_take_prop_writes(void)
+{
+    uint32_t n = prop_writes;
+
+    prop_writes = 0;
+    return n;
 }
 
 static void start_event_cb(lv_event_t *e)
@@ -567,67 +657,55 @@ static void start_event_cb(lv_event_t *e)
     switch (current_state) {
         case POMODORO_IDLE:
             // Start new work session
-            event_dispatch(EVENT_START, NULL);
+            event_post(EVENT_START);
             break;
             
         case POMODORO_WORK:
         case POMODORO_SHORT_BREAK:
         case POMODORO_LONG_BREAK:
-            timer_pause();
-            event_dispatch(EVENT_PAUSE, NULL);
+            event_post(EVENT_PAUSE);
             break;
             
         case POMODORO_PAUSED_WORK:
         case POMODORO_PAUSED_BREAK:
-            timer_resume();
-            event_dispatch(EVENT_RESUME, NULL);
+            event_post(EVENT_RESUME);
             break;
     }
 }
 
 static void reset_event_cb(lv_event_t *e)
 {
-    event_dispatch(EVENT_RESET, NULL);
-    timer_stop();
-    pomodoro_state_changed(POMODORO_IDLE); // Force UI update
+    // The state callback of the reset updates the screen
+    event_post(EVENT_RESET);
 }
 
 static void ui_tick_cb(uint32_t remaining) {
-    update_timer_label(remaining);
+    PomodoroViewModel_t view;
 
-    PomodoroState_e state = pomodoro_get_state();
-    if (state == POMODORO_WORK) {
+    TRACE_BEGIN(TRACE_UI_TICK_CB);
+    pomodoro_view_get(&view);
+
+    // Ticks land on the second boundary: render now instead of at the next refresh period
+    if (ui_apply_view(&view) != 0) {
+        lv_timer_t *refr_timer = lv_display_get_refr_timer(lv_display_get_default());
+        if (refr_timer) {
+            lv_timer_ready(refr_timer);
+        }
+    }
+
+    if (view.state == POMODORO_WORK) {
         if (fullscreen_enable) {
             work_state_elapsed_sec++;
             if (!fullscreen_timer_active && work_state_elapsed_sec >= POMO_MOVE_TO_FULLSCREEN_SEC) {
                 // Show fullscreen overlay after 10 seconds
                 show_fullscreen_timer(main_cont);
                 fullscreen_timer_active = true;
+                ui_update_ring_anim(view.state);
             }
             if (fullscreen_timer_active) {
                 update_fullscreen_timer(remaining);
             }
         }
-
-        uint8_t percent = pomodoro_get_work_progress_in_percent();
-        if (percent > 50 && percent < 80) {
-            lv_obj_clear_flag(work_race_icon, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_set_style_text_color(label_timer, lv_color_hex(0x9B59B6), 0);
-            lv_obj_set_style_arc_color(progress, lv_color_hex(0x9B59B6), LV_PART_INDICATOR);
-        }
-        else if (percent >= 80) {
-            lv_obj_clear_flag(work_speed_icon, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_set_style_text_color(label_timer, lv_color_hex(0xE74C3C), 0);
-            lv_obj_set_style_arc_color(progress, lv_color_hex(0xE74C3C), LV_PART_INDICATOR);
-        }
-        else {
-            lv_obj_set_style_text_color(label_timer, lv_color_hex(0x4A90E2), 0);
-            lv_obj_set_style_arc_color(progress, lv_color_hex(0x4A90E2), LV_PART_INDICATOR);
-        }
-    }
-    else if (state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK) {
-        lv_obj_set_style_text_color(label_timer, lv_color_hex(0x4A90E2), 0);
-        lv_obj_set_style_arc_color(progress, lv_color_hex(0x4A90E2), LV_PART_INDICATOR);
     }
     else {
         // Not in WORK state: reset elapsed time and hide overlay if shown
@@ -635,12 +713,10 @@ static void ui_tick_cb(uint32_t remaining) {
         if (fullscreen_timer_active) {
             hide_fullscreen_timer();
             fullscreen_timer_active = false;
+            ui_update_ring_anim(view.state);
         }
     }
-}
-
-static void timer_tick_cb(lv_timer_t * timer) {
-    timer_tick_handler();
+    TRACE_END(TRACE_UI_TICK_CB, remaining);
 }
 
 static void setting_event_cb(lv_event_t *e)
@@ -648,4 +724,10 @@ static void setting_event_cb(lv_event_t *e)
     LV_LOG_USER("Moving to Settings page...\n");
     show_settings_screen(main_cont);
 
-}
\ No newline at end of file
+}
+
+static void history_event_cb(lv_event_t *e)
+{
+    LV_LOG_USER("Moving to History page...\n");
+    show_history_screen(main_cont);
+}
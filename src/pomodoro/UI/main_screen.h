@@ -5,4 +5,13 @@
 
 void ui_main_screen(lv_obj_t *parent);
 
+/* Cover the screen with a large timer after POMO_MOVE_TO_FULLSCREEN_SEC of WORK, off by default */
+void ui_main_screen_set_fullscreen(bool enable);
+
+/* Low-power mode: the progress ring steps once a second instead of moving every frame, off by default */
+void ui_main_screen_set_low_power(bool enable);
+
+/* Widget properties written since the last call, the view diff skips unchanged ones */
+uint32_t ui_main_screen_take_prop_writes(void);
+
 #endif /* __H_MAIN_SCREEN_H__ */
@@ -0,0 +1,226 @@
+#include "lvgl.h"
+#include "progress_ring.h"
+#include "ring_geometry.h"
+
+typedef struct {
+    RingGeometry_t geometry;
+    lv_color_t track_color;
+    lv_color_t indicator_color;
+    lv_draw_buf_t *track;           // The whole track, NULL: drawn as an arc
+    uint32_t range;
+    uint32_t value;
+    int32_t angle;                  // Moving end, of the value or the last Q16 progress
+} ProgressRing_t;
+
+/* Ring angles are clockwise from 12 o'clock, LVGL's from 3 o'clock */
+static lv_value_precise_t lv_angle(int32_t angle)
+{
+    return (lv_value_precise_t)(angle + 270 * RING_ANGLE_UNITS) / RING_ANGLE_UNITS;
+}
+
+static void init_arc_dsc(lv_obj_t *obj, const ProgressRing_t *ring, lv_draw_arc_dsc_t *dsc)
+{
+    lv_area_t coords;
+
+    lv_obj_get_coords(obj, &coords);
+    lv_draw_arc_dsc_init(dsc);
+    dsc->opa = lv_obj_get_style_opa_recursive(obj, LV_PART_MAIN);
+    dsc->center.x = coords.x1 + ring->geometry.radius;
+    dsc->center.y = coords.y1 + ring->geometry.radius;
+    dsc->radius = (uint16_t)ring->geometry.radius;
+    dsc->width = ring->geometry.width;
+    dsc->rounded = ring->geometry.rounded;
+}
+
+/* Draw the track once into an image, through a canvas deleted afterwards */
+static lv_draw_buf_t *paint_track(const ProgressRing_t *ring)
+{
+    int32_t d = 2 * ring->geometry.radius;
+    lv_draw_buf_t *buf = lv_draw_buf_create((uint32_t)d, (uint32_t)d, LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    lv_draw_arc_dsc_t dsc;
+    lv_obj_t *canvas;
+    lv_layer_t layer;
+
+    if (!buf) {
+        LV_LOG_WARN("progress_ring: no memory for a %dx%d track", (int)d, (int)d);
+        return NULL;
+    }
+    canvas = lv_canvas_create(lv_layer_sys());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, buf);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_TRANSP);
+    lv_canvas_init_layer(canvas, &layer);
+
+    lv_draw_arc_dsc_init(&dsc);
+    dsc.color = ring->track_color;
+    dsc.center.x = ring->geometry.radius;
+    dsc.center.y = ring->geometry.radius;
+    dsc.radius = (uint16_t)ring->geometry.radius;
+    dsc.width = ring->geometry.width;
+    dsc.start_angle = 0;
+    dsc.end_angle = 360;
+    lv_draw_arc(&layer, &dsc);
+
+    lv_canvas_finish_layer(canvas, &layer);
+    lv_obj_delete(canvas);
+    return buf;
+}
+
+static void progress_ring_draw(lv_obj_t *obj, const ProgressRing_t *ring, lv_layer_t *layer)
+{
+    lv_draw_arc_dsc_t arc;
+
+    init_arc_dsc(obj, ring, &arc);
+
+    // Track: the part of the image under the invalidated area is blended, nothing else
+    if (ring->track) {
+        lv_draw_image_dsc_t img;
+        lv_area_t coords;
+
+        lv_obj_get_coords(obj, &coords);
+        lv_draw_image_dsc_init(&img);
+        img.src = ring->track;
+        img.opa = arc.opa;
+        lv_draw_image(layer, &img, &coords);
+    }
+    else {
+        lv_draw_arc_dsc_t track = arc;
+
+        track.color = ring->track_color;
+        track.rounded = 0;
+        track.start_angle = 0;
+        track.end_angle = 360;
+        lv_draw_arc(layer, &track);
+    }
+
+    // Indicator: from the moving end to 12 o'clock
+    if (ring->angle >= RING_TURN) return;
+    arc.color = ring->indicator_color;
+    if (ring->angle == 0) {
+        arc.start_angle = 0;
+        arc.end_angle = 360;
+        arc.rounded = 0;
+    }
+    else {
+        arc.start_angle = lv_angle(ring->angle);
+        arc.end_angle = lv_angle(RING_TURN);
+    }
+    lv_draw_arc(layer, &arc);
+}
+
+/* Invalidate the part of the ring between the angles a and b */
+static void invalidate_sector(lv_obj_t *obj, const ProgressRing_t *ring, int32_t a, int32_t b)
+{
+    RingArea_t sector = ring_sector_area(&ring->geometry, a, b);
+    lv_area_t coords;
+    lv_area_t area;
+
+    if (ring_area_size(&sector) == 0) return;
+    lv_obj_get_coords(obj, &coords);
+    area.x1 = coords.x1 + sector.x1;
+    area.y1 = coords.y1 + sector.y1;
+    area.x2 = coords.x1 + sector.x2;
+    area.y2 = coords.y1 + sector.y2;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static bool progress_ring_move(lv_obj_t *obj, ProgressRing_t *ring, int32_t angle)
+{
+    if (angle == ring->angle) return false;
+    // A full ring has no caps, filling or emptying it changes the whole ring
+    if (angle == 0 || ring->angle == 0) {
+        lv_obj_invalidate(obj);
+    }
+    else {
+        invalidate_sector(obj, ring, ring->angle, angle);
+    }
+    ring->angle = angle;
+    return true;
+}
+
+static void progress_ring_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    ProgressRing_t *ring = lv_obj_get_user_data(obj);
+
+    if (!ring) return;
+    if (lv_event_get_code(e) == LV_EVENT_DRAW_MAIN) {
+        progress_ring_draw(obj, ring, lv_event_get_layer(e));
+    }
+    else if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+        if (ring->track) {
+            lv_image_cache_drop(ring->track);
+            lv_draw_buf_destroy(ring->track);
+        }
+        lv_free(ring);
+        lv_obj_set_user_data(obj, NULL);
+    }
+}
+
+lv_obj_t *progress_ring_create(lv_obj_t *parent, int32_t diameter, int32_t width,
+                               lv_color_t track_color, lv_color_t indicator_color)
+{
+    lv_obj_t *obj = lv_obj_create(parent);
+    ProgressRing_t *ring = lv_malloc_zeroed(sizeof(ProgressRing_t));
+
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(obj, diameter, diameter);
+    if (!ring) return obj;
+
+    ring->geometry.radius = diameter / 2;
+    ring->geometry.width = width;
+    ring->geometry.rounded = true;
+    ring->track_color = track_color;
+    ring->indicator_color = indicator_color;
+    ring->range = 1;
+    ring->value = 1;
+    ring->angle = 0;
+    ring->track = paint_track(ring);
+
+    lv_obj_set_user_data(obj, ring);
+    lv_obj_add_event_cb(obj, progress_ring_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, progress_ring_event_cb, LV_EVENT_DELETE, NULL);
+    return obj;
+}
+
+void progress_ring_set_range(lv_obj_t *obj, uint32_t range)
+{
+    ProgressRing_t *ring = lv_obj_get_user_data(obj);
+
+    if (!ring) return;
+    ring->range = range;
+    progress_ring_move(obj, ring, ring_angle_of(ring->value, ring->range));
+}
+
+void progress_ring_set_value(lv_obj_t *obj, uint32_t value)
+{
+    ProgressRing_t *ring = lv_obj_get_user_data(obj);
+
+    if (!ring) return;
+    ring->value = value;
+    progress_ring_move(obj, ring, ring_angle_of(ring->value, ring->range));
+}
+
+bool progress_ring_set_progress_q16(lv_obj_t *obj, uint32_t done_q16)
+{
+    ProgressRing_t *ring = lv_obj_get_user_data(obj);
+
+    if (!ring) return false;
+    return progress_ring_move(obj, ring, ring_angle_of_q16(done_q16));
+}
+
+void progress_ring_set_indicator_color(lv_obj_t *obj, lv_color_t color)
+{
+    ProgressRing_t *ring = lv_obj_get_user_data(obj);
+
+    if (!ring || lv_color_eq(ring->indicator_color, color)) return;
+    ring->indicator_color = color;
+    // The indicator only, from the moving end to 12 o'clock
+    if (ring->angle == 0) {
+        lv_obj_invalidate(obj);
+    }
+    else {
+        invalidate_sector(obj, ring, ring->angle, RING_TURN);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef __H_PROGRESS_RING_H__
+#define __H_PROGRESS_RING_H__
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/*
+ * Progress ring: the circular indicator of the main screen, counting down
+ * like an lv_arc in LV_ARC_MODE_REVERSE rotated to 12 o'clock.
+ *
+ * The track is drawn once into an image, at creation. A new value
+ * invalidates only the box around the part of the ring between the old and
+ * the new end (ring_geometry.h); rendering it blits that part of the track
+ * and draws the indicator arc clipped to it. Values that do not move the
+ * end by a 1/RING_ANGLE_UNITS degree invalidate nothing.
+ *
+ * Without memory for the track image the track is drawn as an arc.
+ */
+
+/* A ring of diameter px, width px thick, full */
+lv_obj_t *progress_ring_create(lv_obj_t *parent, int32_t diameter, int32_t width,
+                               lv_color_t track_color, lv_color_t indicator_color);
+
+/* Length of the countdown, the value is kept */
+void progress_ring_set_range(lv_obj_t *obj, uint32_t range);
+
+/* Left of the range: range shows a full ring, 0 an empty one */
+void progress_ring_set_value(lv_obj_t *obj, uint32_t value);
+
+/*
+ * Done of the phase in Q16, 0 a full ring and 65536 an empty one, instead of
+ * the value. For animating between values: returns false if the end did not
+ * move, nothing was invalidated. The next set_value()/set_range() moves the
+ * end back to the value.
+ */
+bool progress_ring_set_progress_q16(lv_obj_t *obj, uint32_t done_q16);
+
+void progress_ring_set_indicator_color(lv_obj_t *obj, lv_color_t color);
+
+#endif/* __H_PROGRESS_RING_H__ */
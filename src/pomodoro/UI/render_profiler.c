@@ -0,0 +1,253 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "render_profiler.h"
+#include "app_timer.h"
+
+#if POMODORO_RENDER_PROFILER
+
+#include "pomodoro.h"
+#include "full_screen.h"
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
+#define OVERLAY_PERIOD_MS       1000
+
+static RenderStats_t stats;
+static RenderFrame_t frame;
+static bool in_frame;
+static uint64_t frame_start_us;
+static uint64_t flush_start_us;
+static uint32_t pending_invalidations;
+
+// Frames since the overlay was last updated
+static uint32_t window_frames;
+static uint64_t window_render_us;
+static uint32_t window_max_us;
+static uint64_t window_area_px;
+static uint64_t window_tasks;
+
+static lv_obj_t *overlay;
+static lv_timer_t *overlay_timer;
+
+/* lv_tick_get() counts ms, a frame of the arc takes a fraction of one */
+static uint64_t now_us(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000u +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000u / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+static RenderMode_e current_mode(void)
+{
+    switch (pomodoro_get_state()) {
+        case POMODORO_WORK:
+            return is_fullscreen_timer_shown() ? RENDER_MODE_FULLSCREEN : RENDER_MODE_WORK;
+        case POMODORO_SHORT_BREAK:
+        case POMODORO_LONG_BREAK:
+            return RENDER_MODE_BREAK;
+        case POMODORO_PAUSED_WORK:
+        case POMODORO_PAUSED_BREAK:
+            return RENDER_MODE_PAUSED;
+        default:
+            return RENDER_MODE_IDLE;
+    }
+}
+
+static RenderTask_e task_kind(lv_draw_task_type_t type)
+{
+    switch (type) {
+        case LV_DRAW_TASK_TYPE_FILL:            return RENDER_TASK_FILL;
+        case LV_DRAW_TASK_TYPE_BORDER:          return RENDER_TASK_BORDER;
+        case LV_DRAW_TASK_TYPE_BOX_SHADOW:      return RENDER_TASK_BOX_SHADOW;
+        case LV_DRAW_TASK_TYPE_LABEL:           return RENDER_TASK_LABEL;
+        case LV_DRAW_TASK_TYPE_IMAGE:           return RENDER_TASK_IMAGE;
+        case LV_DRAW_TASK_TYPE_LAYER:           return RENDER_TASK_LAYER;
+        case LV_DRAW_TASK_TYPE_LINE:            return RENDER_TASK_LINE;
+        case LV_DRAW_TASK_TYPE_ARC:             return RENDER_TASK_ARC;
+        case LV_DRAW_TASK_TYPE_TRIANGLE:        return RENDER_TASK_TRIANGLE;
+        case LV_DRAW_TASK_TYPE_MASK_RECTANGLE:
+        case LV_DRAW_TASK_TYPE_MASK_BITMAP:     return RENDER_TASK_MASK;
+        default:                                return RENDER_TASK_OTHER;
+    }
+}
+
+static void draw_task_event_cb(lv_event_t *e)
+{
+    lv_draw_task_t *task = lv_event_get_draw_task(e);
+    RenderTask_e kind;
+
+    if (!in_frame || task == NULL) return;
+    kind = task_kind(lv_draw_task_get_type(task));
+    if (frame.tasks[kind] < UINT16_MAX) frame.tasks[kind]++;
+}
+
+/* Ask for the draw tasks of obj and its children, objects already asked are skipped */
+static void hook_tree(lv_obj_t *obj)
+{
+    uint32_t count = lv_obj_get_child_count(obj);
+
+    if (!lv_obj_has_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS)) {
+        lv_obj_add_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+        lv_obj_add_event_cb(obj, draw_task_event_cb, LV_EVENT_DRAW_TASK_ADDED, NULL);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        hook_tree(lv_obj_get_child(obj, (int32_t)i));
+    }
+}
+
+static void display_event_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+
+    switch (code) {
+        case LV_EVENT_INVALIDATE_AREA:
+            pending_invalidations++;
+            // Something will be rendered: the overlay has a window to show again
+            if (overlay_timer) app_timer_resume(overlay_timer);
+            break;
+
+        case LV_EVENT_RENDER_START:
+            lv_memzero(&frame, sizeof(frame));
+            frame.invalidations = pending_invalidations;
+            pending_invalidations = 0;
+            in_frame = true;
+            frame_start_us = now_us();
+            break;
+
+        case LV_EVENT_FLUSH_START: {
+            const lv_area_t *area = lv_event_get_param(e);
+            if (area) frame.area_px += (uint32_t)lv_area_get_size(area);
+            flush_start_us = now_us();
+            break;
+        }
+
+        case LV_EVENT_FLUSH_FINISH:
+            frame.flush_us += (uint32_t)(now_us() - flush_start_us);
+            break;
+
+        case LV_EVENT_RENDER_READY:
+            if (!in_frame) break;
+            in_frame = false;
+            frame.render_us = (uint32_t)(now_us() - frame_start_us);
+            render_stats_add(&stats, current_mode(), &frame);
+
+            window_frames++;
+            window_render_us += frame.render_us;
+            window_area_px += frame.area_px;
+            if (frame.render_us > window_max_us) window_max_us = frame.render_us;
+            for (uint32_t t = 0; t < RENDER_TASK_COUNT; t++) {
+                window_tasks += frame.tasks[t];
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void overlay_timer_cb(lv_timer_t *t)
+{
+    uint32_t mean_us = window_frames ? (uint32_t)(window_render_us / window_frames) : 0;
+    uint32_t area_k = window_frames ? (uint32_t)(window_area_px / window_frames / 1000u) : 0;
+    uint32_t tasks = window_frames ? (uint32_t)(window_tasks / window_frames) : 0;
+
+    // Widgets created since the last pass (settings, fullscreen timer) start reporting their tasks
+    hook_tree(lv_screen_active());
+    hook_tree(lv_layer_top());
+
+    // Nothing rendered: keep the last window on screen and let the main loop sleep until an invalidation
+    if (window_frames == 0) {
+        app_timer_pause(t);
+        return;
+    }
+
+    if (overlay && !lv_obj_has_flag(overlay, LV_OBJ_FLAG_HIDDEN)) {
+        char text[96];
+
+        lv_snprintf(text, sizeof(text), "%s %u fps\n%u.%u ms max %u.%u\n%uk px %u tasks",
+                    render_stats_mode_name(current_mode()), (unsigned)window_frames,
+                    (unsigned)(mean_us / 1000u), (unsigned)(mean_us / 100u % 10u),
+                    (unsigned)(window_max_us / 1000u), (unsigned)(window_max_us / 100u % 10u),
+                    (unsigned)area_k, (unsigned)tasks);
+        // The same text again would render the overlay, which is a frame of its own
+        if (strcmp(text, lv_label_get_text(overlay)) != 0) {
+            lv_label_set_text(overlay, text);
+        }
+    }
+
+    window_frames = 0;
+    window_render_us = 0;
+    window_max_us = 0;
+    window_area_px = 0;
+    window_tasks = 0;
+}
+
+void render_profiler_start(lv_display_t *disp)
+{
+    if (overlay_timer) return;
+
+    render_stats_reset(&stats);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+
+    // On the system layer, above the screens and the top layer whose tasks are counted
+    overlay = lv_label_create(lv_layer_sys());
+    lv_obj_set_style_text_font(overlay, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_color(overlay, lv_color_hex(0xffffff), 0);
+    lv_obj_set_style_bg_color(overlay, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_60, 0);
+    lv_obj_set_style_pad_all(overlay, 3, 0);
+    lv_obj_align(overlay, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_label_set_text(overlay, "");
+
+    overlay_timer = app_timer_create(overlay_timer_cb, OVERLAY_PERIOD_MS);
+    overlay_timer_cb(overlay_timer);
+}
+
+void render_profiler_show_overlay(bool show)
+{
+    if (!overlay) return;
+    if (show) {
+        lv_obj_clear_flag(overlay, LV_OBJ_FLAG_HIDDEN);
+    }
+    else {
+        lv_obj_add_flag(overlay, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+const RenderStats_t *render_profiler_get_stats(void)
+{
+    return &stats;
+}
+
+bool render_profiler_write_csv(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    bool ok;
+
+    if (f == NULL) return false;
+    ok = render_stats_write_csv(f, &stats);
+    return (fclose(f) == 0) && ok;
+}
+
+#endif /* POMODORO_RENDER_PROFILER */
@@ -0,0 +1,44 @@
+#ifndef __H_RENDER_PROFILER_H__
+#define __H_RENDER_PROFILER_H__
+
+#include <stdbool.h>
+#include "lvgl.h"
+#include "render_stats.h"
+
+/*
+ * Render profiler: hooks the render and flush events of a display and, for
+ * every frame LVGL renders, records its render time, the pixels flushed, the
+ * invalidations behind it and the draw tasks of the screen's widgets by type
+ * (arc, box_shadow, image, label...), into the histograms of the mode the UI
+ * is in (see render_stats.h). A small label on the system layer shows the
+ * last second; render_profiler_write_csv() writes the histograms.
+ *
+ * Draw tasks are counted through LV_EVENT_DRAW_TASK_ADDED, so the profiler
+ * sets LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS on the objects of the active screen
+ * and the top layer, once a second for objects created since. The overlay
+ * redraws itself once a second, which the pixel counts include.
+ *
+ * Compiled in with POMODORO_RENDER_PROFILER=1 (CMake option of the same
+ * name), independent of LV_USE_PROFILER and LV_USE_PERF_MONITOR.
+ */
+
+#ifndef POMODORO_RENDER_PROFILER
+#define POMODORO_RENDER_PROFILER    0
+#endif
+
+#if POMODORO_RENDER_PROFILER
+
+/* Start recording the frames of disp, with the overlay shown */
+void render_profiler_start(lv_display_t *disp);
+
+void render_profiler_show_overlay(bool show);
+
+/* The histograms so far, from the LVGL thread */
+const RenderStats_t *render_profiler_get_stats(void);
+
+/* Write the histograms as CSV to a new file, false if it cannot be written */
+bool render_profiler_write_csv(const char *path);
+
+#endif /* POMODORO_RENDER_PROFILER */
+
+#endif/* __H_RENDER_PROFILER_H__ */
@@ -0,0 +1,135 @@
+#include <string.h>
+#include "render_stats.h"
+
+// Up to a 60 Hz frame in fine steps, then one and two frames missed
+static const uint32_t time_edge_us[RENDER_TIME_BUCKETS] = {
+    250, 500, 1000, 2000, 4000, 8000, 16000, 33000, 66000, UINT32_MAX
+};
+
+// The 200 px arc is 40k pixels, a 480x480 screen 230k
+static const uint32_t area_edge_px[RENDER_AREA_BUCKETS] = {
+    1024, 4096, 16384, 65536, 262144, UINT32_MAX
+};
+
+static const char *const mode_names[RENDER_MODE_COUNT] = {
+    "IDLE", "WORK", "BREAK", "PAUSED", "FULLSCREEN"
+};
+
+static const char *const task_names[RENDER_TASK_COUNT] = {
+    "fill", "border", "box_shadow", "label", "image", "layer", "line", "arc", "triangle", "mask", "other"
+};
+
+static uint32_t bucket_of(const uint32_t *edges, uint32_t count, uint32_t value)
+{
+    uint32_t b = 0;
+
+    while (b < count - 1u && value > edges[b]) b++;
+    return b;
+}
+
+static double ms_of(uint64_t us)
+{
+    return (double)us / 1000.0;
+}
+
+void render_stats_reset(RenderStats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void render_stats_add(RenderStats_t *stats, RenderMode_e mode, const RenderFrame_t *frame)
+{
+    RenderModeStats_t *m;
+
+    if ((unsigned)mode >= RENDER_MODE_COUNT) return;
+    m = &stats->mode[mode];
+
+    m->frames++;
+    m->render_us += frame->render_us;
+    m->flush_us += frame->flush_us;
+    m->area_px += frame->area_px;
+    m->invalidations += frame->invalidations;
+    if (frame->render_us > m->max_us) m->max_us = frame->render_us;
+    m->time_hist[bucket_of(time_edge_us, RENDER_TIME_BUCKETS, frame->render_us)]++;
+    m->area_hist[bucket_of(area_edge_px, RENDER_AREA_BUCKETS, frame->area_px)]++;
+    for (uint32_t t = 0; t < RENDER_TASK_COUNT; t++) {
+        m->tasks[t] += frame->tasks[t];
+    }
+}
+
+uint32_t render_stats_percentile_us(const RenderModeStats_t *mode, uint32_t pct)
+{
+    // Frames at or below the percentile, rounded up so p99 of 10 frames is the slowest
+    uint64_t need = ((uint64_t)mode->frames * pct + 99u) / 100u;
+    uint64_t seen = 0;
+
+    if (mode->frames == 0) return 0;
+    if (need == 0) need = 1;
+    for (uint32_t b = 0; b < RENDER_TIME_BUCKETS; b++) {
+        seen += mode->time_hist[b];
+        if (seen >= need) {
+            // The open last bucket reports the slowest frame instead of its edge
+            return (b == RENDER_TIME_BUCKETS - 1u) ? mode->max_us : time_edge_us[b];
+        }
+    }
+    return mode->max_us;
+}
+
+uint32_t render_stats_time_edge_us(uint32_t bucket)
+{
+    return (bucket < RENDER_TIME_BUCKETS) ? time_edge_us[bucket] : UINT32_MAX;
+}
+
+uint32_t render_stats_area_edge_px(uint32_t bucket)
+{
+    return (bucket < RENDER_AREA_BUCKETS) ? area_edge_px[bucket] : UINT32_MAX;
+}
+
+const char *render_stats_mode_name(RenderMode_e mode)
+{
+    return ((unsigned)mode < RENDER_MODE_COUNT) ? mode_names[mode] : "UNKNOWN";
+}
+
+const char *render_stats_task_name(RenderTask_e task)
+{
+    return ((unsigned)task < RENDER_TASK_COUNT) ? task_names[task] : "unknown";
+}
+
+bool render_stats_write_csv(FILE *f, const RenderStats_t *stats)
+{
+    fprintf(f, "mode,frames,render_ms_mean,render_ms_p50,render_ms_p99,render_ms_max,flush_ms_mean,"
+               "redrawn_px_mean,invalidations_mean");
+    for (uint32_t b = 0; b < RENDER_TIME_BUCKETS - 1u; b++) {
+        fprintf(f, ",render_le_%uus", (unsigned)time_edge_us[b]);
+    }
+    fprintf(f, ",render_gt_%uus", (unsigned)time_edge_us[RENDER_TIME_BUCKETS - 2u]);
+    for (uint32_t b = 0; b < RENDER_AREA_BUCKETS - 1u; b++) {
+        fprintf(f, ",area_le_%upx", (unsigned)area_edge_px[b]);
+    }
+    fprintf(f, ",area_gt_%upx", (unsigned)area_edge_px[RENDER_AREA_BUCKETS - 2u]);
+    for (uint32_t t = 0; t < RENDER_TASK_COUNT; t++) {
+        fprintf(f, ",tasks_%s", task_names[t]);
+    }
+    fputc('\n', f);
+
+    for (uint32_t i = 0; i < RENDER_MODE_COUNT; i++) {
+        const RenderModeStats_t *m = &stats->mode[i];
+        double n = m->frames ? (double)m->frames : 1.0;
+
+        fprintf(f, "%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f,%.2f", mode_names[i], (unsigned)m->frames,
+                ms_of(m->render_us) / n, ms_of(render_stats_percentile_us(m, 50)),
+                ms_of(render_stats_percentile_us(m, 99)), ms_of(m->max_us), ms_of(m->flush_us) / n,
+                (double)m->area_px / n, (double)m->invalidations / n);
+        for (uint32_t b = 0; b < RENDER_TIME_BUCKETS; b++) {
+            fprintf(f, ",%u", (unsigned)m->time_hist[b]);
+        }
+        for (uint32_t b = 0; b < RENDER_AREA_BUCKETS; b++) {
+            fprintf(f, ",%u", (unsigned)m->area_hist[b]);
+        }
+        for (uint32_t t = 0; t < RENDER_TASK_COUNT; t++) {
+            fprintf(f, ",%.2f", (double)m->tasks[t] / n);
+        }
+        fputc('\n', f);
+    }
+    return !ferror(f);
+}
@@ -0,0 +1,93 @@
+#ifndef __H_RENDER_STATS_H__
+#define __H_RENDER_STATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Frame statistics of the render profiler, without LVGL: every rendered
+ * frame is added to the histograms of the mode the UI was in (IDLE, WORK,
+ * BREAK, PAUSED or the fullscreen overlay), with its render time, the pixels
+ * flushed, the invalidations that caused it and its draw tasks by type.
+ * Adding a frame is a few increments, the histograms have fixed buckets so
+ * a profiling run can last for hours.
+ */
+
+/* Render time buckets, upper edges in us; the last bucket holds everything above */
+#define RENDER_TIME_BUCKETS     10
+/* Redrawn area buckets, upper edges in pixels */
+#define RENDER_AREA_BUCKETS     6
+
+typedef enum {
+    RENDER_MODE_IDLE,
+    RENDER_MODE_WORK,
+    RENDER_MODE_BREAK,
+    RENDER_MODE_PAUSED,
+    RENDER_MODE_FULLSCREEN,     // WORK with the fullscreen timer shown
+    RENDER_MODE_COUNT
+} RenderMode_e;
+
+/* Draw tasks as the profiler sorts them, LVGL types it does not know go to OTHER */
+typedef enum {
+    RENDER_TASK_FILL,
+    RENDER_TASK_BORDER,
+    RENDER_TASK_BOX_SHADOW,
+    RENDER_TASK_LABEL,
+    RENDER_TASK_IMAGE,
+    RENDER_TASK_LAYER,
+    RENDER_TASK_LINE,
+    RENDER_TASK_ARC,
+    RENDER_TASK_TRIANGLE,
+    RENDER_TASK_MASK,
+    RENDER_TASK_OTHER,
+    RENDER_TASK_COUNT
+} RenderTask_e;
+
+typedef struct {
+    uint32_t render_us;                     // RENDER_START to RENDER_READY, flushes included
+    uint32_t flush_us;                      // Part of it spent in the display driver
+    uint32_t area_px;                       // Pixels flushed
+    uint32_t invalidations;                 // Areas invalidated since the previous frame
+    uint16_t tasks[RENDER_TASK_COUNT];
+} RenderFrame_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t max_us;
+    uint64_t render_us;
+    uint64_t flush_us;
+    uint64_t area_px;
+    uint64_t invalidations;
+    uint32_t time_hist[RENDER_TIME_BUCKETS];
+    uint32_t area_hist[RENDER_AREA_BUCKETS];
+    uint64_t tasks[RENDER_TASK_COUNT];
+} RenderModeStats_t;
+
+typedef struct {
+    RenderModeStats_t mode[RENDER_MODE_COUNT];
+} RenderStats_t;
+
+void render_stats_reset(RenderStats_t *stats);
+
+void render_stats_add(RenderStats_t *stats, RenderMode_e mode, const RenderFrame_t *frame);
+
+/* Render time under which pct percent of the frames of a mode fall, as the upper edge of its bucket */
+uint32_t render_stats_percentile_us(const RenderModeStats_t *mode, uint32_t pct);
+
+/* Upper edge of a bucket, UINT32_MAX for the last one */
+uint32_t render_stats_time_edge_us(uint32_t bucket);
+uint32_t render_stats_area_edge_px(uint32_t bucket);
+
+const char *render_stats_mode_name(RenderMode_e mode);
+const char *render_stats_task_name(RenderTask_e task);
+
+/*
+ * One CSV line per mode, after a header: frames, mean / p50 / p99 / max
+ * render time in ms, mean flush time, mean redrawn pixels and invalidations,
+ * the count of frames in each time and area bucket, and the mean draw tasks
+ * of each type per frame. Modes without frames are written with zeros.
+ */
+bool render_stats_write_csv(FILE *f, const RenderStats_t *stats);
+
+#endif/* __H_RENDER_STATS_H__ */
@@ -0,0 +1,117 @@
+#include "ring_geometry.h"
+
+// sin() of 0..90 degrees, Q15
+static const int16_t sin_table[91] = {
+    0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126,
+    5690, 6252, 6813, 7371, 7927, 8481, 9032, 9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14364, 14876, 15383, 15886,
+    16383, 16876, 17364, 17846, 18323, 18794, 19260, 19720, 20173, 20621,
+    21062, 21497, 21925, 22347, 22762, 23170, 23571, 23964, 24351, 24730,
+    25101, 25465, 25821, 26169, 26509, 26841, 27165, 27481, 27788, 28087,
+    28377, 28659, 28932, 29196, 29451, 29697, 29934, 30162, 30381, 30591,
+    30791, 30982, 31163, 31335, 31498, 31650, 31794, 31927, 32051, 32165,
+    32269, 32364, 32448, 32523, 32587, 32642, 32687, 32722, 32747, 32762,
+    32767,
+};
+
+static int32_t wrap(int32_t angle)
+{
+    angle %= RING_TURN;
+    return (angle < 0) ? angle + RING_TURN : angle;
+}
+
+static int32_t sin_quarter(int32_t angle)
+{
+    int32_t deg = angle / RING_ANGLE_UNITS;
+    int32_t frac = angle % RING_ANGLE_UNITS;
+
+    if (deg >= 90) return sin_table[90];
+    return sin_table[deg] + (sin_table[deg + 1] - sin_table[deg]) * frac / RING_ANGLE_UNITS;
+}
+
+int32_t ring_sin(int32_t angle)
+{
+    const int32_t quarter = 90 * RING_ANGLE_UNITS;
+
+    angle = wrap(angle);
+    if (angle < quarter) return sin_quarter(angle);
+    if (angle < 2 * quarter) return sin_quarter(2 * quarter - angle);
+    if (angle < 3 * quarter) return -sin_quarter(angle - 2 * quarter);
+    return -sin_quarter(RING_TURN - angle);
+}
+
+int32_t ring_angle_of(uint32_t value, uint32_t range)
+{
+    if (range == 0 || value >= range) return 0;
+    return ring_angle_of_q16((uint32_t)(((uint64_t)(range - value) << 16) / range));
+}
+
+int32_t ring_angle_of_q16(uint32_t done_q16)
+{
+    if (done_q16 >= 65536u) return RING_TURN;
+    return (int32_t)(((uint64_t)done_q16 * RING_TURN + 32768u) >> 16);
+}
+
+RingArea_t ring_bounds(const RingGeometry_t *g)
+{
+    RingArea_t a = { 0, 0, 2 * g->radius - 1, 2 * g->radius - 1 };
+    return a;
+}
+
+/* Grow a by the point at radius r and angle, and by pad around it */
+static void add_point(RingArea_t *a, int32_t c, int32_t r, int32_t angle, int32_t pad)
+{
+    int32_t x = c + ((r * ring_sin(angle) + 16384) >> 15);
+    int32_t y = c - ((r * ring_sin(angle + 90 * RING_ANGLE_UNITS) + 16384) >> 15);
+
+    if (x - pad < a->x1) a->x1 = x - pad;
+    if (x + pad > a->x2) a->x2 = x + pad;
+    if (y - pad < a->y1) a->y1 = y - pad;
+    if (y + pad > a->y2) a->y2 = y + pad;
+}
+
+RingArea_t ring_sector_area(const RingGeometry_t *g, int32_t a, int32_t b)
+{
+    RingArea_t area = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+    RingArea_t bounds = ring_bounds(g);
+    int32_t c = g->radius;
+    int32_t r_in = g->radius - g->width;
+    int32_t span;
+
+    if (a == b) {
+        RingArea_t empty = { 0, 0, -1, -1 };
+        return empty;
+    }
+    if (a > b) {
+        int32_t t = a;
+        a = b;
+        b = t;
+    }
+    span = b - a;
+    if (span >= RING_TURN) return bounds;
+    a = wrap(a);
+    b = a + span;
+
+    if (g->rounded) {
+        // The caps: a disc across the ring at each end
+        int32_t r_mid = g->radius - g->width / 2;
+        add_point(&area, c, r_mid, a, g->width / 2 + 1);
+        add_point(&area, c, r_mid, b, g->width / 2 + 1);
+    }
+    else {
+        add_point(&area, c, g->radius, a, 1);
+        add_point(&area, c, r_in, a, 1);
+        add_point(&area, c, g->radius, b, 1);
+        add_point(&area, c, r_in, b, 1);
+    }
+    // The outer edge reaches furthest where it crosses 12, 3, 6 and 9 o'clock
+    for (int32_t q = 0; q <= 2 * RING_TURN; q += 90 * RING_ANGLE_UNITS) {
+        if (q > a && q < b) add_point(&area, c, g->radius, q, 1);
+    }
+
+    if (area.x1 < bounds.x1) area.x1 = bounds.x1;
+    if (area.y1 < bounds.y1) area.y1 = bounds.y1;
+    if (area.x2 > bounds.x2) area.x2 = bounds.x2;
+    if (area.y2 > bounds.y2) area.y2 = bounds.y2;
+    return area;
+}
@@ -0,0 +1,56 @@
+#ifndef __H_RING_GEOMETRY_H__
+#define __H_RING_GEOMETRY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Geometry of the progress ring, without LVGL: where the moving end of the
+ * indicator is, and the smallest box that covers the part of the ring
+ * between two positions of it. The box is what the ring invalidates on a
+ * tick: a wedge about as wide as the ring, whatever its diameter, instead
+ * of the whole ring.
+ *
+ * Angles are in 1/RING_ANGLE_UNITS degree, clockwise from 12 o'clock.
+ * Coordinates are relative to the top-left corner of the ring's square.
+ */
+
+#define RING_ANGLE_UNITS    64                          /* per degree */
+#define RING_TURN           (360 * RING_ANGLE_UNITS)
+
+typedef struct {
+    int32_t x1, y1, x2, y2;     // Inclusive, as lv_area_t
+} RingArea_t;
+
+typedef struct {
+    int32_t radius;             // Outer radius, the square is 2 * radius wide
+    int32_t width;              // Of the ring, inwards from radius
+    bool rounded;               // Round caps on the indicator ends
+} RingGeometry_t;
+
+/* Angle of the moving end with value of range left, the indicator runs from it to RING_TURN */
+int32_t ring_angle_of(uint32_t value, uint32_t range);
+
+/* Angle of the moving end once done_q16 (0..65536) of the phase is done */
+int32_t ring_angle_of_q16(uint32_t done_q16);
+
+/* sin() of an angle in RING_ANGLE_UNITS, Q15 */
+int32_t ring_sin(int32_t angle);
+
+/* The ring's square */
+RingArea_t ring_bounds(const RingGeometry_t *g);
+
+/*
+ * Box around the ring between angles a and b, in either order: both caps
+ * and a pixel of anti-aliasing included, the whole ring if they are a turn
+ * or more apart. Empty (x2 < x1) if a == b.
+ */
+RingArea_t ring_sector_area(const RingGeometry_t *g, int32_t a, int32_t b);
+
+static inline uint32_t ring_area_size(const RingArea_t *a)
+{
+    if (a->x2 < a->x1 || a->y2 < a->y1) return 0;
+    return (uint32_t)(a->x2 - a->x1 + 1) * (uint32_t)(a->y2 - a->y1 + 1);
+}
+
+#endif/* __H_RING_GEOMETRY_H__ */
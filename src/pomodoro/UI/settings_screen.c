@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include "settings_screen.h"
 #include "event.h"
+#include "pomodoro_runtime.h"
+#include "settings_store.h"
 #include "lvgl.h"
 
 typedef struct {
@@ -11,12 +13,8 @@ typedef struct {
     lv_obj_t *cycle_roller;
 } rollers_t;
 
-static PomodoroSettings_t settings = {
-    .work_min = 25,
-    .short_break_min = 5,
-    .long_break_min = 15,
-    .cycles_before_long = 4
-};
+// Edited by the rollers, loaded from the settings store each time the screen opens
+static PomodoroSettings_t settings;
 
 static lv_obj_t *settings_screen;
 static lv_style_t setting_section_label_style;
@@ -153,7 +151,16 @@ static void roller_event_handler(lv_event_t *e)
 static void setting_event_handler(lv_event_t *e)
 {
     LV_LOG_USER("Settings saved. Returning to Main screen...\n");
-    event_dispatch(EVENT_SETTINGS, &settings);
+    if (!settings_store_save_pomodoro(&settings)) {
+        LV_LOG_WARN("Settings not stored, they apply until the app is closed\n");
+    }
+    if (pomodoro_runtime_is_running()) {
+        // Only the timing thread touches the Core: queued ahead of the reset posted by the main screen
+        event_post_settings(&settings);
+    } else {
+        // Applied right away, not posted: the main screen is rebuilt from the new settings below
+        event_dispatch(EVENT_SETTINGS, &settings);
+    }
 
     ui_main_screen(lv_scr_act());
 
@@ -168,6 +175,8 @@ void show_settings_screen(lv_obj_t *parent)
     static rollers_t rollers;
     static lv_obj_t *cycle_setting;
 
+    settings_store_load_pomodoro(&settings);
+
     settings_screen = lv_obj_create(parent);
     ui_setting_screen_set_bg_by_theme(settings_screen);
 
@@ -254,21 +263,28 @@ static void ui_setting_screen_set_bg_by_theme(lv_obj_t *parent)
 
 int settings_get_work_time()
 {
-    return settings.work_min;
+    PomodoroSettings_t stored;
+    settings_store_load_pomodoro(&stored);
+    return stored.work_min;
 }
 
 int settings_get_short_break()
 {
-    return settings.short_break_min;
+    PomodoroSettings_t stored;
+    settings_store_load_pomodoro(&stored);
+    return stored.short_break_min;
 }
 
 int settings_get_long_break()
 {
-    return settings.long_break_min;
+    PomodoroSettings_t stored;
+    settings_store_load_pomodoro(&stored);
+    return stored.long_break_min;
 }
 
 int settings_get_cycle_count()
 {
-   //TODO: Make this configurable in the future
-   return 4; // Default cycle count
-}
\ No newline at end of file
+    PomodoroSettings_t stored;
+    settings_store_load_pomodoro(&stored);
+    return stored.cycles_before_long;
+}
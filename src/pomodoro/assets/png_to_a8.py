@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Convert a PNG icon into an LVGL 9 A8 image (alpha mask) as a C source file.
+
+The icons only carry their shape in the alpha channel, their colour is the
+recolor of the style. An A8 copy is a quarter of the ARGB8888 one, and LVGL
+draws it by blending the recolor through the mask. --scale resizes it here,
+with an area average, so that no layout needs lv_image_set_scale() at draw
+time.
+
+Usage: png_to_a8.py input.png output.c [--scale 0.7] [--suffix _240x320]
+
+The image is named after the input file (run.png -> `run`) plus the suffix.
+Only the Python standard library is used: 8-bit non-interlaced PNGs with an
+alpha channel (RGBA, grey + alpha, or a palette with tRNS).
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import zlib
+
+PNG_MAGIC = b"\x89PNG\r\n\x1a\n"
+
+
+def fail(path, what):
+    sys.exit("png_to_a8: %s: %s" % (path, what))
+
+
+def read_chunks(path, data):
+    pos = len(PNG_MAGIC)
+    while pos + 8 <= len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if len(body) != length:
+            fail(path, "truncated %s chunk" % kind.decode("latin-1"))
+        yield kind, body
+        pos += 12 + length
+
+
+def unfilter(path, raw, height, stride, bpp):
+    """Undo the per-row filters, return the rows as bytearrays"""
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        row = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        if kind == 1:
+            for i in range(bpp, stride):
+                row[i] = (row[i] + row[i - bpp]) & 0xFF
+        elif kind == 2:
+            for i in range(stride):
+                row[i] = (row[i] + prev[i]) & 0xFF
+        elif kind == 3:
+            for i in range(stride):
+                left = row[i - bpp] if i >= bpp else 0
+                row[i] = (row[i] + ((left + prev[i]) >> 1)) & 0xFF
+        elif kind == 4:
+            for i in range(stride):
+                a = row[i - bpp] if i >= bpp else 0
+                b = prev[i]
+                c = prev[i - bpp] if i >= bpp else 0
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                row[i] = (row[i] + pred) & 0xFF
+        elif kind != 0:
+            fail(path, "bad filter %d" % kind)
+        rows.append(row)
+        prev = row
+    return rows
+
+
+def read_alpha(path):
+    """Width, height and the alpha of every pixel, row by row"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(PNG_MAGIC):
+        fail(path, "not a PNG")
+
+    idat = bytearray()
+    trns = b""
+    header = None
+    for kind, body in read_chunks(path, data):
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if header is None:
+        fail(path, "no IHDR")
+
+    width, height, depth, colour, _, _, interlace = header
+    channels = {6: 4, 4: 2, 3: 1}.get(colour)
+    if depth != 8 or interlace != 0 or channels is None or (colour == 3 and not trns):
+        fail(path, "needs 8-bit, non-interlaced, with alpha (colour type %d, depth %d)" % (colour, depth))
+
+    rows = unfilter(path, zlib.decompress(bytes(idat)), height, width * channels, channels)
+    if colour == 3:
+        return width, height, [[trns[i] if i < len(trns) else 255 for i in row] for row in rows]
+    return width, height, [list(row[channels - 1::channels]) for row in rows]
+
+
+def box_weights(src, dst):
+    """For each destination pixel, the source pixels it covers and by how much"""
+    ratio = src / dst
+    out = []
+    for d in range(dst):
+        x0, x1 = d * ratio, (d + 1) * ratio
+        taps = []
+        for i in range(int(math.floor(x0)), min(src, int(math.ceil(x1)))):
+            w = min(x1, i + 1) - max(x0, i)
+            if w > 0:
+                taps.append((i, w / ratio))
+        out.append(taps)
+    return out
+
+
+def resample(alpha, width, height, dst_w, dst_h):
+    """Area average, exact copy at the same size"""
+    wx = box_weights(width, dst_w)
+    wy = box_weights(height, dst_h)
+    rows = [[sum(row[i] * w for i, w in taps) for taps in wx] for row in alpha]
+    return [[min(255, int(sum(rows[j][x] * w for j, w in taps) + 0.5)) for x in range(dst_w)] for taps in wy]
+
+
+def write_c(path, name, width, height, alpha):
+    guard = "LV_ATTRIBUTE_IMAGE_" + name.upper()
+    lines = [
+        "/* Generated by png_to_a8.py, do not edit: A8 mask, %dx%d */" % (width, height),
+        "",
+        "#ifdef __has_include",
+        "    #if __has_include(\"lvgl.h\")",
+        "        #ifndef LV_LVGL_H_INCLUDE_SIMPLE",
+        "            #define LV_LVGL_H_INCLUDE_SIMPLE",
+        "        #endif",
+        "    #endif",
+        "#endif",
+        "",
+        "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)",
+        "    #include \"lvgl.h\"",
+        "#else",
+        "    #include \"lvgl/lvgl.h\"",
+        "#endif",
+        "",
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+        "#define LV_ATTRIBUTE_MEM_ALIGN",
+        "#endif",
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "#endif",
+        "",
+        "const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST %s uint8_t %s_map[] = {" % (guard, name),
+    ]
+    for row in alpha:
+        lines.append("  " + ", ".join("0x%02x" % a for a in row) + ",")
+    lines += [
+        "};",
+        "",
+        "const lv_image_dsc_t %s = {" % name,
+        "  .header.cf = LV_COLOR_FORMAT_A8,",
+        "  .header.magic = LV_IMAGE_HEADER_MAGIC,",
+        "  .header.w = %d," % width,
+        "  .header.h = %d," % height,
+        "  .header.stride = %d," % width,
+        "  .data_size = %d," % (width * height),
+        "  .data = %s_map," % name,
+        "};",
+        "",
+    ]
+    with open(path, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PNG icon to an LVGL A8 image in C")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--scale", type=float, default=1.0, help="size factor, e.g. 0.7 for 240x320")
+    parser.add_argument("--suffix", default="", help="appended to the image name")
+    args = parser.parse_args()
+
+    width, height, alpha = read_alpha(args.input)
+    dst_w = max(1, int(round(width * args.scale)))
+    dst_h = max(1, int(round(height * args.scale)))
+    if (dst_w, dst_h) != (width, height):
+        alpha = resample(alpha, width, height, dst_w, dst_h)
+
+    name = os.path.splitext(os.path.basename(args.input))[0] + args.suffix
+    write_c(args.output, name, dst_w, dst_h, alpha)
+
+
+if __name__ == "__main__":
+    main()
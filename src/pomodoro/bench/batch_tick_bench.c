@@ -0,0 +1,242 @@
+/**
+ * @file batch_tick_bench.c
+ * @brief Batch tick kernel vs the per-session countdown loop
+ *
+ * Sessions are 85% running (WORK / SHORT_BREAK / LONG_BREAK), 10% paused and
+ * 5% idle, with 1 s .. 60 min left, so about one in 1800 expires per 1 s tick.
+ * An expired session gets its next phase through an indirect call, like the
+ * state callbacks of the Core.
+ *
+ *  - per-session:   the loop pomodoro_sessions_advance() ran before the kernel,
+ *                   a branch per session and the phase end inline
+ *  - scalar / sse2 / avx2: batch_tick() over chunks of 4096 sessions, then
+ *                   phase ends for the set bits of the expiry mask only
+ *  - sweep:         pomodoro_sessions_advance(1000) on created sessions with
+ *                   each kernel, the whole Core path
+ *
+ * Every kernel is checked against the per-session loop: same remaining times,
+ * same number of expiries. At 1k / 100k / 1M sessions.
+ *
+ * Built with its own copy of the Core and POMODORO_MAX_SESSIONS=1048577.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "batch_tick.h"
+#include "pomodoro.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_MAX_LANES     (1u << 20)
+#define BENCH_LANE_TICKS    200000000u      // session-ticks per measurement
+#define BENCH_CHUNK         4096u
+#define BENCH_ELAPSED_MS    1000u
+#define BENCH_SWEEPS        60u
+
+static uint32_t init_remaining[BENCH_MAX_LANES];
+static uint8_t init_state[BENCH_MAX_LANES];
+static uint32_t remaining[BENCH_MAX_LANES];
+static uint8_t state[BENCH_MAX_LANES];
+static uint32_t ref_remaining[BENCH_MAX_LANES];
+static pomodoro_session_t sessions[BENCH_MAX_LANES];
+
+static uint64_t expirations;
+static uint64_t transitions;
+static uint32_t rng = 12345u;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+/* Next phase of an expired session, minus the overshoot */
+static void on_expire(uint32_t i, uint32_t overshoot)
+{
+    uint32_t next = (state[i] == POMODORO_WORK) ? 5u * 60000u : 25u * 60000u;
+
+    state[i] = (state[i] == POMODORO_WORK) ? POMODORO_SHORT_BREAK : POMODORO_WORK;
+    remaining[i] = next - overshoot;
+    expirations++;
+}
+
+/* Volatile so the compiler keeps the indirect call the Core makes */
+static void (*volatile expire_cb)(uint32_t i, uint32_t overshoot) = on_expire;
+
+static void lanes_reset(uint32_t count)
+{
+    memcpy(remaining, init_remaining, count * sizeof(remaining[0]));
+    memcpy(state, init_state, count * sizeof(state[0]));
+    expirations = 0;
+}
+
+static void tick_per_session(uint32_t count, uint32_t elapsed_ms)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if ((uint8_t)(state[i] - POMODORO_WORK) > (uint8_t)(POMODORO_LONG_BREAK - POMODORO_WORK)) {
+            continue;
+        }
+        if (remaining[i] > elapsed_ms) {
+            remaining[i] -= elapsed_ms;
+            continue;
+        }
+        expire_cb(i, elapsed_ms - remaining[i]);
+    }
+}
+
+static void tick_batched(uint32_t count, uint32_t elapsed_ms)
+{
+    uint64_t expired[BATCH_TICK_MASK_WORDS(BENCH_CHUNK)];
+
+    for (uint32_t base = 0; base < count; base += BENCH_CHUNK) {
+        uint32_t n = (count - base < BENCH_CHUNK) ? (count - base) : BENCH_CHUNK;
+
+        if (batch_tick(&remaining[base], &state[base], n, elapsed_ms,
+                       POMODORO_WORK, POMODORO_LONG_BREAK, expired) == 0) {
+            continue;
+        }
+        for (uint32_t w = 0; w < BATCH_TICK_MASK_WORDS(n); w++) {
+            for (uint64_t bits = expired[w]; bits; bits &= bits - 1u) {
+                uint32_t i = base + w * 64u + batch_tick_lowest_lane(bits);
+                expire_cb(i, elapsed_ms - remaining[i]);
+            }
+        }
+    }
+}
+
+/* Returns ns per session-tick */
+static double run_lanes(uint32_t count, batch_tick_impl_e impl)
+{
+    uint32_t ticks = BENCH_LANE_TICKS / count;
+    uint64_t start;
+
+    lanes_reset(count);
+    if (impl != BATCH_TICK_AUTO) {
+        batch_tick_select(impl);
+    }
+
+    start = bench_now_ns();
+    for (uint32_t t = 0; t < ticks; t++) {
+        if (impl == BATCH_TICK_AUTO) {
+            tick_per_session(count, BENCH_ELAPSED_MS);
+        } else {
+            tick_batched(count, BENCH_ELAPSED_MS);
+        }
+    }
+    return (double)(bench_now_ns() - start) / ((double)ticks * count);
+}
+
+static void bench_lanes(uint32_t count)
+{
+    static const batch_tick_impl_e impls[] = { BATCH_TICK_SCALAR, BATCH_TICK_SSE2, BATCH_TICK_AVX2 };
+    double base_ns = run_lanes(count, BATCH_TICK_AUTO);
+    uint64_t ref_expirations = expirations;
+
+    memcpy(ref_remaining, remaining, count * sizeof(remaining[0]));
+    printf("%9u  %-12s  %8.3f  %7s  %10llu\n", count, "per-session", base_ns, "1.00x",
+           (unsigned long long)ref_expirations);
+
+    for (uint32_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (!batch_tick_is_supported(impls[i])) {
+            printf("%9u  %-12s  %8s\n", count, batch_tick_impl_name(impls[i]), "n/a");
+            continue;
+        }
+
+        double ns = run_lanes(count, impls[i]);
+        bool match = expirations == ref_expirations &&
+                     memcmp(remaining, ref_remaining, count * sizeof(remaining[0])) == 0;
+
+        printf("%9u  %-12s  %8.3f  %6.2fx  %10llu%s\n", count, batch_tick_impl_name(impls[i]), ns,
+               base_ns / ns, (unsigned long long)expirations, match ? "" : "  MISMATCH");
+        if (!match) {
+            exit(1);
+        }
+    }
+}
+
+static void on_session_state(pomodoro_session_t session, PomodoroState_e st)
+{
+    (void)session;
+    (void)st;
+    transitions++;
+}
+
+static void bench_sweep(uint32_t count)
+{
+    static const batch_tick_impl_e impls[] = { BATCH_TICK_SCALAR, BATCH_TICK_SSE2, BATCH_TICK_AVX2 };
+
+    for (uint32_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (!batch_tick_select(impls[i])) {
+            continue;
+        }
+
+        for (uint32_t s = 0; s < count; s++) {
+            sessions[s] = pomodoro_session_create(20 + s % 41, 3 + s % 5, 10 + s % 11, (uint8_t)(2 + s % 4));
+            pomodoro_session_start(sessions[s]);
+        }
+        transitions = 0;
+
+        uint64_t start = bench_now_ns();
+        for (uint32_t t = 0; t < BENCH_SWEEPS; t++) {
+            pomodoro_sessions_advance(60u * 1000u);
+        }
+        uint64_t ns = bench_now_ns() - start;
+
+        printf("sweep %7u sessions  %-6s  %8.1f us/sweep  %6.3f ns/session  %llu transitions\n",
+               count, batch_tick_impl_name(impls[i]), (double)ns / BENCH_SWEEPS / 1e3,
+               (double)ns / ((double)BENCH_SWEEPS * count), (unsigned long long)transitions);
+
+        for (uint32_t s = 0; s < count; s++) {
+            pomodoro_session_destroy(sessions[s]);
+        }
+    }
+}
+
+int main(void)
+{
+    static const uint32_t counts[] = { 1000, 100000, BENCH_MAX_LANES };
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+    pomodoro_sessions_set_state_callback(on_session_state);
+
+    for (uint32_t i = 0; i < BENCH_MAX_LANES; i++) {
+        uint32_t r = next_rand() % 100u;
+
+        init_state[i] = (r < 85u) ? (uint8_t)(POMODORO_WORK + r % 3u) :
+                        (r < 95u) ? (uint8_t)(POMODORO_PAUSED_WORK + r % 2u) : (uint8_t)POMODORO_IDLE;
+        init_remaining[i] = 1000u + next_rand() % (60u * 60000u);
+    }
+
+    printf("batch_tick_bench: best kernel on this CPU is %s, %u ms per tick\n",
+           batch_tick_impl_name(batch_tick_get_impl()), BENCH_ELAPSED_MS);
+    printf("%9s  %-12s  %8s  %7s  %10s\n", "sessions", "path", "ns/sess", "speedup", "expiries");
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench_lanes(counts[i]);
+    }
+
+    // One simulated minute per sweep so phase ends are frequent enough to matter
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench_sweep(counts[i]);
+    }
+
+    batch_tick_select(BATCH_TICK_AUTO);
+    return 0;
+}
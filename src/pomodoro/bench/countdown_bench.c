@@ -0,0 +1,199 @@
+/**
+ * @file countdown_bench.c
+ * @brief Per-tick cost of "MM:SS": label against the digit atlas
+ *
+ * Counts 25:00 down to 00:00 one second at a time on an offscreen display
+ * (direct mode, no SDL window), rendering after every tick, with:
+ *
+ *  - label:     lv_snprintf() and lv_label_set_text(), as the timer of the
+ *               main screen (montserrat 28) and the fullscreen timer
+ *               (montserrat 48) did
+ *  - atlas:     countdown_set_seconds() of UI/countdown.c, the changed
+ *               cells drawn from the pre-rendered glyphs
+ *
+ * Reported per font and path, as CSV on stdout:
+ *
+ *  - set_us:        the set call alone, mean per tick
+ *  - render_us:     lv_refr_now() after it, mean per tick
+ *  - px_per_tick:   pixels flushed per tick
+ *  - atlas_ms:      rasterizing the atlas of the font (atlas path only)
+ *  - atlas_bytes:   memory of the atlases after the run
+ *
+ * Checked: a tick that changes only the last digit flushes less than a
+ * quarter of the countdown, and the atlas path flushes fewer pixels per
+ * tick than the label.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "countdown.h"
+
+#define BENCH_HOR_RES       480
+#define BENCH_VER_RES       480
+#define BENCH_FROM_S        (25u * 60u)
+
+/**
+ * @brief Totals of one countdown run
+ */
+typedef struct {
+    uint64_t set_ns;
+    uint64_t render_ns;
+    uint64_t px;
+    uint32_t ticks;
+} BenchRun_t;
+
+static lv_display_t *disp;
+static uint8_t *frame_buf;
+static uint64_t flushed_px;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t bench_tick_cb(void)
+{
+    return (uint32_t)(bench_now_ns() / 1000000u);
+}
+
+static void bench_flush_cb(lv_display_t *d, const lv_area_t *area, uint8_t *px_map)
+{
+    (void)px_map;
+    flushed_px += (uint64_t)lv_area_get_size(area);
+    lv_display_flush_ready(d);
+}
+
+static void bench_lv_log_cb(lv_log_level_t level, const char *buf)
+{
+    (void)level;
+    fputs(buf, stderr);
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "check failed: %s\n", what);
+        errors++;
+    }
+}
+
+static void set_label(lv_obj_t *obj, uint32_t s)
+{
+    char buf[8];
+
+    lv_snprintf(buf, sizeof(buf), "%02d:%02d", (int)(s / 60u), (int)(s % 60u));
+    lv_label_set_text(obj, buf);
+}
+
+static void set_atlas(lv_obj_t *obj, uint32_t s)
+{
+    countdown_set_seconds(obj, s);
+}
+
+/* Count down from BENCH_FROM_S, one set and one render per second */
+static void run(lv_obj_t *obj, void (*set)(lv_obj_t *, uint32_t), BenchRun_t *r, uint64_t *last_digit_px)
+{
+    lv_memzero(r, sizeof(*r));
+    set(obj, BENCH_FROM_S);
+    lv_refr_now(disp);
+
+    for (uint32_t s = BENCH_FROM_S; s-- > 0;) {
+        uint64_t t0, t1;
+
+        flushed_px = 0;
+        t0 = bench_now_ns();
+        set(obj, s);
+        t1 = bench_now_ns();
+        lv_refr_now(disp);
+        r->set_ns += t1 - t0;
+        r->render_ns += bench_now_ns() - t1;
+        r->px += flushed_px;
+        r->ticks++;
+        // 24:58 -> 24:57: only the last digit changes
+        if (s == BENCH_FROM_S - 3u) *last_digit_px = flushed_px;
+    }
+}
+
+static void report(const char *font, const char *path, const BenchRun_t *r, double atlas_ms)
+{
+    printf("%s,%s,%.2f,%.2f,%.0f,%.3f,%u\n", font, path,
+           r->set_ns / 1e3 / r->ticks, r->render_ns / 1e3 / r->ticks,
+           (double)r->px / r->ticks, atlas_ms, (unsigned)countdown_get_atlas_bytes());
+}
+
+static void bench_font(const char *name, const lv_font_t *font)
+{
+    lv_obj_t *scr = lv_screen_active();
+    BenchRun_t label_run, atlas_run;
+    uint64_t label_digit_px = 0, atlas_digit_px = 0;
+    uint64_t t0;
+    double atlas_ms;
+    lv_obj_t *obj;
+
+    obj = lv_label_create(scr);
+    lv_obj_set_style_text_font(obj, font, 0);
+    lv_obj_set_style_text_color(obj, lv_color_hex(0x4A90E2), 0);
+    lv_obj_center(obj);
+    run(obj, set_label, &label_run, &label_digit_px);
+    lv_obj_delete(obj);
+    report(name, "label", &label_run, 0.0);
+
+    t0 = bench_now_ns();
+    obj = countdown_create(scr, font, lv_color_hex(0x4A90E2));
+    atlas_ms = (bench_now_ns() - t0) / 1e6;
+    lv_obj_center(obj);
+    run(obj, set_atlas, &atlas_run, &atlas_digit_px);
+    lv_obj_update_layout(obj);
+    check(atlas_digit_px * 4u < (uint64_t)lv_obj_get_width(obj) * (uint64_t)lv_obj_get_height(obj),
+          "last digit tick flushes one cell");
+    check(atlas_run.px < label_run.px, "atlas flushes fewer pixels than the label");
+    lv_obj_delete(obj);
+    report(name, "atlas", &atlas_run, atlas_ms);
+    fprintf(stderr, "%s: last digit tick %llu px label, %llu px atlas\n", name,
+            (unsigned long long)label_digit_px, (unsigned long long)atlas_digit_px);
+}
+
+int main(void)
+{
+    size_t buf_size;
+
+    lv_init();
+    lv_log_register_print_cb(bench_lv_log_cb);
+    lv_tick_set_cb(bench_tick_cb);
+
+    disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    buf_size = (size_t)BENCH_HOR_RES * BENCH_VER_RES * lv_color_format_get_size(lv_display_get_color_format(disp));
+    frame_buf = malloc(buf_size);
+    if (frame_buf == NULL) {
+        fprintf(stderr, "no memory for the frame buffer\n");
+        return 1;
+    }
+    lv_display_set_buffers(disp, frame_buf, NULL, (uint32_t)buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, bench_flush_cb);
+
+    // The dark background of the app
+    lv_obj_set_style_bg_color(lv_screen_active(), lv_color_hex(0x343247), 0);
+    lv_obj_set_style_bg_opa(lv_screen_active(), LV_OPA_COVER, 0);
+    lv_refr_now(disp);
+
+    printf("font,path,set_us,render_us,px_per_tick,atlas_ms,atlas_bytes\n");
+    bench_font("montserrat_28", &lv_font_montserrat_28);
+    bench_font("montserrat_48", &lv_font_montserrat_48);
+
+    if (errors) {
+        fprintf(stderr, "FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
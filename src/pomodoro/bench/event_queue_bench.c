@@ -0,0 +1,156 @@
+/**
+ * @file event_queue_bench.c
+ * @brief Throughput and latency of the lock-free event queue (Core/event_queue.c)
+ *
+ *  - uncontended: push + pop pairs on one thread
+ *  - 1..8 producers: every producer posts a fixed number of EVENT_SETTINGS,
+ *    one consumer drains them. Producers retry when the queue is full, like
+ *    a caller that must not lose a button press would.
+ *
+ * Latency is post to pop: producers stamp the time into a table indexed by
+ * (producer, sequence) before posting and carry both indices in the payload.
+ * It includes time spent retrying on a full queue and, with fewer cores
+ * than threads, waiting for the scheduler.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "event_queue.h"
+
+#define BENCH_MAX_PRODUCERS     8
+#define BENCH_EVENTS_PER_PROD   200000u
+#define BENCH_UNCONTENDED_OPS   10000000u
+
+static event_queue_t queue;
+static uint64_t post_ns[BENCH_MAX_PRODUCERS][BENCH_EVENTS_PER_PROD];
+static uint32_t latency_ns[BENCH_MAX_PRODUCERS * BENCH_EVENTS_PER_PROD];
+static atomic_uint start_flag;
+static atomic_uint full_retries;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void *producer(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    PomodoroEvent_t ev = { .type = EVENT_SETTINGS };
+    uint32_t retries = 0;
+
+    while (!atomic_load_explicit(&start_flag, memory_order_acquire)) {
+        sched_yield();
+    }
+
+    ev.data.settings.work_min = id;
+    for (uint32_t i = 0; i < BENCH_EVENTS_PER_PROD; i++) {
+        ev.data.settings.short_break_min = (int)i;
+        post_ns[id][i] = bench_now_ns();
+        while (!event_queue_push(&queue, &ev)) {
+            retries++;
+            sched_yield();
+        }
+    }
+
+    atomic_fetch_add(&full_retries, retries);
+    return NULL;
+}
+
+static void bench_uncontended(void)
+{
+    PomodoroEvent_t ev = { .type = EVENT_START };
+    PomodoroEvent_t out;
+
+    event_queue_init(&queue);
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_UNCONTENDED_OPS; i++) {
+        event_queue_push(&queue, &ev);
+        event_queue_pop(&queue, &out);
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    printf("uncontended push + pop: %.1f ns/pair\n\n", (double)ns / BENCH_UNCONTENDED_OPS);
+}
+
+static void bench_producers(int producers)
+{
+    pthread_t threads[BENCH_MAX_PRODUCERS];
+    uint32_t total = (uint32_t)producers * BENCH_EVENTS_PER_PROD;
+    uint32_t received = 0;
+    uint32_t expected[BENCH_MAX_PRODUCERS] = { 0 };
+    uint32_t order_errors = 0;
+    PomodoroEvent_t ev;
+
+    event_queue_init(&queue);
+    atomic_store(&start_flag, 0);
+    atomic_store(&full_retries, 0);
+    for (int p = 0; p < producers; p++) {
+        pthread_create(&threads[p], NULL, producer, (void *)(intptr_t)p);
+    }
+
+    uint64_t start = bench_now_ns();
+    atomic_store_explicit(&start_flag, 1, memory_order_release);
+    while (received < total) {
+        if (event_queue_pop(&queue, &ev)) {
+            uint64_t now = bench_now_ns();
+            // Events of one producer must arrive complete and in order
+            if ((uint32_t)ev.data.settings.short_break_min != expected[ev.data.settings.work_min]++) {
+                order_errors++;
+            }
+            latency_ns[received++] = (uint32_t)(now - post_ns[ev.data.settings.work_min][ev.data.settings.short_break_min]);
+        } else {
+            // Let producers run when there are fewer cores than threads
+            sched_yield();
+        }
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    for (int p = 0; p < producers; p++) {
+        pthread_join(threads[p], NULL);
+    }
+
+    qsort(latency_ns, total, sizeof(latency_ns[0]), cmp_u32);
+    printf("%9d  %12.2f  %10u  %10u  %10u  %12u\n",
+           producers,
+           (double)total / ((double)ns / 1e9) / 1e6,
+           latency_ns[total / 2],
+           latency_ns[(uint64_t)total * 99u / 100u],
+           latency_ns[total - 1],
+           atomic_load(&full_retries));
+    if (order_errors) {
+        printf("ERROR: %u events out of order\n", order_errors);
+    }
+}
+
+int main(void)
+{
+    printf("event queue: %u cells, %u events per producer, %zu bytes per event\n",
+           EVENT_QUEUE_SIZE, BENCH_EVENTS_PER_PROD, sizeof(PomodoroEvent_t));
+    bench_uncontended();
+
+    printf("%9s  %12s  %10s  %10s  %10s  %12s\n",
+           "producers", "Mevents/s", "p50 ns", "p99 ns", "max ns", "full retries");
+    for (int p = 1; p <= BENCH_MAX_PRODUCERS; p *= 2) {
+        bench_producers(p);
+    }
+
+    return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file fsm_bench.c
+ * @brief Events per second through the session state machine
+ *
+ * Feeds the same random stream of START, PAUSE, RESUME, RESET and FINISHED
+ * events (64k of them, replayed) through
+ *
+ *  - switch:              the nested switch pomodoro.c used before the
+ *                         table, state only, as the baseline
+ *  - table:               pomodoro_fsm_lookup() on the same state, the
+ *                         branch-free part of the dispatch
+ *  - session dispatch:    pomodoro_session_dispatch() on a created session,
+ *                         the whole Core path without the timer
+ *  - event_dispatch:      event_dispatch() on the default session, with the
+ *                         timer armed, paused and stopped (no FINISHED, the
+ *                         timer sends those)
+ *
+ * The switch and the table must end every event in the same state.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_fsm.h"
+#include "event.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_STREAM        65536u
+#define BENCH_ROUNDS        64u
+#define BENCH_EVENTS        (BENCH_STREAM * BENCH_ROUNDS)
+#define BENCH_MAX_CYCLES    4u
+
+/**
+ * @brief State of the two bare machines
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t previous;
+    uint8_t cycle;
+} BenchMachine_t;
+
+static uint8_t stream[BENCH_STREAM];
+static uint8_t trace[BENCH_STREAM];
+static uint32_t rng = 16u;
+static uint32_t errors;
+static volatile uint32_t sink;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static void report(const char *name, uint64_t ns, uint32_t events)
+{
+    double ns_per_event = (double)ns / events;
+    printf("%-24s %10.2f  %12.1f\n", name, ns_per_event, 1e3 / ns_per_event);
+}
+
+static void set_state(BenchMachine_t *m, uint8_t state)
+{
+    m->previous = m->state;
+    m->state = state;
+}
+
+/* The transitions as pomodoro.c spelled them out, before the table */
+static void switch_step(BenchMachine_t *m, uint8_t ev)
+{
+    switch (ev) {
+    case POMODORO_EV_START:
+        if (m->state == POMODORO_IDLE) set_state(m, POMODORO_WORK);
+        break;
+
+    case POMODORO_EV_PAUSE:
+        switch (m->state) {
+        case POMODORO_WORK:
+            set_state(m, POMODORO_PAUSED_WORK);
+            break;
+        case POMODORO_SHORT_BREAK:
+        case POMODORO_LONG_BREAK:
+            set_state(m, POMODORO_PAUSED_BREAK);
+            break;
+        }
+        break;
+
+    case POMODORO_EV_RESUME:
+        if (m->state == POMODORO_PAUSED_WORK) {
+            set_state(m, POMODORO_WORK);
+        } else if (m->state == POMODORO_PAUSED_BREAK) {
+            set_state(m, m->previous == POMODORO_LONG_BREAK ? POMODORO_LONG_BREAK : POMODORO_SHORT_BREAK);
+        }
+        break;
+
+    case POMODORO_EV_RESET:
+        m->cycle = 0;
+        set_state(m, POMODORO_IDLE);
+        break;
+
+    case POMODORO_EV_FINISHED:
+        if (m->state == POMODORO_WORK) {
+            m->cycle++;
+            set_state(m, (m->cycle % BENCH_MAX_CYCLES == 0) ? POMODORO_LONG_BREAK : POMODORO_SHORT_BREAK);
+        } else if (m->state == POMODORO_SHORT_BREAK || m->state == POMODORO_LONG_BREAK) {
+            set_state(m, POMODORO_WORK);
+        }
+        break;
+    }
+}
+
+/* The same through the table, as session_dispatch() does it */
+static void table_step(BenchMachine_t *m, uint8_t ev)
+{
+    uint32_t round_done = (uint8_t)(m->cycle + 1u) % BENCH_MAX_CYCLES == 0;
+    uint32_t e = ev + (ev == POMODORO_EV_FINISHED) * round_done;
+    PomodoroFsmEntry_t entry = pomodoro_fsm_lookup(m->state, (uint8_t)e, m->previous);
+    uint8_t changed = entry.action != POMODORO_ACT_IGNORE;
+
+    // Branch-free bookkeeping: the reset clears, a finished work phase counts
+    m->cycle = (uint8_t)((m->cycle + (entry.action == POMODORO_ACT_FINISH_WORK)) * (entry.action != POMODORO_ACT_RESET));
+    m->previous = changed ? m->state : m->previous;
+    m->state = entry.next;
+}
+
+static uint64_t run_machine(void (*step)(BenchMachine_t *, uint8_t), bool record)
+{
+    BenchMachine_t m = { .state = POMODORO_IDLE, .previous = POMODORO_IDLE };
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+            step(&m, stream[i]);
+            if (record) trace[i] = m.state;
+        }
+    }
+    sink = m.state;
+    return bench_now_ns() - start;
+}
+
+static void check_table(void)
+{
+    BenchMachine_t a = { .state = POMODORO_IDLE, .previous = POMODORO_IDLE };
+    BenchMachine_t b = a;
+
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        switch_step(&a, stream[i]);
+        table_step(&b, stream[i]);
+        if (a.state != b.state || a.previous != b.previous || a.cycle != b.cycle) {
+            printf("table differs at event %u (%s): state %u/%u, previous %u/%u, cycle %u/%u\n",
+                   i, pomodoro_fsm_event_name((PomodoroFsmEvent_e)stream[i]),
+                   a.state, b.state, a.previous, b.previous, a.cycle, b.cycle);
+            errors++;
+            return;
+        }
+    }
+}
+
+static uint64_t run_session_dispatch(void)
+{
+    pomodoro_session_t s = pomodoro_session_create(25, 5, 15, BENCH_MAX_CYCLES);
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+            pomodoro_session_dispatch(s, (PomodoroFsmEvent_e)stream[i]);
+        }
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    PomodoroSnapshot_t snap;
+    pomodoro_session_get_snapshot(s, &snap);
+    if (snap.state != (PomodoroState_e)trace[BENCH_STREAM - 1u]) {
+        printf("session ends in %d, the table in %u\n", (int)snap.state, trace[BENCH_STREAM - 1u]);
+        errors++;
+    }
+    pomodoro_session_destroy(s);
+    return ns;
+}
+
+static uint64_t run_event_dispatch(uint32_t *events)
+{
+    static const EventType_e map[POMODORO_EV_COUNT] = {
+        [POMODORO_EV_START] = EVENT_START,
+        [POMODORO_EV_PAUSE] = EVENT_PAUSE,
+        [POMODORO_EV_RESUME] = EVENT_RESUME,
+        [POMODORO_EV_RESET] = EVENT_RESET,
+        [POMODORO_EV_FINISHED] = EVENT_TICK,
+    };
+    uint64_t start;
+
+    timer_init();
+    pomodoro_init(25, 5, 15, BENCH_MAX_CYCLES);
+    *events = 0;
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < BENCH_ROUNDS / 4u; r++) {
+        for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+            if (stream[i] != POMODORO_EV_FINISHED) {
+                event_dispatch(map[stream[i]], NULL);
+                (*events)++;
+            }
+        }
+    }
+    return bench_now_ns() - start;
+}
+
+int main(void)
+{
+    uint32_t count[POMODORO_EV_COUNT] = { 0 };
+    uint32_t core_events;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+
+    // Mostly pauses, resumes and phase ends, a reset now and then
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        uint32_t r = next_rand() % 32u;
+        stream[i] = (r < 6u) ? POMODORO_EV_START : (r < 14u) ? POMODORO_EV_PAUSE :
+                    (r < 22u) ? POMODORO_EV_RESUME : (r < 23u) ? POMODORO_EV_RESET : POMODORO_EV_FINISHED;
+        count[stream[i]]++;
+    }
+    printf("fsm_bench: %u events (%u start, %u pause, %u resume, %u reset, %u finished) x %u\n",
+           BENCH_STREAM, count[POMODORO_EV_START], count[POMODORO_EV_PAUSE], count[POMODORO_EV_RESUME],
+           count[POMODORO_EV_RESET], count[POMODORO_EV_FINISHED], BENCH_ROUNDS);
+    printf("%-24s %10s  %12s\n", "", "ns/event", "M events/s");
+
+    check_table();
+    run_machine(table_step, true);
+    report("switch", run_machine(switch_step, false), BENCH_EVENTS);
+    report("table", run_machine(table_step, false), BENCH_EVENTS);
+    report("session dispatch", run_session_dispatch(), BENCH_EVENTS);
+    uint64_t ns = run_event_dispatch(&core_events);
+    report("event_dispatch", ns, core_events);
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
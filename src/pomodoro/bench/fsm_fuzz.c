@@ -0,0 +1,332 @@
+/**
+ * @file fsm_fuzz.c
+ * @brief Random event sequences through the state machine, against a model
+ *
+ * Drives the Core with random START, PAUSE, RESUME and RESET events mixed
+ * with random amounts of time, and after every step compares the state,
+ * previous state, cycle count and (when paused) remaining time with a plain
+ * model of the Pomodoro schedule:
+ *
+ *  - default session:     on the virtual clock through pomodoro_tick(), time
+ *                         either stops short of the deadline or lands on it
+ *  - created sessions:    through pomodoro_session_dispatch() and
+ *                         pomodoro_sessions_advance(), with the overshoot of
+ *                         a sweep carried into the next phase
+ *
+ * Half the steps each, one after the other: the clock stands still while the
+ * created sessions run, so the sweep timer leaves the model's countdown alone.
+ * Settings (durations, cycles before the long break) change now and then.
+ * Usage: fsm_fuzz [seed] [steps]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pomodoro.h"
+#include "pomodoro_fsm.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define FUZZ_STEPS          2000000u
+#define FUZZ_SESSIONS       8u
+#define FUZZ_MAX_REPORTS    10u
+
+/**
+ * @brief Model of one session
+ */
+typedef struct {
+    pomodoro_session_t handle;
+    uint32_t work_ms;
+    uint32_t short_ms;
+    uint32_t long_ms;
+    uint32_t max_cycles;
+    uint32_t remaining_ms;
+    uint8_t state;
+    uint8_t previous;
+    uint8_t cycle;
+} FuzzModel_t;
+
+static FuzzModel_t def;
+static FuzzModel_t sessions[FUZZ_SESSIONS];
+static uint32_t rng;
+static uint32_t errors;
+static uint64_t step;
+static uint32_t finished;
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static bool is_running(uint8_t state)
+{
+    return state == POMODORO_WORK || state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK;
+}
+
+static void model_configure(FuzzModel_t *m, uint32_t work_min, uint32_t short_min, uint32_t long_min,
+                            uint32_t cycles)
+{
+    m->work_ms = work_min * 60000u;
+    m->short_ms = short_min * 60000u;
+    m->long_ms = long_min * 60000u;
+    m->max_cycles = cycles;
+}
+
+static void model_set(FuzzModel_t *m, uint8_t state, uint32_t remaining_ms)
+{
+    m->previous = m->state;
+    m->state = state;
+    m->remaining_ms = remaining_ms;
+}
+
+/* The schedule as the user sees it, written out without the table */
+static void model_event(FuzzModel_t *m, PomodoroFsmEvent_e ev)
+{
+    switch (ev) {
+    case POMODORO_EV_START:
+        if (m->state == POMODORO_IDLE) model_set(m, POMODORO_WORK, m->work_ms);
+        break;
+
+    case POMODORO_EV_PAUSE:
+        if (m->state == POMODORO_WORK) {
+            model_set(m, POMODORO_PAUSED_WORK, m->remaining_ms);
+        } else if (m->state == POMODORO_SHORT_BREAK || m->state == POMODORO_LONG_BREAK) {
+            model_set(m, POMODORO_PAUSED_BREAK, m->remaining_ms);
+        }
+        break;
+
+    case POMODORO_EV_RESUME:
+        // Back into the phase that was paused
+        if (m->state == POMODORO_PAUSED_WORK || m->state == POMODORO_PAUSED_BREAK) {
+            model_set(m, m->previous, m->remaining_ms);
+        }
+        break;
+
+    case POMODORO_EV_RESET:
+        m->cycle = 0;
+        model_set(m, POMODORO_IDLE, m->work_ms);
+        break;
+
+    case POMODORO_EV_FINISHED:
+        finished++;
+        if (m->state == POMODORO_WORK) {
+            m->cycle++;
+            if (m->cycle % m->max_cycles == 0) {
+                model_set(m, POMODORO_LONG_BREAK, m->long_ms);
+            } else {
+                model_set(m, POMODORO_SHORT_BREAK, m->short_ms);
+            }
+        } else {
+            model_set(m, POMODORO_WORK, m->work_ms);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void check(const char *who, const FuzzModel_t *m, const PomodoroSnapshot_t *snap)
+{
+    bool paused = m->state == POMODORO_PAUSED_WORK || m->state == POMODORO_PAUSED_BREAK;
+
+    if (snap->state == (PomodoroState_e)m->state && snap->previous_state == (PomodoroState_e)m->previous &&
+        snap->cycle_count == m->cycle && (!paused || snap->remaining_ms == m->remaining_ms)) {
+        return;
+    }
+    if (errors++ < FUZZ_MAX_REPORTS) {
+        printf("step %llu, %s: state %d/%u, previous %d/%u, cycle %u/%u, remaining %u/%u ms (core/model)\n",
+               (unsigned long long)step, who, (int)snap->state, m->state, (int)snap->previous_state, m->previous,
+               (unsigned)snap->cycle_count, m->cycle, (unsigned)snap->remaining_ms, m->remaining_ms);
+    }
+}
+
+static PomodoroFsmEvent_e random_event(void)
+{
+    static const PomodoroFsmEvent_e events[] = {
+        POMODORO_EV_START, POMODORO_EV_START, POMODORO_EV_PAUSE, POMODORO_EV_PAUSE,
+        POMODORO_EV_RESUME, POMODORO_EV_RESUME, POMODORO_EV_RESUME, POMODORO_EV_RESET,
+    };
+    return events[next_rand() % (sizeof(events) / sizeof(events[0]))];
+}
+
+static void random_settings(uint32_t *work, uint32_t *short_b, uint32_t *long_b, uint32_t *cycles)
+{
+    *work = 1u + next_rand() % 3u;
+    *short_b = 1u + next_rand() % 2u;
+    *long_b = 1u + next_rand() % 4u;
+    *cycles = 1u + next_rand() % 5u;
+}
+
+// ====================== Default Session ======================
+
+static void default_event(PomodoroFsmEvent_e ev)
+{
+    switch (ev) {
+    case POMODORO_EV_START:  pomodoro_start();  break;
+    case POMODORO_EV_PAUSE:  pomodoro_pause();  break;
+    case POMODORO_EV_RESUME: pomodoro_resume(); break;
+    case POMODORO_EV_RESET:  pomodoro_reset();  break;
+    default: break;
+    }
+    model_event(&def, ev);
+}
+
+/* Time passes: short of the deadline, or wheel deadline by wheel deadline until the phase ends */
+static void default_advance(void)
+{
+    if (is_running(def.state) && next_rand() % 2u == 0) {
+        uint64_t start_ns = monotonic_now_ns();
+        PomodoroSnapshot_t snap;
+
+        do {
+            monotonic_virtual_advance_ns(timer_get_next_deadline_ns() - monotonic_now_ns());
+            pomodoro_tick();
+            pomodoro_get_snapshot(&snap);
+        } while (snap.state == (PomodoroState_e)def.state && snap.cycle_count == def.cycle &&
+                 monotonic_now_ns() - start_ns < (uint64_t)def.remaining_ms * MONOTONIC_NS_PER_MS);
+
+        if (monotonic_now_ns() - start_ns != (uint64_t)def.remaining_ms * MONOTONIC_NS_PER_MS &&
+            errors++ < FUZZ_MAX_REPORTS) {
+            printf("step %llu, default: phase ended after %llu ns, %u ms were left\n", (unsigned long long)step,
+                   (unsigned long long)(monotonic_now_ns() - start_ns), def.remaining_ms);
+        }
+        model_event(&def, POMODORO_EV_FINISHED);
+        return;
+    }
+
+    uint32_t ms = next_rand() % 90000u;
+
+    if (is_running(def.state)) {
+        if (ms >= def.remaining_ms) ms = def.remaining_ms - 1u;
+        def.remaining_ms -= ms;
+    }
+    monotonic_virtual_advance_ns((uint64_t)ms * MONOTONIC_NS_PER_MS);
+    pomodoro_tick();
+}
+
+static void default_step(void)
+{
+    uint32_t r = next_rand() % 64u;
+    PomodoroSnapshot_t snap;
+
+    if (r == 0) {
+        uint32_t work, short_b, long_b, cycles;
+
+        // New settings apply from the next phase; the cycle count starts over
+        random_settings(&work, &short_b, &long_b, &cycles);
+        pomodoro_init(work, short_b, long_b, (uint8_t)cycles);
+        model_configure(&def, work, short_b, long_b, cycles);
+        def.cycle = 0;
+        def.state = POMODORO_IDLE;
+        def.remaining_ms = def.work_ms;
+        timer_stop();
+    } else if (r < 28u) {
+        default_event(random_event());
+    } else {
+        default_advance();
+    }
+    pomodoro_get_snapshot(&snap);
+    check("default", &def, &snap);
+}
+
+// ====================== Created Sessions ======================
+
+static void sessions_advance(void)
+{
+    uint32_t elapsed_ms = next_rand() % 100000u;
+
+    pomodoro_sessions_advance(elapsed_ms);
+    for (uint32_t i = 0; i < FUZZ_SESSIONS; i++) {
+        FuzzModel_t *m = &sessions[i];
+
+        if (!is_running(m->state)) {
+            continue;
+        }
+        if (m->remaining_ms > elapsed_ms) {
+            m->remaining_ms -= elapsed_ms;
+        } else {
+            uint32_t overshoot = elapsed_ms - m->remaining_ms;
+
+            model_event(m, POMODORO_EV_FINISHED);
+            m->remaining_ms = (m->remaining_ms > overshoot) ? m->remaining_ms - overshoot : 0;
+        }
+    }
+}
+
+static void sessions_step(void)
+{
+    uint32_t r = next_rand() % 64u;
+    FuzzModel_t *m = &sessions[next_rand() % FUZZ_SESSIONS];
+
+    if (r == 0) {
+        uint32_t work, short_b, long_b, cycles;
+
+        // Recreated with new settings
+        random_settings(&work, &short_b, &long_b, &cycles);
+        pomodoro_session_destroy(m->handle);
+        m->handle = pomodoro_session_create(work, short_b, long_b, (uint8_t)cycles);
+        model_configure(m, work, short_b, long_b, cycles);
+        m->state = m->previous = POMODORO_IDLE;
+        m->cycle = 0;
+        m->remaining_ms = m->work_ms;
+    } else if (r < 40u) {
+        PomodoroFsmEvent_e ev = random_event();
+
+        pomodoro_session_dispatch(m->handle, ev);
+        model_event(m, ev);
+    } else {
+        sessions_advance();
+    }
+
+    for (uint32_t i = 0; i < FUZZ_SESSIONS; i++) {
+        PomodoroSnapshot_t snap;
+
+        pomodoro_session_get_snapshot(sessions[i].handle, &snap);
+        check("session", &sessions[i], &snap);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2025u;
+    uint64_t steps = (argc > 2) ? strtoull(argv[2], NULL, 0) : FUZZ_STEPS;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+    rng = seed;
+    // Whole milliseconds from here on, so deadlines land where the model expects them
+    monotonic_virtual_advance_ns(MONOTONIC_NS_PER_MS - monotonic_now_ns() % MONOTONIC_NS_PER_MS);
+
+    pomodoro_init(1, 1, 2, 4);
+    model_configure(&def, 1, 1, 2, 4);
+    def.remaining_ms = def.work_ms;
+    for (step = 0; step < steps / 2u; step++) {
+        default_step();
+    }
+
+    for (uint32_t i = 0; i < FUZZ_SESSIONS; i++) {
+        FuzzModel_t *m = &sessions[i];
+
+        m->handle = pomodoro_session_create(1, 1, 2, (uint8_t)(1u + i % 5u));
+        model_configure(m, 1, 1, 2, 1u + i % 5u);
+        m->remaining_ms = m->work_ms;
+    }
+
+    for (; step < steps; step++) {
+        sessions_step();
+    }
+
+    printf("fsm_fuzz: seed %u, %llu steps, %u phases finished\n",
+           seed, (unsigned long long)steps, finished);
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    printf("OK (0 errors)\n");
+    return 0;
+}
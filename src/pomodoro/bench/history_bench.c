@@ -0,0 +1,274 @@
+/**
+ * @file history_bench.c
+ * @brief History store: append, size and scan throughput on 10 years of Pomodoros
+ *
+ * The synthetic dataset has 10 to 16 work phases a day (25 min, some days 50),
+ * each followed by a 5 min break and a 15 min one every 4th, from about 9:00;
+ * one work phase in 8 is paused 1 to 3 times.
+ *
+ *  - append:        ns per pomodoro_history_append(), in RAM and with a file
+ *  - size:          bytes per record and per year, against the 24 byte record
+ *  - scan:          all columns, then only type + duration (focus time), in
+ *                   records/s and decoded MB/s; reference is the same sum over
+ *                   a plain array of records
+ *  - range:         one month out of the 10 years, skipped to by block headers
+ *  - open:          loading the file written by the append run
+ *
+ * Every scan is checked against the generated records.
+ *
+ * Usage: history_bench [directory for the history file, default /tmp]
+ *
+ * Built with its own copy of the history and POMODORO_HISTORY_ARENA_BYTES=4 MB.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_history.h"
+#include "core_log.h"
+
+#define BENCH_YEARS         10u
+#define BENCH_DAYS          (BENCH_YEARS * 365u)
+#define BENCH_MAX_RECORDS   (BENCH_DAYS * 16u * 2u)
+#define BENCH_SCAN_REPEAT   20u
+#define DAY_S               86400
+#define EPOCH_2016_S        1451606400
+
+static PomodoroHistoryRecord_t records[BENCH_MAX_RECORDS];
+static uint32_t record_count;
+static uint32_t rng = 2016u;
+static char path[512];
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static void generate(void)
+{
+    for (uint32_t day = 0; day < BENCH_DAYS; day++) {
+        int64_t t = EPOCH_2016_S + (int64_t)day * DAY_S + 9 * 3600 + (int64_t)(next_rand() % 3600u);
+        uint32_t work_s = (next_rand() % 10u == 0) ? 50u * 60u : 25u * 60u;
+        uint32_t phases = 10u + next_rand() % 7u;
+
+        for (uint32_t p = 0; p < phases; p++) {
+            PomodoroHistoryRecord_t *w = &records[record_count++];
+            PomodoroHistoryRecord_t *b = &records[record_count++];
+
+            w->start_s = t;
+            w->duration_s = work_s;
+            w->type = POMODORO_WORK;
+            w->interruptions = 0;
+            w->paused_s = 0;
+            if (next_rand() % 8u == 0) {
+                w->interruptions = (uint16_t)(1u + next_rand() % 3u);
+                w->paused_s = 30u + next_rand() % 600u;
+            }
+            t += w->duration_s + w->paused_s;
+
+            b->start_s = t;
+            b->type = ((p + 1u) % 4u == 0) ? POMODORO_LONG_BREAK : POMODORO_SHORT_BREAK;
+            b->duration_s = (b->type == POMODORO_LONG_BREAK) ? 15u * 60u : 5u * 60u;
+            b->paused_s = 0;
+            b->interruptions = 0;
+            t += b->duration_s + (int64_t)(next_rand() % 120u);
+        }
+    }
+}
+
+static double append_all(void)
+{
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t i = 0; i < record_count; i++) {
+        pomodoro_history_append(&records[i]);
+    }
+    return (double)(bench_now_ns() - start) / record_count;
+}
+
+typedef struct {
+    uint32_t next;              /**< Index of the next expected record */
+    uint64_t focus_s;
+    bool     mismatch;
+} ScanCheck_t;
+
+static bool check_all_cb(const PomodoroHistoryColumns_t *cols, void *user_data)
+{
+    ScanCheck_t *chk = user_data;
+
+    for (uint32_t i = 0; i < cols->count; i++) {
+        const PomodoroHistoryRecord_t *r = &records[chk->next++];
+
+        if (cols->start_s[i] != r->start_s || cols->duration_s[i] != r->duration_s ||
+            cols->type[i] != r->type || cols->paused_s[i] != r->paused_s ||
+            cols->interruptions[i] != r->interruptions) {
+            chk->mismatch = true;
+        }
+    }
+    return true;
+}
+
+static bool sum_all_cb(const PomodoroHistoryColumns_t *cols, void *user_data)
+{
+    uint64_t *sum = user_data;
+
+    for (uint32_t i = 0; i < cols->count; i++) {
+        *sum += (uint64_t)cols->start_s[i] + cols->duration_s[i] + cols->type[i] +
+                cols->paused_s[i] + cols->interruptions[i];
+    }
+    return true;
+}
+
+static bool focus_cb(const PomodoroHistoryColumns_t *cols, void *user_data)
+{
+    uint64_t *focus = user_data;
+
+    for (uint32_t i = 0; i < cols->count; i++) {
+        *focus += (cols->type[i] == POMODORO_WORK) ? cols->duration_s[i] : 0u;
+    }
+    return true;
+}
+
+static void bench_scans(void)
+{
+    const double decoded_bytes = (double)record_count * (8 + 4 + 1 + 4 + 2);
+    ScanCheck_t chk = { 0 };
+    uint64_t ref_focus = 0, focus = 0, sum = 0, ref_sum = 0;
+    uint64_t start, ns;
+    uint32_t n;
+
+    n = pomodoro_history_scan(INT64_MIN, INT64_MAX, POMODORO_HISTORY_COL_ALL, check_all_cb, &chk);
+    if (n != record_count || chk.mismatch) {
+        printf("scan mismatch: %u of %u records%s\n", n, record_count, chk.mismatch ? ", values differ" : "");
+        errors++;
+    }
+
+    // Reference: the same sums over a plain array of records
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < BENCH_SCAN_REPEAT; r++) {
+        for (uint32_t i = 0; i < record_count; i++) {
+            const PomodoroHistoryRecord_t *rec = &records[i];
+            ref_sum += (uint64_t)rec->start_s + rec->duration_s + rec->type + rec->paused_s + rec->interruptions;
+        }
+    }
+    ns = bench_now_ns() - start;
+    printf("scan  plain array, all columns    %7.2f ns/record  %8.1f M records/s  %8.0f MB/s\n",
+           (double)ns / ((double)record_count * BENCH_SCAN_REPEAT),
+           (double)record_count * BENCH_SCAN_REPEAT / ((double)ns / 1e3),
+           (double)record_count * sizeof(PomodoroHistoryRecord_t) * BENCH_SCAN_REPEAT / ((double)ns / 1e3));
+
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < BENCH_SCAN_REPEAT; r++) {
+        pomodoro_history_scan(INT64_MIN, INT64_MAX, POMODORO_HISTORY_COL_ALL, sum_all_cb, &sum);
+    }
+    ns = bench_now_ns() - start;
+    printf("scan  history,     all columns    %7.2f ns/record  %8.1f M records/s  %8.0f MB/s decoded\n",
+           (double)ns / ((double)record_count * BENCH_SCAN_REPEAT),
+           (double)record_count * BENCH_SCAN_REPEAT / ((double)ns / 1e3),
+           decoded_bytes * BENCH_SCAN_REPEAT / ((double)ns / 1e3));
+    if (sum != ref_sum) {
+        printf("  sum mismatch\n");
+        errors++;
+    }
+
+    for (uint32_t i = 0; i < record_count; i++) {
+        ref_focus += (records[i].type == POMODORO_WORK) ? records[i].duration_s : 0u;
+    }
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < BENCH_SCAN_REPEAT; r++) {
+        pomodoro_history_scan(INT64_MIN, INT64_MAX, POMODORO_HISTORY_COL_TYPE | POMODORO_HISTORY_COL_DURATION,
+                              focus_cb, &focus);
+    }
+    ns = bench_now_ns() - start;
+    printf("scan  history,     type+duration  %7.2f ns/record  %8.1f M records/s  %8.0f h focus\n",
+           (double)ns / ((double)record_count * BENCH_SCAN_REPEAT),
+           (double)record_count * BENCH_SCAN_REPEAT / ((double)ns / 1e3),
+           (double)(focus / BENCH_SCAN_REPEAT) / 3600.0);
+    if (focus != ref_focus * BENCH_SCAN_REPEAT) {
+        printf("  focus mismatch\n");
+        errors++;
+    }
+
+    // March of year 6
+    int64_t from = EPOCH_2016_S + (int64_t)(5u * 365u + 59u) * DAY_S;
+    int64_t to = from + 31 * DAY_S;
+    uint32_t expected = 0;
+    for (uint32_t i = 0; i < record_count; i++) {
+        expected += records[i].start_s >= from && records[i].start_s < to;
+    }
+    focus = 0;
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < BENCH_SCAN_REPEAT; r++) {
+        n = pomodoro_history_scan(from, to, POMODORO_HISTORY_COL_TYPE | POMODORO_HISTORY_COL_DURATION,
+                                  focus_cb, &focus);
+    }
+    ns = bench_now_ns() - start;
+    printf("range one month, type+duration    %7.2f us/scan    %u records%s\n",
+           (double)ns / BENCH_SCAN_REPEAT / 1e3, n, n == expected ? "" : "  MISMATCH");
+    if (n != expected) errors++;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = (argc > 1) ? argv[1] : "/tmp";
+    PomodoroHistoryStats_t st;
+    double ram_ns, file_ns;
+    uint64_t start;
+
+    snprintf(path, sizeof(path), "%s/history_bench.history", dir);
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+
+    generate();
+    printf("history_bench: %u records over %u years, %u per block, file %s\n",
+           record_count, BENCH_YEARS, POMODORO_HISTORY_BLOCK_RECORDS, path);
+
+    ram_ns = append_all();
+    pomodoro_history_get_stats(&st);
+    if (st.records != record_count || st.dropped_blocks != 0) {
+        printf("history holds %u of %u records, %u blocks dropped\n",
+               st.records, record_count, st.dropped_blocks);
+        errors++;
+    }
+
+    remove(path);
+    pomodoro_history_open(path);
+    pomodoro_history_clear();
+    file_ns = append_all();
+    pomodoro_history_close();
+
+    printf("append: %.1f ns/record in RAM, %.1f ns/record with the file\n", ram_ns, file_ns);
+    printf("size:   %u bytes in %u blocks, %.2f bytes/record (plain %u), %.1f KB/year\n",
+           st.arena_bytes, st.blocks, (double)st.arena_bytes / st.records,
+           (unsigned)sizeof(PomodoroHistoryRecord_t), st.arena_bytes / 1024.0 / BENCH_YEARS);
+
+    start = bench_now_ns();
+    pomodoro_history_open(path);
+    printf("open:   %.2f ms to load %u records\n", (double)(bench_now_ns() - start) / 1e6, record_count);
+    pomodoro_history_close();
+
+    bench_scans();
+    remove(path);
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file history_screen_bench.c
+ * @brief History screen data path on 10 years of Pomodoros, against the 33 ms frame
+ *
+ * Runs the part of show_history_screen() that grows with the history,
+ * without LVGL: the stats index is rebuilt from 10 years of records, then
+ *
+ *  - model:         history_model_build(), 371 heatmap days, the last
+ *                   12 months, streaks and every week of the history
+ *                   downsampled to HISTORY_CHART_POINTS bars
+ *  - tile:          painting the whole heatmap tile (first open, new week)
+ *                   and only the changed cells (a session finished)
+ *  - lttb:          downsampling 1k to 1M weekly points, the bar count
+ *                   stays bounded
+ *
+ * The heatmap levels are checked against a scan of the records, the
+ * change count the screen skips rebuilds with against added sessions, and
+ * the LTTB output against its contract (first, last, increasing).
+ *
+ * Built with its own copy of the stats index, the history (4 MB arena) and
+ * UI/history_model.c, which does not use LVGL.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_history.h"
+#include "pomodoro_stats.h"
+#include "history_model.h"
+#include "core_log.h"
+
+#define BENCH_YEARS         10u
+#define BENCH_DAYS          (BENCH_YEARS * 365u)
+#define BENCH_MAX_RECORDS   (BENCH_DAYS * 16u * 2u)
+#define BENCH_RUNS          1000u
+#define BENCH_LTTB_MAX      1000000u
+#define FRAME_BUDGET_MS     33.0
+#define DAY_S               86400
+#define EPOCH_2016_S        1451606400
+
+static PomodoroHistoryRecord_t records[BENCH_MAX_RECORDS];
+static uint32_t record_count;
+static uint32_t rng = 2016u;
+static int64_t clock_s;
+static uint32_t errors;
+static uint64_t run_ns[BENCH_RUNS];
+static uint32_t lttb_y[BENCH_LTTB_MAX];
+static uint16_t tile[HISTORY_TILE_W * HISTORY_TILE_H];
+static HistoryModel_t model;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static uint64_t bench_clock_ms(void)
+{
+    return (uint64_t)clock_s * 1000u;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Same dataset as history_bench, with a day off now and then */
+static void generate(void)
+{
+    for (uint32_t day = 0; day < BENCH_DAYS; day++) {
+        int64_t t = EPOCH_2016_S + (int64_t)day * DAY_S + 9 * 3600 + (int64_t)(next_rand() % 3600u);
+        uint32_t work_s = (next_rand() % 10u == 0) ? 50u * 60u : 25u * 60u;
+        uint32_t phases = (next_rand() % 7u == 0) ? 0u : 1u + next_rand() % 14u;
+
+        for (uint32_t p = 0; p < phases; p++) {
+            PomodoroHistoryRecord_t *w = &records[record_count++];
+            PomodoroHistoryRecord_t *b = &records[record_count++];
+
+            *w = (PomodoroHistoryRecord_t){ .start_s = t, .duration_s = work_s, .type = POMODORO_WORK };
+            t += work_s;
+            *b = (PomodoroHistoryRecord_t){ .start_s = t, .duration_s = 5u * 60u, .type = POMODORO_SHORT_BREAK };
+            t += 5 * 60 + (int64_t)(next_rand() % 120u);
+        }
+    }
+    clock_s = records[record_count - 1u].start_s + 3600;
+}
+
+static void report(const char *what, uint32_t runs)
+{
+    qsort(run_ns, runs, sizeof(run_ns[0]), cmp_u64);
+    printf("%-28s %9.1f  %9.1f  %9.1f\n", what,
+           run_ns[0] / 1e3, run_ns[runs / 2u] / 1e3, run_ns[runs - 1u] / 1e3);
+}
+
+static void check_levels(void)
+{
+    uint32_t sessions[HISTORY_HEATMAP_CELLS] = { 0 };
+    bool ok = true;
+
+    for (uint32_t i = 0; i < record_count; i++) {
+        int32_t cell = pomodoro_stats_day_of(records[i].start_s) - model.first_day;
+        if (records[i].type == POMODORO_WORK && cell >= 0 && cell < HISTORY_HEATMAP_CELLS) {
+            sessions[cell]++;
+        }
+    }
+    for (int32_t i = 0; i < HISTORY_HEATMAP_CELLS; i++) {
+        uint8_t expect = (model.first_day + i > model.today) ? HISTORY_LEVEL_FUTURE : history_model_level(sessions[i]);
+        ok &= model.level[i] == expect;
+    }
+    if (!ok || model.chart_count > HISTORY_CHART_POINTS || model.chart_count < 2u) {
+        printf("model mismatch: levels %s, %u bars\n", ok ? "ok" : "differ", model.chart_count);
+        errors++;
+    }
+}
+
+static void bench_model(void)
+{
+    double worst_ms;
+
+    for (uint32_t r = 0; r < BENCH_RUNS; r++) {
+        uint64_t start = bench_now_ns();
+        history_model_build(&model);
+        run_ns[r] = bench_now_ns() - start;
+    }
+    worst_ms = run_ns[0];
+    for (uint32_t r = 1; r < BENCH_RUNS; r++) {
+        if (run_ns[r] > worst_ms) worst_ms = run_ns[r];
+    }
+    worst_ms /= 1e6;
+    report("model build", BENCH_RUNS);
+    check_levels();
+    // Nothing added since: the screen's refresh timer skips the rebuild
+    if (pomodoro_stats_change_count() != model.stats_changes) {
+        printf("  change count moved without a session\n");
+        errors++;
+    }
+    printf("  %u weeks in %u bars, %u sessions in the last 12 months, streak %u, longest %u\n",
+           model.weeks, model.chart_count, model.year_sessions, model.current_streak, model.longest_streak);
+    if (worst_ms > FRAME_BUDGET_MS) {
+        printf("  over the frame budget: %.2f ms\n", worst_ms);
+        errors++;
+    }
+}
+
+static void bench_tile(void)
+{
+    const uint16_t palette[HISTORY_HEATMAP_LEVELS + 1] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t cached[HISTORY_HEATMAP_CELLS];
+    uint32_t painted = 0;
+
+    for (uint32_t r = 0; r < BENCH_RUNS; r++) {
+        uint64_t start = bench_now_ns();
+        history_model_paint_tile(tile, HISTORY_TILE_W, &model, cached, palette, true);
+        run_ns[r] = bench_now_ns() - start;
+    }
+    report("tile, full paint", BENCH_RUNS);
+
+    // One more session today: its cell changes level now and then
+    for (uint32_t r = 0; r < BENCH_RUNS; r++) {
+        PomodoroHistoryRecord_t rec = { .start_s = clock_s - 60, .duration_s = 1500, .type = POMODORO_WORK };
+
+        pomodoro_stats_add(&rec);
+        if (pomodoro_stats_change_count() == model.stats_changes) {
+            printf("  change count missed a session\n");
+            errors++;
+        }
+        history_model_build(&model);
+        uint64_t start = bench_now_ns();
+        painted += history_model_paint_tile(tile, HISTORY_TILE_W, &model, cached, palette, false);
+        run_ns[r] = bench_now_ns() - start;
+    }
+    report("tile, changed cells", BENCH_RUNS);
+    printf("  %u cells painted over %u sessions\n", painted, BENCH_RUNS);
+    if (painted == 0 || painted > 4u) {
+        errors++;
+    }
+}
+
+static void bench_lttb(void)
+{
+    static uint32_t idx[HISTORY_CHART_POINTS];
+
+    for (uint32_t i = 0; i < BENCH_LTTB_MAX; i++) {
+        lttb_y[i] = 600u + (next_rand() % 900u) + ((i / 52u) % 3u) * 200u;
+    }
+    for (uint32_t n = 1000u; n <= BENCH_LTTB_MAX; n *= 10u) {
+        uint64_t start = bench_now_ns();
+        uint32_t count = history_model_lttb(lttb_y, n, idx, HISTORY_CHART_POINTS);
+        uint64_t ns = bench_now_ns() - start;
+        bool ok = count == HISTORY_CHART_POINTS && idx[0] == 0 && idx[count - 1u] == n - 1u;
+
+        for (uint32_t i = 1; i < count; i++) {
+            ok &= idx[i] > idx[i - 1u];
+        }
+        printf("lttb %8u points -> %u     %9.1f us%s\n", n, count, ns / 1e3, ok ? "" : "  MISMATCH");
+        if (!ok) errors++;
+    }
+}
+
+int main(void)
+{
+    uint64_t start;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    generate();
+    pomodoro_history_set_clock(bench_clock_ms);
+    for (uint32_t i = 0; i < record_count; i++) {
+        pomodoro_history_append(&records[i]);
+    }
+    start = bench_now_ns();
+    pomodoro_stats_rebuild();
+    printf("history_screen_bench: %u records over %u years, stats rebuilt in %.2f ms (startup)\n\n",
+           record_count, BENCH_YEARS, (bench_now_ns() - start) / 1e6);
+
+    printf("%-28s %9s  %9s  %9s\n", "", "min us", "med us", "max us");
+    bench_model();
+    bench_tile();
+    printf("\n");
+    bench_lttb();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file icon_bench.c
+ * @brief Icon draw time and asset bytes: ARGB8888 sources against A8 masks
+ *
+ * Redraws every icon of assets/png on an offscreen display (direct mode, no
+ * SDL window), for each layout, with:
+ *
+ *  - argb8888:  the committed ARGB8888 assets, recolored at draw time and, on
+ *               240x320, scaled by 0.7 with lv_image_set_scale(), as the
+ *               main screen drew them
+ *  - a8:        the masks of assets/png_to_a8.py built at the size of the
+ *               layout, drawn in the recolor, no transform
+ *
+ * Reported per layout and format, as CSV on stdout:
+ *
+ *  - bytes:         image data of all the icons
+ *  - draw_us:       lv_refr_now() of an invalidated icon, mean
+ *  - px_per_draw:   pixels flushed per redraw, mean
+ *
+ * Checked: the masks take at most a quarter of the bytes, and at 480x480
+ * they render the same pixels as the recolored ARGB8888 icons.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+
+#define BENCH_HOR_RES       480
+#define BENCH_VER_RES       480
+#define BENCH_DRAWS         2000u
+#define BENCH_RECOLOR       0xBBBBBB
+#define BENCH_PX_TOLERANCE  2
+
+/* The three builds of an icon, the A8 ones named by their suffix */
+#define DECLARE_ICON(name) \
+    LV_IMAGE_DECLARE(name); LV_IMAGE_DECLARE(name##_a8_480x480); LV_IMAGE_DECLARE(name##_a8_240x320)
+#define ICON(name) { #name, &name, { &name##_a8_480x480, &name##_a8_240x320 } }
+
+DECLARE_ICON(get_ready_64x64);
+DECLARE_ICON(run);
+DECLARE_ICON(race);
+DECLARE_ICON(speed);
+DECLARE_ICON(short_break);
+DECLARE_ICON(long_break);
+DECLARE_ICON(objective);
+DECLARE_ICON(setting_icon);
+
+/**
+ * @brief One icon: the ARGB8888 source and its mask for each layout
+ */
+typedef struct {
+    const char *name;
+    const lv_image_dsc_t *argb;
+    const lv_image_dsc_t *a8[2];
+} BenchIcon_t;
+
+/**
+ * @brief A layout: its A8 set and the scale the main screen used on it
+ */
+typedef struct {
+    const char *name;
+    uint32_t set;
+    int32_t scale;
+} BenchLayout_t;
+
+static const BenchIcon_t icons[] = {
+    ICON(get_ready_64x64),
+    ICON(run),
+    ICON(race),
+    ICON(speed),
+    ICON(short_break),
+    ICON(long_break),
+    ICON(objective),
+    ICON(setting_icon),
+};
+
+static const BenchLayout_t layouts[] = {
+    { "480x480", 0, LV_SCALE_NONE },
+    { "240x320", 1, (int32_t)(LV_SCALE_NONE * 0.7) },
+};
+
+#define ICON_COUNT (sizeof(icons) / sizeof(icons[0]))
+
+static lv_display_t *disp;
+static uint8_t *frame_buf;
+static size_t frame_size;
+static uint64_t flushed_px;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t bench_tick_cb(void)
+{
+    return (uint32_t)(bench_now_ns() / 1000000u);
+}
+
+static void bench_flush_cb(lv_display_t *d, const lv_area_t *area, uint8_t *px_map)
+{
+    (void)px_map;
+    flushed_px += (uint64_t)lv_area_get_size(area);
+    lv_display_flush_ready(d);
+}
+
+static void bench_lv_log_cb(lv_log_level_t level, const char *buf)
+{
+    (void)level;
+    fputs(buf, stderr);
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "check failed: %s\n", what);
+        errors++;
+    }
+}
+
+/* An icon as the main screen shows it: recolored, centered */
+static lv_obj_t *icon_create(const lv_image_dsc_t *src, int32_t scale)
+{
+    lv_obj_t *img = lv_image_create(lv_screen_active());
+
+    lv_image_set_src(img, src);
+    lv_obj_set_style_image_recolor(img, lv_color_hex(BENCH_RECOLOR), 0);
+    lv_obj_set_style_image_recolor_opa(img, LV_OPA_100, 0);
+    if (scale != LV_SCALE_NONE) lv_image_set_scale(img, (uint32_t)scale);
+    lv_obj_center(img);
+    lv_refr_now(disp);
+    return img;
+}
+
+/* Redraw the icon BENCH_DRAWS times, return the ns and add the pixels */
+static uint64_t redraw(lv_obj_t *img, uint64_t *px)
+{
+    uint64_t ns = 0;
+
+    for (uint32_t i = 0; i < BENCH_DRAWS; i++) {
+        uint64_t t0;
+
+        flushed_px = 0;
+        lv_obj_invalidate(img);
+        t0 = bench_now_ns();
+        lv_refr_now(disp);
+        ns += bench_now_ns() - t0;
+        *px += flushed_px;
+    }
+    return ns;
+}
+
+static void report(const char *layout, const char *format, uint32_t bytes, uint64_t ns, uint64_t px)
+{
+    uint64_t draws = (uint64_t)BENCH_DRAWS * ICON_COUNT;
+
+    printf("%s,%s,%u,%.2f,%.0f\n", layout, format, (unsigned)bytes, ns / 1e3 / draws, (double)px / draws);
+}
+
+/* Largest difference of a frame buffer byte against the snapshot */
+static uint32_t frame_diff(const uint8_t *snapshot)
+{
+    uint32_t max = 0;
+
+    for (size_t i = 0; i < frame_size; i++) {
+        uint32_t d = (uint32_t)abs((int)frame_buf[i] - (int)snapshot[i]);
+        if (d > max) max = d;
+    }
+    return max;
+}
+
+static void bench_layout(const BenchLayout_t *l, uint8_t *snapshot)
+{
+    uint64_t argb_ns = 0, argb_px = 0, a8_ns = 0, a8_px = 0;
+    uint32_t argb_bytes = 0, a8_bytes = 0;
+    uint32_t max_diff = 0;
+
+    for (uint32_t i = 0; i < ICON_COUNT; i++) {
+        const BenchIcon_t *icon = &icons[i];
+        lv_obj_t *img;
+
+        argb_bytes += icon->argb->data_size;
+        a8_bytes += icon->a8[l->set]->data_size;
+        check(icon->a8[l->set]->header.cf == LV_COLOR_FORMAT_A8, "mask is A8");
+
+        img = icon_create(icon->argb, l->scale);
+        argb_ns += redraw(img, &argb_px);
+        memcpy(snapshot, frame_buf, frame_size);
+        lv_obj_delete(img);
+
+        img = icon_create(icon->a8[l->set], LV_SCALE_NONE);
+        a8_ns += redraw(img, &a8_px);
+        if (l->scale == LV_SCALE_NONE) {
+            uint32_t d = frame_diff(snapshot);
+            if (d > BENCH_PX_TOLERANCE) fprintf(stderr, "%s: pixels differ by %u\n", icon->name, (unsigned)d);
+            if (d > max_diff) max_diff = d;
+        }
+        lv_obj_delete(img);
+    }
+
+    report(l->name, "argb8888", argb_bytes, argb_ns, argb_px);
+    report(l->name, "a8", a8_bytes, a8_ns, a8_px);
+    check(a8_bytes * 4u <= argb_bytes, "masks take a quarter of the bytes");
+    if (l->scale == LV_SCALE_NONE) {
+        check(max_diff <= BENCH_PX_TOLERANCE, "masks render the recolored icons");
+        fprintf(stderr, "%s: largest pixel difference %u\n", l->name, (unsigned)max_diff);
+    }
+}
+
+int main(void)
+{
+    uint8_t *snapshot;
+
+    lv_init();
+    lv_log_register_print_cb(bench_lv_log_cb);
+    lv_tick_set_cb(bench_tick_cb);
+
+    disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    frame_size = (size_t)BENCH_HOR_RES * BENCH_VER_RES * lv_color_format_get_size(lv_display_get_color_format(disp));
+    frame_buf = malloc(frame_size);
+    snapshot = malloc(frame_size);
+    if (frame_buf == NULL || snapshot == NULL) {
+        fprintf(stderr, "no memory for the frame buffers\n");
+        return 1;
+    }
+    lv_display_set_buffers(disp, frame_buf, NULL, (uint32_t)frame_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, bench_flush_cb);
+
+    // The dark background of the app
+    lv_obj_set_style_bg_color(lv_screen_active(), lv_color_hex(0x343247), 0);
+    lv_obj_set_style_bg_opa(lv_screen_active(), LV_OPA_COVER, 0);
+    lv_refr_now(disp);
+
+    printf("layout,format,bytes,draw_us,px_per_draw\n");
+    for (uint32_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+        bench_layout(&layouts[i], snapshot);
+    }
+    free(snapshot);
+
+    if (errors) {
+        fprintf(stderr, "FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
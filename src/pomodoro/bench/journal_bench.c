@@ -0,0 +1,235 @@
+/**
+ * @file journal_bench.c
+ * @brief Cost of the session journal: per transition, and recovery at startup
+ *
+ *  - transition:    pomodoro_pause() + pomodoro_resume() on the default session,
+ *                   ns per state change without and with an open journal. The
+ *                   batched flushes (every POMODORO_JOURNAL_FLUSH_BATCH records)
+ *                   are included.
+ *  - recovery:      journals of 1M / 4M / 16M records. open is what startup
+ *                   pays (map, find the newest record, restore, checkpoint);
+ *                   torn tail has a corrupted last record, torn head a corrupted
+ *                   first slot, which forces a scan; replay checks every record.
+ *  - downtime:      a 25/5/15 min x4 session closed in WORK and reopened
+ *                   40 min and 3 days later on a fake wall clock, checked
+ *                   against the schedule.
+ *
+ * Usage: journal_bench [directory for the journal files, default /tmp]
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 200809L /* needed for clock_gettime(), ftruncate(), pread() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pomodoro.h"
+#include "pomodoro_journal.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_TRANSITION_PAIRS  500000u
+#define MIN_MS                  (60u * 1000u)
+
+static char path[512];
+static uint64_t fake_wall_ms = 1700000000000ull;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t fake_wall(void)
+{
+    return fake_wall_ms;
+}
+
+static double transitions_ns(bool journal)
+{
+    uint64_t start;
+
+    timer_init();
+    pomodoro_init(25, 5, 15, 4);
+    if (journal) {
+        unlink(path);
+        pomodoro_journal_open(path, 0);
+    }
+    pomodoro_start();
+
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_TRANSITION_PAIRS; i++) {
+        pomodoro_pause();
+        pomodoro_resume();
+    }
+    double ns = (double)(bench_now_ns() - start) / (2.0 * BENCH_TRANSITION_PAIRS);
+
+    pomodoro_journal_close();
+    return ns;
+}
+
+static void bench_transitions(void)
+{
+    double plain = transitions_ns(false);
+    double journaled = transitions_ns(true);
+
+    printf("transition: %.1f ns without journal, %.1f ns with, +%.1f ns per transition\n",
+           plain, journaled, journaled - plain);
+}
+
+static void corrupt_byte(uint64_t offset)
+{
+    int fd = open(path, O_RDWR);
+    uint8_t b;
+
+    if (fd < 0) return;
+    if (pread(fd, &b, 1, (off_t)offset) == 1) {
+        b ^= 0x5Au;
+        if (pwrite(fd, &b, 1, (off_t)offset) != 1) errors++;
+    }
+    close(fd);
+}
+
+static double open_ms(void)
+{
+    uint64_t start = bench_now_ns();
+    bool ok = pomodoro_journal_open(path, 0);
+    double ms = (double)(bench_now_ns() - start) / 1e6;
+
+    if (!ok) errors++;
+    return ms;
+}
+
+static void bench_recovery(uint32_t records)
+{
+    PomodoroSnapshot_t snap;
+    uint64_t start;
+    double fill_ns, t_open, t_replay, t_torn_tail, t_torn_head;
+    uint32_t replayed;
+
+    // Fill: one record per append, wrapping once so the newest sits mid-file
+    timer_init();
+    pomodoro_init(25, 5, 15, 4);
+    pomodoro_get_snapshot(&snap);
+    unlink(path);
+    pomodoro_journal_open(path, records);
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < records + records / 2u; i++) {
+        snap.transition_count = i;
+        pomodoro_journal_append(&snap);
+    }
+    fill_ns = (double)(bench_now_ns() - start) / (records + records / 2u);
+    pomodoro_journal_close();
+
+    timer_init();
+    t_open = open_ms();
+    start = bench_now_ns();
+    replayed = pomodoro_journal_replay(NULL, NULL);
+    t_replay = (double)(bench_now_ns() - start) / 1e6;
+    pomodoro_journal_close();
+    if (replayed != records) {
+        printf("  replay visited %u of %u records\n", replayed, records);
+        errors++;
+    }
+
+    // The fill wrapped at slot 0 and ended at slot records / 2 - 1, the checkpoint of the open above follows
+    uint64_t newest = 64u + (uint64_t)(records / 2u) * sizeof(PomodoroJournalRecord_t);
+    corrupt_byte(newest + 12u);
+    timer_init();
+    t_torn_tail = open_ms();
+    pomodoro_journal_close();
+
+    corrupt_byte(64u + 12u);
+    timer_init();
+    t_torn_head = open_ms();
+    pomodoro_journal_close();
+
+    printf("%9u  %9.1f  %8.3f  %10.3f  %10.3f  %9.1f\n",
+           records, fill_ns, t_open, t_torn_tail, t_torn_head, t_replay);
+    unlink(path);
+}
+
+static void expect(const char *what, PomodoroState_e state, uint32_t remaining_min, uint8_t cycle)
+{
+    PomodoroSnapshot_t snap;
+
+    pomodoro_get_snapshot(&snap);
+    bool ok = snap.state == state && snap.remaining_ms == remaining_min * MIN_MS && snap.cycle_count == cycle;
+    printf("downtime %-8s state %u, %u ms left, cycle %u%s\n", what, (unsigned)snap.state,
+           (unsigned)snap.remaining_ms, (unsigned)snap.cycle_count, ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+}
+
+static void bench_downtime(void)
+{
+    pomodoro_journal_set_clock(fake_wall);
+    unlink(path);
+
+    timer_init();
+    pomodoro_init(25, 5, 15, 4);
+    pomodoro_journal_open(path, 0);
+    pomodoro_start();
+    pomodoro_journal_close();
+
+    // 25 WORK + 5 SHORT, then 10 of the next WORK
+    fake_wall_ms += 40u * MIN_MS;
+    timer_init();
+    pomodoro_journal_open(path, 0);
+    expect("40 min", POMODORO_WORK, 15, 1);
+    pomodoro_journal_close();
+
+    // From the checkpoint: 15 min to the end of cycle 2, then 4305 min = 33 rounds of
+    // 4 x 25 + 3 x 5 + 15 = 130 min + 15 min: a 5 min short break and 10 min of work
+    fake_wall_ms += 3u * 24u * 60u * MIN_MS;
+    timer_init();
+    pomodoro_journal_open(path, 0);
+    expect("3 days", POMODORO_WORK, 15, 2);
+    pomodoro_pause();
+    pomodoro_journal_close();
+
+    // Paused sessions do not count down while down
+    fake_wall_ms += 24u * 60u * MIN_MS;
+    timer_init();
+    pomodoro_journal_open(path, 0);
+    expect("paused", POMODORO_PAUSED_WORK, 15, 2);
+    pomodoro_journal_close();
+
+    pomodoro_journal_set_clock(NULL);
+    unlink(path);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t sizes[] = { 1u << 20, 4u << 20, 16u << 20 };
+    const char *dir = (argc > 1) ? argv[1] : "/tmp";
+
+    snprintf(path, sizeof(path), "%s/journal_bench.journal", dir);
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+
+    printf("journal_bench: %u byte records, flush every %u records, file %s\n",
+           (unsigned)sizeof(PomodoroJournalRecord_t), POMODORO_JOURNAL_FLUSH_BATCH, path);
+    bench_transitions();
+
+    printf("%9s  %9s  %8s  %10s  %10s  %9s\n",
+           "records", "append ns", "open ms", "torn tail", "torn head", "replay ms");
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_recovery(sizes[i]);
+    }
+
+    bench_downtime();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file plan_bench.c
+ * @brief Session plans: compiler, interpreter and Core transitions
+ *
+ *  - built-in plans:      each source in pomodoro_plan_source() compiles to
+ *                         the bytecode kept in flash, byte for byte
+ *  - compiler:            plans that must be rejected (wrong order of phases,
+ *                         empty or unclosed blocks, a loop not last, nesting,
+ *                         too long, bad durations) and some that must not
+ *  - schedules:           the phases a created session runs through for the
+ *                         classic, warm-up and workday plans, lengths included,
+ *                         and the workday plan ending in IDLE
+ *  - step:                ns per pomodoro_plan_step() for every built-in plan,
+ *                         against the cycle % max_cycles test the Core used
+ *                         before plans
+ *  - transitions:         ns per phase end through pomodoro_session_dispatch()
+ *                         on a created session, per plan
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_plan.h"
+#include "pomodoro_fsm.h"
+#include "core_log.h"
+
+#define BENCH_STEPS         (1u << 24)
+#define BENCH_TRANSITIONS   (1u << 22)
+#define BENCH_MAX_CYCLES    4u
+
+/**
+ * @brief A phase a session is expected to enter: state and minutes
+ */
+typedef struct {
+    uint8_t  state;
+    uint16_t minutes;
+} BenchPhase_t;
+
+static uint32_t errors;
+static volatile uint32_t sink;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t ns, uint32_t count)
+{
+    double ns_per = (double)ns / count;
+    printf("%-24s %10.2f  %12.1f\n", name, ns_per, 1e3 / ns_per);
+}
+
+// ====================== Correctness ======================
+
+static void check_builtins(void)
+{
+    for (uint8_t id = 0; id < POMODORO_PLAN_BUILTIN_COUNT; id++) {
+        const PomodoroPlan_t *flash = pomodoro_plan_get(id);
+        PomodoroPlan_t compiled;
+        PomodoroPlanError_t err;
+
+        if (!pomodoro_plan_compile(pomodoro_plan_source(id), &compiled, &err)) {
+            printf("%s: does not compile at %u: %s\n", pomodoro_plan_name(id), (unsigned)err.offset, err.message);
+            errors++;
+        } else if (compiled.size != flash->size || memcmp(compiled.code, flash->code, sizeof(compiled.code)) != 0) {
+            printf("%s: compiles to %u bytes that differ from the %u in flash\n",
+                   pomodoro_plan_name(id), compiled.size, flash->size);
+            errors++;
+        }
+        printf("  %-10s %2u bytes  %s\n", pomodoro_plan_name(id), flash->size, pomodoro_plan_source(id));
+    }
+}
+
+static void check_compiler(void)
+{
+    static const char *const bad[] = {
+        "",
+        "# only a comment",
+        "short 5; work 25",
+        "work; work",
+        "work 25; short 5; long 15",
+        "repeat 2 { }",
+        "repeat 2 { work; break",
+        "work }",
+        "loop { work; break } work",
+        "loop { work }",
+        "repeat 2 { loop { work; break } }",
+        "repeat 2 { repeat 2 { repeat 2 { work; break } } }",
+        "repeat 0 { work; break }",
+        "repeat 256 { work; break }",
+        "work 0",
+        "work 19h",
+        "work 5x",
+        "work 99999999999",
+        "walk 25",
+        "workout",
+        "work 1; short 1; work 1; short 1; work 1; short 1; work 1; short 1; work 1; short 1; "
+        "work 1; short 1; work 1; short 1; work 1; short 1; work 1; short 1; work 1; short 1; "
+        "work 1; short 1",
+    };
+    static const char *const good[] = {
+        "work",
+        "work 25; short 5",
+        "work 1h, long 30s",
+        "repeat 255 { work 90s; break }",
+        "repeat 2 { repeat 3 { work; short } work; long }",
+        "work 10m; short 5m  # warm-up\nloop { work; break }",
+    };
+    PomodoroPlan_t plan;
+    PomodoroPlanError_t err;
+
+    for (uint32_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (pomodoro_plan_compile(bad[i], &plan, &err)) {
+            printf("compiles, should not: \"%s\"\n", bad[i]);
+            errors++;
+        } else if (err.message == NULL || err.offset > strlen(bad[i])) {
+            printf("no usable error for \"%s\"\n", bad[i]);
+            errors++;
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(good) / sizeof(good[0]); i++) {
+        if (!pomodoro_plan_compile(good[i], &plan, &err)) {
+            printf("does not compile at %u (%s): \"%s\"\n", (unsigned)err.offset, err.message, good[i]);
+            errors++;
+        }
+    }
+    if (pomodoro_plan_load(POMODORO_PLAN_CLASSIC, "work", &err) || pomodoro_plan_is_valid(POMODORO_PLAN_BUILTIN_COUNT)) {
+        printf("built-in slot overwritten or user slot valid before loading\n");
+        errors++;
+    }
+}
+
+/* Phases a created session enters, from START until IDLE or the list is done */
+static void check_schedule(uint8_t plan, const BenchPhase_t *want, uint32_t count)
+{
+    pomodoro_session_t s = pomodoro_session_create(25, 5, 15, BENCH_MAX_CYCLES);
+    PomodoroSnapshot_t snap;
+
+    pomodoro_session_set_plan(s, plan);
+    pomodoro_session_start(s);
+    for (uint32_t i = 0; i < count; i++) {
+        pomodoro_session_get_snapshot(s, &snap);
+        if (snap.state != (PomodoroState_e)want[i].state || snap.remaining_ms != want[i].minutes * 60000u ||
+            snap.phase_duration_ms != snap.remaining_ms) {
+            printf("%s, phase %u: state %d for %u ms, expected %u for %u min\n", pomodoro_plan_name(plan), i,
+                   (int)snap.state, (unsigned)snap.remaining_ms, want[i].state, want[i].minutes);
+            errors++;
+            break;
+        }
+        pomodoro_session_dispatch(s, POMODORO_EV_FINISHED);
+    }
+    pomodoro_session_destroy(s);
+}
+
+static void check_schedules(void)
+{
+    static const BenchPhase_t classic[] = {
+        { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 }, { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 },
+        { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 }, { POMODORO_WORK, 25 }, { POMODORO_LONG_BREAK, 15 },
+        { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 },
+    };
+    // The warm-up counts as the first work phase of the round
+    static const BenchPhase_t warm_up[] = {
+        { POMODORO_WORK, 10 }, { POMODORO_SHORT_BREAK, 5 }, { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 },
+        { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 }, { POMODORO_WORK, 25 }, { POMODORO_LONG_BREAK, 15 },
+        { POMODORO_WORK, 25 }, { POMODORO_SHORT_BREAK, 5 },
+    };
+    // After the last work phase the session is IDLE, showing the first one again
+    static const BenchPhase_t workday[] = {
+        { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 }, { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 },
+        { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 }, { POMODORO_WORK, 50 }, { POMODORO_LONG_BREAK, 60 },
+        { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 }, { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 },
+        { POMODORO_WORK, 50 }, { POMODORO_SHORT_BREAK, 10 }, { POMODORO_WORK, 50 }, { POMODORO_IDLE, 50 },
+        { POMODORO_IDLE, 50 },
+    };
+    pomodoro_session_t s;
+    PomodoroSnapshot_t snap;
+
+    check_schedule(POMODORO_PLAN_CLASSIC, classic, sizeof(classic) / sizeof(classic[0]));
+    check_schedule(POMODORO_PLAN_WARM_UP, warm_up, sizeof(warm_up) / sizeof(warm_up[0]));
+    check_schedule(POMODORO_PLAN_WORKDAY, workday, sizeof(workday) / sizeof(workday[0]));
+
+    // Unloaded slots are refused, the session keeps its plan
+    s = pomodoro_session_create(25, 5, 15, BENCH_MAX_CYCLES);
+    if (pomodoro_session_set_plan(s, POMODORO_PLAN_BUILTIN_COUNT) || pomodoro_session_set_plan(s, 0xFF)) {
+        printf("an unloaded plan slot was accepted\n");
+        errors++;
+    }
+    pomodoro_session_get_snapshot(s, &snap);
+    if (snap.plan != POMODORO_PLAN_CLASSIC) {
+        printf("session left the classic plan\n");
+        errors++;
+    }
+    pomodoro_session_destroy(s);
+}
+
+// ====================== Timing ======================
+
+/* What the Core did before plans: work, then a break picked by the cycle count */
+static uint8_t classic_next(uint8_t state, uint8_t *cycle)
+{
+    if (state != POMODORO_WORK) return POMODORO_WORK;
+    (*cycle)++;
+    return (*cycle % BENCH_MAX_CYCLES == 0) ? POMODORO_LONG_BREAK : POMODORO_SHORT_BREAK;
+}
+
+static void bench_steps(void)
+{
+    uint8_t state = POMODORO_IDLE;
+    uint8_t cycle = 0;
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t i = 0; i < BENCH_STEPS; i++) {
+        state = classic_next(state, &cycle);
+    }
+    sink = state;
+    report("cycle % max_cycles", bench_now_ns() - start, BENCH_STEPS);
+
+    for (uint8_t id = 0; id < POMODORO_PLAN_BUILTIN_COUNT; id++) {
+        const PomodoroPlan_t *plan = pomodoro_plan_get(id);
+        PomodoroPlanCursor_t cursor = { 0 };
+        uint32_t acc = 0;
+        char name[32];
+
+        start = bench_now_ns();
+        for (uint32_t i = 0; i < BENCH_STEPS; i++) {
+            PomodoroPlanStep_t step = pomodoro_plan_step(plan, &cursor);
+
+            // A plan that ran out starts over, as a session does on START
+            if (step.phase == POMODORO_PLAN_END) cursor.pc = 0;
+            acc += step.phase + step.duration_s;
+        }
+        sink = acc;
+        snprintf(name, sizeof(name), "step %s", pomodoro_plan_name(id));
+        report(name, bench_now_ns() - start, BENCH_STEPS);
+    }
+}
+
+static void bench_transitions(void)
+{
+    for (uint8_t id = 0; id < POMODORO_PLAN_BUILTIN_COUNT; id++) {
+        pomodoro_session_t s = pomodoro_session_create(25, 5, 15, BENCH_MAX_CYCLES);
+        PomodoroSnapshot_t snap;
+        uint64_t start;
+        char name[32];
+
+        pomodoro_session_set_plan(s, id);
+        pomodoro_session_start(s);
+        start = bench_now_ns();
+        for (uint32_t i = 0; i < BENCH_TRANSITIONS; i++) {
+            pomodoro_session_dispatch(s, POMODORO_EV_FINISHED);
+        }
+        uint64_t ns = bench_now_ns() - start;
+
+        // Only the workday plan ends, it sits in IDLE from its first end on
+        pomodoro_session_get_snapshot(s, &snap);
+        if ((snap.state == POMODORO_IDLE) != (id == POMODORO_PLAN_WORKDAY)) {
+            printf("%s: state %d after %u phase ends\n", pomodoro_plan_name(id), (int)snap.state, BENCH_TRANSITIONS);
+            errors++;
+        }
+        snprintf(name, sizeof(name), "dispatch %s", pomodoro_plan_name(id));
+        report(name, ns, BENCH_TRANSITIONS);
+        pomodoro_session_destroy(s);
+    }
+}
+
+int main(void)
+{
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+
+    printf("plan_bench: built-in plans\n");
+    check_builtins();
+    check_compiler();
+    check_schedules();
+
+    printf("%-24s %10s  %12s\n", "", "ns/phase", "M phases/s");
+    bench_steps();
+    bench_transitions();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file pomo_bench.c
+ * @brief Microbenchmarks for the headless Core (pomodoro_core)
+ *
+ * Runs on the virtual clock so every measured call does the same work each
+ * time: time only moves when the benchmark moves it.
+ *
+ *  - pomodoro_tick, idle:      nothing due, the common main loop pass
+ *  - timer_tick_handler, tick: a second boundary delivered to an empty callback
+ *  - pomodoro_tick, tick:      the same through pomodoro.c to the UI callback
+ *  - callback overhead:        difference of the two above, the cost of the
+ *                              Core forwarding a tick to its listener
+ *  - phase transition:         pomodoro_tick that ends a phase, state callback
+ *                              and re-arm of the next phase
+ *  - pause + resume:           one pomodoro_pause() / pomodoro_resume() pair
+ *
+ * Transitions are timed one by one for percentiles, the rest in batches.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_BATCH             1000000u
+#define BENCH_TRANSITIONS       200000u
+
+static volatile uint32_t sink;
+static uint64_t samples[BENCH_TRANSITIONS];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_tick_empty(uint32_t remaining_ms)
+{
+    sink = remaining_ms;
+}
+
+static void on_state_empty(PomodoroState_e state)
+{
+    sink = (uint32_t)state;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, double ns_per_op)
+{
+    printf("%-30s %10.1f\n", name, ns_per_op);
+}
+
+/* Fresh running WORK phase of the given length, default callbacks */
+static void core_setup(uint32_t work_min, pomodoro_tick_cb_t tick_cb)
+{
+    timer_init();
+    pomodoro_init(work_min, 1, 1, 4);
+    pomodoro_set_state_callback(on_state_empty);
+    pomodoro_set_tick_callback(tick_cb);
+    pomodoro_start();
+}
+
+static double bench_idle_tick(void)
+{
+    core_setup(25, on_tick_empty);
+    monotonic_virtual_advance_ns(MONOTONIC_NS_PER_SEC / 2);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+        pomodoro_tick();
+    }
+    return (double)(bench_now_ns() - start) / BENCH_BATCH;
+}
+
+static double bench_timer_boundary(void)
+{
+    // Long enough that no phase ends during the batch
+    timer_init();
+    timer_start(UINT32_MAX, on_tick_empty, NULL);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+        monotonic_virtual_advance_ns(MONOTONIC_NS_PER_SEC);
+        timer_tick_handler();
+    }
+    return (double)(bench_now_ns() - start) / BENCH_BATCH;
+}
+
+static double bench_pomodoro_boundary(void)
+{
+    core_setup(60000, on_tick_empty);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+        monotonic_virtual_advance_ns(MONOTONIC_NS_PER_SEC);
+        pomodoro_tick();
+    }
+    return (double)(bench_now_ns() - start) / BENCH_BATCH;
+}
+
+static void bench_transitions(void)
+{
+    // No tick listener: every deadline is a phase end
+    core_setup(1, NULL);
+
+    for (uint32_t i = 0; i < BENCH_TRANSITIONS; i++) {
+        uint64_t deadline = timer_get_next_deadline_ns();
+        uint64_t now = monotonic_now_ns();
+        if (deadline > now) {
+            monotonic_virtual_advance_ns(deadline - now);
+        }
+
+        uint64_t start = bench_now_ns();
+        pomodoro_tick();
+        samples[i] = bench_now_ns() - start;
+    }
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < BENCH_TRANSITIONS; i++) {
+        sum += samples[i];
+    }
+    qsort(samples, BENCH_TRANSITIONS, sizeof(samples[0]), cmp_u64);
+
+    report("phase transition, mean", (double)sum / BENCH_TRANSITIONS);
+    report("phase transition, p50", (double)samples[BENCH_TRANSITIONS / 2]);
+    report("phase transition, p99", (double)samples[(uint64_t)BENCH_TRANSITIONS * 99u / 100u]);
+    report("phase transition, max", (double)samples[BENCH_TRANSITIONS - 1]);
+}
+
+static double bench_pause_resume(void)
+{
+    core_setup(25, on_tick_empty);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+        pomodoro_pause();
+        pomodoro_resume();
+    }
+    return (double)(bench_now_ns() - start) / BENCH_BATCH;
+}
+
+int main(void)
+{
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+
+    printf("pomo_bench: %u ops per batch, %u timed transitions\n", BENCH_BATCH, BENCH_TRANSITIONS);
+    printf("%-30s %10s\n", "benchmark", "ns/op");
+
+    report("pomodoro_tick, idle", bench_idle_tick());
+
+    double timer_ns = bench_timer_boundary();
+    double pomo_ns = bench_pomodoro_boundary();
+    report("timer_tick_handler, tick", timer_ns);
+    report("pomodoro_tick, tick", pomo_ns);
+    report("callback overhead", pomo_ns - timer_ns);
+
+    bench_transitions();
+    report("pause + resume", bench_pause_resume());
+
+    return 0;
+}
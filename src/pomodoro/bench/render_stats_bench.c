@@ -0,0 +1,190 @@
+/**
+ * @file render_stats_bench.c
+ * @brief Frame statistics of the render profiler, on synthetic frames
+ *
+ * The part of UI/render_profiler.c that runs once per rendered frame,
+ * without LVGL:
+ *
+ *  - add:           render_stats_add() of a frame with its draw tasks, the
+ *                   work done at each LV_EVENT_RENDER_READY
+ *  - csv:           render_stats_write_csv() of every mode, done once per
+ *                   report period by the app
+ *
+ * Checked: frames land in their mode only, the histograms count every frame,
+ * percentiles of a known distribution, and the CSV has a header and one line
+ * per mode with as many columns.
+ *
+ * Built with UI/render_stats.c, which does not use LVGL.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "render_stats.h"
+
+#define BENCH_FRAMES        (1u << 24)
+#define BENCH_CSV_WRITES    1000u
+
+static RenderStats_t stats;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t ns, uint32_t count)
+{
+    printf("%-26s %10.2f\n", name, (double)ns / count);
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("check failed: %s\n", what);
+        errors++;
+    }
+}
+
+/* A WORK frame of the main screen on a tick: timer label and arc */
+static void tick_frame(RenderFrame_t *frame, uint32_t render_us)
+{
+    memset(frame, 0, sizeof(*frame));
+    frame->render_us = render_us;
+    frame->flush_us = render_us / 4u;
+    frame->area_px = 200u * 200u;
+    frame->invalidations = 3;
+    frame->tasks[RENDER_TASK_FILL] = 2;
+    frame->tasks[RENDER_TASK_ARC] = 2;
+    frame->tasks[RENDER_TASK_LABEL] = 1;
+}
+
+static void check_stats(void)
+{
+    RenderFrame_t frame;
+    const RenderModeStats_t *work = &stats.mode[RENDER_MODE_WORK];
+    uint32_t hist = 0;
+
+    render_stats_reset(&stats);
+    // 90 fast frames, 10 that miss a 60 Hz frame
+    for (uint32_t i = 0; i < 100u; i++) {
+        tick_frame(&frame, (i < 90u) ? 300u : 20000u);
+        render_stats_add(&stats, RENDER_MODE_WORK, &frame);
+    }
+    tick_frame(&frame, 100000u);
+    render_stats_add(&stats, RENDER_MODE_IDLE, &frame);
+    render_stats_add(&stats, RENDER_MODE_COUNT, &frame);
+
+    check(work->frames == 100u, "WORK frames");
+    check(stats.mode[RENDER_MODE_IDLE].frames == 1u, "IDLE frames");
+    check(stats.mode[RENDER_MODE_PAUSED].frames == 0u, "PAUSED frames");
+    check(work->max_us == 20000u, "WORK max");
+    for (uint32_t b = 0; b < RENDER_TIME_BUCKETS; b++) hist += work->time_hist[b];
+    check(hist == work->frames, "time histogram total");
+    check(work->area_hist[3] == 100u, "area bucket of the arc");
+    check(render_stats_percentile_us(work, 50) == 500u, "p50");
+    check(render_stats_percentile_us(work, 90) == 500u, "p90");
+    check(render_stats_percentile_us(work, 99) == 33000u, "p99");
+    check(render_stats_percentile_us(&stats.mode[RENDER_MODE_IDLE], 50) == 100000u, "open bucket reports max");
+    check(render_stats_percentile_us(&stats.mode[RENDER_MODE_BREAK], 50) == 0u, "no frames");
+    check(work->tasks[RENDER_TASK_ARC] == 200u, "arc tasks");
+}
+
+static void check_csv(void)
+{
+    FILE *f = tmpfile();
+    char line[1024];
+    uint32_t lines = 0;
+    uint32_t header_cols = 0;
+
+    if (f == NULL) {
+        check(false, "tmpfile");
+        return;
+    }
+    check(render_stats_write_csv(f, &stats), "csv write");
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        uint32_t cols = 1;
+
+        for (const char *p = line; *p; p++) cols += (*p == ',');
+        if (lines == 0) {
+            header_cols = cols;
+        }
+        else {
+            check(cols == header_cols, "csv columns");
+            check(strncmp(line, render_stats_mode_name((RenderMode_e)(lines - 1u)),
+                          strlen(render_stats_mode_name((RenderMode_e)(lines - 1u)))) == 0, "csv mode order");
+        }
+        lines++;
+    }
+    fclose(f);
+    check(lines == 1u + RENDER_MODE_COUNT, "csv lines");
+    printf("%-26s %10u columns\n", "csv", (unsigned)header_cols);
+}
+
+static void bench_add(void)
+{
+    RenderFrame_t frame;
+    uint32_t x = 12345u;
+    uint64_t start;
+
+    tick_frame(&frame, 0);
+    render_stats_reset(&stats);
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_FRAMES; i++) {
+        // xorshift: render times over every bucket, modes in turn
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        frame.render_us = x & 0x1FFFFu;
+        frame.area_px = x >> 14;
+        render_stats_add(&stats, (RenderMode_e)(i % RENDER_MODE_COUNT), &frame);
+    }
+    report("add", bench_now_ns() - start, BENCH_FRAMES);
+
+    uint64_t total = 0;
+    for (uint32_t m = 0; m < RENDER_MODE_COUNT; m++) total += stats.mode[m].frames;
+    check(total == BENCH_FRAMES, "frames over all modes");
+}
+
+static void bench_csv(void)
+{
+    FILE *f = tmpfile();
+    uint64_t start;
+
+    if (f == NULL) return;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_CSV_WRITES; i++) {
+        rewind(f);
+        render_stats_write_csv(f, &stats);
+    }
+    fflush(f);
+    report("csv, all modes", bench_now_ns() - start, BENCH_CSV_WRITES);
+    fclose(f);
+}
+
+int main(void)
+{
+    printf("render_stats_bench: %u modes, %u time buckets, %u task types\n",
+           RENDER_MODE_COUNT, RENDER_TIME_BUCKETS, RENDER_TASK_COUNT);
+    printf("%-26s %10s\n", "", "ns");
+
+    check_stats();
+    check_csv();
+    bench_add();
+    bench_csv();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
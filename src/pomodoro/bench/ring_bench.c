@@ -0,0 +1,319 @@
+/**
+ * @file ring_bench.c
+ * @brief Pixels the progress ring invalidates per tick, by ring size
+ *
+ * Counts a 25 minute WORK phase down at 1 Hz on rings of 130 (240x320
+ * layout), 200 (480x480), 480, 960 and 1920 px, 10 px wide, and reports per
+ * tick:
+ *
+ *  - box:           the ring's square, what a tick invalidated while the
+ *                   colour of the arc was written on every tick
+ *  - lv_arc:        the sector of an lv_arc, whose end moves in whole
+ *                   degrees (every 4 s here), and the ticks that move it
+ *  - ring:          ring_sector_area() of the progress ring, mean and max,
+ *                   and the ticks that move its end: every one, it is kept
+ *                   to 1/64 degree
+ *
+ * Then the same phase animated at 30 fps, as the main screen does outside
+ * low-power mode: pomodoro_progress_q16() of a running phase at every frame,
+ * reported per frame and per second of UI time next to the 1 Hz steps.
+ *
+ * Checked: every pixel of the ring between two angles lies in the box
+ * ring_sector_area() returns (brute force, random angles and sizes), a tick
+ * invalidates a wedge of a few times the ring width squared at every size,
+ * the Q16 progress of phases up to 2^32 ms against double precision, and the
+ * helpers at their edges.
+ *
+ * Also timed: ns per ring_sector_area(), and per animation frame (progress,
+ * angle and box), against the 2 ms frame budget at 480x480. Built with
+ * UI/ring_geometry.c, which does not use LVGL.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "ring_geometry.h"
+#include "pomodoro.h"
+#include "monotonic.h"
+
+#define BENCH_PHASE_S       (25u * 60u)
+#define BENCH_FRAME_NS      (33u * MONOTONIC_NS_PER_MS)
+#define BENCH_BUDGET_NS     (2u * MONOTONIC_NS_PER_MS)
+#define BENCH_WIDTH         10
+#define BENCH_SECTORS       (1u << 22)
+#define BENCH_COVER_PAIRS   400u
+
+static uint32_t errors;
+static volatile uint32_t sink;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("check failed: %s\n", what);
+        errors++;
+    }
+}
+
+static uint32_t xorshift(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+static void check_helpers(void)
+{
+    RingGeometry_t g = { 100, BENCH_WIDTH, true };
+    RingArea_t a;
+
+    check(ring_sin(0) == 0 && ring_sin(90 * RING_ANGLE_UNITS) == 32767, "sin at 0 and 90");
+    check(ring_sin(30 * RING_ANGLE_UNITS) == 16383 && ring_sin(-90 * RING_ANGLE_UNITS) == -32767, "sin at 30 and -90");
+    check(ring_angle_of(60, 60) == 0 && ring_angle_of(0, 60) == RING_TURN, "full and empty ring");
+    check(ring_angle_of(45, 60) == 90 * RING_ANGLE_UNITS, "a quarter done");
+    check(ring_angle_of(5, 0) == 0, "no range");
+    check(ring_angle_of_q16(32768) == 180 * RING_ANGLE_UNITS, "half done in Q16");
+
+    a = ring_sector_area(&g, 1000, 1000);
+    check(ring_area_size(&a) == 0, "no sector between equal angles");
+    a = ring_sector_area(&g, 0, RING_TURN);
+    check(ring_area_size(&a) == 200u * 200u, "a whole turn is the ring's square");
+    a = ring_sector_area(&g, RING_TURN - 64, RING_TURN + 64);
+    check(a.y1 == 0 && a.x1 > 80 && a.x2 < 120, "sector across 12 o'clock");
+}
+
+/* Is the centre of pixel (x, y) on the ring between angles a and b, caps included */
+static bool on_ring(const RingGeometry_t *g, int32_t x, int32_t y, int32_t a, int32_t b)
+{
+    const double pi = 3.14159265358979323846;
+    double dx = x + 0.5 - g->radius, dy = y + 0.5 - g->radius;
+    double r = sqrt(dx * dx + dy * dy);
+    double deg = atan2(dx, -dy) * 180.0 / pi;
+    double r_mid = g->radius - g->width / 2.0;
+    double lo = (double)a / RING_ANGLE_UNITS, hi = (double)b / RING_ANGLE_UNITS;
+
+    if (deg < 0) deg += 360.0;
+    while (deg < lo) deg += 360.0;
+    if (r >= g->radius - g->width && r <= g->radius && deg <= hi) return true;
+    if (!g->rounded) return false;
+    // Caps: discs of half the width on the middle of the ring at both ends
+    for (int i = 0; i < 2; i++) {
+        double t = (i ? hi : lo) * pi / 180.0;
+        double cx = g->radius + r_mid * sin(t), cy = g->radius - r_mid * cos(t);
+        double ddx = x + 0.5 - cx, ddy = y + 0.5 - cy;
+        if (ddx * ddx + ddy * ddy <= (g->width / 2.0) * (g->width / 2.0)) return true;
+    }
+    return false;
+}
+
+static void check_cover(void)
+{
+    uint32_t x = 0x2545F491u;
+    uint32_t missed = 0;
+
+    for (uint32_t i = 0; i < BENCH_COVER_PAIRS; i++) {
+        RingGeometry_t g = { 20 + (int32_t)(xorshift(&x) % 200u), 2 + (int32_t)(xorshift(&x) % 16u), (i & 1u) != 0 };
+        int32_t a = (int32_t)(xorshift(&x) % RING_TURN);
+        int32_t b = a + 1 + (int32_t)(xorshift(&x) % ((i % 3u) ? 8u * RING_ANGLE_UNITS : (uint32_t)RING_TURN - 1u));
+        RingArea_t box = ring_sector_area(&g, a, b);
+
+        for (int32_t py = 0; py < 2 * g.radius; py++) {
+            for (int32_t px = 0; px < 2 * g.radius; px++) {
+                bool inside = px >= box.x1 && px <= box.x2 && py >= box.y1 && py <= box.y2;
+                if (!inside && on_ring(&g, px, py, a, b)) missed++;
+            }
+        }
+    }
+    check(missed == 0, "sector boxes cover the ring between their angles");
+    printf("%-26s %10u pairs, %u pixels outside\n", "cover", BENCH_COVER_PAIRS, (unsigned)missed);
+}
+
+static void run_size(int32_t diameter)
+{
+    RingGeometry_t g = { diameter / 2, BENCH_WIDTH, true };
+    uint64_t ring_px = 0, arc_px = 0;
+    uint32_t ring_max = 0, moves = 0, arc_moves = 0;
+    int32_t angle = ring_angle_of(BENCH_PHASE_S, BENCH_PHASE_S);
+    int32_t arc_deg = 0;
+
+    for (uint32_t left = BENCH_PHASE_S; left-- > 0;) {
+        int32_t next = ring_angle_of(left, BENCH_PHASE_S);
+        // lv_arc: lv_map() of the value to whole degrees, then the sector between them
+        int32_t next_deg = (int32_t)((uint64_t)(BENCH_PHASE_S - left) * 360u / BENCH_PHASE_S);
+        RingArea_t a;
+
+        if (next != angle && angle != 0 && next != RING_TURN) {
+            a = ring_sector_area(&g, angle, next);
+            ring_px += ring_area_size(&a);
+            if (ring_area_size(&a) > ring_max) ring_max = ring_area_size(&a);
+            moves++;
+        }
+        if (next_deg != arc_deg && arc_deg != 0 && next_deg != 360) {
+            a = ring_sector_area(&g, arc_deg * RING_ANGLE_UNITS, next_deg * RING_ANGLE_UNITS);
+            arc_px += ring_area_size(&a);
+            arc_moves++;
+        }
+        angle = next;
+        arc_deg = next_deg;
+    }
+
+    printf("%-8d %10u %10.0f %8u %10.0f %10u %8u\n", (int)diameter, (unsigned)(diameter * diameter),
+           (double)arc_px / BENCH_PHASE_S, (unsigned)arc_moves, (double)ring_px / BENCH_PHASE_S,
+           (unsigned)ring_max, (unsigned)moves);
+    // A wedge: the ring width and its caps, plus the arc moved in a second
+    check(ring_max <= (uint32_t)((3 * BENCH_WIDTH) * (3 * BENCH_WIDTH)) + (uint32_t)diameter * 4u,
+          "a tick invalidates a wedge");
+}
+
+/* A WORK phase of phase_ms running since start_ns, as a snapshot publishes it */
+static PomodoroSnapshot_t running_phase(uint32_t phase_ms, uint64_t start_ns)
+{
+    PomodoroSnapshot_t snap = { 0 };
+
+    snap.state = POMODORO_WORK;
+    snap.phase_duration_ms = phase_ms;
+    snap.remaining_ms = phase_ms;
+    snap.phase_end_ns = start_ns + (uint64_t)phase_ms * MONOTONIC_NS_PER_MS;
+    return snap;
+}
+
+static void check_progress(void)
+{
+    static const uint32_t phases_ms[] = { 1000u, 25u * 60000u, 12u * 3600000u, UINT32_MAX };
+    PomodoroSnapshot_t snap;
+    uint32_t x = 0x9E3779B9u;
+    uint32_t off = 0;
+
+    for (uint32_t i = 0; i < sizeof(phases_ms) / sizeof(phases_ms[0]); i++) {
+        uint32_t last = 0;
+
+        snap = running_phase(phases_ms[i], 1000u);
+        for (uint32_t k = 0; k <= 1000u; k++) {
+            uint64_t at_us = (uint64_t)phases_ms[i] * k;     // k / 1000 of the phase
+            uint32_t q16 = pomodoro_progress_q16(&snap, 1000u + at_us * 1000u);
+            double expect = (double)at_us / ((double)phases_ms[i] * 1000.0) * 65536.0;
+
+            if ((double)q16 > expect + 1.0 || (double)q16 < expect - 1.0 || q16 < last) off++;
+            last = q16;
+        }
+        check(last == POMODORO_PROGRESS_ONE, "a phase ends at POMODORO_PROGRESS_ONE");
+    }
+    check(off == 0, "Q16 progress within one step of the exact value");
+
+    snap = running_phase(60000u, 0);
+    check(pomodoro_progress_q16(&snap, 0) == 0, "no progress at the start");
+    check(pomodoro_progress_q16(&snap, 90u * MONOTONIC_NS_PER_SEC) == POMODORO_PROGRESS_ONE, "clamped past the end");
+    snap.phase_end_ns = 0;
+    snap.remaining_ms = 15000u;
+    check(pomodoro_progress_q16(&snap, xorshift(&x)) == 49152u, "paused: the remaining time, not the clock");
+    snap.phase_duration_ms = 0;
+    check(pomodoro_progress_q16(&snap, 0) == 0, "no phase");
+}
+
+/* The phase at 30 fps: the box of each frame that moves the end */
+static void run_frames(int32_t diameter)
+{
+    RingGeometry_t g = { diameter / 2, BENCH_WIDTH, true };
+    PomodoroSnapshot_t snap = running_phase(BENCH_PHASE_S * 1000u, 0);
+    uint64_t px = 0;
+    uint32_t frames = 0, moves = 0, max = 0;
+    int32_t angle = 0;
+
+    for (uint64_t t = 0; t < (uint64_t)BENCH_PHASE_S * MONOTONIC_NS_PER_SEC; t += BENCH_FRAME_NS) {
+        int32_t next = ring_angle_of_q16(pomodoro_progress_q16(&snap, t));
+        RingArea_t a;
+
+        frames++;
+        if (next == angle || angle == 0 || next == RING_TURN) {
+            angle = next;
+            continue;
+        }
+        a = ring_sector_area(&g, angle, next);
+        px += ring_area_size(&a);
+        if (ring_area_size(&a) > max) max = ring_area_size(&a);
+        moves++;
+        angle = next;
+    }
+    printf("%-8d %10.0f %10u %8u %10.0f %10u %8u\n", (int)diameter, (double)px / BENCH_PHASE_S,
+           (unsigned)frames, (unsigned)moves, moves ? (double)px / moves : 0.0, (unsigned)max, (unsigned)(px / frames));
+    check(max <= (uint32_t)((3 * BENCH_WIDTH) * (3 * BENCH_WIDTH)), "a frame invalidates a wedge");
+}
+
+/* What a frame costs before rendering: progress, angle and box, half of them move the end */
+static void bench_frames(void)
+{
+    RingGeometry_t g = { 100, BENCH_WIDTH, true };
+    PomodoroSnapshot_t snap = running_phase(BENCH_PHASE_S * 1000u, 0);
+    int32_t angle = RING_TURN / 2;
+    uint64_t start = bench_now_ns();
+    double ns;
+
+    for (uint32_t i = 0; i < BENCH_SECTORS; i++) {
+        uint64_t t = (uint64_t)(i % (BENCH_PHASE_S * 30u)) * BENCH_FRAME_NS;
+        int32_t next = ring_angle_of_q16(pomodoro_progress_q16(&snap, t));
+        RingArea_t area = ring_sector_area(&g, angle, next);
+        sink += (uint32_t)area.x1;
+        angle = next;
+    }
+    ns = (double)(bench_now_ns() - start) / BENCH_SECTORS;
+    printf("%-26s %10.2f ns (%.4f%% of the %u ms budget)\n", "frame: progress to box", ns,
+           ns * 100.0 / BENCH_BUDGET_NS, (unsigned)(BENCH_BUDGET_NS / MONOTONIC_NS_PER_MS));
+}
+
+static void bench_sectors(void)
+{
+    RingGeometry_t g = { 100, BENCH_WIDTH, true };
+    uint32_t x = 12345u;
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t i = 0; i < BENCH_SECTORS; i++) {
+        int32_t a = (int32_t)(xorshift(&x) % RING_TURN);
+        RingArea_t area = ring_sector_area(&g, a, a + 15);
+        sink += (uint32_t)area.x1;
+    }
+    printf("%-26s %10.2f ns\n", "ring_sector_area", (double)(bench_now_ns() - start) / BENCH_SECTORS);
+}
+
+int main(void)
+{
+    printf("ring_bench: 25 min countdown at 1 Hz, ring %d px wide\n", BENCH_WIDTH);
+    check_helpers();
+    check_cover();
+
+    printf("%-8s %10s %10s %8s %10s %10s %8s\n", "diameter", "box px", "lv_arc px", "moves", "ring px", "ring max", "moves");
+    run_size(130);
+    run_size(200);
+    run_size(480);
+    run_size(960);
+    run_size(1920);
+
+    check_progress();
+    printf("30 fps, Q16 progress of the running phase at every frame\n");
+    printf("%-8s %10s %10s %8s %10s %10s %8s\n", "diameter", "px per s", "frames", "moves", "px/move", "max", "px/frame");
+    run_frames(130);
+    run_frames(200);
+    run_frames(480);
+    run_frames(1920);
+
+    bench_sectors();
+    bench_frames();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file runtime_jitter_bench.c
+ * @brief Tick jitter with and without render load, single loop vs timing thread
+ *
+ * A fake renderer draws 30 frames per second and burns a fixed amount of CPU
+ * per frame (0 ms = idle UI, 30 ms = saturated, 120 ms = frames that overrun
+ * by several periods). Meanwhile the Core runs the pomodoro countdown plus
+ * TICKERS second-ticking timers staggered 20 ms apart (the timer pool holds
+ * 64), so there are TICKERS ticks per second to measure.
+ *
+ *  - single loop:   pomodoro_tick() and the frames share one loop, as in the
+ *                   plain main loop of main.c. A tick that falls due during a
+ *                   frame waits for the frame to end.
+ *  - timing thread: pomodoro_runtime owns the Core, the frames run on the
+ *                   main thread and adopt snapshots with pomodoro_runtime_dispatch().
+ *
+ * Jitter is the time a tick callback runs minus its exact second boundary,
+ * read on the real clock. Negative values are the drift correction waking
+ * a little ahead of the boundary.
+ *
+ * Usage: runtime_jitter_bench [seconds per scenario]
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_runtime.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define TICKERS             48u
+#define TICKER_STEP_MS      20u
+#define TICKER_BASE_MS      (3600u * 1000u)
+#define FRAME_NS            (MONOTONIC_NS_PER_SEC / 30u)
+#define MAX_SAMPLES         (TICKERS * 120u)
+
+static const uint32_t loads_ms[] = { 0, 5, 30, 120 };
+
+static uint64_t ticker_start_ns[TICKERS];
+static int64_t samples[MAX_SAMPLES];
+static uint32_t sample_count;
+static volatile uint32_t sink;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / MONOTONIC_NS_PER_SEC), (long)(ns % MONOTONIC_NS_PER_SEC) };
+    nanosleep(&ts, NULL);
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Runs on whichever thread drives the Core. Ticker i ends TICKER_BASE_MS + i * TICKER_STEP_MS
+ * after its start and reports the whole seconds left at each boundary. */
+static void ticker_record(uint32_t i, uint32_t remaining_ms)
+{
+    uint64_t expires = ticker_start_ns[i] + (uint64_t)(TICKER_BASE_MS + i * TICKER_STEP_MS) * MONOTONIC_NS_PER_MS;
+    uint64_t boundary = expires - (uint64_t)remaining_ms * MONOTONIC_NS_PER_MS;
+
+    if (sample_count < MAX_SAMPLES) {
+        samples[sample_count++] = (int64_t)monotonic_now_ns() - (int64_t)boundary;
+    }
+}
+
+/* Tick callbacks carry no user data, so every ticker gets its own */
+#define TICKER_CB(n)    static void on_ticker_##n(uint32_t remaining_ms) { ticker_record(n, remaining_ms); }
+TICKER_CB(0)  TICKER_CB(1)  TICKER_CB(2)  TICKER_CB(3)  TICKER_CB(4)  TICKER_CB(5)  TICKER_CB(6)  TICKER_CB(7)
+TICKER_CB(8)  TICKER_CB(9)  TICKER_CB(10) TICKER_CB(11) TICKER_CB(12) TICKER_CB(13) TICKER_CB(14) TICKER_CB(15)
+TICKER_CB(16) TICKER_CB(17) TICKER_CB(18) TICKER_CB(19) TICKER_CB(20) TICKER_CB(21) TICKER_CB(22) TICKER_CB(23)
+TICKER_CB(24) TICKER_CB(25) TICKER_CB(26) TICKER_CB(27) TICKER_CB(28) TICKER_CB(29) TICKER_CB(30) TICKER_CB(31)
+TICKER_CB(32) TICKER_CB(33) TICKER_CB(34) TICKER_CB(35) TICKER_CB(36) TICKER_CB(37) TICKER_CB(38) TICKER_CB(39)
+TICKER_CB(40) TICKER_CB(41) TICKER_CB(42) TICKER_CB(43) TICKER_CB(44) TICKER_CB(45) TICKER_CB(46) TICKER_CB(47)
+
+static const timer_tick_cb_t ticker_cbs[TICKERS] = {
+    on_ticker_0,  on_ticker_1,  on_ticker_2,  on_ticker_3,  on_ticker_4,  on_ticker_5,  on_ticker_6,  on_ticker_7,
+    on_ticker_8,  on_ticker_9,  on_ticker_10, on_ticker_11, on_ticker_12, on_ticker_13, on_ticker_14, on_ticker_15,
+    on_ticker_16, on_ticker_17, on_ticker_18, on_ticker_19, on_ticker_20, on_ticker_21, on_ticker_22, on_ticker_23,
+    on_ticker_24, on_ticker_25, on_ticker_26, on_ticker_27, on_ticker_28, on_ticker_29, on_ticker_30, on_ticker_31,
+    on_ticker_32, on_ticker_33, on_ticker_34, on_ticker_35, on_ticker_36, on_ticker_37, on_ticker_38, on_ticker_39,
+    on_ticker_40, on_ticker_41, on_ticker_42, on_ticker_43, on_ticker_44, on_ticker_45, on_ticker_46, on_ticker_47,
+};
+
+/* One frame of fake rendering: spin for load_ms */
+static void render_frame(uint32_t load_ms)
+{
+    uint64_t end = bench_now_ns() + (uint64_t)load_ms * MONOTONIC_NS_PER_MS;
+    uint32_t acc = 0;
+
+    while (bench_now_ns() < end) {
+        for (uint32_t i = 0; i < 1000u; i++) {
+            acc = acc * 1664525u + 1013904223u;
+        }
+    }
+    sink = acc;
+}
+
+/* Fresh Core: a running 60 min work phase and the staggered tickers */
+static void core_setup(void)
+{
+    timer_init();
+    timer_reset_tick_latency();
+    pomodoro_init(60, 5, 15, 4);
+    pomodoro_set_state_callback(NULL);
+    pomodoro_set_tick_callback(NULL);
+    pomodoro_start();
+
+    for (uint32_t i = 0; i < TICKERS; i++) {
+        ticker_start_ns[i] = monotonic_now_ns();
+        timer_handle_create(TICKER_BASE_MS + i * TICKER_STEP_MS, ticker_cbs[i], NULL, NULL);
+    }
+    sample_count = 0;
+}
+
+static uint32_t run_single_loop(uint32_t load_ms, uint64_t duration_ns)
+{
+    uint64_t now = bench_now_ns();
+    uint64_t end = now + duration_ns;
+    uint64_t next_frame = now;
+    uint32_t frames = 0;
+
+    core_setup();
+    while ((now = bench_now_ns()) < end) {
+        pomodoro_tick();
+
+        if (now >= next_frame) {
+            render_frame(load_ms);
+            frames++;
+            next_frame += FRAME_NS;
+            if (next_frame < bench_now_ns()) {
+                next_frame = bench_now_ns() + FRAME_NS;
+            }
+            continue;
+        }
+
+        // Sleep until the next frame or Core deadline, like main_loop_wait()
+        uint64_t wait = next_frame - now;
+        uint64_t deadline = timer_get_next_deadline_ns();
+        uint64_t core_now = monotonic_now_ns();
+        if (deadline != TIMER_NO_DEADLINE_NS) {
+            uint64_t core_wait = (deadline > core_now) ? (deadline - core_now) : 0;
+            if (core_wait < wait) {
+                wait = core_wait;
+            }
+        }
+        sleep_ns(wait);
+    }
+    return frames;
+}
+
+static uint32_t run_timing_thread(uint32_t load_ms, uint64_t duration_ns)
+{
+    uint64_t now = bench_now_ns();
+    uint64_t end = now + duration_ns;
+    uint64_t next_frame = now;
+    uint32_t frames = 0;
+
+    core_setup();
+    if (!pomodoro_runtime_start()) {
+        return 0;
+    }
+
+    while ((now = bench_now_ns()) < end) {
+        if (now < next_frame) {
+            sleep_ns(next_frame - now);
+            continue;
+        }
+        pomodoro_runtime_dispatch();
+        render_frame(load_ms);
+        frames++;
+        next_frame += FRAME_NS;
+        if (next_frame < bench_now_ns()) {
+            next_frame = bench_now_ns() + FRAME_NS;
+        }
+    }
+
+    pomodoro_runtime_stop();
+    return frames;
+}
+
+static void report(const char *mode, uint32_t load_ms, uint32_t frames)
+{
+    uint32_t late = 0;
+
+    if (sample_count == 0) {
+        printf("%-14s %7u  no ticks recorded\n", mode, load_ms);
+        return;
+    }
+    for (uint32_t i = 0; i < sample_count; i++) {
+        if (samples[i] > (int64_t)MONOTONIC_NS_PER_MS) {
+            late++;
+        }
+    }
+    qsort(samples, sample_count, sizeof(samples[0]), cmp_i64);
+    printf("%-14s %7u  %6u  %6u  %9.1f  %9.1f  %9.1f  %9.1f  %7.1f%%\n",
+           mode, load_ms, frames, sample_count,
+           (double)samples[0] / 1e3,
+           (double)samples[sample_count / 2] / 1e3,
+           (double)samples[(uint64_t)sample_count * 99u / 100u] / 1e3,
+           (double)samples[sample_count - 1] / 1e3,
+           100.0 * late / sample_count);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 3u;
+    uint64_t duration_ns;
+
+    if (seconds == 0 || seconds > 120) {
+        seconds = 3;
+    }
+    duration_ns = (uint64_t)seconds * MONOTONIC_NS_PER_SEC;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_POSIX);
+
+    printf("runtime_jitter_bench: %u tickers, 30 fps render, %u s per scenario\n", TICKERS, seconds);
+    printf("%-14s %7s  %6s  %6s  %9s  %9s  %9s  %9s  %8s\n",
+           "mode", "load ms", "frames", "ticks", "min us", "p50 us", "p99 us", "max us", ">1ms");
+
+    for (uint32_t i = 0; i < sizeof(loads_ms) / sizeof(loads_ms[0]); i++) {
+        uint32_t frames = run_single_loop(loads_ms[i], duration_ns);
+        report("single loop", loads_ms[i], frames);
+    }
+    for (uint32_t i = 0; i < sizeof(loads_ms) / sizeof(loads_ms[0]); i++) {
+        uint32_t frames = run_timing_thread(loads_ms[i], duration_ns);
+        report("timing thread", loads_ms[i], frames);
+    }
+
+    return 0;
+}
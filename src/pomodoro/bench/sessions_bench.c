@@ -0,0 +1,159 @@
+/**
+ * @file sessions_bench.c
+ * @brief Many sessions in one process: the struct-of-arrays store of pomodoro.c
+ *
+ * Sessions get mixed configurations (20..60 min work, 3..7 min short,
+ * 10..20 min long, 2..5 cycles) so their phase ends spread out over time.
+ *
+ *  - create:        pomodoro_session_create() + start, per session
+ *  - sweep:         pomodoro_sessions_advance(1000), one simulated second of
+ *                   every running session, at 1k / 10k / 100k sessions.
+ *                   Session-seconds per second is how many sessions one core
+ *                   could tick at 1 Hz.
+ *  - clocked:       one simulated day through pomodoro_sim (pomodoro_tick()
+ *                   on the virtual clock), the sweep timer waking once per second
+ *  - pause + resume: one pair on a created session
+ *
+ * Built with its own copy of the Core and POMODORO_MAX_SESSIONS=131072.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_sim.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_MAX_SESSIONS      100000u
+#define BENCH_SWEEP_SECONDS     3600u
+#define BENCH_CLOCKED_SECONDS   (24u * 3600u)
+#define BENCH_PAUSE_OPS         1000000u
+
+static pomodoro_session_t sessions[BENCH_MAX_SESSIONS];
+static uint32_t session_count;
+static uint64_t transitions;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_session_state(pomodoro_session_t session, PomodoroState_e state)
+{
+    (void)session;
+    (void)state;
+    transitions++;
+}
+
+static void sessions_destroy_all(void)
+{
+    for (uint32_t i = 0; i < session_count; i++) {
+        pomodoro_session_destroy(sessions[i]);
+    }
+    session_count = 0;
+}
+
+/* Returns ns per create + start */
+static double sessions_create(uint32_t count)
+{
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t i = 0; i < count; i++) {
+        sessions[i] = pomodoro_session_create(20 + i % 41, 3 + i % 5, 10 + i % 11, (uint8_t)(2 + i % 4));
+        pomodoro_session_start(sessions[i]);
+    }
+    session_count = count;
+    return (double)(bench_now_ns() - start) / count;
+}
+
+static void bench_sweep(uint32_t count)
+{
+    double create_ns = sessions_create(count);
+
+    transitions = 0;
+    uint64_t start = bench_now_ns();
+    for (uint32_t t = 0; t < BENCH_SWEEP_SECONDS; t++) {
+        pomodoro_sessions_advance(1000);
+    }
+    uint64_t ns = bench_now_ns() - start;
+    double session_seconds = (double)count * BENCH_SWEEP_SECONDS;
+
+    printf("%9u  %10.1f  %11.1f  %11.2f  %14.1f  %12llu\n",
+           count, create_ns,
+           (double)ns / BENCH_SWEEP_SECONDS / 1e3,
+           (double)ns / session_seconds,
+           session_seconds / ((double)ns / 1e9) / 1e6,
+           (unsigned long long)transitions);
+
+    sessions_destroy_all();
+}
+
+static void bench_clocked(uint32_t count)
+{
+    PomodoroSimStats_t stats;
+
+    pomodoro_sim_begin();
+    sessions_create(count);
+    transitions = 0;
+
+    uint64_t start = bench_now_ns();
+    pomodoro_sim_advance_ms((uint64_t)BENCH_CLOCKED_SECONDS * 1000u);
+    uint64_t ns = bench_now_ns() - start;
+    pomodoro_sim_get_stats(&stats);
+    pomodoro_sim_end();
+
+    printf("clocked: %u sessions, %u s simulated in %.2f s: %llu wakeups, %llu transitions, %.1f us per wakeup\n",
+           count, BENCH_CLOCKED_SECONDS, (double)ns / 1e9, (unsigned long long)stats.wakeups,
+           (unsigned long long)transitions, (double)ns / (double)stats.wakeups / 1e3);
+
+    sessions_destroy_all();
+}
+
+static void bench_pause_resume(void)
+{
+    pomodoro_session_t s = pomodoro_session_create(25, 5, 15, 4);
+    pomodoro_session_start(s);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_PAUSE_OPS; i++) {
+        pomodoro_session_pause(s);
+        pomodoro_session_resume(s);
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    printf("pause + resume (created session): %.1f ns\n", (double)ns / BENCH_PAUSE_OPS);
+    pomodoro_session_destroy(s);
+}
+
+int main(void)
+{
+    static const uint32_t counts[] = { 1000, 10000, BENCH_MAX_SESSIONS };
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+    pomodoro_sessions_set_state_callback(on_session_state);
+
+    printf("sessions_bench: %u slots, %u simulated seconds per sweep run\n",
+           POMODORO_MAX_SESSIONS, BENCH_SWEEP_SECONDS);
+    printf("%9s  %10s  %11s  %11s  %14s  %12s\n",
+           "sessions", "create ns", "us/sweep", "ns/session", "Msession-s/s", "transitions");
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench_sweep(counts[i]);
+    }
+
+    bench_clocked(BENCH_MAX_SESSIONS);
+    bench_pause_resume();
+
+    return 0;
+}
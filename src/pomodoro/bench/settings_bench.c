@@ -0,0 +1,304 @@
+/**
+ * @file settings_bench.c
+ * @brief Settings store: cold boot to settings applied, commit cost, wear, power cuts
+ *
+ *  - boot:          settings_store_open() + settings_store_load_pomodoro() +
+ *                   event_init(), the path from startup until the Core runs
+ *                   with the stored settings. On a new file, after one commit,
+ *                   with a full bank and after 10k commits; warm, and with the
+ *                   file's pages dropped from the page cache before each open.
+ *  - commit:        us per changed commit (one record programmed and synced),
+ *                   ns per commit without a change (nothing programmed).
+ *  - wear:          erases of each sector after 10k changed commits.
+ *  - power cut:     a torn newest record, a torn first record of a freshly
+ *                   erased bank and a torn erase; each reopen must load the
+ *                   values of the last complete commit.
+ *
+ * Usage: settings_bench [directory for the store file, default /tmp]
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 200809L /* needed for clock_gettime(), pwrite(), posix_fadvise() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "settings_store.h"
+#include "event.h"
+#include "pomodoro.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_BOOTS             2000u
+#define BENCH_COMMITS           10000u
+#define BENCH_UNCHANGED         1000000u
+#define MIN_MS                  (60u * 1000u)
+
+static char path[512];
+static uint32_t errors;
+static uint64_t boot_ns[BENCH_BOOTS];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Settings number i, all fields differ from number i - 1 */
+static PomodoroSettings_t settings_for(uint32_t i)
+{
+    PomodoroSettings_t s = {
+        .work_min = 1 + (int)(i % 25u),
+        .short_break_min = 1 + (int)(i % 5u),
+        .long_break_min = 1 + (int)(i % 10u),
+        .cycles_before_long = 1 + (int)(i % 4u),
+    };
+    return s;
+}
+
+static void commit_n(uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < first + count; i++) {
+        PomodoroSettings_t s = settings_for(i);
+        if (!settings_store_save_pomodoro(&s)) errors++;
+    }
+}
+
+static void drop_cache(void)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) return;
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+}
+
+/* Open, load and apply; returns false if the Core did not get the expected settings */
+static bool boot(const PomodoroSettings_t *expect)
+{
+    settings_store_open(path);
+    event_init();
+
+    return (uint32_t)pomodoro_get_work_time() == (uint32_t)expect->work_min * MIN_MS &&
+           (uint32_t)pomodoro_get_short_break() == (uint32_t)expect->short_break_min * MIN_MS &&
+           (uint32_t)pomodoro_get_long_break() == (uint32_t)expect->long_break_min * MIN_MS &&
+           pomodoro_get_cycle_count() == expect->cycles_before_long;
+}
+
+static void bench_boot(const char *what, const PomodoroSettings_t *expect, bool cold)
+{
+    bool ok = true;
+
+    settings_store_close();
+    for (uint32_t i = 0; i < BENCH_BOOTS; i++) {
+        if (cold) drop_cache();
+        uint64_t start = bench_now_ns();
+        ok &= boot(expect);
+        boot_ns[i] = bench_now_ns() - start;
+        settings_store_close();
+    }
+    qsort(boot_ns, BENCH_BOOTS, sizeof(boot_ns[0]), cmp_u64);
+
+    printf("boot %-18s %-5s  %8.2f  %8.2f  %8.2f%s\n", what, cold ? "cold" : "warm",
+           boot_ns[0] / 1e3, boot_ns[BENCH_BOOTS / 2u] / 1e3, boot_ns[BENCH_BOOTS * 99u / 100u] / 1e3,
+           ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+}
+
+static void bench_boots(void)
+{
+    PomodoroSettings_t defaults = {
+        POMODORO_DEF_WORK_MIN, POMODORO_DEF_SHORT_BREAK_MIN,
+        POMODORO_DEF_LONG_BREAK_MIN, POMODORO_DEF_CYCLES_BEFORE_LONG
+    };
+    PomodoroSettings_t s;
+
+    printf("%-23s %-5s  %8s  %8s  %8s\n", "boot to settings", "cache", "min us", "med us", "p99 us");
+
+    // A new file every boot: create, erase, load the defaults
+    bool ok = true;
+    for (uint32_t i = 0; i < BENCH_BOOTS; i++) {
+        unlink(path);
+        uint64_t start = bench_now_ns();
+        ok &= boot(&defaults);
+        boot_ns[i] = bench_now_ns() - start;
+        settings_store_close();
+    }
+    qsort(boot_ns, BENCH_BOOTS, sizeof(boot_ns[0]), cmp_u64);
+    printf("boot %-18s %-5s  %8.2f  %8.2f  %8.2f%s\n", "new file", "-",
+           boot_ns[0] / 1e3, boot_ns[BENCH_BOOTS / 2u] / 1e3, boot_ns[BENCH_BOOTS * 99u / 100u] / 1e3,
+           ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+
+    unlink(path);
+    settings_store_open(path);
+    commit_n(1, 1);
+    s = settings_for(1);
+    bench_boot("1 commit", &s, false);
+    bench_boot("1 commit", &s, true);
+
+    settings_store_open(path);
+    commit_n(2, SETTINGS_STORE_SLOTS - 2u);
+    s = settings_for(SETTINGS_STORE_SLOTS - 1u);
+    bench_boot("full bank", &s, false);
+    bench_boot("full bank", &s, true);
+
+    settings_store_open(path);
+    commit_n(SETTINGS_STORE_SLOTS, BENCH_COMMITS);
+    s = settings_for(SETTINGS_STORE_SLOTS + BENCH_COMMITS - 1u);
+    bench_boot("10k commits", &s, false);
+    bench_boot("10k commits", &s, true);
+}
+
+static void bench_commits(void)
+{
+    SettingsStoreStats_t st;
+    uint64_t start;
+    double changed_us, unchanged_ns;
+
+    unlink(path);
+    settings_store_open(path);
+
+    start = bench_now_ns();
+    commit_n(1, BENCH_COMMITS);
+    changed_us = (double)(bench_now_ns() - start) / BENCH_COMMITS / 1e3;
+
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_UNCHANGED; i++) {
+        PomodoroSettings_t s = settings_for(BENCH_COMMITS);
+        settings_store_save_pomodoro(&s);
+    }
+    unchanged_ns = (double)(bench_now_ns() - start) / BENCH_UNCHANGED;
+
+    settings_store_get_stats(&st);
+    printf("commit: %.2f us changed, %.1f ns unchanged (%u of %u skipped)\n",
+           changed_us, unchanged_ns, (unsigned)st.commits_skipped, BENCH_UNCHANGED);
+    printf("wear: %u records, sector erases %u / %u, one per %.1f commits\n",
+           (unsigned)st.records_written, (unsigned)st.erase_count[0], (unsigned)st.erase_count[1],
+           (double)st.records_written / (st.erase_count[0] + st.erase_count[1]));
+
+    // Every bank is formatted once before its first record, after that an erase per full bank
+    uint32_t expected = BENCH_COMMITS / SETTINGS_STORE_SLOTS;
+    if (st.commits_skipped != BENCH_UNCHANGED ||
+        st.erase_count[0] + st.erase_count[1] + 1u < expected ||
+        st.erase_count[0] + st.erase_count[1] > expected ||
+        st.erase_count[0] > st.erase_count[1] + 1u || st.erase_count[1] > st.erase_count[0] + 1u) {
+        printf("  unexpected wear\n");
+        errors++;
+    }
+    settings_store_close();
+}
+
+/* Overwrite len bytes at a byte of a record (0 is the sector header) */
+static void corrupt(uint32_t bank, uint32_t record, uint32_t byte, uint32_t len, uint8_t value)
+{
+    uint8_t buf[SETTINGS_STORE_SECTOR_SIZE];
+    int fd = open(path, O_RDWR);
+    off_t offset = (off_t)bank * SETTINGS_STORE_SECTOR_SIZE + (off_t)record * SETTINGS_STORE_RECORD_SIZE + byte;
+
+    if (fd < 0) return;
+    memset(buf, value, len);
+    if (pwrite(fd, buf, len, offset) != (ssize_t)len) errors++;
+    close(fd);
+}
+
+static void expect_boot(const char *what, uint32_t settings_no)
+{
+    PomodoroSettings_t s = settings_for(settings_no);
+    bool ok = boot(&s);
+
+    printf("power cut %-24s %s\n", what, ok ? "previous settings loaded" : "MISMATCH");
+    if (!ok) errors++;
+    settings_store_close();
+}
+
+static void bench_power_cuts(void)
+{
+    SettingsStoreStats_t st;
+
+    // Slot s of the sector is at record offset s + 1, after the header
+    unlink(path);
+    settings_store_open(path);
+    commit_n(1, 10);
+    settings_store_get_stats(&st);
+    settings_store_close();
+    corrupt(st.active_bank, st.next_slot, 20, 1, 0x00);
+    expect_boot("torn newest record", 9);
+
+    // The store continues past the torn slot
+    settings_store_open(path);
+    commit_n(100, 1);
+    settings_store_close();
+    expect_boot("record after torn one", 100);
+
+    // Fill the bank: the next commit erases the other bank and writes its first slot
+    unlink(path);
+    settings_store_open(path);
+    commit_n(1, SETTINGS_STORE_SLOTS + 1u);
+    settings_store_get_stats(&st);
+    settings_store_close();
+    corrupt(st.active_bank, 1, 8, 1, 0x00);
+    expect_boot("torn bank switch", SETTINGS_STORE_SLOTS);
+
+    // Cut during the erase of the older bank: its header and first records are blank,
+    // the rest still old records
+    unlink(path);
+    settings_store_open(path);
+    commit_n(1, 2u * SETTINGS_STORE_SLOTS);
+    settings_store_get_stats(&st);
+    settings_store_close();
+    corrupt((uint32_t)st.active_bank ^ 1u, 0, 0, 8u * SETTINGS_STORE_RECORD_SIZE, 0xFF);
+    expect_boot("torn erase", 2u * SETTINGS_STORE_SLOTS);
+
+    // The next commit formats that bank again, keeping its wear count
+    settings_store_open(path);
+    commit_n(1000, 1);
+    settings_store_get_stats(&st);
+    settings_store_close();
+    if (st.erase_count[st.active_bank] != 1u) {
+        printf("  erase count %u after the torn erase\n", (unsigned)st.erase_count[st.active_bank]);
+        errors++;
+    }
+    expect_boot("commit after torn erase", 1000);
+
+    unlink(path);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = (argc > 1) ? argv[1] : "/tmp";
+
+    snprintf(path, sizeof(path), "%s/settings_bench.settings", dir);
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+
+    printf("settings_bench: %u byte records, %u slots per %u byte sector, file %s\n",
+           SETTINGS_STORE_RECORD_SIZE, (unsigned)SETTINGS_STORE_SLOTS, SETTINGS_STORE_SECTOR_SIZE, path);
+    bench_boots();
+    bench_commits();
+    bench_power_cuts();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
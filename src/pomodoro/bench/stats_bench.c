@@ -0,0 +1,293 @@
+/**
+ * @file stats_bench.c
+ * @brief Day index: range and streak queries against a naive scan at 1M records
+ *
+ * The synthetic dataset has 1M WORK phases, 10 to 16 a day (25 min, some
+ * days 50), with one day in 6 off and now and then a week off, so there
+ * are streaks of all lengths.
+ *
+ *  - build:         ns per pomodoro_stats_add(), and pomodoro_stats_rebuild()
+ *                   from a history holding the same records
+ *  - range:         ns per query of a week, a month, a year and a random span,
+ *                   against summing a plain array of records in the range
+ *  - streak:        ns per pomodoro_stats_streak_at() on random days and for
+ *                   the longest streak, against walking per-day counts
+ *  - window:        a session far ahead moves the window; ranges and streaks
+ *                   of the days kept must not change
+ *
+ * Every answer is checked against the naive one.
+ *
+ * Built with its own copy of the index (POMODORO_STATS_DAYS=131072) and of
+ * the history (POMODORO_HISTORY_ARENA_BYTES=8 MB).
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_history.h"
+#include "pomodoro_stats.h"
+#include "core_log.h"
+
+#define BENCH_RECORDS       1000000u
+#define BENCH_MAX_DAYS      (BENCH_RECORDS / 4u)
+#define BENCH_QUERIES       1000000u
+#define BENCH_NAIVE_QUERIES 200u
+#define DAY_S               86400
+#define FIRST_DAY           7305    /* 1990-01-01 */
+
+static PomodoroHistoryRecord_t records[BENCH_RECORDS];
+static uint32_t day_sessions[BENCH_MAX_DAYS];   // Per day from FIRST_DAY, for the naive streaks
+static uint32_t day_count;
+static int32_t queries[BENCH_QUERIES][2];
+static uint32_t rng = 1990u;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_rand(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static void generate(void)
+{
+    uint32_t n = 0;
+
+    for (uint32_t d = 0; n < BENCH_RECORDS; d++) {
+        if (next_rand() % 6u == 0) {
+            continue;
+        }
+        if (next_rand() % 200u == 0) {
+            d += 7u;
+            continue;
+        }
+        int64_t t = (int64_t)(FIRST_DAY + (int32_t)d) * DAY_S + 9 * 3600 + (int64_t)(next_rand() % 3600u);
+        uint32_t work_s = (next_rand() % 10u == 0) ? 50u * 60u : 25u * 60u;
+        uint32_t phases = 10u + next_rand() % 7u;
+
+        for (uint32_t p = 0; p < phases && n < BENCH_RECORDS; p++) {
+            records[n].start_s = t;
+            records[n].duration_s = work_s;
+            records[n].type = POMODORO_WORK;
+            t += work_s + 5 * 60 + (int64_t)(next_rand() % 120u);
+            n++;
+        }
+    }
+
+    // Late days run past midnight, so count by the day each record starts on
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        uint32_t d = (uint32_t)(records[i].start_s / DAY_S - FIRST_DAY);
+        day_sessions[d]++;
+        day_count = d + 1u;
+    }
+}
+
+/* Naive range: every record, summed if it started in the range */
+static PomodoroStatsRange_t naive_range(int32_t first_day, int32_t last_day)
+{
+    PomodoroStatsRange_t sum = { 0, 0 };
+    int64_t from = (int64_t)first_day * DAY_S;
+    int64_t to = ((int64_t)last_day + 1) * DAY_S;
+
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        if (records[i].start_s >= from && records[i].start_s < to) {
+            sum.sessions++;
+            sum.focus_s += records[i].duration_s;
+        }
+    }
+    return sum;
+}
+
+/* Naive streak: walk back over the per-day counts */
+static uint32_t naive_streak_at(int32_t day, int32_t first_kept)
+{
+    uint32_t streak = 0;
+
+    for (int32_t d = day - FIRST_DAY; d >= first_kept - FIRST_DAY && d >= 0 && (uint32_t)d < day_count &&
+                                      day_sessions[d]; d--) {
+        streak++;
+    }
+    return streak;
+}
+
+static uint32_t naive_longest(int32_t first_kept)
+{
+    uint32_t longest = 0, run = 0;
+
+    for (int32_t d = first_kept - FIRST_DAY; d < (int32_t)day_count; d++) {
+        run = day_sessions[d] ? run + 1u : 0u;
+        if (run > longest) longest = run;
+    }
+    return longest;
+}
+
+static void make_queries(int32_t span_days, int32_t first_kept)
+{
+    int32_t last = FIRST_DAY + (int32_t)day_count - 1;
+
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        int32_t span = span_days ? span_days : 1 + (int32_t)(next_rand() % (uint32_t)(last - first_kept + 1));
+        int32_t first = first_kept + (int32_t)(next_rand() % (uint32_t)(last - first_kept - span + 2));
+        queries[q][0] = first;
+        queries[q][1] = first + span - 1;
+    }
+}
+
+static void bench_range(const char *what, int32_t span_days, int32_t first_kept)
+{
+    uint64_t start, index_ns, naive_ns;
+    uint32_t sink = 0;
+    bool ok = true;
+
+    make_queries(span_days, first_kept);
+
+    start = bench_now_ns();
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        PomodoroStatsRange_t r = pomodoro_stats_range(queries[q][0], queries[q][1]);
+        sink += r.sessions + r.focus_s;
+    }
+    index_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (uint32_t q = 0; q < BENCH_NAIVE_QUERIES; q++) {
+        PomodoroStatsRange_t r = naive_range(queries[q][0], queries[q][1]);
+        sink += r.sessions + r.focus_s;
+    }
+    naive_ns = bench_now_ns() - start;
+
+    for (uint32_t q = 0; q < BENCH_NAIVE_QUERIES; q++) {
+        PomodoroStatsRange_t a = pomodoro_stats_range(queries[q][0], queries[q][1]);
+        PomodoroStatsRange_t b = naive_range(queries[q][0], queries[q][1]);
+        ok &= a.sessions == b.sessions && a.focus_s == b.focus_s;
+    }
+
+    printf("range %-12s %10.1f ns  %12.1f ns  %8.1fx%s\n", what,
+           (double)index_ns / BENCH_QUERIES, (double)naive_ns / BENCH_NAIVE_QUERIES,
+           ((double)naive_ns / BENCH_NAIVE_QUERIES) / ((double)index_ns / BENCH_QUERIES),
+           ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+    if (sink == 1u) printf(" ");
+}
+
+static void bench_streaks(int32_t first_kept)
+{
+    uint64_t start, index_ns, naive_ns;
+    uint32_t sink = 0;
+    bool ok = true;
+
+    make_queries(1, first_kept);
+
+    start = bench_now_ns();
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        sink += pomodoro_stats_streak_at(queries[q][0]);
+    }
+    index_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        sink += naive_streak_at(queries[q][0], first_kept);
+    }
+    naive_ns = bench_now_ns() - start;
+
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        ok &= pomodoro_stats_streak_at(queries[q][0]) == naive_streak_at(queries[q][0], first_kept);
+    }
+    printf("streak at day       %10.1f ns  %12.1f ns  %8.1fx%s\n",
+           (double)index_ns / BENCH_QUERIES, (double)naive_ns / BENCH_QUERIES,
+           (double)naive_ns / (double)index_ns, ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+
+    start = bench_now_ns();
+    for (uint32_t q = 0; q < BENCH_QUERIES; q++) {
+        sink += pomodoro_stats_longest_streak();
+    }
+    index_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    uint32_t naive = 0;
+    for (uint32_t q = 0; q < BENCH_NAIVE_QUERIES; q++) {
+        naive = naive_longest(first_kept);
+        sink += naive;
+    }
+    naive_ns = bench_now_ns() - start;
+
+    ok = pomodoro_stats_longest_streak() == naive;
+    printf("streak longest      %10.1f ns  %12.1f ns  %8.1fx   %u days%s\n",
+           (double)index_ns / BENCH_QUERIES, (double)naive_ns / BENCH_NAIVE_QUERIES,
+           ((double)naive_ns / BENCH_NAIVE_QUERIES) / ((double)index_ns / BENCH_QUERIES),
+           naive, ok ? "" : "  MISMATCH");
+    if (!ok) errors++;
+    if (sink == 1u) printf(" ");
+}
+
+static void bench_all(int32_t first_kept)
+{
+    printf("%-19s %13s  %15s  %9s\n", "query", "index", "naive scan", "speedup");
+    bench_range("week", 7, first_kept);
+    bench_range("month", 31, first_kept);
+    bench_range("year", 365, first_kept);
+    bench_range("random", 0, first_kept);
+    bench_streaks(first_kept);
+}
+
+int main(void)
+{
+    uint64_t start;
+    double add_ns;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    generate();
+    printf("stats_bench: %u sessions over %u days, window %u days\n",
+           BENCH_RECORDS, day_count, POMODORO_STATS_DAYS);
+
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        pomodoro_stats_add(&records[i]);
+    }
+    add_ns = (double)(bench_now_ns() - start) / BENCH_RECORDS;
+
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        pomodoro_history_append(&records[i]);
+    }
+    start = bench_now_ns();
+    pomodoro_stats_rebuild();
+    printf("build: %.1f ns per add, rebuild from the history %.2f ms\n\n",
+           add_ns, (double)(bench_now_ns() - start) / 1e6);
+
+    bench_all(FIRST_DAY);
+
+    // A session past the window: it moves forward and keeps its last 3/4
+    int32_t far_day = FIRST_DAY + (int32_t)POMODORO_STATS_DAYS + 1000;
+    PomodoroHistoryRecord_t far = { .start_s = (int64_t)far_day * DAY_S, .duration_s = 1500, .type = POMODORO_WORK };
+    int32_t first_kept = far_day - (int32_t)(POMODORO_STATS_DAYS - POMODORO_STATS_DAYS / 4u) + 1;
+
+    pomodoro_stats_add(&far);
+    PomodoroStatsRange_t dropped = pomodoro_stats_range(FIRST_DAY, first_kept - 1);
+    PomodoroStatsRange_t ahead = pomodoro_stats_range(far_day, far_day);
+    printf("\nwindow moved to day %d: %u sessions before it, %u on the far day\n",
+           first_kept, dropped.sessions, ahead.sessions);
+    if (dropped.sessions != 0 || ahead.sessions != 1u || pomodoro_stats_streak_at(far_day) != 1u) {
+        errors++;
+    }
+    bench_all(first_kept);
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
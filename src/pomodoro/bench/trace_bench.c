@@ -0,0 +1,221 @@
+/**
+ * @file trace_bench.c
+ * @brief Cost of the event tracer (Core/trace.c), and its export under load
+ *
+ * Built twice from this file: trace_bench with POMODORO_TRACE=1 and
+ * trace_bench_off without it, both with their own copy of the timer.
+ *
+ *  - instant, begin + end:   ns per record on one thread, ring wrapping
+ *  - paused:                 ns per record while trace_set_enabled(false)
+ *  - timer_tick_handler:     a second boundary on the virtual clock, which
+ *                            records one span when traced (pomo_bench's case)
+ *  - 3 writers:              wall time per record with three threads recording
+ *                            at once, each into its own ring
+ *  - dump under load:        trace_write_json() while the writers run; every
+ *                            dump is parsed back and each thread's records
+ *                            must be consecutive, so a record torn by a
+ *                            concurrent write would show
+ *
+ * trace_bench_off runs the same loops, which the compiler empties.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "trace.h"
+#include "timer.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define BENCH_RECORDS       (1u << 24)
+#define BENCH_TICKS         (1u << 22)
+#define BENCH_WRITERS       3u
+#define BENCH_DUMPS         20u
+#define BENCH_MAX_TID       (TRACE_MAX_THREADS + 1u)
+
+static atomic_bool writers_run;
+static atomic_uint writers_ready;
+static uint32_t writer_count[BENCH_WRITERS];
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t ns, uint32_t count)
+{
+    printf("%-26s %10.2f\n", name, (double)ns / count);
+}
+
+static void on_tick_empty(uint32_t remaining_ms)
+{
+    (void)remaining_ms;
+}
+
+static void bench_single(void)
+{
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        TRACE_INSTANT(TRACE_STATE, i);
+    }
+    report("instant", bench_now_ns() - start, BENCH_RECORDS);
+
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS / 2u; i++) {
+        TRACE_BEGIN(TRACE_UI_TICK_CB);
+        TRACE_END(TRACE_UI_TICK_CB, i);
+    }
+    report("begin + end, per record", bench_now_ns() - start, BENCH_RECORDS);
+
+    trace_set_enabled(false);
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+        TRACE_INSTANT(TRACE_STATE, i);
+    }
+    report("paused", bench_now_ns() - start, BENCH_RECORDS);
+    trace_set_enabled(true);
+}
+
+static void bench_timer_tick(void)
+{
+    // Long enough that no phase ends during the batch
+    monotonic_select(MONOTONIC_SRC_VIRTUAL);
+    timer_init();
+    timer_start(UINT32_MAX, on_tick_empty, NULL);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_TICKS; i++) {
+        monotonic_virtual_advance_ns(MONOTONIC_NS_PER_SEC);
+        timer_tick_handler();
+    }
+    report("timer_tick_handler, tick", bench_now_ns() - start, BENCH_TICKS);
+    timer_stop();
+}
+
+/* Instants with arg 0, 1, 2... until stopped, so a dump can check the sequence */
+static void *writer(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    char name[16];
+    uint32_t n = 0;
+
+    snprintf(name, sizeof(name), "writer %u", id);
+    TRACE_THREAD_NAME(name);
+    atomic_fetch_add(&writers_ready, 1u);
+    while (atomic_load_explicit(&writers_run, memory_order_relaxed)) {
+        for (uint32_t i = 0; i < 1024u; i++) {
+            TRACE_INSTANT(TRACE_TIMER_TICK, n + i);
+        }
+        n += 1024u;
+    }
+    writer_count[id] = n;
+    return NULL;
+}
+
+/* Parse a dump back: per thread, the args of the writers' instants must follow each other */
+static uint32_t check_dump(FILE *f)
+{
+    char line[256];
+    uint32_t last[BENCH_MAX_TID] = { 0 };
+    bool seen[BENCH_MAX_TID] = { false };
+    uint32_t events = 0;
+
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        unsigned tid, arg;
+        const char *p;
+
+        if (strstr(line, "\"name\":\"timer_tick\"") == NULL || strstr(line, "\"ph\":\"i\"") == NULL) continue;
+        p = strstr(line, "\"tid\":");
+        if (p == NULL || sscanf(p, "\"tid\":%u", &tid) != 1 || tid >= BENCH_MAX_TID) {
+            errors++;
+            continue;
+        }
+        p = strstr(line, "\"delivered\":");
+        if (p == NULL || sscanf(p, "\"delivered\":%u", &arg) != 1) {
+            errors++;
+            continue;
+        }
+        if (seen[tid] && arg != last[tid] + 1u) {
+            if (errors++ < 5u) printf("thread %u: record %u after %u\n", tid, arg, last[tid]);
+        }
+        seen[tid] = true;
+        last[tid] = arg;
+        events++;
+    }
+    return events;
+}
+
+static void bench_writers(void)
+{
+    pthread_t threads[BENCH_WRITERS];
+    uint64_t records = 0;
+    uint64_t dump_ns = 0;
+    uint32_t parsed = 0;
+    uint64_t start = bench_now_ns();
+
+    atomic_store(&writers_run, true);
+    for (uint32_t i = 0; i < BENCH_WRITERS; i++) {
+        pthread_create(&threads[i], NULL, writer, (void *)(uintptr_t)i);
+    }
+    while (atomic_load(&writers_ready) < BENCH_WRITERS) {
+    }
+
+    for (uint32_t d = 0; d < BENCH_DUMPS; d++) {
+        FILE *f = tmpfile();
+        uint64_t dump_start = bench_now_ns();
+
+        if (f == NULL) break;
+        if (!trace_write_json(f) && POMODORO_TRACE) {
+            printf("dump %u failed\n", d);
+            errors++;
+        }
+        fflush(f);
+        dump_ns += bench_now_ns() - dump_start;
+        parsed += check_dump(f);
+        fclose(f);
+    }
+
+    atomic_store(&writers_run, false);
+    for (uint32_t i = 0; i < BENCH_WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+        records += writer_count[i];
+    }
+    report("3 writers, per record", bench_now_ns() - start, (uint32_t)records);
+    printf("%-26s %10.2f ms, %u writer records each\n", "dump under load", dump_ns / 1e6 / BENCH_DUMPS,
+           parsed / BENCH_DUMPS);
+    if (POMODORO_TRACE && parsed < BENCH_DUMPS * BENCH_WRITERS) {
+        printf("dumps hold %u writer records, expected full rings\n", parsed);
+        errors++;
+    }
+}
+
+int main(void)
+{
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    printf("trace_bench: tracer %s, %u records per ring, %u rings\n",
+           POMODORO_TRACE ? "compiled in" : "compiled out", TRACE_RING_RECORDS, TRACE_MAX_THREADS);
+    printf("%-26s %10s\n", "", "ns");
+
+    TRACE_THREAD_NAME("main");
+    bench_single();
+    bench_timer_tick();
+    bench_writers();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
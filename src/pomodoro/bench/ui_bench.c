@@ -0,0 +1,267 @@
+/**
+ * @file ui_bench.c
+ * @brief Render cost of every screen and state of the UI, on an offscreen display
+ *
+ * Builds the main screen on a memory display (direct mode, no SDL window)
+ * and drives the Core on virtual time through:
+ *
+ *  - IDLE
+ *  - WORK at 10, 60 and 90% (the three colour bands of the timer and arc)
+ *  - SHORT_BREAK, PAUSED_BREAK, LONG_BREAK, PAUSED_WORK
+ *  - WORK_LOW_POWER: WORK at 10% in low-power mode, the ring steps once a second
+ *  - FULLSCREEN:    WORK with the fullscreen timer shown
+ *  - SETTINGS:      the settings screen opened from IDLE
+ *
+ * For each case the frame that shows it is rendered at once (enter), then
+ * BENCH_STEADY_MS of virtual time run in 33 ms loop passes as in the app:
+ * Core ticks, lv_timer_handler(), renders when something changed. Only
+ * lv_timer_handler() is timed. Reported per case, as CSV on stdout:
+ *
+ *  - enter_ms, enter_px:   render time and pixels of the first frame
+ *  - frames:               frames rendered over the steady period
+ *  - ms_per_frame:         wall time of lv_timer_handler() per frame
+ *  - px_per_s:             pixels flushed per second of UI time
+ *  - objects:              objects on the screen and the layers
+ *  - heap_used, heap_hwm:  LVGL heap in use after the case, and its high-water
+ *                          mark since start (LVGL cannot reset it)
+ *
+ * Running phases animate the progress ring every frame: their ms_per_frame
+ * is held to a budget of BENCH_BUDGET_MS, a warning on stderr if over it.
+ *
+ * Built twice: ui_bench for the 480x480 layout, ui_bench_240x320 with
+ * SCREEN_SIZE_240x320. Each builds its own copy of the UI and the assets.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "pomodoro.h"
+#include "pomodoro_sim.h"
+#include "monotonic.h"
+#include "timer.h"
+#include "event.h"
+#include "core_log.h"
+#include "main_screen.h"
+#include "settings_screen.h"
+
+#ifdef SCREEN_SIZE_240x320
+  #define BENCH_LAYOUT      "240x320"
+  #define BENCH_HOR_RES     240
+  #define BENCH_VER_RES     320
+#else
+  #define BENCH_LAYOUT      "480x480"
+  #define BENCH_HOR_RES     480
+  #define BENCH_VER_RES     480
+#endif
+
+#define BENCH_STEADY_MS     10000u
+#define BENCH_PASS_MS       LV_DEF_REFR_PERIOD
+#define BENCH_BUDGET_MS     2.0
+
+static lv_display_t *disp;
+static uint8_t *frame_buf;
+static uint64_t flushed_px;
+static uint32_t rendered_frames;
+static uint32_t errors;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* LVGL runs on the Core's virtual clock: animations and the marquee move with it */
+static uint32_t bench_tick_cb(void)
+{
+    return (uint32_t)monotonic_now_ms();
+}
+
+static void bench_flush_cb(lv_display_t *d, const lv_area_t *area, uint8_t *px_map)
+{
+    (void)px_map;
+    flushed_px += (uint64_t)lv_area_get_size(area);
+    lv_display_flush_ready(d);
+}
+
+static void bench_render_event_cb(lv_event_t *e)
+{
+    (void)e;
+    rendered_frames++;
+}
+
+/* LVGL and Core messages go to stderr, stdout is the CSV */
+static void bench_lv_log_cb(lv_log_level_t level, const char *buf)
+{
+    (void)level;
+    fputs(buf, stderr);
+}
+
+static uint32_t count_objects(lv_obj_t *obj)
+{
+    uint32_t n = 1;
+    uint32_t children = lv_obj_get_child_count(obj);
+
+    for (uint32_t i = 0; i < children; i++) {
+        n += count_objects(lv_obj_get_child(obj, (int32_t)i));
+    }
+    return n;
+}
+
+/* Apply posted events, as the main loop does before rendering */
+static void post(EventType_e ev)
+{
+    event_post(ev);
+    event_process();
+}
+
+/* One-second steps of the Core until the state is reached, without rendering */
+static void advance_until_state(PomodoroState_e state)
+{
+    for (uint32_t s = 0; s < 24u * 3600u && pomodoro_get_state() != state; s++) {
+        pomodoro_sim_advance_ms(1000);
+    }
+}
+
+static void advance_until_percent(uint8_t pct)
+{
+    for (uint32_t s = 0; s < 24u * 3600u && pomodoro_get_state() == POMODORO_WORK &&
+                         pomodoro_get_work_progress_in_percent() < pct; s++) {
+        pomodoro_sim_advance_ms(1000);
+    }
+}
+
+static void run_case(const char *name, PomodoroState_e expect)
+{
+    lv_mem_monitor_t mon;
+    uint64_t enter_ns, steady_ns = 0;
+    uint64_t enter_px;
+    uint32_t objects;
+    double ms_per_frame;
+
+    if (pomodoro_get_state() != expect) {
+        fprintf(stderr, "%s: state %d, expected %d\n", name, (int)pomodoro_get_state(), (int)expect);
+        errors++;
+    }
+
+    // Everything the case changed, drawn at once
+    flushed_px = 0;
+    enter_ns = bench_now_ns();
+    lv_refr_now(disp);
+    enter_ns = bench_now_ns() - enter_ns;
+    enter_px = flushed_px;
+
+    flushed_px = 0;
+    rendered_frames = 0;
+    for (uint32_t t = 0; t < BENCH_STEADY_MS; t += BENCH_PASS_MS) {
+        uint64_t start;
+
+        pomodoro_sim_advance_ms(BENCH_PASS_MS);
+        event_process();
+        start = bench_now_ns();
+        lv_timer_handler();
+        steady_ns += bench_now_ns() - start;
+    }
+
+    objects = count_objects(lv_screen_active()) + count_objects(lv_layer_top()) + count_objects(lv_layer_sys());
+    lv_mem_monitor(&mon);
+    ms_per_frame = rendered_frames ? steady_ns / 1e6 / rendered_frames : 0.0;
+    if ((expect == POMODORO_WORK || expect == POMODORO_SHORT_BREAK || expect == POMODORO_LONG_BREAK) &&
+        ms_per_frame > BENCH_BUDGET_MS) {
+        fprintf(stderr, "%s: %.3f ms per frame, over the %.1f ms budget\n", name, ms_per_frame, BENCH_BUDGET_MS);
+    }
+    printf("%s,%s,%.3f,%llu,%u,%.3f,%.0f,%u,%u,%u\n", BENCH_LAYOUT, name, enter_ns / 1e6,
+           (unsigned long long)enter_px, (unsigned)rendered_frames, ms_per_frame,
+           (double)flushed_px * 1000.0 / BENCH_STEADY_MS, (unsigned)objects,
+           (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.max_used);
+}
+
+int main(void)
+{
+    size_t buf_size;
+
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    timer_init();
+    event_init();
+    pomodoro_sim_begin();
+
+    lv_init();
+    lv_log_register_print_cb(bench_lv_log_cb);
+    lv_tick_set_cb(bench_tick_cb);
+
+    // Whole-screen buffer in direct mode, as the SDL window of the app
+    disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    buf_size = (size_t)BENCH_HOR_RES * BENCH_VER_RES * lv_color_format_get_size(lv_display_get_color_format(disp));
+    frame_buf = malloc(buf_size);
+    if (frame_buf == NULL) {
+        fprintf(stderr, "no memory for the frame buffer\n");
+        return 1;
+    }
+    lv_display_set_buffers(disp, frame_buf, NULL, (uint32_t)buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, bench_flush_cb);
+    lv_display_add_event_cb(disp, bench_render_event_cb, LV_EVENT_RENDER_READY, NULL);
+
+    ui_main_screen(lv_screen_active());
+
+    printf("layout,case,enter_ms,enter_px,frames,ms_per_frame,px_per_s,objects,heap_used,heap_hwm\n");
+    run_case("IDLE", POMODORO_IDLE);
+
+    post(EVENT_START);
+    advance_until_percent(10);
+    run_case("WORK_10", POMODORO_WORK);
+    advance_until_percent(60);
+    run_case("WORK_60", POMODORO_WORK);
+    advance_until_percent(90);
+    run_case("WORK_90", POMODORO_WORK);
+
+    advance_until_state(POMODORO_SHORT_BREAK);
+    run_case("SHORT_BREAK", POMODORO_SHORT_BREAK);
+    post(EVENT_PAUSE);
+    run_case("PAUSED_BREAK", POMODORO_PAUSED_BREAK);
+    post(EVENT_RESUME);
+
+    advance_until_state(POMODORO_LONG_BREAK);
+    run_case("LONG_BREAK", POMODORO_LONG_BREAK);
+
+    post(EVENT_RESET);
+    post(EVENT_START);
+    advance_until_percent(10);
+    post(EVENT_PAUSE);
+    run_case("PAUSED_WORK", POMODORO_PAUSED_WORK);
+    post(EVENT_RESET);
+
+    ui_main_screen_set_low_power(true);
+    post(EVENT_START);
+    advance_until_percent(10);
+    run_case("WORK_LOW_POWER", POMODORO_WORK);
+    post(EVENT_RESET);
+    ui_main_screen_set_low_power(false);
+
+    // The overlay comes up after 10 s of WORK and fades in over 2 s
+    ui_main_screen_set_fullscreen(true);
+    post(EVENT_START);
+    pomodoro_sim_advance_ms(11000);
+    lv_timer_handler();
+    pomodoro_sim_advance_ms(2500);
+    lv_timer_handler();
+    run_case("FULLSCREEN", POMODORO_WORK);
+    post(EVENT_RESET);
+    ui_main_screen_set_fullscreen(false);
+
+    show_settings_screen(lv_screen_active());
+    run_case("SETTINGS", POMODORO_IDLE);
+
+    pomodoro_sim_end();
+    if (errors) {
+        fprintf(stderr, "FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file view_bench.c
+ * @brief Widget writes of the main screen: every tick against the view diff
+ *
+ * Replays a classic session (25/5/15 min, 4 cycles) on virtual time and, at
+ * each state and tick callback, counts what the main screen writes:
+ *
+ *  - before:        the update path the screen used up to the view model,
+ *                   timer text, arc value and both colours on every tick,
+ *                   every icon, button and label on every state change
+ *  - after:         ui_apply_view(), only the properties pomodoro_view_diff()
+ *                   reports as changed, the colour three times a pomodoro
+ *
+ * Each write is weighted by the pixels LVGL invalidates for it, from the
+ * widget sizes of the 480x480 layout (a style write repaints the whole
+ * widget, a new arc value only the sector between the two angles, hiding a
+ * hidden object nothing). Reported per minute of virtual time, by window of
+ * the session. The app logs the measured "after" numbers once a minute.
+ *
+ * Also timed: ns per pomodoro_view_get() + pomodoro_view_diff(), the work
+ * the UI now does on each tick before writing anything.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_MSC_VER)
+  #define _POSIX_C_SOURCE 199309L /* needed for clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_view.h"
+#include "pomodoro_sim.h"
+#include "core_log.h"
+
+#define BENCH_VIEWS         (1u << 20)
+
+/**
+ * @brief Widgets of the main screen, by the area a write to them invalidates
+ */
+typedef enum {
+    W_TIMER,        /**< "MM:SS", montserrat 28 */
+    W_ARC,          /**< 200x200 progress arc, whole object */
+    W_ARC_SECTOR,   /**< Arc between two values a second apart, with the 10 px width */
+    W_ICON,         /**< 64x64 mode icon */
+    W_BUTTON,       /**< Start / Reset / Settings */
+    W_BUTTON_LABEL, /**< Text of a button */
+    W_PAUSE,        /**< "Paused" */
+    W_CYCLE,        /**< "Cycle: 1 / 4" */
+    W_QUOTE,        /**< Quote marquee, 200 px wide */
+    W_COUNT
+} Widget_e;
+
+/* Estimated from the 480x480 layout of UI/main_screen.c */
+static const uint32_t widget_px[W_COUNT] = {
+    [W_TIMER]        = 84u * 34u,
+    [W_ARC]          = 200u * 200u,
+    [W_ARC_SECTOR]   = 20u * 20u,
+    [W_ICON]         = 64u * 64u,
+    [W_BUTTON]       = 72u * 77u,
+    [W_BUTTON_LABEL] = 50u * 16u,
+    [W_PAUSE]        = 60u * 16u,
+    [W_CYCLE]        = 100u * 16u,
+    [W_QUOTE]        = 200u * 16u,
+};
+
+/**
+ * @brief Writes and invalidated pixels of one update path
+ */
+typedef struct {
+    uint64_t writes;
+    uint64_t px;
+    uint8_t  icons_shown;   /**< POMODORO_ICON_*, hiding a hidden icon costs nothing */
+} Path_t;
+
+static Path_t before, after;
+static PomodoroViewModel_t applied;
+static bool applied_valid;
+static uint32_t band_changes;
+static uint32_t errors;
+static volatile uint32_t sink;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("check failed: %s\n", what);
+        errors++;
+    }
+}
+
+static void write_prop(Path_t *path, Widget_e w)
+{
+    path->writes++;
+    path->px += widget_px[w];
+}
+
+static void show_icon(Path_t *path, uint32_t bit)
+{
+    write_prop(path, W_ICON);
+    path->icons_shown |= (uint8_t)bit;
+}
+
+static void hide_icon(Path_t *path, uint32_t bit)
+{
+    path->writes++;
+    if (path->icons_shown & bit) path->px += widget_px[W_ICON];
+    path->icons_shown &= (uint8_t)~bit;
+}
+
+// ====================== Before: every tick ======================
+
+static void before_colours(void)
+{
+    write_prop(&before, W_TIMER);
+    write_prop(&before, W_ARC);
+}
+
+static void before_state(PomodoroState_e state)
+{
+    bool running = state == POMODORO_WORK || state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK;
+
+    // Mode icons: all hidden, one shown
+    for (uint32_t i = 0; i < POMODORO_ICON_COUNT; i++) hide_icon(&before, 1u << i);
+    switch (state) {
+        case POMODORO_IDLE:         show_icon(&before, POMODORO_ICON_READY); break;
+        case POMODORO_WORK:
+        case POMODORO_PAUSED_WORK:  show_icon(&before, POMODORO_ICON_RUN); break;
+        case POMODORO_SHORT_BREAK:  show_icon(&before, POMODORO_ICON_SHORT_BREAK); break;
+        case POMODORO_LONG_BREAK:   show_icon(&before, POMODORO_ICON_LONG_BREAK); break;
+        default:
+            show_icon(&before, (pomodoro_get_pause_break_type() == POMODORO_SHORT_BREAK)
+                               ? POMODORO_ICON_SHORT_BREAK : POMODORO_ICON_LONG_BREAK);
+            break;
+    }
+
+    // Buttons: five writes idle or running, the label and "Paused" when paused
+    if (state == POMODORO_IDLE || running) {
+        write_prop(&before, W_BUTTON);
+        write_prop(&before, W_BUTTON);
+        write_prop(&before, W_BUTTON_LABEL);
+        write_prop(&before, W_PAUSE);
+        write_prop(&before, W_BUTTON);
+    }
+    else {
+        write_prop(&before, W_BUTTON_LABEL);
+        write_prop(&before, W_PAUSE);
+    }
+
+    // Arc range except on pause and resume, then timer text and arc value
+    if (!pomodoro_is_resume_transition() && !pomodoro_is_pause_transition()) {
+        write_prop(&before, W_ARC);
+    }
+    write_prop(&before, W_TIMER);
+    write_prop(&before, W_ARC_SECTOR);
+    if (state == POMODORO_IDLE) before_colours();
+
+    // Cycle text and colour, quote scrolling
+    write_prop(&before, W_CYCLE);
+    write_prop(&before, W_CYCLE);
+    write_prop(&before, W_QUOTE);
+}
+
+static void before_tick(PomodoroState_e state)
+{
+    write_prop(&before, W_TIMER);
+    write_prop(&before, W_ARC_SECTOR);
+
+    if (state == POMODORO_WORK) {
+        uint8_t percent = pomodoro_get_work_progress_in_percent();
+
+        // The race or the speed icon is shown again on every tick past 50%
+        if (percent > 50) show_icon(&before, (percent < 80) ? POMODORO_ICON_RACE : POMODORO_ICON_SPEED);
+        before_colours();
+    }
+    else if (state == POMODORO_SHORT_BREAK || state == POMODORO_LONG_BREAK) {
+        before_colours();
+    }
+}
+
+// ====================== After: the view diff ======================
+
+/* Same writes as ui_apply_view() in UI/main_screen.c */
+static void after_apply(void)
+{
+    PomodoroViewModel_t view;
+    uint32_t changed;
+
+    pomodoro_view_get(&view);
+    changed = applied_valid ? pomodoro_view_diff(&applied, &view) : POMODORO_VIEW_ALL;
+
+    if (changed & POMODORO_VIEW_ICONS) {
+        uint32_t toggle = applied_valid ? (uint32_t)(applied.icons ^ view.icons) : 0xFFu;
+
+        for (uint32_t i = 0; i < POMODORO_ICON_COUNT; i++) {
+            if (!(toggle & (1u << i))) continue;
+            if (view.icons & (1u << i)) show_icon(&after, 1u << i);
+            else hide_icon(&after, 1u << i);
+        }
+    }
+    if (changed & POMODORO_VIEW_CONTROLS) {
+        write_prop(&after, W_BUTTON);
+        write_prop(&after, W_BUTTON);
+        write_prop(&after, W_BUTTON_LABEL);
+        write_prop(&after, W_PAUSE);
+        write_prop(&after, W_BUTTON);
+        write_prop(&after, W_QUOTE);
+    }
+    if (changed & POMODORO_VIEW_ARC_RANGE) write_prop(&after, W_ARC);
+    if (changed & POMODORO_VIEW_ARC_VALUE) write_prop(&after, W_ARC_SECTOR);
+    if (changed & POMODORO_VIEW_TIME) write_prop(&after, W_TIMER);
+    if (changed & POMODORO_VIEW_BAND) {
+        write_prop(&after, W_TIMER);
+        write_prop(&after, W_ARC);
+        band_changes++;
+    }
+    if (changed & POMODORO_VIEW_CYCLE) write_prop(&after, W_CYCLE);
+
+    applied = view;
+    applied_valid = true;
+}
+
+// ====================== Session ======================
+
+static void on_state(PomodoroState_e state)
+{
+    before_state(state);
+    after_apply();
+}
+
+static void on_tick(uint32_t remaining_ms)
+{
+    (void)remaining_ms;
+    before_tick(pomodoro_get_state());
+    after_apply();
+}
+
+static void report(const char *name, uint64_t ms, const Path_t *b0, const Path_t *a0)
+{
+    double min = (double)ms / 60000.0;
+    uint64_t bw = before.writes - b0->writes, aw = after.writes - a0->writes;
+    uint64_t bp = before.px - b0->px, ap = after.px - a0->px;
+
+    printf("%-26s %10.0f %10.0f %12.0f %12.0f\n", name, bw / min, aw / min, bp / min, ap / min);
+    check(aw <= bw, "the view diff writes more than every tick");
+}
+
+/* Advance ms of virtual time around action (may be NULL), report the window */
+static void run_window(const char *name, uint64_t ms, void (*action)(void))
+{
+    Path_t b0 = before, a0 = after;
+
+    if (action) action();
+    pomodoro_sim_advance_ms(ms);
+    report(name, ms, &b0, &a0);
+}
+
+/* Old reset button: the reset's own state callback and a forced IDLE update */
+static void reset_before_and_after(void)
+{
+    pomodoro_reset();
+    before_state(POMODORO_IDLE);
+}
+
+static void check_view(void)
+{
+    PomodoroViewModel_t a, b;
+
+    pomodoro_view_get(&a);
+    check(strcmp(a.time_text, "25:00") == 0, "time text at start");
+    check(a.arc_range_s == 25u * 60u && a.arc_value_s == 25u * 60u, "arc at start");
+    check(a.icons == POMODORO_ICON_RUN && a.band == POMODORO_BAND_CALM, "icons and band at start");
+    check(pomodoro_view_diff(&a, &a) == 0, "a view differs from itself");
+
+    pomodoro_sim_advance_ms(1000);
+    pomodoro_view_get(&b);
+    check(strcmp(b.time_text, "24:59") == 0, "time text after one second");
+    check(pomodoro_view_diff(&a, &b) == (POMODORO_VIEW_TIME | POMODORO_VIEW_ARC_VALUE), "fields of a tick");
+}
+
+/* Long phases keep all their minute digits, up to the 2^32 ms of the Core */
+static void check_long_phases(void)
+{
+    PomodoroSnapshot_t snap;
+    PomodoroViewModel_t view;
+
+    memset(&snap, 0, sizeof(snap));
+    snap.state = POMODORO_WORK;
+    snap.phase_duration_ms = snap.remaining_ms = 1080u * 60u * 1000u;
+    pomodoro_view_build(&view, &snap);
+    check(strcmp(view.time_text, "1080:00") == 0, "time text of a 1080 min phase");
+
+    snap.phase_duration_ms = snap.remaining_ms = UINT32_MAX;
+    pomodoro_view_build(&view, &snap);
+    check(strcmp(view.time_text, "71582:48") == 0, "time text of a 2^32 ms phase");
+    check(view.arc_value_s == 4294968u, "remaining seconds of a 2^32 ms phase");
+}
+
+static void bench_view(void)
+{
+    PomodoroViewModel_t prev, view;
+    uint64_t start;
+
+    pomodoro_view_get(&prev);
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_VIEWS; i++) {
+        pomodoro_view_get(&view);
+        sink += pomodoro_view_diff(&prev, &view);
+    }
+    printf("%-26s %10.2f ns\n", "view get + diff", (double)(bench_now_ns() - start) / BENCH_VIEWS);
+}
+
+int main(void)
+{
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    pomodoro_sim_begin();
+    pomodoro_init(25, 5, 15, 4);
+
+    // The screen as built: IDLE written once by both paths
+    before_state(POMODORO_IDLE);
+    after_apply();
+
+    pomodoro_set_state_callback(on_state);
+    pomodoro_set_tick_callback(on_tick);
+
+    printf("view_bench: classic session, 25/5/15 min, 4 cycles, 480x480 widget sizes\n");
+    printf("%-26s %10s %10s %12s %12s\n", "per minute", "writes", "writes", "px", "px");
+    printf("%-26s %10s %10s %12s %12s\n", "", "before", "after", "before", "after");
+
+    // Start and the first 25 minutes: the view diff writes the colour at 50 and 80%,
+    // and back at the break
+    {
+        Path_t b0 = before, a0 = after;
+
+        band_changes = 0;
+        pomodoro_start();
+        check_view();
+        check_long_phases();
+        pomodoro_sim_advance_ms(25u * 60u * 1000u - 1000u);
+        report("WORK, 25 min", 25u * 60u * 1000u, &b0, &a0);
+        check(band_changes == 3u, "colour changes in WORK and at the break");
+    }
+    check(pomodoro_get_state() == POMODORO_SHORT_BREAK, "short break after WORK");
+
+    run_window("SHORT_BREAK, 5 min", 5u * 60u * 1000u, NULL);
+    run_window("PAUSED_WORK, 2 min", 2u * 60u * 1000u, pomodoro_pause);
+    pomodoro_resume();
+    run_window("rest of the cycles", (2u * 25u + 2u * 5u + 25u + 15u) * 60u * 1000u, NULL);
+    run_window("reset, IDLE 1 min", 60u * 1000u, reset_before_and_after);
+    check(pomodoro_get_state() == POMODORO_IDLE, "IDLE after reset");
+
+    printf("%-26s %10llu %10llu %12llu %12llu\n", "session total",
+           (unsigned long long)before.writes, (unsigned long long)after.writes,
+           (unsigned long long)before.px, (unsigned long long)after.px);
+
+    pomodoro_set_tick_callback(NULL);
+    pomodoro_set_state_callback(NULL);
+    pomodoro_start();
+    bench_view();
+    pomodoro_sim_end();
+
+    if (errors) {
+        printf("FAILED (%u errors)\n", errors);
+        return 1;
+    }
+    return 0;
+}
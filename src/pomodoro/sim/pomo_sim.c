@@ -0,0 +1,212 @@
+/**
+ * @file pomo_sim.c
+ * @brief Headless driver for the Pomodoro engine on virtual time
+ *
+ * Runs the real Core (pomodoro.c, timer.c) through days of WORK / SHORT_BREAK
+ * / LONG_BREAK cycles in fast-forward and checks every callback against a
+ * model of the schedule:
+ *  - states follow WORK -> SHORT_BREAK ... -> LONG_BREAK every N cycles
+ *  - every phase lasts exactly its configured duration
+ *  - ticks count down every whole second of every phase, on the second
+ *  - the progress getters agree with the tick, also in phases over 11.9 h
+ *
+ * Usage: pomo_sim [-d days] [-w work_min] [-s short_min] [-l long_min]
+ *                 [-c cycles] [-t]
+ *   -t  no tick callback: only phase ends are simulated (capacity runs)
+ *
+ * Exit code is 0 when the run matched the model, 1 otherwise.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pomodoro.h"
+#include "pomodoro_sim.h"
+#include "monotonic.h"
+#include "core_log.h"
+
+#define SIM_MAX_REPORTED_ERRORS     10
+
+static struct {
+    uint32_t        work_ms;
+    uint32_t        short_ms;
+    uint32_t        long_ms;
+    uint8_t         cycles;
+    bool            with_ticks;
+
+    PomodoroState_e state;          /**< State the model expects the engine to be in */
+    uint32_t        completed;      /**< WORK phases completed */
+    uint64_t        phase_start_ns;
+    uint32_t        phase_ms;
+    uint32_t        next_tick_ms;   /**< Remaining time the next tick must report */
+
+    uint64_t        transitions;
+    uint64_t        ticks;
+    uint64_t        errors;
+} model;
+
+static uint64_t wall_now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void model_error(const char *what, uint64_t expected, uint64_t got)
+{
+    if (model.errors++ < SIM_MAX_REPORTED_ERRORS) {
+        printf("ERROR at transition %llu: %s, expected %llu, got %llu\n",
+               (unsigned long long)model.transitions, what,
+               (unsigned long long)expected, (unsigned long long)got);
+    }
+}
+
+static void model_phase_begin(PomodoroState_e state, uint32_t duration_ms)
+{
+    model.state = state;
+    model.phase_start_ns = monotonic_now_ns();
+    model.phase_ms = duration_ms;
+    model.next_tick_ms = duration_ms - 1000u;
+}
+
+static void on_state(PomodoroState_e state)
+{
+    uint64_t now = monotonic_now_ns();
+    PomodoroState_e expected;
+    uint32_t duration_ms;
+
+    if (model.state == POMODORO_IDLE) {
+        expected = POMODORO_WORK;
+    } else {
+        // A phase ended: it must have lasted exactly its duration and ticked every second
+        uint64_t elapsed = now - model.phase_start_ns;
+        if (elapsed != (uint64_t)model.phase_ms * MONOTONIC_NS_PER_MS) {
+            model_error("phase length (ns)", (uint64_t)model.phase_ms * MONOTONIC_NS_PER_MS, elapsed);
+        }
+        if (model.with_ticks && model.next_tick_ms != 0) {
+            model_error("ticks left in phase", 0, model.next_tick_ms / 1000u);
+        }
+
+        if (model.state == POMODORO_WORK) {
+            model.completed++;
+            expected = (model.completed % model.cycles == 0) ? POMODORO_LONG_BREAK : POMODORO_SHORT_BREAK;
+        } else {
+            expected = POMODORO_WORK;
+        }
+    }
+
+    if (state != expected) {
+        model_error("state", expected, state);
+    }
+
+    switch (expected) {
+        case POMODORO_SHORT_BREAK: duration_ms = model.short_ms; break;
+        case POMODORO_LONG_BREAK:  duration_ms = model.long_ms; break;
+        default:                   duration_ms = model.work_ms; break;
+    }
+    model.transitions++;
+    model_phase_begin(expected, duration_ms);
+}
+
+static void on_tick(uint32_t remaining_ms)
+{
+    uint64_t done_ms = model.phase_ms - remaining_ms;
+    uint64_t due = model.phase_start_ns + done_ms * MONOTONIC_NS_PER_MS;
+
+    if (remaining_ms != model.next_tick_ms) {
+        model_error("tick value (ms)", model.next_tick_ms, remaining_ms);
+    }
+    if (monotonic_now_ns() != due) {
+        model_error("tick time (ns)", due, monotonic_now_ns());
+    }
+    // On the second the interpolated progress is the tick's
+    if (pomodoro_get_work_progress_in_percent() != done_ms * 100u / model.phase_ms) {
+        model_error("progress (%)", done_ms * 100u / model.phase_ms, pomodoro_get_work_progress_in_percent());
+    }
+    if (pomodoro_get_progress_q16() != (done_ms << 16) / model.phase_ms) {
+        model_error("progress (Q16)", (done_ms << 16) / model.phase_ms, pomodoro_get_progress_q16());
+    }
+
+    model.next_tick_ms = (remaining_ms >= 1000u) ? (remaining_ms - 1000u) : 0;
+    model.ticks++;
+}
+
+static uint32_t parse_arg(int argc, char **argv, int *i)
+{
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "missing value for %s\n", argv[*i]);
+        exit(2);
+    }
+    return (uint32_t)strtoul(argv[++(*i)], NULL, 10);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t days = 1;
+    uint32_t work_min = POMODORO_DEF_WORK_MIN;
+    uint32_t short_min = POMODORO_DEF_SHORT_BREAK_MIN;
+    uint32_t long_min = POMODORO_DEF_LONG_BREAK_MIN;
+    uint32_t cycles = POMODORO_DEF_CYCLES_BEFORE_LONG;
+    bool with_ticks = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0)      days = parse_arg(argc, argv, &i);
+        else if (strcmp(argv[i], "-w") == 0) work_min = parse_arg(argc, argv, &i);
+        else if (strcmp(argv[i], "-s") == 0) short_min = parse_arg(argc, argv, &i);
+        else if (strcmp(argv[i], "-l") == 0) long_min = parse_arg(argc, argv, &i);
+        else if (strcmp(argv[i], "-c") == 0) cycles = parse_arg(argc, argv, &i);
+        else if (strcmp(argv[i], "-t") == 0) with_ticks = false;
+        else {
+            fprintf(stderr, "usage: %s [-d days] [-w work_min] [-s short_min] [-l long_min] [-c cycles] [-t]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (work_min == 0 || short_min == 0 || long_min == 0 || cycles == 0 || cycles > UINT8_MAX) {
+        fprintf(stderr, "durations and cycles must be at least 1 (cycles at most %d)\n", UINT8_MAX);
+        return 2;
+    }
+
+    model.work_ms = work_min * 60u * 1000u;
+    model.short_ms = short_min * 60u * 1000u;
+    model.long_ms = long_min * 60u * 1000u;
+    model.cycles = (uint8_t)cycles;
+    model.with_ticks = with_ticks;
+    model.state = POMODORO_IDLE;
+
+    // One line per transition would dominate the run
+    core_log_set_level(CORE_LOG_LEVEL_WARN);
+    pomodoro_sim_begin();
+    pomodoro_init(work_min, short_min, long_min, (uint8_t)cycles);
+    pomodoro_set_state_callback(on_state);
+    pomodoro_set_tick_callback(with_ticks ? on_tick : NULL);
+
+    uint64_t start = wall_now_ns();
+    pomodoro_start();
+    for (uint32_t d = 0; d < days; d++) {
+        pomodoro_sim_advance_ms(24ull * 3600u * 1000u);
+    }
+    uint64_t wall_ns = wall_now_ns() - start;
+
+    PomodoroSimStats_t stats;
+    pomodoro_sim_get_stats(&stats);
+    pomodoro_sim_end();
+
+    double wall_s = (double)wall_ns / 1e9;
+    printf("pomo_sim: %u day(s), work %u / short %u / long %u min, long break every %u, ticks %s\n",
+           days, work_min, short_min, long_min, cycles, with_ticks ? "on" : "off");
+    printf("  simulated   %.1f h in %.3f ms wall (%.0fx real time)\n",
+           (double)stats.sim_ns / 3.6e12, wall_s * 1e3, wall_s > 0 ? ((double)stats.sim_ns / 1e9) / wall_s : 0.0);
+    printf("  transitions %llu (%.2f M/s), pomodoros %u\n",
+           (unsigned long long)model.transitions, wall_s > 0 ? (double)model.transitions / wall_s / 1e6 : 0.0,
+           model.completed);
+    printf("  ticks       %llu (%.2f M/s), wakeups %llu\n",
+           (unsigned long long)model.ticks, wall_s > 0 ? (double)model.ticks / wall_s / 1e6 : 0.0,
+           (unsigned long long)stats.wakeups);
+    printf("  %s (%llu errors)\n", model.errors ? "FAIL" : "OK", (unsigned long long)model.errors);
+
+    return model.errors ? 1 : 0;
+}